@@ -39,6 +39,11 @@ public:
     bool isWriteable() const;
     bool isExecutable() const;
 
+    // FileUtils::sortKeyOfString of the display name and of the sort data,
+    // kept until the string changes, they may be called from several threads
+    QByteArray nameSortKey(const QString &name) const;
+    QByteArray dataSortKey(const QString &data) const;
+
 private:
     QScopedPointer<SortFileInfoPrivate> d;
 };
@@ -19,6 +19,18 @@ namespace dfmbase {
 class InfoCachePrivate;
 class InfoCache;
 
+struct InfoCacheStatistics
+{
+    quint64 hits { 0 };
+    quint64 misses { 0 };
+    quint64 inserts { 0 };
+    quint64 evictions { 0 };
+    quint64 removals { 0 };
+    int count { 0 };
+    qint64 cost { 0 };   // estimated bytes
+    qint64 capacity { 0 };
+};
+
 // 异步缓存和移除
 class CacheWorker : public QObject
 {
@@ -30,9 +42,7 @@ public:
 public Q_SLOTS:
     void cacheInfo(const QUrl url, const FileInfoPointer info);
     void removeCaches(const QList<QUrl> urls);
-    void updateInfoTime(const QUrl url);
     void dealRemoveInfo();
-    void removeInfosTime(const QList<QUrl> urls);
     void disconnectWatcher(const QMap<QUrl, FileInfoPointer> infos);
 
 private:
@@ -55,8 +65,6 @@ public:
 Q_SIGNALS:
     void cacheRemoveCaches(const QList<QUrl> &key);
     void cacheDisconnectWatcher(const QMap<QUrl, FileInfoPointer> infos);
-    void cacheUpdateInfoTime(const QUrl url);
-    void cacheRemoveInfosTime(const QList<QUrl> urls);
 
 private:
     explicit InfoCache(QObject *parent = nullptr);
@@ -68,9 +76,9 @@ private:
     void cacheInfo(const QUrl url, const FileInfoPointer info);
     void disconnectWatcher(const QMap<QUrl, FileInfoPointer> infos);
     void removeCaches(const QList<QUrl> urls);
-    void updateSortTimeWorker(const QUrl url);
     void timeRemoveCache();
-    void removeInfosTimeWorker(const QList<QUrl> urls);
+    void evictCaches(bool aging);
+    InfoCacheStatistics statistics() const;
 
 private Q_SLOTS:
     void fileAttributeChanged(const QUrl url);
@@ -91,6 +99,7 @@ public:
     bool cacheDisable(const QString &scheme);
     void setCacheDisbale(const QString &scheme, bool disable = true);
     FileInfoPointer getCacheInfo(const QUrl &url);
+    InfoCacheStatistics statistics() const;
 Q_SIGNALS:
     void cacheFileInfo(const QUrl url, const FileInfoPointer info);
     void removeCacheFileInfo(const QList<QUrl> &urls);
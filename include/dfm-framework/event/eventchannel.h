@@ -37,12 +37,23 @@ class EventChannel
 {
 public:
     using Connector = std::function<QVariant(const QVariantList &)>;
+    using Receiver = std::shared_ptr<const EventHandler<Connector>>;
 
     QVariant send();
     QVariant send(const QVariantList &params);
     template<class T, class... Args>
     inline QVariant send(T param, Args &&... args)
     {
+        if constexpr (IsTypedCallable<T, Args...>::value) {
+            const Receiver &conn = std::atomic_load(&receiver);
+            if (!conn)
+                return QVariant();
+
+            QVariant ret;
+            if (typedInvoke(*conn, &ret, param, args...))
+                return ret;
+        }
+
         QVariantList ret;
         makeVariantList(&ret, param, std::forward<Args>(args)...);
         return send(ret);
@@ -64,16 +75,23 @@ public:
         static_assert(std::is_base_of<QObject, T>::value, "Template type T must be derived QObject");
         static_assert(!std::is_pointer<T>::value, "Receiver::bind's template type T must not be a pointer type");
 
-        QMutexLocker guard(&receiverMutex);
-        conn = [obj, method](const QVariantList &args) -> QVariant {
+        auto conn = [obj, method](const QVariantList &args) -> QVariant {
             EventHelper<decltype(method)> helper = (EventHelper<decltype(method)>(obj, method));
             return helper.invoke(args);
         };
+
+        using Typed = TypedEventHelper<decltype(method)>;
+        std::atomic_store(&receiver, std::make_shared<const EventHandler<Connector>>(obj, memberFunctionVoidCast(method), conn,
+                                                                                     Typed::arguments(), Typed::template create<QVariant>(obj, method)));
+    }
+
+    inline void clear()
+    {
+        std::atomic_store(&receiver, Receiver());
     }
 
 private:
-    Connector conn;
-    QMutex receiverMutex;
+    Receiver receiver;
 };
 
 class EventChannelManager
@@ -99,13 +117,7 @@ public:
         }
 
         QWriteLocker guard(&rwLock);
-        if (channelMap.contains(type)) {
-            channelMap[type]->setReceiver(obj, method);
-        } else {
-            ChannelPtr Channel { new EventChannel };
-            Channel->setReceiver(obj, method);
-            channelMap.insert(type, Channel);
-        }
+        channelMap.valueOrInsert(type)->setReceiver(obj, method);
         return true;
     }
 
@@ -124,12 +136,8 @@ public:
     [[gnu::hot]] inline QVariant push(EventType type, T param, Args &&... args)
     {
         threadEventAlert(type);
-        QReadLocker guard(&rwLock);
-        if (Q_LIKELY(channelMap.contains(type))) {
-            auto channel = channelMap.value(type);
-            guard.unlock();
+        if (auto channel = channelMap.value(type))
             return channel->send(param, std::forward<Args>(args)...);
-        }
         return QVariant();
     }
 
@@ -143,14 +151,8 @@ public:
     inline QVariant push(const EventType &type)
     {
         threadEventAlert(type);
-        QReadLocker guard(&rwLock);
-        if (Q_LIKELY(channelMap.contains(type))) {
-            auto channel = channelMap.value(type);
-            guard.unlock();
-            if (channel)
-                return channel->send();
-        }
-
+        if (auto channel = channelMap.value(type))
+            return channel->send();
         return QVariant();
     }
 
@@ -164,12 +166,8 @@ public:
     template<class T, class... Args>
     inline EventChannelFuture post(EventType type, T param, Args &&... args)
     {
-        QReadLocker guard(&rwLock);
-        if (Q_LIKELY(channelMap.contains(type))) {
-            auto channel { channelMap[type] };
-            guard.unlock();
+        if (auto channel = channelMap.value(type))
             return channel->asyncSend(param, std::forward<Args>(args)...);
-        }
         return EventChannelFuture(QFuture<QVariant>());
     }
 
@@ -181,18 +179,13 @@ public:
 
     inline EventChannelFuture post(const EventType &type)
     {
-        QReadLocker guard(&rwLock);
-        if (Q_LIKELY(channelMap.contains(type))) {
-            auto channel { channelMap[type] };
-            guard.unlock();
+        if (auto channel = channelMap.value(type))
             return channel->asyncSend();
-        }
         return EventChannelFuture(QFuture<QVariant>());
     }
 
 private:
-    using ChannelPtr = QSharedPointer<EventChannel>;
-    using EventChannelMap = QMap<EventType, ChannelPtr>;
+    using EventChannelMap = EventTable<EventChannel>;
 
 private:
     EventChannelMap channelMap;
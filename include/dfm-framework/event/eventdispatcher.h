@@ -20,17 +20,44 @@ class EventDispatcher
 {
 public:
     using Listener = std::function<QVariant(const QVariantList &)>;
-    using HandlerList = QList<EventHandler<Listener>>;
-    using FilterList = QList<EventHandler<Listener>>;
+    using HandlerList = EventHandlerList<Listener>;
+    using FilterList = EventHandlerList<Listener>;
 
     bool dispatch();
     bool dispatch(const QVariantList &params);
     template<class T, class... Args>
     inline bool dispatch(T param, Args &&... args)
     {
-        QVariantList ret;
-        makeVariantList(&ret, param, std::forward<Args>(args)...);
-        return dispatch(ret);
+        if constexpr (IsTypedCallable<T, Args...>::value) {
+            const auto &filters = filterList.snapshot();
+            const auto &handlers = handlerList.snapshot();
+            // the arguments are packed only for the handlers taking other types
+            QVariantList params;
+            auto variantParams = [&]() -> const QVariantList & {
+                if (params.isEmpty())
+                    makeVariantList(&params, param, args...);
+                return params;
+            };
+
+            for (const auto &filter : *filters) {
+                bool filtered { false };
+                if (!typedInvoke(filter, &filtered, param, args...))
+                    filtered = filter.handler(variantParams()).toBool();
+                if (filtered)
+                    return false;
+            }
+
+            for (const auto &handler : *handlers) {
+                bool ret { false };
+                if (!typedInvoke(handler, &ret, param, args...))
+                    handler.handler(variantParams());
+            }
+            return true;
+        } else {
+            QVariantList ret;
+            makeVariantList(&ret, param, std::forward<Args>(args)...);
+            return dispatch(ret);
+        }
     }
 
     QFuture<bool> asyncDispatch();
@@ -54,7 +81,9 @@ public:
             return helper.invoke(args);
         };
 
-        handlerList.push_back(EventHandler<Listener> { obj, memberFunctionVoidCast(method), func });
+        using Typed = TypedEventHelper<decltype(method)>;
+        handlerList.append(EventHandler<Listener> { obj, memberFunctionVoidCast(method), func,
+                                                    Typed::arguments(), Typed::template create<bool>(obj, method) });
     }
 
     template<class T, class Func>
@@ -63,17 +92,7 @@ public:
         static_assert(std::is_base_of<QObject, T>::value, "Template type T must be derived QObject");
         static_assert(!std::is_pointer<T>::value, "Receiver::bind's template type T must not be a pointer type");
 
-        bool ret { true };
-        for (auto handler : handlerList) {
-            if (handler.compare(obj, method)) {
-                if (!handlerList.removeOne(handler)) {
-                    qWarning() << "Cannot remove: " << handler.objectIndex->objectName();
-                    ret = false;
-                }
-            }
-        }
-
-        return ret;
+        return handlerList.remove(obj, method);
     }
 
     template<class T, class Func>
@@ -90,7 +109,10 @@ public:
             EventHelper<decltype(method)> helper = (EventHelper<decltype(method)>(obj, method));
             return helper.invoke(args).toBool();
         };
-        filterList.push_back(EventHandler<Listener> { obj, memberFunctionVoidCast(method), func });
+
+        using Typed = TypedEventHelper<decltype(method)>;
+        filterList.append(EventHandler<Listener> { obj, memberFunctionVoidCast(method), func,
+                                                   Typed::arguments(), Typed::template create<bool>(obj, method) });
     }
 
     template<class T, class Func>
@@ -103,17 +125,13 @@ public:
 #elif __cplusplus > 201103L
         static_assert(std::is_same<bool, ReturnType<decltype(method)>>::value, "Template method's ReturnType must is bool");
 #endif
-        bool ret { true };
-        for (auto handler : filterList) {
-            if (handler.compare(obj, method)) {
-                if (!filterList.removeOne(handler)) {
-                    qWarning() << "Cannot remove: " << handler.objectIndex->objectName();
-                    ret = false;
-                }
-            }
-        }
+        return filterList.remove(obj, method);
+    }
 
-        return ret;
+    inline void clear()
+    {
+        handlerList.clear();
+        filterList.clear();
     }
 
 private:
@@ -146,13 +164,7 @@ public:
         }
 
         QWriteLocker lk(&rwLock);
-        if (dispatcherMap.contains(type)) {
-            dispatcherMap[type]->append(obj, method);
-        } else {
-            DispatcherPtr dispatcher { new EventDispatcher };
-            dispatcher->append(obj, method);
-            dispatcherMap.insert(type, dispatcher);
-        }
+        dispatcherMap.valueOrInsert(type)->append(obj, method);
         return true;
     }
 
@@ -170,8 +182,8 @@ public:
             return false;
 
         QWriteLocker lk(&rwLock);
-        if (dispatcherMap.contains(type))
-            return dispatcherMap[type]->remove(obj, std::move(method));
+        if (auto dispatcher = dispatcherMap.value(type))
+            return dispatcher->remove(obj, std::move(method));
 
         return false;
     }
@@ -195,13 +207,8 @@ public:
                 return false;
         }
 
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(dispatcherMap.contains(type))) {
-            auto dispatcher = dispatcherMap.value(type);
-            lk.unlock();
-            if (dispatcher)
-                return dispatcher->dispatch(param, std::forward<Args>(args)...);
-        }
+        if (auto dispatcher = dispatcherMap.value(type))
+            return dispatcher->dispatch(param, std::forward<Args>(args)...);
         return false;
     }
 
@@ -218,13 +225,8 @@ public:
         if (!globalFilterMap.isEmpty() && globalFiltered(type, QVariantList()))
             return false;
 
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(dispatcherMap.contains(type))) {
-            auto dispatcher = dispatcherMap.value(type);
-            lk.unlock();
-            if (dispatcher)
-                return dispatcher->dispatch();
-        }
+        if (auto dispatcher = dispatcherMap.value(type))
+            return dispatcher->dispatch();
         return false;
     }
 
@@ -245,13 +247,8 @@ public:
                 return QFuture<bool>();
         }
 
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(dispatcherMap.contains(type))) {
-            auto dispatcher { dispatcherMap[type] };
-            Q_ASSERT(dispatcher);
-            lk.unlock();
+        if (auto dispatcher = dispatcherMap.value(type))
             return dispatcher->asyncDispatch(param, std::forward<Args>(args)...);
-        }
         return QFuture<bool>();
     }
 
@@ -266,13 +263,8 @@ public:
         if (!globalFilterMap.isEmpty() && globalFiltered(type, QVariantList()))
             return QFuture<bool>();
 
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(dispatcherMap.contains(type))) {
-            auto dispatcher { dispatcherMap[type] };
-            Q_ASSERT(dispatcher);
-            lk.unlock();
+        if (auto dispatcher = dispatcherMap.value(type))
             return dispatcher->asyncDispatch();
-        }
         return QFuture<bool>();
     }
 
@@ -300,13 +292,7 @@ public:
         }
 
         QWriteLocker lk(&rwLock);
-        if (dispatcherMap.contains(type)) {
-            dispatcherMap[type]->appendFilter(obj, method);
-        } else {
-            DispatcherPtr dispatcher { new EventDispatcher };
-            dispatcher->appendFilter(obj, method);
-            dispatcherMap.insert(type, dispatcher);
-        }
+        dispatcherMap.valueOrInsert(type)->appendFilter(obj, method);
         return true;
     }
 
@@ -324,8 +310,8 @@ public:
             return false;
 
         QWriteLocker lk(&rwLock);
-        if (dispatcherMap.contains(type))
-            return dispatcherMap[type]->removeFilter(obj, std::move(method));
+        if (auto dispatcher = dispatcherMap.value(type))
+            return dispatcher->removeFilter(obj, std::move(method));
 
         return false;
     }
@@ -335,8 +321,7 @@ protected:
     bool unsubscribe(EventType type);
 
 private:
-    using DispatcherPtr = QSharedPointer<EventDispatcher>;
-    using EventDispatcherMap = QMap<EventType, DispatcherPtr>;
+    using EventDispatcherMap = EventTable<EventDispatcher>;
     using GlobalEventFilterMap = QMap<QObject *, GlobalFilter>;
 
 private:
@@ -9,12 +9,23 @@
 
 #include <QDebug>
 #include <QVariant>
+#include <QHash>
 #include <QObject>
 #include <QUrl>
 #include <QThread>
 #include <QCoreApplication>
 
+#include <QMutex>
+
 #include <mutex>
+#include <memory>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <tuple>
+#include <typeinfo>
+#include <functional>
+#include <algorithm>
 
 DPF_BEGIN_NAMESPACE
 
@@ -500,6 +511,88 @@ protected:
     Func f;
 };
 
+/*
+ * typed invoke of the handler, without packing the arguments into a QVariantList.
+ * It is taken when the decayed types of the arguments of the caller are the
+ * decayed parameter types of the handler, other calls go through EventHelper,
+ * which converts the arguments as QVariant does.
+ */
+template<class... Args>
+using TypedArguments = std::tuple<const Args &...>;
+
+template<class Ret, class... Args>
+using TypedHandler = std::function<Ret(const TypedArguments<Args...> &)>;
+
+// the arguments are passed without a copy only if they are not arrays or functions
+template<class... Args>
+struct IsTypedCallable : std::integral_constant<bool, (std::is_same<std::decay_t<Args>, std::remove_cv_t<std::remove_reference_t<Args>>>::value && ...)>
+{
+};
+
+template<class Handler>
+struct TypedEventHelper;
+
+template<class Result, class T, class... Args>
+struct TypedEventHelper<Result (T::*)(Args...)>
+{
+    using Func = Result (T::*)(Args...);
+
+    // Ret is bool for the hooks and the filters, QVariant for the slots
+    // and the return value of a signal handler is dropped
+    template<class Ret>
+    static std::shared_ptr<const void> create(T *self, Func func)
+    {
+        if constexpr ((std::is_rvalue_reference<Args>::value || ...)) {
+            return {};
+        } else {
+            auto handler = [self, func](const TypedArguments<std::decay_t<Args>...> &args) -> Ret {
+                return invoke<Ret>(self, func, args);
+            };
+            return std::make_shared<const TypedHandler<Ret, std::decay_t<Args>...>>(handler);
+        }
+    }
+
+    static const std::type_info *arguments()
+    {
+        return &typeid(std::tuple<std::decay_t<Args>...>);
+    }
+
+private:
+    // the parameters are values or const references, as EventHelper requires
+    template<class Ret>
+    static Ret invoke(T *self, Func func, const TypedArguments<std::decay_t<Args>...> &args)
+    {
+        return std::apply([self, func](const auto &... params) { return call<Ret>(self, func, params...); }, args);
+    }
+
+    template<class Ret, class... Params>
+    static Ret call(T *self, Func func, const Params &... params)
+    {
+        if constexpr (std::is_same<Ret, QVariant>::value) {
+            QVariant ret = resultGenerator<Result>();
+            emit(self->*func)(params...), ApplyReturnValue<Result>(ret.data());
+            return ret;
+        } else if constexpr (std::is_same<Result, bool>::value) {
+            return (self->*func)(params...);
+        } else {
+            (self->*func)(params...);
+            return Ret();
+        }
+    }
+};
+
+// calls the typed handler of \a handler if it takes the arguments, returns false otherwise
+template<class Ret, class Handler, class... Args>
+inline bool typedInvoke(const Handler &handler, Ret *ret, const Args &... args)
+{
+    if (!handler.typedHandler || *handler.argumentsType != typeid(std::tuple<Args...>))
+        return false;
+
+    const auto *func = static_cast<const TypedHandler<Ret, Args...> *>(handler.typedHandler.get());
+    *ret = (*func)(TypedArguments<Args...>(args...));
+    return true;
+}
+
 /*
  * cast member function to void *
  */
@@ -637,6 +730,9 @@ struct EventHandler
     // See: https://stackoverflow.com/questions/1307278/casting-between-void-and-a-pointer-to-member-function
     void *funcIndex;
     Method handler;
+    // see TypedEventHelper
+    const std::type_info *argumentsType { nullptr };
+    std::shared_ptr<const void> typedHandler;
 
     inline EventHandler(QObject *obj, void *func, Method method)
         : objectIndex(obj),
@@ -645,6 +741,16 @@ struct EventHandler
     {
     }
 
+    inline EventHandler(QObject *obj, void *func, Method method,
+                        const std::type_info *argsType, std::shared_ptr<const void> typed)
+        : objectIndex(obj),
+          funcIndex(func),
+          handler(method),
+          argumentsType(argsType),
+          typedHandler(std::move(typed))
+    {
+    }
+
     inline bool compare(QObject *obj)
     {
         if (!objectIndex)
@@ -667,6 +773,137 @@ struct EventHandler
     }
 };
 
+/*
+ * copy-on-write list of the event handlers, the dispatching thread takes a
+ * snapshot of the list without a lock and the changes replace the list
+ */
+template<class Method>
+class EventHandlerList
+{
+public:
+    using List = QList<EventHandler<Method>>;
+    using Snapshot = std::shared_ptr<const List>;
+
+    inline Snapshot snapshot() const
+    {
+        return std::atomic_load(&list);
+    }
+
+    inline bool isEmpty() const
+    {
+        return snapshot()->isEmpty();
+    }
+
+    inline int count() const
+    {
+        return snapshot()->count();
+    }
+
+    inline void append(const EventHandler<Method> &handler)
+    {
+        QMutexLocker guard(&writeMutex);
+        auto copied = std::make_shared<List>(*list);
+        copied->push_back(handler);
+        std::atomic_store(&list, Snapshot(std::move(copied)));
+    }
+
+    template<class T, class Func>
+    inline bool remove(T *obj, Func method)
+    {
+        QMutexLocker guard(&writeMutex);
+        auto copied = std::make_shared<List>(*list);
+        auto it = std::remove_if(copied->begin(), copied->end(), [obj, method](EventHandler<Method> &handler) {
+            return handler.compare(obj, method);
+        });
+        copied->erase(it, copied->end());
+        std::atomic_store(&list, Snapshot(std::move(copied)));
+        return true;
+    }
+
+    inline void clear()
+    {
+        QMutexLocker guard(&writeMutex);
+        std::atomic_store(&list, Snapshot(std::make_shared<const List>()));
+    }
+
+private:
+    Snapshot list { std::make_shared<const List>() };
+    QMutex writeMutex;
+};
+
+/*
+ * flat table of the event objects indexed by the event type, the lookup takes
+ * two atomic loads. The objects removed from the table are never deleted while
+ * the table lives, so a dispatching thread never holds a deleted object; instead
+ * the object is cleared and put back when its type is inserted again, which keeps
+ * the table bounded by the number of event types.
+ * The changes must be serialized by the caller.
+ */
+template<class T>
+class EventTable
+{
+public:
+    inline T *value(EventType type) const
+    {
+        if (Q_UNLIKELY(!isValidEventType(type)))
+            return nullptr;
+        const Block *block = blocks[std::size_t(type) >> kBlockBits].load(std::memory_order_acquire);
+        return block ? (*block)[std::size_t(type) & kBlockMask].load(std::memory_order_acquire) : nullptr;
+    }
+
+    inline bool contains(EventType type) const
+    {
+        return value(type) != nullptr;
+    }
+
+    inline T *insert(EventType type)
+    {
+        Q_ASSERT(isValidEventType(type));
+        auto &blockSlot = blocks[std::size_t(type) >> kBlockBits];
+        Block *block = blockSlot.load(std::memory_order_relaxed);
+        if (!block) {
+            ownedBlocks.emplace_back(new Block());
+            block = ownedBlocks.back().get();
+            blockSlot.store(block, std::memory_order_release);
+        }
+
+        T *item = retiredItems.take(type);
+        if (item) {
+            item->clear();
+        } else {
+            ownedItems.emplace_back(new T);
+            item = ownedItems.back().get();
+        }
+        (*block)[std::size_t(type) & kBlockMask].store(item, std::memory_order_release);
+        return item;
+    }
+
+    inline T *valueOrInsert(EventType type)
+    {
+        T *item = value(type);
+        return item ? item : insert(type);
+    }
+
+    inline bool remove(EventType type)
+    {
+        if (!contains(type))
+            return false;
+        Block *block = blocks[std::size_t(type) >> kBlockBits].load(std::memory_order_relaxed);
+        retiredItems.insert(type, (*block)[std::size_t(type) & kBlockMask].exchange(nullptr, std::memory_order_acq_rel));
+        return true;
+    }
+
+private:
+    static constexpr std::size_t kBlockBits { 8 };
+    static constexpr std::size_t kBlockMask { (1 << kBlockBits) - 1 };
+    using Block = std::array<std::atomic<T *>, kBlockMask + 1>;
+
+    std::array<std::atomic<Block *>, ((EventTypeScope::kCustomTop + 1) >> kBlockBits)> blocks {};
+    std::vector<std::unique_ptr<Block>> ownedBlocks;
+    std::vector<std::unique_ptr<T>> ownedItems;
+    QHash<EventType, T *> retiredItems;
+};
+
 DPF_END_NAMESPACE
 
 #endif   // EVENTHELPER_H
@@ -21,16 +21,33 @@ class EventSequence
 {
 public:
     using Sequence = std::function<bool(const QVariantList &)>;
-    using HandlerList = QList<EventHandler<Sequence>>;
+    using HandlerList = EventHandlerList<Sequence>;
 
     bool traversal();
     bool traversal(const QVariantList &params);
     template<class T, class... Args>
     inline bool traversal(T param, Args &&... args)
     {
-        QVariantList ret;
-        makeVariantList(&ret, param, std::forward<Args>(args)...);
-        return traversal(ret);
+        if constexpr (IsTypedCallable<T, Args...>::value) {
+            const auto &handlers = list.snapshot();
+            // the arguments are packed only for the handlers taking other types
+            QVariantList params;
+            for (const auto &seq : *handlers) {
+                bool ret { false };
+                if (!typedInvoke(seq, &ret, param, args...)) {
+                    if (params.isEmpty())
+                        makeVariantList(&params, param, args...);
+                    ret = seq.handler(params);
+                }
+                if (ret)
+                    return true;
+            }
+            return false;
+        } else {
+            QVariantList ret;
+            makeVariantList(&ret, param, std::forward<Args>(args)...);
+            return traversal(ret);
+        }
     }
 
     template<class T, class Func>
@@ -44,12 +61,14 @@ public:
         static_assert(std::is_same<bool, ReturnType<decltype(method)>>::value, "Template method's ReturnType must is bool");
 #endif
 
-        QMutexLocker guard(&sequenceMutex);
         auto func = [obj, method](const QVariantList &args) -> bool {
             EventHelper<decltype(method)> helper = (EventHelper<decltype(method)>(obj, method));
             return helper.invoke(args).toBool();
         };
-        list.push_back(EventHandler<Sequence> { obj, memberFunctionVoidCast(method), func });
+
+        using Typed = TypedEventHelper<decltype(method)>;
+        list.append(EventHandler<Sequence> { obj, memberFunctionVoidCast(method), func,
+                                             Typed::arguments(), Typed::template create<bool>(obj, method) });
     }
 
     template<class T, class Func>
@@ -63,23 +82,16 @@ public:
         static_assert(std::is_same<bool, ReturnType<decltype(method)>>::value, "Template method's ReturnType must is bool");
 #endif
 
-        bool ret { true };
-        QMutexLocker guard(&sequenceMutex);
-        for (auto handler : list) {
-            if (handler.compare(obj, method)) {
-                if (!list.removeOne(handler)) {
-                    qWarning() << "Cannot remove: " << handler.objectIndex->objectName();
-                    ret = false;
-                }
-            }
-        }
+        return list.remove(obj, method);
+    }
 
-        return ret;
+    inline void clear()
+    {
+        list.clear();
     }
 
 private:
     HandlerList list {};
-    QMutex sequenceMutex;
 };
 
 class EventSequenceManager
@@ -105,13 +117,7 @@ public:
         }
 
         QWriteLocker lk(&rwLock);
-        if (sequenceMap.contains(type)) {
-            sequenceMap[type]->append(obj, method);
-        } else {
-            SequencePtr sequence { new EventSequence };
-            sequence->append(obj, method);
-            sequenceMap.insert(type, sequence);
-        }
+        sequenceMap.valueOrInsert(type)->append(obj, method);
         return true;
     }
 
@@ -129,8 +135,8 @@ public:
             return false;
 
         QWriteLocker lk(&rwLock);
-        if (sequenceMap.contains(type))
-            return sequenceMap[type]->remove(obj, std::move(method));
+        if (auto sequence = sequenceMap.value(type))
+            return sequence->remove(obj, std::move(method));
 
         return false;
     }
@@ -147,13 +153,8 @@ public:
     inline bool run(EventType type, T param, Args &&... args)
     {
         threadEventAlert(type);
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(sequenceMap.contains(type))) {
-            auto sequence = sequenceMap.value(type);
-            lk.unlock();
-            if (sequence)
-                return sequence->traversal(param, std::forward<Args>(args)...);
-        }
+        if (auto sequence = sequenceMap.value(type))
+            return sequence->traversal(param, std::forward<Args>(args)...);
         return false;
     }
 
@@ -167,13 +168,8 @@ public:
     inline bool run(EventType type)
     {
         threadEventAlert(type);
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(sequenceMap.contains(type))) {
-            auto sequence = sequenceMap.value(type);
-            lk.unlock();
-            if (sequence)
-                return sequence->traversal();
-        }
+        if (auto sequence = sequenceMap.value(type))
+            return sequence->traversal();
         return false;
     }
 
@@ -182,8 +178,7 @@ protected:
     bool unfollow(EventType type);
 
 private:
-    using SequencePtr = QSharedPointer<EventSequence>;
-    using EventSequenceMap = QMap<EventType, SequencePtr>;
+    using EventSequenceMap = EventTable<EventSequence>;
 
 private:
     EventSequenceMap sequenceMap;
@@ -8,6 +8,7 @@
 #include <dfm-base/interfaces/sortfileinfo.h>
 
 #include <QPointer>
+#include <QReadWriteLock>
 
 namespace dfmbase {
 class SortFileInfoPrivate
@@ -27,6 +28,13 @@ public:
     bool readable { false };
     bool writeable { false };
     bool executable { false };
+
+    // the sort infos are shared by the sort workers of a directory
+    QReadWriteLock keyLock;
+    QString keyName;
+    QByteArray nameKey;
+    QString keyData;
+    QByteArray dataKey;
 };
 
 }
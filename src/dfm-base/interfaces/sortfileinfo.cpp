@@ -4,6 +4,8 @@
 
 #include "private/sortfileinfo_p.h"
 
+#include <dfm-base/utils/fileutils.h>
+
 namespace dfmbase {
 SortFileInfo::SortFileInfo()
     : d(new SortFileInfoPrivate(this))
@@ -106,6 +108,39 @@ bool SortFileInfo::isExecutable() const
     return d->executable;
 }
 
+QByteArray SortFileInfo::nameSortKey(const QString &name) const
+{
+    {
+        QReadLocker lk(&d->keyLock);
+        if (!d->nameKey.isEmpty() && d->keyName == name)
+            return d->nameKey;
+    }
+
+    // made out of the lock, another thread may store the same key meanwhile
+    const QByteArray &key = FileUtils::sortKeyOfString(name);
+    QWriteLocker lk(&d->keyLock);
+    d->nameKey = key;
+    d->keyName = name;
+    return key;
+}
+
+QByteArray SortFileInfo::dataSortKey(const QString &data) const
+{
+    {
+        QReadLocker lk(&d->keyLock);
+        if (!d->nameKey.isEmpty() && d->keyName == data)
+            return d->nameKey;
+        if (!d->dataKey.isEmpty() && d->keyData == data)
+            return d->dataKey;
+    }
+
+    const QByteArray &key = FileUtils::sortKeyOfString(data);
+    QWriteLocker lk(&d->keyLock);
+    d->dataKey = key;
+    d->keyData = data;
+    return key;
+}
+
 SortFileInfoPrivate::SortFileInfoPrivate(SortFileInfo *qq)
     : q(qq)
 {
@@ -0,0 +1,173 @@
+# Generates the pinyin table of Chinese2Pinyin from pinyin.dict at build time.
+#
+# Included by a CMakeLists.txt, it provides dfm_generate_pinyin_table(<var>) which
+# adds the command generating pinyintable.h in the current binary directory and
+# stores the path of the header in <var>.
+# Run with "cmake -DDICT_FILE=<dict> -DOUTPUT_FILE=<header> -P pinyintable.cmake",
+# it writes the header.
+#
+# The table is indexed by the high byte of the code point, then by the low byte,
+# the blocks without any Chinese character are not stored.
+
+if (NOT CMAKE_SCRIPT_MODE_FILE)
+    set(PINYIN_TABLE_SCRIPT ${CMAKE_CURRENT_LIST_FILE})
+
+    function(dfm_generate_pinyin_table OUTPUT_VAR)
+        get_filename_component(ScriptDir ${PINYIN_TABLE_SCRIPT} DIRECTORY)
+        set(DictFile ${ScriptDir}/pinyin.dict)
+        set(OutputFile ${CMAKE_CURRENT_BINARY_DIR}/pinyintable.h)
+        add_custom_command(
+            OUTPUT ${OutputFile}
+            COMMAND ${CMAKE_COMMAND} -DDICT_FILE=${DictFile} -DOUTPUT_FILE=${OutputFile} -P ${PINYIN_TABLE_SCRIPT}
+            DEPENDS ${DictFile} ${PINYIN_TABLE_SCRIPT}
+            COMMENT "Generating the pinyin table from ${DictFile}"
+            VERBATIM)
+        set(${OUTPUT_VAR} ${OutputFile} PARENT_SCOPE)
+    endfunction()
+    return()
+endif()
+
+set(HexDigits 0 1 2 3 4 5 6 7 8 9 a b c d e f)
+function(hex_to_dec HEX OUTPUT_VAR)
+    string(TOLOWER ${HEX} Hex)
+    string(LENGTH ${Hex} Length)
+    set(Value 0)
+    math(EXPR Last "${Length} - 1")
+    foreach(i RANGE ${Last})
+        string(SUBSTRING ${Hex} ${i} 1 Digit)
+        list(FIND HexDigits ${Digit} DigitValue)
+        if (DigitValue LESS 0)
+            message(FATAL_ERROR "invalid code point ${HEX} in ${DICT_FILE}")
+        endif()
+        math(EXPR Value "${Value} * 16 + ${DigitValue}")
+    endforeach()
+    set(${OUTPUT_VAR} ${Value} PARENT_SCOPE)
+endfunction()
+
+file(STRINGS ${DICT_FILE} Lines REGEX "^0x[0-9a-fA-F]+:[a-z0-9]+$")
+
+set(Text "")
+set(TextLength 0)
+set(Syllables "")
+set(SyllableCount 0)
+set(Blocks "")
+set(BlockIds "")
+set(BlockCount 0)
+set(CurrentBlock -1)
+set(NextPos 256)
+set(LastCode -1)
+set(MaxLength 0)
+
+# the lines are sorted by code point, the blocks are written in order
+foreach(Line IN LISTS Lines)
+    string(REGEX MATCH "^0x([0-9a-fA-F]+):([a-z0-9]+)$" Unused ${Line})
+    hex_to_dec(${CMAKE_MATCH_1} Code)
+    set(Pinyin ${CMAKE_MATCH_2})
+    if (Code LESS_EQUAL LastCode OR Code GREATER 65535)
+        message(FATAL_ERROR "${DICT_FILE} is not sorted by code point of the BMP: ${Line}")
+    endif()
+    set(LastCode ${Code})
+
+    if (NOT DEFINED SyllableIndex_${Pinyin})
+        math(EXPR SyllableCount "${SyllableCount} + 1")
+        set(SyllableIndex_${Pinyin} ${SyllableCount})
+        string(LENGTH ${Pinyin} Length)
+        string(APPEND Syllables "    { ${TextLength}, ${Length} },\n")
+        string(APPEND Text ${Pinyin})
+        math(EXPR TextLength "${TextLength} + ${Length}")
+        if (Length GREATER MaxLength)
+            set(MaxLength ${Length})
+        endif()
+    endif()
+
+    math(EXPR Block "${Code} / 256")
+    math(EXPR Pos "${Code} % 256")
+    if (NOT Block EQUAL CurrentBlock)
+        while (NextPos LESS 256)
+            string(APPEND Blocks " 0,")
+            math(EXPR NextPos "${NextPos} + 1")
+        endwhile()
+        if (CurrentBlock GREATER_EQUAL 0)
+            string(APPEND Blocks " },\n")
+        endif()
+        string(APPEND Blocks "    {")
+        list(APPEND BlockIds "${Block}:${BlockCount}")
+        math(EXPR BlockCount "${BlockCount} + 1")
+        set(CurrentBlock ${Block})
+        set(NextPos 0)
+    endif()
+    while (NextPos LESS Pos)
+        string(APPEND Blocks " 0,")
+        math(EXPR NextPos "${NextPos} + 1")
+    endwhile()
+    string(APPEND Blocks " ${SyllableIndex_${Pinyin}},")
+    math(EXPR NextPos "${Pos} + 1")
+endforeach()
+
+if (BlockCount EQUAL 0)
+    message(FATAL_ERROR "no pinyin in ${DICT_FILE}")
+endif()
+while (NextPos LESS 256)
+    string(APPEND Blocks " 0,")
+    math(EXPR NextPos "${NextPos} + 1")
+endwhile()
+string(APPEND Blocks " },\n")
+
+set(BlockIndex "")
+foreach(Block RANGE 255)
+    set(Id 255)
+    foreach(Pair IN LISTS BlockIds)
+        if (Pair MATCHES "^${Block}:([0-9]+)$")
+            set(Id ${CMAKE_MATCH_1})
+        endif()
+    endforeach()
+    math(EXPR Column "${Block} % 16")
+    if (Column EQUAL 0)
+        string(APPEND BlockIndex "   ")
+    endif()
+    string(APPEND BlockIndex " ${Id},")
+    if (Column EQUAL 15)
+        string(APPEND BlockIndex "\n")
+    endif()
+endforeach()
+
+file(WRITE ${OUTPUT_FILE}.tmp
+"// Generated by pinyintable.cmake from pinyin.dict, do not edit.
+
+#ifndef PINYINTABLE_H
+#define PINYINTABLE_H
+
+#include <cstdint>
+
+namespace Pinyin {
+
+struct Syllable
+{
+    uint16_t offset;
+    uint8_t length;
+};
+
+constexpr int kMaxSyllableLength { ${MaxLength} };
+constexpr uint8_t kNoBlock { 255 };
+
+constexpr char kSyllableText[] = \"${Text}\";
+
+// the syllables by index - 1
+constexpr Syllable kSyllables[] = {
+${Syllables}};
+
+// the blocks of 256 code points by the high byte
+constexpr uint8_t kBlockIndex[256] = {
+${BlockIndex}};
+
+// the syllable index of the code points by the low byte, 0 if there is none
+constexpr uint16_t kBlocks[][256] = {
+${Blocks}};
+
+}   // namespace Pinyin
+
+#endif   // PINYINTABLE_H
+")
+# keep the time stamp of an unchanged header
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different ${OUTPUT_FILE}.tmp ${OUTPUT_FILE})
+file(REMOVE ${OUTPUT_FILE}.tmp)
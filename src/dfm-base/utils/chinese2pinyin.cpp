@@ -4,60 +4,56 @@
 
 #include "chinese2pinyin.h"
 
-#include <QHash>
-#include <QTextStream>
-#include <QFile>
+// generated from qrc/chinese2pinyin/pinyin.dict by pinyintable.cmake
+#include "pinyintable.h"
 
 namespace Pinyin {
 
-static QHash<uint, QString> dict = {};
-
-const char kDictFile[] = ":/misc/pinyin.dict";
-
-void InitDict() {
-    if (!dict.isEmpty()) {
-        return;
+static inline const Syllable *syllableOf(const QChar ch) {
+    const uint8_t block = kBlockIndex[ch.unicode() >> 8];
+    if (block == kNoBlock) {
+        return nullptr;
     }
 
-    dict.reserve(25333);
-
-    QFile file(kDictFile);
-
-    if (!file.open(QIODevice::ReadOnly))
-        return;
-
-    QByteArray content = file.readAll();
+    const uint16_t index = kBlocks[block][ch.unicode() & 0xFF];
+    return index ? &kSyllables[index - 1] : nullptr;
+}
 
-    file.close();
+int Chinese2Pinyin(const QChar *words, int length, QChar *buffer, int size) {
+    int pos = 0;
 
-    QTextStream stream(&content, QIODevice::ReadOnly);
+    for (int i = 0; i < length; ++i) {
+        const Syllable *syllable = syllableOf(words[i]);
 
-    while (!stream.atEnd()) {
-        const QString line = stream.readLine();
-        const QStringList items = line.split(QChar(':'));
+        if (!syllable) {
+            if (pos < size) {
+                buffer[pos] = words[i];
+            }
+            ++pos;
+            continue;
+        }
 
-        if (items.size() == 2) {
-            dict.insert(static_cast<uint>(items[0].toInt(nullptr, 16)), items[1]);
+        const char *text = kSyllableText + syllable->offset;
+        for (int j = 0; j < syllable->length; ++j, ++pos) {
+            if (pos < size) {
+                buffer[pos] = QLatin1Char(text[j]);
+            }
         }
     }
+
+    return pos;
 }
 
 QString Chinese2Pinyin(const QString& words) {
-    InitDict();
-
-    QString result;
+    const int length = Chinese2Pinyin(words.constData(), words.length(), nullptr, 0);
 
-    for (int i = 0; i < words.length(); ++i) {
-        const uint key = words.at(i).unicode();
-        auto find_result = dict.find(key);
-
-        if (find_result != dict.end()) {
-            result.append(find_result.value());
-        } else {
-            result.append(words.at(i));
-        }
+    // no Chinese character
+    if (length == words.length()) {
+        return words;
     }
 
+    QString result(length, Qt::Uninitialized);
+    Chinese2Pinyin(words.constData(), words.length(), result.data(), length);
     return result;
 }
 
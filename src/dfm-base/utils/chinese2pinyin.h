@@ -9,6 +9,10 @@
 
 namespace Pinyin {
 QString Chinese2Pinyin(const QString& words);
+
+// Writes the pinyin of words into buffer without allocating, returns the length
+// of the whole pinyin, which is larger than size if the buffer is too short.
+int Chinese2Pinyin(const QChar *words, int length, QChar *buffer, int size);
 };
 
 #endif  // CHINESE_2_PINYIN_H
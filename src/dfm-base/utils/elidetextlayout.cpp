@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "elidetextlayout.h"
+#include "textlayoutcache.h"
 
 #include <QPainter>
 #include <QtMath>
@@ -10,10 +11,45 @@
 #include <QTextDocument>
 #include <QTextLayout>
 #include <QTextBlock>
+#include <QDataStream>
 #include <QDebug>
 
+#include <typeinfo>
+
 using namespace dfmbase;
 
+static void writeKeyValue(QDataStream &out, const QVariant &value)
+{
+    out << value.userType();
+    switch (value.userType()) {
+    case QMetaType::QColor:
+        out << value.value<QColor>().rgba();
+        return;
+    case QMetaType::QBrush: {
+        const QBrush &brush = value.value<QBrush>();
+        out << int(brush.style()) << brush.color().rgba();
+        return;
+    }
+    case QMetaType::QPen: {
+        const QPen &pen = value.value<QPen>();
+        out << int(pen.style()) << pen.color().rgba() << pen.widthF();
+        return;
+    }
+    default:
+        break;
+    }
+
+    // containers of the custom formats, such as the colors of the tags
+    if (value.userType() >= QMetaType::User && value.canConvert<QVariantList>()) {
+        const QSequentialIterable &items = value.value<QSequentialIterable>();
+        for (const QVariant &item : items)
+            writeKeyValue(out, item);
+        return;
+    }
+
+    out << value.toString();
+}
+
 ElideTextLayout::ElideTextLayout(const QString &text)
     : document(new QTextDocument)
 {
@@ -44,6 +80,57 @@ QString ElideTextLayout::text() const
 }
 
 QList<QRectF> ElideTextLayout::layout(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines)
+{
+    if (painter)
+        return doLayout(rect, elideMode, painter, background, textLines);
+
+    // the geometry of the same text is shared by all the views
+    const QByteArray &key = cacheKey(rect.size(), elideMode);
+    QList<QRectF> ret;
+    QStringList lines;
+    if (!TextLayoutCache::instance()->findLines(key, &ret, &lines)) {
+        ret = doLayout(QRectF(QPointF(0, 0), rect.size()), elideMode, nullptr, Qt::NoBrush, &lines);
+        TextLayoutCache::instance()->insertLines(key, ret, lines);
+    }
+
+    for (QRectF &line : ret)
+        line.translate(rect.topLeft());
+    if (textLines)
+        textLines->append(lines);
+    return ret;
+}
+
+/*!
+ * \brief key of the layout result, made of the document including the formats
+ *  inserted by the hooks, the attributes, the size and the elide mode
+ */
+QByteArray ElideTextLayout::cacheKey(const QSizeF &size, Qt::TextElideMode elideMode) const
+{
+    QByteArray key;
+    QDataStream out(&key, QIODevice::WriteOnly);
+    out << QByteArray(typeid(*this).name()) << size << int(elideMode);
+    for (auto it = attributes.cbegin(); it != attributes.cend(); ++it) {
+        out << int(it.key());
+        writeKeyValue(out, it.value());
+    }
+
+    for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
+        for (auto it = block.begin(); !it.atEnd(); ++it) {
+            const QTextFragment &fragment = it.fragment();
+            out << fragment.text();
+            const QMap<int, QVariant> &properties = fragment.charFormat().properties();
+            for (auto prop = properties.cbegin(); prop != properties.cend(); ++prop) {
+                out << prop.key();
+                writeKeyValue(out, prop.value());
+            }
+        }
+        out << QChar(QChar::ParagraphSeparator);
+    }
+
+    return key;
+}
+
+QList<QRectF> ElideTextLayout::doLayout(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines)
 {
     QList<QRectF> ret;
     QTextLayout *lay = document->firstBlock().layout();
@@ -32,6 +32,7 @@ public:
     void setText(const QString &text);
     QString text() const;
     QList<QRectF> layout(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter = nullptr, const QBrush &background = Qt::NoBrush, QStringList *textLines = nullptr);
+    QByteArray cacheKey(const QSizeF &size, Qt::TextElideMode elideMode) const;
 public:
     inline QTextDocument *documentHandle() {
         return document;
@@ -47,6 +48,7 @@ public:
     }
 
 protected:
+    QList<QRectF> doLayout(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines);
     QRectF drawLineBackground(QPainter *painter, const QRectF &curLineRect, QRectF lastLineRect, const QBrush &brush) const;
     virtual void initLayoutOption(QTextLayout *lay);
 protected:
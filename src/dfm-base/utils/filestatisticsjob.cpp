@@ -19,6 +19,8 @@
 #include <QWaitCondition>
 #include <QStorageInfo>
 #include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QtConcurrent>
 #include <QDebug>
 
 #include <fts.h>
@@ -28,6 +30,23 @@
 namespace dfmbase {
 
 static constexpr uint16_t kSizeChangeinterval { 200 };
+// the counters of a walk are added to the job after the number of entries
+static constexpr int kFlushInterval { 1000 };
+// the top levels are split until there are enough subtrees for the threads
+static constexpr int kMaxSplitLevel { 3 };
+static constexpr int kMinSubtreesPerThread { 4 };
+
+static bool isUnderPaths(const QString &path, const QSet<QString> &paths)
+{
+    if (path.length() <= 1)
+        return false;
+
+    for (int pos = path.lastIndexOf('/'); pos >= 0; pos = pos > 0 ? path.lastIndexOf('/', pos - 1) : -1) {
+        if (paths.contains(pos == 0 ? QStringLiteral("/") : path.left(pos)))
+            return true;
+    }
+    return false;
+}
 
 FileStatisticsJobPrivate::FileStatisticsJobPrivate(FileStatisticsJob *qq)
     : QObject(nullptr), q(qq), notifyDataTimer(nullptr)
@@ -44,7 +63,7 @@ FileStatisticsJobPrivate::~FileStatisticsJobPrivate()
         notifyDataTimer->stop();
         notifyDataTimer->deleteLater();
     }
-    inodelist.clear();
+    fileKeys.clear();
 }
 
 void FileStatisticsJobPrivate::setState(FileStatisticsJob::State s)
@@ -121,7 +140,7 @@ void FileStatisticsJobPrivate::processFile(const QUrl &url, const bool followLin
             auto isSyslink = info->isAttributes(OptInfoType::kIsSymLink);
             if (isSyslink) {
                 const auto &symLinkTargetUrl = QUrl::fromLocalFile(info->pathOf(PathInfoType::kSymLinkTarget));
-                if (sizeInfo->allFiles.contains(symLinkTargetUrl) || fileStatistics.contains(symLinkTargetUrl)) {
+                if (countedUrls.contains(symLinkTargetUrl) || fileStatistics.contains(symLinkTargetUrl)) {
                     return;
                 }
                 fileStatistics << symLinkTargetUrl;
@@ -175,7 +194,7 @@ void FileStatisticsJobPrivate::processFile(const QUrl &url, const bool followLin
             }
 
             const auto &symLinkTargetUrl = QUrl::fromLocalFile(info->pathOf(PathInfoType::kSymLinkTarget));
-            if (sizeInfo->allFiles.contains(symLinkTargetUrl) || fileStatistics.contains(symLinkTargetUrl)) {
+            if (countedUrls.contains(symLinkTargetUrl) || fileStatistics.contains(symLinkTargetUrl)) {
                 return;
             }
             fileStatistics << symLinkTargetUrl;
@@ -210,23 +229,60 @@ void FileStatisticsJobPrivate::processFile(const QUrl &url, const bool followLin
 
 void FileStatisticsJobPrivate::processFileByFts(const QUrl &url, const bool followLink)
 {
-    // The files counted are not counted
-    if (sizeInfo->allFiles.contains(url))
+    StatisticsCounter counter;
+    QList<QByteArray> subtrees;
+    const bool singleDepth = fileHints.testFlag(FileStatisticsJob::kSingleDepth);
+    statisticByFts(url.path().toUtf8(), followLink, 1, true, counter, singleDepth ? nullptr : &subtrees);
+
+    const int minSubtrees = QThread::idealThreadCount() * kMinSubtreesPerThread;
+    for (int level = 1; level < kMaxSplitLevel && !subtrees.isEmpty() && subtrees.size() < minSubtrees; ++level) {
+        const QList<QByteArray> parents = subtrees;
+        subtrees.clear();
+        for (const QByteArray &path : parents)
+            statisticByFts(path, followLink, 1, false, counter, &subtrees);
+    }
+    mergeCounter(counter);
+
+    if (subtrees.isEmpty())
         return;
 
-    char *paths[2] = { nullptr, nullptr };
-    paths[0] = strdup(url.path().toUtf8().toStdString().data());
-    auto openflags = fileHints.testFlag(FileStatisticsJob::kExcludeSourceFile) ? FTS_COMFOLLOW : 0;
+    // the subtrees are walked in parallel and merged in order, the parents stay before their children in allFiles
+    QVector<QPair<QByteArray, StatisticsCounter>> walks;
+    walks.reserve(subtrees.size());
+    for (const QByteArray &path : subtrees)
+        walks.append({ path, StatisticsCounter() });
+
+    QtConcurrent::blockingMap(walks, [this, followLink](QPair<QByteArray, StatisticsCounter> &walk) {
+        statisticByFts(walk.first, followLink, 0, false, walk.second, nullptr);
+    });
+
+    for (auto &walk : walks)
+        mergeCounter(walk.second);
+}
+
+/*!
+ * \brief FileStatisticsJobPrivate::statisticByFts walk the path by fts and count the files in counter
+ * \param splitLevel the directories of the level are counted but not walked, 0 walks all the levels
+ * \param countRoot false if the path has been counted by the walk that split it
+ * \param subtrees the directories not walked are appended to it
+ */
+void FileStatisticsJobPrivate::statisticByFts(const QByteArray &path, const bool followLink, const int splitLevel,
+                                              const bool countRoot, StatisticsCounter &counter, QList<QByteArray> *subtrees)
+{
+    char *paths[2] = { const_cast<char *>(path.constData()), nullptr };
+    // the walks run in parallel, none of them can change the working directory
+    int openflags = FTS_PHYSICAL | FTS_NOCHDIR;
+    if (countRoot && fileHints.testFlag(FileStatisticsJob::kExcludeSourceFile))
+        openflags |= FTS_COMFOLLOW;
     FTS *fts = fts_open(paths, openflags, nullptr);
 
     if (nullptr == fts) {
-        qWarning() << "open file by fts failed ! url = " << url << ", case " << strerror(errno);
+        qWarning() << "open file by fts failed ! path = " << path << ", case " << strerror(errno);
         return;
     }
-    if (paths[0])
-        free(paths[0]);
 
-    auto singleDepth = fileHints.testFlag(FileStatisticsJob::kSingleDepth);
+    const bool singleDepth = fileHints.testFlag(FileStatisticsJob::kSingleDepth);
+    int visitedCount = 0;
     while (1) {
         FTSENT *ent = fts_read(fts);
         if (nullptr == ent)
@@ -235,37 +291,81 @@ void FileStatisticsJobPrivate::processFileByFts(const QUrl &url, const bool foll
         if (!stateCheck())
             break;
 
-        if (!checkInode(ent, fts))
+        // the directory has been counted before its children
+        if (ent->fts_info == FTS_DP)
             continue;
 
-        QUrl currentUrl = QUrl::fromLocalFile(ent->fts_path);
+        const bool isRoot = ent->fts_level == FTS_ROOTLEVEL;
+        if (isRoot && !countRoot)
+            continue;
 
-        if (fileHints.testFlag(FileStatisticsJob::kExcludeSourceFile) && currentUrl.path() == url.path())
+        if (!checkInode(ent, fts))
             continue;
 
-        sizeInfo->allFiles.append(currentUrl);
+        if (isRoot && fileHints.testFlag(FileStatisticsJob::kExcludeSourceFile))
+            continue;
+
+        const QUrl &currentUrl = QUrl::fromLocalFile(ent->fts_path);
+        counter.allFiles.append(currentUrl);
+        if (singleDepth)
+            countedUrls.insert(currentUrl);
+
+        if (++visitedCount % kFlushInterval == 0)
+            flushCounter(counter);
 
         auto isLink = S_ISLNK(ent->fts_statp->st_mode);
         if (isLink) {
-            statisticSysLink(currentUrl, fts, ent, singleDepth, followLink);
+            statisticSysLink(currentUrl, fts, ent, singleDepth, followLink, counter);
             continue;
         }
 
         if (skipPath.contains(ent->fts_path)) {
-            filesCount++;
+            counter.filesCount++;
             continue;
         }
 
         if (!S_ISDIR(ent->fts_statp->st_mode)) {
-            statisticFile(ent);
+            statisticFile(ent, counter);
             continue;
         }
 
-        statisticDir(url, fts, singleDepth, ent);
+        statisticDir(ent, counter);
+        if (splitLevel > 0 && ent->fts_level >= splitLevel) {
+            fts_set(fts, ent, FTS_SKIP);
+            if (subtrees)
+                subtrees->append(QByteArray(ent->fts_path, ent->fts_pathlen));
+        }
     }
 
-    if (fts)
-        fts_close(fts);
+    fts_close(fts);
+}
+
+void FileStatisticsJobPrivate::flushCounter(StatisticsCounter &counter)
+{
+    totalSize += counter.totalSize;
+    totalProgressSize += counter.totalProgressSize;
+    filesCount += counter.filesCount;
+    directoryCount += counter.directoryCount;
+
+    counter.totalSize = 0;
+    counter.totalProgressSize = 0;
+    counter.filesCount = 0;
+    counter.directoryCount = 0;
+}
+
+void FileStatisticsJobPrivate::mergeCounter(StatisticsCounter &counter)
+{
+    flushCounter(counter);
+    if (sizeInfo->dirSize == 0)
+        sizeInfo->dirSize = counter.dirSize;
+    sizeInfo->allFiles.append(counter.allFiles);
+    counter.allFiles.clear();
+}
+
+void FileStatisticsJobPrivate::appendCountedUrl(const QUrl &url)
+{
+    sizeInfo->allFiles << url;
+    countedUrls.insert(url);
 }
 
 void FileStatisticsJobPrivate::emitSizeChanged()
@@ -345,51 +445,50 @@ FileInfo::FileType FileStatisticsJobPrivate::getFileType(const uint mode)
     return fileType;
 }
 
-void FileStatisticsJobPrivate::statisticDir(const QUrl &url, FTS *fts, const bool singleDepth, FTSENT *ent)
+void FileStatisticsJobPrivate::statisticDir(FTSENT *ent, StatisticsCounter &counter)
 {
-    if (sizeInfo->dirSize == 0) {
-        sizeInfo->dirSize = ent->fts_statp->st_size == 0
+    if (counter.dirSize == 0) {
+        counter.dirSize = ent->fts_statp->st_size == 0
                 ? FileUtils::getMemoryPageSize()
                 : static_cast<quint16>(ent->fts_statp->st_size);
     }
-    totalProgressSize += FileUtils::getMemoryPageSize();
-    ++directoryCount;
-    if (singleDepth && QString(ent->fts_path) != url.path())
-        fts_set(fts, ent, FTS_SKIP);
+    counter.totalProgressSize += FileUtils::getMemoryPageSize();
+    ++counter.directoryCount;
 }
 
-void FileStatisticsJobPrivate::statisticFile(FTSENT *ent)
+void FileStatisticsJobPrivate::statisticFile(FTSENT *ent, StatisticsCounter &counter)
 {
     const FileInfo::FileType &fileType = getFileType(ent->fts_statp->st_mode);
     if (!checkFileType(fileType))
         return;
-    filesCount++;
-    totalSize += ent->fts_statp->st_size;
-    totalProgressSize += ent->fts_statp->st_size <= 0 ? FileUtils::getMemoryPageSize() : ent->fts_statp->st_size;
+    counter.filesCount++;
+    counter.totalSize += ent->fts_statp->st_size;
+    counter.totalProgressSize += ent->fts_statp->st_size <= 0 ? FileUtils::getMemoryPageSize() : ent->fts_statp->st_size;
 }
 
-void FileStatisticsJobPrivate::statisticSysLink(const QUrl &currentUrl, FTS *fts, FTSENT *ent, const bool singleDepth, const bool followLink)
+void FileStatisticsJobPrivate::statisticSysLink(const QUrl &currentUrl, FTS *fts, FTSENT *ent, const bool singleDepth, const bool followLink,
+                                                 StatisticsCounter &counter)
 {
     if (!singleDepth) {
         if (S_ISDIR(ent->fts_statp->st_mode)) {
-            directoryCount++;
+            counter.directoryCount++;
         } else {
-            filesCount++;
+            counter.filesCount++;
         }
-        totalSize += ent->fts_statp->st_size;
+        counter.totalSize += ent->fts_statp->st_size;
         return;
     }
     auto info = InfoFactory::create<FileInfo>(currentUrl, Global::CreateFileInfoType::kCreateFileInfoSync);
     if (!info) {
-        filesCount++;
+        counter.filesCount++;
         return;
     }
     const auto &symLinkTargetUrl = QUrl::fromLocalFile(info->pathOf(PathInfoType::kSymLinkTarget));
-    if (sizeInfo->allFiles.contains(symLinkTargetUrl) || fileStatistics.contains(symLinkTargetUrl)) {
+    if (countedUrls.contains(symLinkTargetUrl) || fileStatistics.contains(symLinkTargetUrl)) {
         return;
     }
     if (skipPath.contains(symLinkTargetUrl.path())) {
-        filesCount++;
+        counter.filesCount++;
         return;
     }
 
@@ -398,14 +497,14 @@ void FileStatisticsJobPrivate::statisticSysLink(const QUrl &currentUrl, FTS *fts
         if (!checkFileType(type))
             return;
 
-        totalProgressSize += FileUtils::getMemoryPageSize();
+        counter.totalProgressSize += FileUtils::getMemoryPageSize();
         fileStatistics << symLinkTargetUrl;
-        filesCount++;
-        totalSize += info->size();
+        counter.filesCount++;
+        counter.totalSize += info->size();
         return;
     }
 
-    ++directoryCount;
+    ++counter.directoryCount;
     if (singleDepth)
         return;
 
@@ -414,33 +513,40 @@ void FileStatisticsJobPrivate::statisticSysLink(const QUrl &currentUrl, FTS *fts
         fts_set(fts, ent, FTS_SYMFOLLOW);
 }
 
+bool FileStatisticsJobPrivate::insertFileKey(const FileKey &key)
+{
+    QMutexLocker locker(&fileKeysMutex);
+    const int count = fileKeys.count();
+    fileKeys.insert(key);
+    return fileKeys.count() != count;
+}
+
 bool FileStatisticsJobPrivate::checkInode(const FileInfoPointer info)
 {
     auto fileInode = info->extendAttributes(ExtInfoType::kInode).toULongLong();
-    if (fileInode > 0) {
-        if (inodelist.contains(fileInode)) {
-            if (info->isAttributes(OptInfoType::kIsFile)) {
-                filesCount++;
-            } else {
-                directoryCount++;
-            }
-            return false;
+    // the device is unknown here, the files of the other file systems are keyed by the inode
+    if (fileInode > 0 && !insertFileKey({ 0, fileInode })) {
+        if (info->isAttributes(OptInfoType::kIsFile)) {
+            filesCount++;
+        } else {
+            directoryCount++;
         }
-        inodelist.append(fileInode);
+        return false;
     }
     return true;
 }
 
 bool FileStatisticsJobPrivate::checkInode(FTSENT *ent, FTS *fts)
 {
-    auto fileInode =  ent->fts_statp->st_ino;
-    if (fileInode > 0) {
-        if (inodelist.contains(fileInode)) {
-            if (S_ISDIR(ent->fts_statp->st_mode))
-                fts_set(fts, ent, FTS_SKIP);
-            return false;
-        }
-        inodelist.append(fileInode);
+    const struct stat *statp = ent->fts_statp;
+    // a file linked once is reached by a single path, only the directories and the hard links are kept
+    if (statp->st_ino == 0 || (!S_ISDIR(statp->st_mode) && statp->st_nlink <= 1))
+        return true;
+
+    if (!insertFileKey({ statp->st_dev, statp->st_ino })) {
+        if (S_ISDIR(statp->st_mode))
+            fts_set(fts, ent, FTS_SKIP);
+        return false;
     }
     return true;
 }
@@ -557,7 +663,8 @@ void FileStatisticsJob::run()
     d->totalSize = 0;
     d->filesCount = 0;
     d->directoryCount = 0;
-    d->inodelist.clear();
+    d->fileKeys.clear();
+    d->countedUrls.clear();
     d->sizeInfo.reset(new FileUtils::FilesSizeInfo());
     if (d->sourceUrlList.isEmpty())
         return;
@@ -591,10 +698,10 @@ void FileStatisticsJob::statistcsOtherFileSystem()
                 return;
             }
             // The files counted are not counted
-            if (d->sizeInfo->allFiles.contains(url))
+            if (d->countedUrls.contains(url))
                 continue;
 
-            d->sizeInfo->allFiles << url;
+            d->appendCountedUrl(url);
             FileInfoPointer info = InfoFactory::create<FileInfo>(url, Global::CreateFileInfoType::kCreateFileInfoSync);
 
             if (!info) {
@@ -618,7 +725,7 @@ void FileStatisticsJob::statistcsOtherFileSystem()
 
                 const auto &symLinkTargetUrl = QUrl::fromLocalFile(info->pathOf(PathInfoType::kSymLinkTarget));
                 // The files counted are not counted
-                if (d->fileStatistics.contains(symLinkTargetUrl) || d->sizeInfo->allFiles.contains(symLinkTargetUrl))
+                if (d->fileStatistics.contains(symLinkTargetUrl) || d->countedUrls.contains(symLinkTargetUrl))
                     continue;
 
                 info = InfoFactory::create<FileInfo>(symLinkTargetUrl, Global::CreateFileInfoType::kCreateFileInfoSync);
@@ -646,7 +753,7 @@ void FileStatisticsJob::statistcsOtherFileSystem()
             FileHints save_file_hints = d->fileHints;
             d->fileHints = d->fileHints | kDontSkipAVFSDStorage | kDontSkipPROCStorage;
             d->processFile(url, followLink, directory_queue);
-            d->sizeInfo->allFiles << url;
+            d->appendCountedUrl(url);
             d->fileHints = save_file_hints;
 
             if (!d->stateCheck()) {
@@ -677,11 +784,11 @@ void FileStatisticsJob::statistcsOtherFileSystem()
         while (d->iterator->hasNext()) {
             QUrl url = d->iterator->next();
             // The files counted are not counted
-            if (d->sizeInfo->allFiles.contains(url))
+            if (d->countedUrls.contains(url))
                 continue;
 
             d->processFile(url, followLink, directory_queue);
-            d->sizeInfo->allFiles << url;
+            d->appendCountedUrl(url);
 
             if (!d->stateCheck()) {
                 d->setState(kStoppedState);
@@ -701,6 +808,11 @@ void FileStatisticsJob::statistcsByFts()
 
     const bool followLink = !d->fileHints.testFlag(kNoFollowSymlink);
 
+    QSet<QString> sourcePaths;
+    for (const auto &url : d->sourceUrlList)
+        sourcePaths.insert(url.path());
+
+    QSet<QString> walkedPaths;
     for (const auto &url : d->sourceUrlList) {
         if (!d->stateCheck()) {
             d->setState(kStoppedState);
@@ -708,8 +820,15 @@ void FileStatisticsJob::statistcsByFts()
             return;
         }
 
+        // The files counted are not counted, a source under another one is counted by the walk of that one
+        const QString &path = url.path();
+        if (walkedPaths.contains(path) || isUnderPaths(path, sourcePaths))
+            continue;
+        walkedPaths.insert(path);
+
         d->processFileByFts(url, followLink);
     }
+    setSizeInfo();
     d->setState(kStoppedState);
 }
 
@@ -40,6 +40,7 @@
 #include <QSet>
 #include <QRegularExpression>
 #include <QCollator>
+#include <QVector>
 #include <QDBusInterface>
 #include <QDBusConnection>
 #include <QDBusReply>
@@ -52,6 +53,8 @@
 #include <sys/stat.h>
 #include <linux/limits.h>
 
+#include <algorithm>
+
 #ifdef COMPILE_ON_V23
 #    define APPEARANCE_SERVICE "org.deepin.dde.Appearance1"
 #    define APPEARANCE_PATH "/org/deepin/dde/Appearance1"
@@ -1100,9 +1103,107 @@ bool FileUtils::compareByStringEx(const QString &str1, const QString &str2)
     return length1 < length2;
 }
 
+// the kinds of the parts of a sort key, in the order of compareByStringEx
+static constexpr char kSortKeyNameEnd { 0 };
+static constexpr char kSortKeyNumber { 1 };
+static constexpr char kSortKeyLetter { 2 };
+static constexpr char kSortKeyHan { 3 };
+static constexpr char kSortKeySymbol { 4 };
+
+// the ranks of the Han characters in the order of the collator, the characters
+// the collator considers equal share a rank
+static const QVector<quint16> &hanSortRanks()
+{
+    static const QVector<quint16> ranks = [] {
+        QVector<QChar> hans;
+        for (int code = 0; code <= 0xFFFF; ++code) {
+            const QChar ch(code);
+            if (ch.script() == QChar::Script_Han)
+                hans.append(ch);
+        }
+
+        DCollator collator;
+        std::stable_sort(hans.begin(), hans.end(), [&collator](const QChar &left, const QChar &right) {
+            return collator.compare(&left, 1, &right, 1) < 0;
+        });
+
+        QVector<quint16> ranks(0x10000, 0);
+        quint16 rank = 0;
+        for (int i = 1; i < hans.count(); ++i) {
+            if (collator.compare(&hans.at(i - 1), 1, &hans.at(i), 1) != 0)
+                ++rank;
+            ranks[hans.at(i).unicode()] = rank;
+        }
+        return ranks;
+    }();
+    return ranks;
+}
+
+/*!
+ * \brief FileUtils::sortKeyOfString The binary key of the string for sorting,
+ * comparing the keys with memcmp gives the order of compareByStringEx.
+ *
+ * The digits are compared by the value of the number they are part of, then by
+ * the digits themselves, so the leading zeros sort first. The numbers are not
+ * limited to the range of uint, and the letters of the other scripts than ASCII
+ * are compared in lower case; compareByStringEx gives no consistent order there.
+ */
+QByteArray FileUtils::sortKeyOfString(const QString &str)
+{
+    const int dot = str.lastIndexOf(".");
+    const int nameLength = dot < 0 ? str.length() : dot;
+
+    QByteArray key;
+    key.reserve(nameLength * 3 + (str.length() - dot) * 2);
+    for (int i = 0; i < nameLength;) {
+        if (isNumber(str.at(i))) {
+            int end = i;
+            while (end < nameLength && isNumber(str.at(end)))
+                ++end;
+            int first = i;
+            while (first < end && str.at(first) == '0')
+                ++first;
+
+            key.append(kSortKeyNumber);
+            const int digits = end - first;
+            key.append(static_cast<char>(digits >> 8));
+            key.append(static_cast<char>(digits));
+            for (int j = first; j < end; ++j)
+                key.append(static_cast<char>(str.at(j).unicode()));
+            for (int j = i; j < end; ++j)
+                key.append(static_cast<char>(str.at(j).unicode()));
+            key.append('\0');
+            i = end;
+            continue;
+        }
+
+        const QChar ch = str.at(i).toLower();
+        if (isNumOrChar(ch)) {
+            key.append(kSortKeyLetter);
+            key.append(static_cast<char>(ch.unicode()));
+        } else {
+            const bool isHanzi = ch.script() == QChar::Script_Han;
+            const ushort weight = isHanzi ? hanSortRanks().at(ch.unicode()) : ch.unicode();
+            key.append(isHanzi ? kSortKeyHan : kSortKeySymbol);
+            key.append(static_cast<char>(weight >> 8));
+            key.append(static_cast<char>(weight));
+        }
+        ++i;
+    }
+
+    // the suffixes of the same names are compared by code unit
+    key.append(kSortKeyNameEnd);
+    for (int i = dot + 1; i < str.length(); ++i) {
+        key.append(static_cast<char>(str.at(i).unicode() >> 8));
+        key.append(static_cast<char>(str.at(i).unicode()));
+    }
+    return key;
+}
+
+// the order of sortKeyOfString, the same as the file view of the file manager
 bool FileUtils::compareString(const QString &str1, const QString &str2, Qt::SortOrder order)
 {
-    return !((order == Qt::AscendingOrder) ^ compareByStringEx(str1, str2));
+    return !((order == Qt::AscendingOrder) ^ (sortKeyOfString(str1) < sortKeyOfString(str2)));
 }
 
 QString FileUtils::dateTimeFormat()
@@ -72,6 +72,7 @@ public:
     static bool isNumber(const QChar ch);
     static bool isSymbol(const QChar ch);
     static bool compareByStringEx(const QString &str1, const QString &str2);
+    static QByteArray sortKeyOfString(const QString &str);
     static QString numberStr(const QString &str, int pos);
     static bool compareString(const QString &str1, const QString &str2, Qt::SortOrder order);
 
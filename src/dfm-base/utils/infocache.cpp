@@ -4,22 +4,26 @@
 
 #include "private/infocache_p.h"
 #include <dfm-base/base/schemefactory.h>
+#include <dfm-base/base/configs/dconfig/dconfigmanager.h>
 
 #include <dfm-io/dfileinfo.h>
 
 #include <QtConcurrent>
 
-// cache file total count
-static constexpr int kCacheFileinfoCount = 20000;
 // rotation training time
 static constexpr int kRotationTrainingTime = (60 * 1000);
-// remove cache time limit
-static constexpr int kCacheRemoveTime = (60 * (60 * 1000));
+// an entry without a hit in this many sweeps is removed, one hour
+static constexpr int kMaxIdleSweeps = (60 * (60 * 1000)) / kRotationTrainingTime;
+static constexpr char kInfoCacheSize[] { "dfm.infocache.size" };
+static constexpr qint64 kDefaultCapacity { 64 * 1024 * 1024 };
+// estimated memory of a file info and its attribute caches
+static constexpr qint64 kInfoBaseCost { 3 * 1024 };
 
 namespace dfmbase {
 InfoCachePrivate::InfoCachePrivate(InfoCache *qq)
     : q(qq)
 {
+    updateCapacity();
 }
 
 InfoCachePrivate::~InfoCachePrivate()
@@ -27,6 +31,63 @@ InfoCachePrivate::~InfoCachePrivate()
     cacheWorkerStoped = true;
 }
 
+InfoCacheShard &InfoCachePrivate::shardOf(const QUrl &url)
+{
+    return shards[qHash(url) % kShardCount];
+}
+
+/*!
+ * \brief InfoCachePrivate::evictShard Run the clock hand of the shard until its cost is under the target,
+ * a referenced entry loses its bit and gets a second chance. The write lock of the shard is held.
+ */
+void InfoCachePrivate::evictShard(InfoCacheShard &shard, qint64 target, QMap<QUrl, FileInfoPointer> *evicted)
+{
+    int scanned = 0;
+    const int maxScanned = shard.clockRing.size() * 2;
+    while (shard.cost > target && !shard.clockRing.isEmpty() && scanned++ < maxScanned) {
+        if (shard.clockHand >= shard.clockRing.size())
+            shard.clockHand = 0;
+
+        auto it = shard.entries.find(shard.clockRing.at(shard.clockHand));
+        if (it == shard.entries.end()) {
+            shard.clockRing.removeAt(shard.clockHand);
+            continue;
+        }
+
+        const InfoCacheEntryPointer entry = it.value();
+        if (entry->referenced.exchange(false, std::memory_order_relaxed)) {
+            ++shard.clockHand;
+            continue;
+        }
+
+        evicted->insert(it.key(), entry->info);
+        shard.cost -= entry->cost;
+        totalCost -= entry->cost;
+        shard.entries.erase(it);
+        shard.clockRing.removeAt(shard.clockHand);
+    }
+
+    // the ring keeps the removed urls until the hand passes them
+    if (shard.clockRing.size() > shard.entries.size() * 2 + 64) {
+        shard.clockRing = shard.entries.keys().toVector();
+        shard.clockHand = 0;
+    }
+}
+
+void InfoCachePrivate::updateCapacity()
+{
+    // in MB
+    bool ok = false;
+    const qint64 size = DConfigManager::instance()->value(kDefaultCfgPath, kInfoCacheSize).toLongLong(&ok);
+    capacity = ok && size > 0 ? size * 1024 * 1024 : kDefaultCapacity;
+}
+
+qint64 InfoCachePrivate::entryCost(const QUrl &url)
+{
+    // the url is kept by the key and several times by the info
+    return kInfoBaseCost + url.path().size() * int(sizeof(QChar)) * 4;
+}
+
 InfoCache::InfoCache(QObject *parent)
     : QObject(parent), d(new InfoCachePrivate(this))
 {
@@ -127,15 +188,10 @@ void InfoCache::cacheInfo(const QUrl url, const FileInfoPointer info)
     if (!info || d->cacheWorkerStoped)
         return;
 
+    InfoCacheShard &shard = d->shardOf(url);
     {
-        QReadLocker rlk(&d->mianLock);
-        if (d->mainCache.contains(url))
-            return;
-    }
-
-    {
-        QReadLocker rlk(&d->copyLock);
-        if (d->copyCache.contains(url))
+        QReadLocker rlk(&shard.lock);
+        if (shard.entries.contains(url))
             return;
     }
 
@@ -155,40 +211,29 @@ void InfoCache::cacheInfo(const QUrl url, const FileInfoPointer info)
         watcher->addCacheInfoConnectSize();
     }
 
-    // 插入到主和副的所有缓存中
-    d->status = kCacheCopy;
+    InfoCacheEntryPointer entry(new InfoCacheEntry);
+    entry->info = info;
+    entry->cost = InfoCachePrivate::entryCost(url);
+
+    QMap<QUrl, FileInfoPointer> evicted;
     {
-        QWriteLocker wlk(&d->mianLock);
-        d->mainCache.insert(url, info);
+        QWriteLocker wlk(&shard.lock);
+        shard.entries.insert(url, entry);
+        shard.clockRing.append(url);
+        shard.cost += entry->cost;
+        d->totalCost += entry->cost;
+
+        // evict a little more than needed so that the hand does not run on every insert
+        const qint64 shardCapacity = d->capacity / InfoCachePrivate::kShardCount;
+        if (shard.cost > shardCapacity)
+            d->evictShard(shard, shardCapacity / 10 * 9, &evicted);
     }
-    d->status = kCacheMain;
-    {
-        QWriteLocker wlk(&d->copyLock);
-        d->copyCache.insert(url, info);
+    d->insertCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (!evicted.isEmpty()) {
+        d->evictCount.fetch_add(quint64(evicted.size()), std::memory_order_relaxed);
+        emit cacheDisconnectWatcher(evicted);
     }
-    // 使用线程处理加入时间序列问题
-    emit cacheUpdateInfoTime(url);
-}
-/*!
- * \brief insertSortTime 处理当前文件的移除时间
- *
- * \param qint64 文件info的当前时间
- *
- * \param QString 文件的url
- *
- * \return
- */
-void InfoCache::updateSortTimeWorker(const QUrl url)
-{
-    Q_D(InfoCache);
-    if (d->cacheWorkerStoped)
-        return;
-    auto time = QDateTime::currentMSecsSinceEpoch();
-    auto key = QString::number(time) + QString("-") + url.toString();
-    if (d->urlTimeSortMap.contains(url))
-        d->timeToUrlMap.remove(d->urlTimeSortMap.value(url));
-    d->timeToUrlMap.insert(key, url);
-    d->urlTimeSortMap.insert(url, key);
 }
 
 void InfoCache::stop()
@@ -211,33 +256,25 @@ void InfoCache::removeCaches(const QList<QUrl> urls)
     if (d->cacheWorkerStoped || urls.size() <= 0)
         return;
 
-    // 读取主缓存，插入到
-    d->status = kCacheCopy;
     QMap<QUrl, FileInfoPointer> infos;
-    {
-        QWriteLocker wlk(&d->mianLock);
-        for (const auto &url : urls) {
-            auto info = d->mainCache.take(url);
-            if (info)
-                infos.insert(url, d->mainCache.take(url));
-        }
+    for (const auto &url : urls) {
+        InfoCacheShard &shard = d->shardOf(url);
+        QWriteLocker wlk(&shard.lock);
+        const InfoCacheEntryPointer &entry = shard.entries.take(url);
+        if (!entry)
+            continue;
+
+        shard.cost -= entry->cost;
+        d->totalCost -= entry->cost;
+        infos.insert(url, entry->info);
     }
     if (d->cacheWorkerStoped)
         return;
+
+    d->removeCount.fetch_add(quint64(infos.size()), std::memory_order_relaxed);
     // 断开监视器监视
     if (infos.size() > 0)
         emit cacheDisconnectWatcher(infos);
-    // 移除时间队列
-    emit cacheRemoveInfosTime(urls);
-
-    // 设置读取主缓存和插入到主缓存中
-    d->status = kCacheMain;
-    {
-        QWriteLocker wlk(&d->copyLock);
-        for (const auto &url : urls) {
-            d->copyCache.remove(url);
-        }
-    }
 }
 /*!
  * \brief getCacheInfo 获取文件
@@ -249,22 +286,18 @@ void InfoCache::removeCaches(const QList<QUrl> urls)
 FileInfoPointer InfoCache::getCacheInfo(const QUrl &url)
 {
     Q_D(InfoCache);
-    // 要异步线程重置计时器 todo 开辟一个可控制的线程来处理时间排序的问题
-    // 读取副缓存和临时缓存返回
-    FileInfoPointer info(nullptr);
-    if (d->status == kCacheMain) {   // 可以读取主缓存返回
-        QReadLocker wlk(&d->mianLock);
-        info = d->mainCache.value(url);
-    } else {
-        QReadLocker wlk(&d->copyLock);
-        info = d->copyCache.value(url);
+    InfoCacheShard &shard = d->shardOf(url);
+    QReadLocker rlk(&shard.lock);
+    auto it = shard.entries.constFind(url);
+    if (it == shard.entries.constEnd()) {
+        d->missCount.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
     }
-    // 异步线程或者信号更新时间
-    // 使用线程处理加入时间序列问题
-    if (info)
-        emit cacheUpdateInfoTime(url);
 
-    return info;
+    // the access is recorded in the entry, no need to tell the cache thread
+    it.value()->referenced.store(true, std::memory_order_relaxed);
+    d->hitCount.fetch_add(1, std::memory_order_relaxed);
+    return it.value()->info;
 }
 /*!
  * \brief refreshFileInfo 刷新缓存fileinfo
@@ -287,36 +320,71 @@ void InfoCache::refreshFileInfo(const QUrl &url)
 void InfoCache::timeRemoveCache()
 {
     Q_D(InfoCache);
-    // 取出哪些url的时间超出了u
-    qint64 delCount = d->urlTimeSortMap.size() < kCacheFileinfoCount ? 0 : d->urlTimeSortMap.size() - kCacheFileinfoCount;
-    QList<QUrl> delList;
-    foreach (const auto time, d->timeToUrlMap.uniqueKeys()) {
+    if (d->cacheWorkerStoped)
+        return;
+
+    d->updateCapacity();
+    evictCaches(true);
+
+    const InfoCacheStatistics &stat = statistics();
+    qDebug() << "info cache: count" << stat.count << "cost" << stat.cost << "capacity" << stat.capacity
+             << "hits" << stat.hits << "misses" << stat.misses << "evictions" << stat.evictions;
+}
+
+/*!
+ * \brief InfoCache::evictCaches Evict the caches over the capacity
+ * \param aging remove the entries without a hit in the last hour as well
+ */
+void InfoCache::evictCaches(bool aging)
+{
+    Q_D(InfoCache);
+    QMap<QUrl, FileInfoPointer> evicted;
+    const qint64 shardCapacity = d->capacity / InfoCachePrivate::kShardCount;
+    for (InfoCacheShard &shard : d->shards) {
         if (d->cacheWorkerStoped)
             return;
 
-        if (time < QString::number(QDateTime::currentDateTime().toMSecsSinceEpoch() - kCacheRemoveTime)) {
-            delList.append(d->timeToUrlMap.values(time));
-            continue;
-        }
-
-        if (delList.size() >= delCount) {
-            break;
+        QWriteLocker wlk(&shard.lock);
+        if (aging) {
+            for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+                const InfoCacheEntryPointer &entry = it.value();
+                if (entry->referenced.exchange(false, std::memory_order_relaxed)) {
+                    entry->idleSweeps = 0;
+                } else if (++entry->idleSweeps >= kMaxIdleSweeps) {
+                    evicted.insert(it.key(), entry->info);
+                    shard.cost -= entry->cost;
+                    d->totalCost -= entry->cost;
+                    it = shard.entries.erase(it);
+                    continue;
+                }
+                ++it;
+            }
         }
+        d->evictShard(shard, shardCapacity, &evicted);
+    }
 
-        delList.append(d->timeToUrlMap.values(time));
+    if (!evicted.isEmpty() && !d->cacheWorkerStoped) {
+        d->evictCount.fetch_add(quint64(evicted.size()), std::memory_order_relaxed);
+        emit cacheDisconnectWatcher(evicted);
     }
-    // 发送异步消息 告诉移除线程创建移除线程移除，考虑是否是使用线程一直还是使用临时线程（使用临时线程）
-    if (delList.size() > 0 && !d->cacheWorkerStoped)
-        emit cacheRemoveCaches(delList);
 }
 
-void InfoCache::removeInfosTimeWorker(const QList<QUrl> urls)
-{
-    for (auto url : urls) {
-        if (d->urlTimeSortMap.contains(url)) {
-            d->timeToUrlMap.remove(d->urlTimeSortMap.take(url));
-        }
+InfoCacheStatistics InfoCache::statistics() const
+{
+    Q_D(const InfoCache);
+    InfoCacheStatistics stat;
+    stat.hits = d->hitCount.load(std::memory_order_relaxed);
+    stat.misses = d->missCount.load(std::memory_order_relaxed);
+    stat.inserts = d->insertCount.load(std::memory_order_relaxed);
+    stat.evictions = d->evictCount.load(std::memory_order_relaxed);
+    stat.removals = d->removeCount.load(std::memory_order_relaxed);
+    stat.cost = d->totalCost;
+    stat.capacity = d->capacity;
+    for (const InfoCacheShard &shard : d->shards) {
+        QReadLocker rlk(&shard.lock);
+        stat.count += shard.entries.size();
     }
+    return stat;
 }
 
 void InfoCache::fileAttributeChanged(const QUrl url)
@@ -345,24 +413,12 @@ void CacheWorker::removeCaches(const QList<QUrl> urls)
     InfoCache::instance().removeCaches(urls);
 }
 
-void CacheWorker::updateInfoTime(const QUrl url)
-{
-    Q_ASSERT(qApp->thread() != QThread::currentThread());
-    InfoCache::instance().updateSortTimeWorker(url);
-}
-
 void CacheWorker::dealRemoveInfo()
 {
     Q_ASSERT(qApp->thread() != QThread::currentThread());
     InfoCache::instance().timeRemoveCache();
 }
 
-void CacheWorker::removeInfosTime(const QList<QUrl> urls)
-{
-    Q_ASSERT(qApp->thread() != QThread::currentThread());
-    InfoCache::instance().removeInfosTimeWorker(urls);
-}
-
 void CacheWorker::disconnectWatcher(const QMap<QUrl, FileInfoPointer> infos)
 {
     Q_ASSERT(qApp->thread() != QThread::currentThread());
@@ -398,6 +454,11 @@ FileInfoPointer InfoCacheController::getCacheInfo(const QUrl &url)
     return InfoCache::instance().getCacheInfo(url);
 }
 
+InfoCacheStatistics InfoCacheController::statistics() const
+{
+    return InfoCache::instance().statistics();
+}
+
 InfoCacheController::InfoCacheController(QObject *parent)
     : QObject(parent), thread(new QThread), worker(new CacheWorker), removeTimer(new QTimer)
 {
@@ -411,7 +472,6 @@ void InfoCacheController::init()
     connect(this, &InfoCacheController::cacheFileInfo, worker.data(), &CacheWorker::cacheInfo, Qt::QueuedConnection);
     connect(this, &InfoCacheController::removeCacheFileInfo, worker.data(), &CacheWorker::removeCaches, Qt::QueuedConnection);
     connect(&InfoCache::instance(), &InfoCache::cacheRemoveCaches, worker.data(), &CacheWorker::removeCaches, Qt::QueuedConnection);
-    connect(&InfoCache::instance(), &InfoCache::cacheRemoveInfosTime, worker.data(), &CacheWorker::removeInfosTime, Qt::QueuedConnection);
     connect(&InfoCache::instance(), &InfoCache::cacheDisconnectWatcher, worker.data(), &CacheWorker::disconnectWatcher, Qt::QueuedConnection);
 
     worker->moveToThread(thread.data());
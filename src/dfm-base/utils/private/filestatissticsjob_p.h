@@ -9,6 +9,8 @@
 #include <dfm-base/interfaces/abstractdiriterator.h>
 
 #include <QObject>
+#include <QSet>
+#include <QMutex>
 
 #include <fts.h>
 
@@ -16,6 +18,20 @@ namespace dfmbase {
 class FileStatisticsJobPrivate : public QObject
 {
 public:
+    // the counters of a walk, a subtree walked in parallel has its own
+    struct StatisticsCounter
+    {
+        qint64 totalSize { 0 };
+        qint64 totalProgressSize { 0 };
+        int filesCount { 0 };
+        int directoryCount { 0 };
+        quint16 dirSize { 0 };
+        QList<QUrl> allFiles;
+    };
+    // (st_dev, st_ino) of a file
+    using FileKey = QPair<quint64, quint64>;
+
+
     explicit FileStatisticsJobPrivate(FileStatisticsJob *qq);
     ~FileStatisticsJobPrivate();
 
@@ -26,13 +42,20 @@ public:
 
     void processFile(const QUrl &url, const bool followLink, QQueue<QUrl> &directoryQueue);
     void processFileByFts(const QUrl &url, const bool followLink);
+    void statisticByFts(const QByteArray &path, const bool followLink, const int splitLevel, const bool countRoot,
+                        StatisticsCounter &counter, QList<QByteArray> *subtrees);
+    void flushCounter(StatisticsCounter &counter);
+    void mergeCounter(StatisticsCounter &counter);
+    void appendCountedUrl(const QUrl &url);
     void emitSizeChanged();
     int countFileCount(const char *name);
     bool checkFileType(const FileInfo::FileType &fileType);
     FileInfo::FileType getFileType(const uint mode);
-    void statisticDir(const QUrl &url, FTS *fts, const bool singleDepth, FTSENT *ent);
-    void statisticFile(FTSENT *ent);
-    void statisticSysLink(const QUrl &currentUrl, FTS *fts, FTSENT *ent, const bool singleDepth, const bool followLink);
+    void statisticDir(FTSENT *ent, StatisticsCounter &counter);
+    void statisticFile(FTSENT *ent, StatisticsCounter &counter);
+    void statisticSysLink(const QUrl &currentUrl, FTS *fts, FTSENT *ent, const bool singleDepth, const bool followLink,
+                          StatisticsCounter &counter);
+    bool insertFileKey(const FileKey &key);
     bool checkInode(const FileInfoPointer info);
     bool checkInode(FTSENT *ent, FTS *fts);
 
@@ -51,9 +74,11 @@ public:
     QAtomicInt filesCount { 0 };
     QAtomicInt directoryCount { 0 };
     SizeInfoPointer sizeInfo { nullptr };
-    QList<QUrl> fileStatistics;
+    QSet<QUrl> fileStatistics;
+    QSet<QUrl> countedUrls;   // the urls of allFiles counted by the sequential walks
     QList<QString> skipPath;
-    QList<quint64> inodelist;
+    QSet<FileKey> fileKeys;   // the directories and the hard linked files visited
+    QMutex fileKeysMutex;
     AbstractDirIteratorPointer iterator { nullptr };
     std::atomic_bool iteratorCanStop { false };
 };
@@ -11,12 +11,34 @@
 #include <QMutex>
 #include <QTimer>
 #include <QMap>
+#include <QVector>
+
+#include <atomic>
 
 namespace dfmbase {
-enum CacheInfoStatus : uint8_t {
-    kCacheMain = 0,   // 1.正常状态 插入(同时插入主和副缓存hash)， 读取主缓存hash， 删除主缓存hash
-    kCacheCopy,
+struct InfoCacheEntry
+{
+    FileInfoPointer info;
+    qint64 cost { 0 };
+    // set on every hit without a lock, cleared by the clock hand
+    std::atomic_bool referenced { true };
+    // the sweeps since the last hit, touched by the cache thread only
+    int idleSweeps { 0 };
 };
+using InfoCacheEntryPointer = QSharedPointer<InfoCacheEntry>;
+
+// The readers of different shards never contend, a hit only takes the read
+// lock of its shard and sets the referenced bit of the entry.
+struct InfoCacheShard
+{
+    mutable QReadWriteLock lock;
+    QHash<QUrl, InfoCacheEntryPointer> entries;
+    // urls in insertion order for the clock hand, the removed ones are skipped
+    QVector<QUrl> clockRing;
+    int clockHand { 0 };
+    qint64 cost { 0 };
+};
+
 class InfoCachePrivate
 {
     friend class InfoCache;
@@ -24,18 +46,24 @@ class InfoCachePrivate
     InfoCache *const q;
     DThreadList<QString> disableCahceSchemes;
 
-    QAtomicInt status { kCacheMain };   // 当前状态缓存的状态
-    QHash<QUrl, FileInfoPointer> mainCache;   // 主信息缓存
-    QHash<QUrl, FileInfoPointer> copyCache;   // 副信息缓存
-    QReadWriteLock mianLock;
-    QReadWriteLock copyLock;
+    static constexpr int kShardCount { 16 };
+    InfoCacheShard shards[kShardCount];
 
-    // 时间排序url,利用map的有序性，来处理时间到了要移除的url
-    QMap<QUrl, QString> urlTimeSortMap;
-    QMap<QString, QUrl> timeToUrlMap;
+    std::atomic<qint64> totalCost { 0 };
+    std::atomic<qint64> capacity { 0 };
+    std::atomic<quint64> hitCount { 0 };
+    std::atomic<quint64> missCount { 0 };
+    std::atomic<quint64> insertCount { 0 };
+    std::atomic<quint64> evictCount { 0 };
+    std::atomic<quint64> removeCount { 0 };
 
     std::atomic_bool cacheWorkerStoped { false };
 
+    InfoCacheShard &shardOf(const QUrl &url);
+    void evictShard(InfoCacheShard &shard, qint64 target, QMap<QUrl, FileInfoPointer> *evicted);
+    void updateCapacity();
+    static qint64 entryCost(const QUrl &url);
+
 public:
     explicit InfoCachePrivate(InfoCache *qq);
     virtual ~InfoCachePrivate();
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "textlayoutcache.h"
+
+#include <DGuiApplicationHelper>
+
+#include <QGuiApplication>
+#include <QDebug>
+
+DGUI_USE_NAMESPACE
+using namespace dfmbase;
+
+static constexpr int kMaxLineEntries { 4096 };
+static constexpr int kMaxPixmapKBytes { 16 * 1024 };
+static constexpr quint64 kStatisticsInterval { 10000 };
+
+TextLayoutCache *TextLayoutCache::instance()
+{
+    static TextLayoutCache *ins = [] {
+        TextLayoutCache *cache = new TextLayoutCache;
+        if (qGuiApp) {
+            auto clear = [cache]() { cache->clear(); };
+            QObject::connect(DGuiApplicationHelper::instance(), &DGuiApplicationHelper::themeTypeChanged, qGuiApp, clear);
+            QObject::connect(qGuiApp, &QGuiApplication::fontChanged, qGuiApp, clear);
+        }
+        return cache;
+    }();
+    return ins;
+}
+
+TextLayoutCache::TextLayoutCache()
+    : lines(kMaxLineEntries),
+      pixmaps(kMaxPixmapKBytes)
+{
+}
+
+bool TextLayoutCache::findLines(const QByteArray &key, QList<QRectF> *lines, QStringList *textLines)
+{
+    QMutexLocker lk(&mutex);
+    const Lines *entry = this->lines.object(key);
+    countLookup(entry);
+    if (!entry)
+        return false;
+
+    if (lines)
+        *lines = entry->rects;
+    if (textLines)
+        textLines->append(entry->texts);
+    return true;
+}
+
+void TextLayoutCache::insertLines(const QByteArray &key, const QList<QRectF> &lines, const QStringList &textLines)
+{
+    QMutexLocker lk(&mutex);
+    this->lines.insert(key, new Lines { lines, textLines });
+}
+
+QPixmap TextLayoutCache::findPixmap(const QByteArray &key)
+{
+    QMutexLocker lk(&mutex);
+    const QPixmap *pixmap = pixmaps.object(key);
+    countLookup(pixmap);
+    return pixmap ? *pixmap : QPixmap();
+}
+
+void TextLayoutCache::insertPixmap(const QByteArray &key, const QPixmap &pixmap)
+{
+    if (pixmap.isNull())
+        return;
+
+    const int cost = qMax(1, pixmap.width() * pixmap.height() * pixmap.depth() / 8 / 1024);
+    QMutexLocker lk(&mutex);
+    pixmaps.insert(key, new QPixmap(pixmap), cost);
+}
+
+void TextLayoutCache::clear()
+{
+    QMutexLocker lk(&mutex);
+    lines.clear();
+    pixmaps.clear();
+}
+
+TextLayoutCacheStatistics TextLayoutCache::statistics() const
+{
+    QMutexLocker lk(&mutex);
+    TextLayoutCacheStatistics stat;
+    stat.hits = hits;
+    stat.misses = misses;
+    stat.lineCount = lines.count();
+    stat.pixmapCount = pixmaps.count();
+    return stat;
+}
+
+void TextLayoutCache::countLookup(bool hit)
+{
+    hit ? ++hits : ++misses;
+    const quint64 total = hits + misses;
+    if (total % kStatisticsInterval == 0)
+        qDebug() << "text layout cache:" << hits << "hits," << misses << "misses, hit rate"
+                 << hits * 100 / total << "%," << lines.count() << "layouts," << pixmaps.count() << "pixmaps";
+}
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TEXTLAYOUTCACHE_H
+#define TEXTLAYOUTCACHE_H
+
+#include <dfm-base/dfm_base_global.h>
+
+#include <QCache>
+#include <QMutex>
+#include <QPixmap>
+#include <QRectF>
+#include <QStringList>
+
+namespace dfmbase {
+
+struct TextLayoutCacheStatistics
+{
+    quint64 hits { 0 };
+    quint64 misses { 0 };
+    int lineCount { 0 };
+    int pixmapCount { 0 };
+};
+
+// Results of ElideTextLayout shared by the item delegates of the workspace,
+// the canvas and the organizer.
+// A key is built by ElideTextLayout::cacheKey from the document, that holds
+// the text and the formats added by the LayoutText hooks, the attributes of
+// the layout, the size and the elide mode. So a renamed file, a new tag or a
+// changed font gets a new key instead of a stale layout. The pixmaps of the
+// rendered text are dropped when the theme or the font is changed.
+class TextLayoutCache
+{
+public:
+    static TextLayoutCache *instance();
+
+    // geometry of the lines, relative to the top left of the layout rect
+    bool findLines(const QByteArray &key, QList<QRectF> *lines, QStringList *textLines);
+    void insertLines(const QByteArray &key, const QList<QRectF> &lines, const QStringList &textLines);
+
+    // rendered text, in the gui thread only
+    QPixmap findPixmap(const QByteArray &key);
+    void insertPixmap(const QByteArray &key, const QPixmap &pixmap);
+
+    void clear();
+    TextLayoutCacheStatistics statistics() const;
+
+private:
+    TextLayoutCache();
+    void countLookup(bool hit);
+
+    struct Lines
+    {
+        QList<QRectF> rects;
+        QStringList texts;
+    };
+
+    mutable QMutex mutex;
+    QCache<QByteArray, Lines> lines;
+    QCache<QByteArray, QPixmap> pixmaps;   // cost in KB
+    quint64 hits { 0 };
+    quint64 misses { 0 };
+};
+
+}   // namespace dfmbase
+
+#endif   // TEXTLAYOUTCACHE_H
@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mediathumbnailer.h"
+
+#include <QProcess>
+#include <QThreadStorage>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QUrl>
+#include <QDebug>
+
+using namespace dfmbase;
+DFMGLOBAL_USE_NAMESPACE
+
+static constexpr char kToolName[] { "dde-file-thumbnail-tool" };
+static constexpr int kReplyTimeout { 15000 };   // ms, a broken file must not block the worker
+static constexpr qint64 kMaxReplySize { 32 * 1024 * 1024 };
+// the helper crashing on every file is unusable, fall back to ffmpeg
+static constexpr int kMaxFailedCount { 3 };
+
+MediaThumbnailer::~MediaThumbnailer()
+{
+    stop();
+}
+
+MediaThumbnailer *MediaThumbnailer::instance()
+{
+    // a QProcess belongs to the thread that created it
+    static QThreadStorage<MediaThumbnailer *> storage;
+    if (!storage.hasLocalData())
+        storage.setLocalData(new MediaThumbnailer);
+    return storage.localData();
+}
+
+QString MediaThumbnailer::toolPath()
+{
+    return QString(THUMBNAIL_TOOL_DIR) + "/" + kToolName;
+}
+
+bool MediaThumbnailer::isAvailable() const
+{
+    if (failedCount >= kMaxFailedCount)
+        return false;
+
+    const QFileInfo info(toolPath());
+    return info.isFile() && info.isExecutable();
+}
+
+QImage MediaThumbnailer::thumbnail(const QString &filePath, ThumbnailSize size)
+{
+    return thumbnails({ filePath }, size).value(0);
+}
+
+/*!
+ * \brief MediaThumbnailer::thumbnails Create the thumbnails of the files in one batch
+ * \return the thumbnails in the order of the files, a null image for a failed file
+ */
+QList<QImage> MediaThumbnailer::thumbnails(const QStringList &filePaths, ThumbnailSize size)
+{
+    QList<QImage> images;
+    images.reserve(filePaths.count());
+    while (images.count() < filePaths.count() && start()) {
+        for (int i = images.count(); i < filePaths.count(); ++i) {
+            const QByteArray &request = QByteArray::number(size) + ' '
+                    + QUrl::fromLocalFile(filePaths.at(i)).toEncoded() + '\n';
+            process->write(request);
+        }
+
+        while (images.count() < filePaths.count()) {
+            QImage image;
+            if (!readReply(&image)) {
+                // the file crashed the helper or hangs it, skip the file and
+                // send the rest of the batch to a new helper
+                qWarning() << "thumbnail: the thumbnail tool failed, restart it" << filePaths.at(images.count());
+                ++failedCount;
+                stop();
+                images.append(QImage());
+                break;
+            }
+
+            failedCount = 0;
+            images.append(image);
+        }
+    }
+
+    while (images.count() < filePaths.count())
+        images.append(QImage());
+    return images;
+}
+
+bool MediaThumbnailer::start()
+{
+    if (process && process->state() == QProcess::Running)
+        return true;
+
+    if (!isAvailable())
+        return false;
+
+    process.reset(new QProcess);
+    process->setStandardErrorFile(QProcess::nullDevice());
+    process->start(toolPath(), {}, QIODevice::ReadWrite);
+    if (!process->waitForStarted()) {
+        qWarning() << "thumbnail: start the thumbnail tool failed: " << process->errorString();
+        ++failedCount;
+        process.reset();
+        return false;
+    }
+
+    return true;
+}
+
+void MediaThumbnailer::stop()
+{
+    if (!process)
+        return;
+
+    if (process->state() != QProcess::NotRunning) {
+        process->kill();
+        process->waitForFinished(1000);
+    }
+    process.reset();
+}
+
+bool MediaThumbnailer::readReply(QImage *image)
+{
+    QElapsedTimer timer;
+    timer.start();
+    auto waitFor = [this, &timer](auto &&ready) {
+        while (!ready()) {
+            const qint64 remain = kReplyTimeout - timer.elapsed();
+            if (remain <= 0 || !process->waitForReadyRead(static_cast<int>(remain)))
+                return false;
+        }
+        return true;
+    };
+
+    // "ok <length>" or "err 0"
+    if (!waitFor([this] { return process->canReadLine(); }))
+        return false;
+
+    const QList<QByteArray> &header = process->readLine().trimmed().split(' ');
+    bool ok = false;
+    const qint64 length = header.value(1).toLongLong(&ok);
+    if (header.count() != 2 || !ok || length < 0 || length > kMaxReplySize)
+        return false;
+
+    if (!waitFor([this, length] { return process->bytesAvailable() >= length; }))
+        return false;
+
+    const QByteArray &data = process->read(length);
+    if (header.first() == "ok" && !image->loadFromData(data, "png"))
+        qWarning() << "thumbnail: cannot load image from the thumbnail tool outputs.";
+    return true;
+}
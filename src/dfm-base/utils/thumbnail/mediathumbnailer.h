@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MEDIATHUMBNAILER_H
+#define MEDIATHUMBNAILER_H
+
+#include <dfm-base/dfm_base_global.h>
+#include <dfm-base/dfm_global_defines.h>
+
+#include <QImage>
+#include <QScopedPointer>
+
+class QProcess;
+
+namespace dfmbase {
+
+// Client of dde-file-thumbnail-tool, the helper process creating the
+// thumbnails of the video and audio files.
+// Every thumbnail thread owns one helper, it is started on the first request
+// and kept running so that the decoders are loaded once. A helper which
+// crashed or stopped replying is killed and started again on the next request.
+class MediaThumbnailer
+{
+public:
+    ~MediaThumbnailer();
+
+    static MediaThumbnailer *instance();
+    static QString toolPath();
+
+    bool isAvailable() const;
+    QImage thumbnail(const QString &filePath, DFMGLOBAL_NAMESPACE::ThumbnailSize size);
+    QList<QImage> thumbnails(const QStringList &filePaths, DFMGLOBAL_NAMESPACE::ThumbnailSize size);
+
+private:
+    MediaThumbnailer() = default;
+
+    bool start();
+    void stop();
+    bool readReply(QImage *image);
+
+private:
+    QScopedPointer<QProcess> process;
+    int failedCount { 0 };   // failed replies since the last successful one
+};
+
+}   // namespace dfmbase
+
+#endif   // MEDIATHUMBNAILER_H
@@ -9,6 +9,7 @@
 #include <dfm-base/dfm_global_defines.h>
 #include <dfm-base/utils/thumbnail/thumbnailworker.h>
 #include <dfm-base/utils/thumbnail/thumbnailhelper.h>
+#include <dfm-base/utils/thumbnail/thumbnailscheduler.h>
 #include <dfm-base/mimetype/dmimedatabase.h>
 
 #include <QFuture>
@@ -18,11 +19,12 @@ namespace dfmbase {
 class ThumbnailWorkerPrivate
 {
 public:
-    explicit ThumbnailWorkerPrivate(ThumbnailWorker *qq);
+    explicit ThumbnailWorkerPrivate(ThumbnailWorker *qq, QSharedPointer<ThumbnailScheduler> scheduler);
     QString createThumbnail(const QUrl &url, DFMGLOBAL_NAMESPACE::ThumbnailSize size);
     bool checkFileStable(const QUrl &url);
 
     ThumbnailWorker *q { nullptr };
+    QSharedPointer<ThumbnailScheduler> scheduler;
     DMimeDatabase mimeDb;
     QMap<QString, ThumbnailWorker::ThumbnailCreator> creators;
     QUrl originalUrl;
@@ -4,9 +4,9 @@
 
 #include "thumbnailcreators.h"
 #include "thumbnailhelper.h"
+#include "mediathumbnailer.h"
 
 #include <dfm-base/utils/fileutils.h>
-#include <dfm-base/mimetype/dmimedatabase.h>
 #include <dfm-base/base/schemefactory.h>
 
 #include <dfm-io/dfmio_utils.h>
@@ -18,6 +18,11 @@
 #include <QPen>
 #include <QPainter>
 #include <QImageReader>
+#include <QImageIOHandler>
+#include <QBuffer>
+#include <QFile>
+#include <QTransform>
+#include <QtEndian>
 #include <QDebug>
 
 // use original poppler api
@@ -27,10 +32,167 @@
 #include <poppler/cpp/poppler-page-renderer.h>
 
 static constexpr char kFormat[] { ".png" };
+static constexpr int kFastDecodeQuality { 25 };   // integer IDCT without fancy upsampling in the jpeg handler
+static constexpr int kMaxJpegSegments { 16 };   // the exif data is in one of the first segments
 
 using namespace dfmbase;
 DFMGLOBAL_USE_NAMESPACE
 
+namespace {
+// the exif data of a jpeg file: the orientation of the image and the
+// thumbnail embedded by the camera
+struct ExifData
+{
+    int orientation { 1 };
+    QByteArray thumbnail;
+};
+
+quint16 exifUInt16(const uchar *data, bool littleEndian)
+{
+    return littleEndian ? qFromLittleEndian<quint16>(data) : qFromBigEndian<quint16>(data);
+}
+
+quint32 exifUInt32(const uchar *data, bool littleEndian)
+{
+    return littleEndian ? qFromLittleEndian<quint32>(data) : qFromBigEndian<quint32>(data);
+}
+
+void parseExif(const QByteArray &tiff, ExifData *exif)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(tiff.constData());
+    const quint32 size = quint32(tiff.size());
+    if (size < 8 || (memcmp(data, "II*\0", 4) != 0 && memcmp(data, "MM\0*", 4) != 0))
+        return;
+
+    const bool le = data[0] == 'I';
+    quint32 ifdOffset = exifUInt32(data + 4, le);
+    quint32 thumbOffset = 0;
+    quint32 thumbLength = 0;
+    // IFD0 of the image, IFD1 of the thumbnail, the offsets are read from the
+    // file and the bounds are checked in 64 bits so that they can't wrap
+    for (int ifd = 0; ifd < 2 && ifdOffset > 0; ++ifd) {
+        if (ifdOffset >= size || quint64(ifdOffset) + 2 > size)
+            return;
+
+        const quint16 count = exifUInt16(data + ifdOffset, le);
+        if (quint64(ifdOffset) + 2 + count * quint64(12) + 4 > size)
+            return;
+
+        for (quint16 i = 0; i < count; ++i) {
+            const uchar *entry = data + ifdOffset + 2 + i * 12;
+            const quint16 tag = exifUInt16(entry, le);
+            if (ifd == 0 && tag == 0x0112)
+                exif->orientation = exifUInt16(entry + 8, le);
+            else if (ifd == 1 && tag == 0x0201)
+                thumbOffset = exifUInt32(entry + 8, le);
+            else if (ifd == 1 && tag == 0x0202)
+                thumbLength = exifUInt32(entry + 8, le);
+        }
+        ifdOffset = exifUInt32(data + ifdOffset + 2 + count * 12, le);
+    }
+
+    if (thumbLength > 0 && thumbOffset + quint64(thumbLength) <= size)
+        exif->thumbnail = tiff.mid(int(thumbOffset), int(thumbLength));
+}
+
+bool readExif(const QString &filePath, ExifData *exif)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    uchar marker[4];
+    if (file.read(reinterpret_cast<char *>(marker), 2) != 2 || marker[0] != 0xFF || marker[1] != 0xD8)
+        return false;
+
+    for (int i = 0; i < kMaxJpegSegments; ++i) {
+        if (file.read(reinterpret_cast<char *>(marker), 4) != 4 || marker[0] != 0xFF)
+            return false;
+
+        // APPn and COM come before the image data
+        const uchar type = marker[1];
+        if ((type < 0xE0 || type > 0xEF) && type != 0xFE)
+            return false;
+
+        const int length = qFromBigEndian<quint16>(marker + 2) - 2;
+        if (length < 0)
+            return false;
+
+        if (type == 0xE1) {
+            const QByteArray &segment = file.read(length);
+            if (segment.startsWith(QByteArray("Exif\0\0", 6))) {
+                parseExif(segment.mid(6), exif);
+                return true;
+            }
+        } else if (!file.seek(file.pos() + length)) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+QImage transformByExif(const QImage &image, int orientation)
+{
+    // the same as QImageReader::setAutoTransform
+    static const QImageIOHandler::Transformations kTransforms[] {
+        QImageIOHandler::TransformationNone, QImageIOHandler::TransformationNone,
+        QImageIOHandler::TransformationMirror, QImageIOHandler::TransformationRotate180,
+        QImageIOHandler::TransformationFlip, QImageIOHandler::TransformationFlipAndRotate90,
+        QImageIOHandler::TransformationRotate90, QImageIOHandler::TransformationMirrorAndRotate90,
+        QImageIOHandler::TransformationRotate270
+    };
+    if (orientation < 2 || orientation > 8)
+        return image;
+
+    const auto transform = kTransforms[orientation];
+    QImage result = image.mirrored(transform.testFlag(QImageIOHandler::TransformationMirror),
+                                   transform.testFlag(QImageIOHandler::TransformationFlip));
+    if (transform.testFlag(QImageIOHandler::TransformationRotate90))
+        result = result.transformed(QTransform().rotate(90));
+    return result;
+}
+
+/*!
+ * \brief exifThumbnail The thumbnail embedded by the camera, when it is big enough
+ * and it has the aspect ratio of the image (some cameras add black bars)
+ */
+QImage exifThumbnail(const QString &filePath, const QSize &imageSize, ThumbnailSize size)
+{
+    ExifData exif;
+    if (!readExif(filePath, &exif) || exif.thumbnail.isEmpty())
+        return {};
+
+    QBuffer buffer(&exif.thumbnail);
+    QImageReader reader(&buffer, "jpeg");
+    const QSize &thumbSize = reader.size();
+    if (!thumbSize.isValid() || qMax(thumbSize.width(), thumbSize.height()) < size)
+        return {};
+
+    const qreal imageRatio = qreal(imageSize.width()) / imageSize.height();
+    const qreal thumbRatio = qreal(thumbSize.width()) / thumbSize.height();
+    if (qAbs(imageRatio - thumbRatio) > imageRatio * 0.02)
+        return {};
+
+    QImage image;
+    if (!reader.read(&image))
+        return {};
+
+    return transformByExif(image, exif.orientation);
+}
+
+// the biggest 1/1, 1/2, 1/4 or 1/8 of the image still covering the thumbnail,
+// libjpeg decodes it from the DCT coefficients without decoding the full image
+QSize jpegScaledSize(const QSize &imageSize, ThumbnailSize size)
+{
+    const int longest = qMax(imageSize.width(), imageSize.height());
+    int denom = 8;
+    while (denom > 1 && longest / denom < size)
+        denom /= 2;
+    return QSize(qMax(1, imageSize.width() / denom), qMax(1, imageSize.height() / denom));
+}
+}   // namespace
+
 QImage ThumbnailCreators::defaultThumbnailCreator(const QString &filePath, ThumbnailSize size)
 {
     QFileInfo qInf(filePath);
@@ -58,6 +220,11 @@ QImage ThumbnailCreators::videoThumbnailCreator(const QString &filePath, Thumbna
 
 QImage ThumbnailCreators::videoThumbnailCreatorFfmpeg(const QString &filePath, ThumbnailSize size)
 {
+    // the persistent helper saves an ffmpeg launch per file
+    MediaThumbnailer *thumbnailer = MediaThumbnailer::instance();
+    if (thumbnailer->isAvailable())
+        return thumbnailer->thumbnail(filePath, size);
+
     QProcess ffmpeg;
     QStringList args { "-nostats", "-loglevel", "0", "-i", filePath,
                        "-vf", QString("scale='min(%1, iw)':-1").arg(size), "-f",
@@ -144,6 +311,11 @@ QImage ThumbnailCreators::textThumbnailCreator(const QString &filePath, Thumbnai
 
 QImage ThumbnailCreators::audioThumbnailCreator(const QString &filePath, ThumbnailSize size)
 {
+    // the helper prefers the embedded cover art
+    MediaThumbnailer *thumbnailer = MediaThumbnailer::instance();
+    if (thumbnailer->isAvailable())
+        return thumbnailer->thumbnail(filePath, size);
+
     QProcess ffmpeg;
     QStringList args { "-nostats", "-loglevel", "0", "-i", filePath,
                        "-an", "-vf", QString("scale='min(%1, iw)':-1").arg(size), "-f", "image2pipe", "-fs", "9000", "-" };
@@ -167,13 +339,17 @@ QImage ThumbnailCreators::audioThumbnailCreator(const QString &filePath, Thumbna
 QImage ThumbnailCreators::imageThumbnailCreator(const QString &filePath, ThumbnailSize size)
 {
     //! fix bug#49451 因为使用mime.preferredSuffix(),会导致后续image.save崩溃，具体原因还需进一步跟进
-    //! QImageReader构造时不传format参数，让其自行判断
-    //! fix bug #53200 QImageReader构造时不传format参数，会造成没有读取不了真实的文件 类型比如将png图标后缀修改为jpg，读取的类型不对
-
-    QString mimeType = DMimeDatabase().mimeTypeForFile(QUrl::fromLocalFile(filePath), QMimeDatabase::MatchContent).name();
-    const QString &suffix = mimeType.replace("image/", "");
+    //! fix bug #53200 后缀与真实类型不一致时（比如将png图标后缀修改为jpg）按文件内容判断类型
+    //! the reader sniffs the content itself, instead of a content matching of the mime database
+    QImageReader reader;
+    reader.setDecideFormatFromContent(true);
+    reader.setFileName(filePath);
+    if (!reader.canRead()) {
+        // some formats can only be known by the suffix
+        reader.setDecideFormatFromContent(false);
+        reader.setFileName(filePath);
+    }
 
-    QImageReader reader(filePath, suffix.toLatin1());
     if (!reader.canRead()) {
         qWarning() << "thumbnail: can not read this file:"
                    << reader.errorString()
@@ -185,14 +361,24 @@ QImage ThumbnailCreators::imageThumbnailCreator(const QString &filePath, Thumbna
 
     //fix 读取损坏icns文件（可能任意损坏的image类文件也有此情况）在arm平台上会导致递归循环的问题
     //这里先对损坏文件（imagesize无效）做处理，不再尝试读取其image数据
-    if (!imageSize.isValid()) {
+    if (!imageSize.isValid() || imageSize.isEmpty()) {
         qWarning() << "thumbnail: fail to read image file attribute data." << filePath;
         return {};
     }
 
-    const QString &defaultMime = DMimeDatabase().mimeTypeForFile(QUrl::fromLocalFile(filePath)).name();
-    if (imageSize.width() > size || imageSize.height() > size || defaultMime == DFMGLOBAL_NAMESPACE::Mime::kTypeImageSvgXml)
-        reader.setScaledSize(reader.size().scaled(size, size, Qt::KeepAspectRatio));
+    const QByteArray &format = reader.format();
+    const bool isBigger = imageSize.width() > size || imageSize.height() > size;
+    const bool isJpeg = format == "jpeg" || format == "jpg";
+    if (isJpeg && isBigger) {
+        const QImage &image = exifThumbnail(filePath, imageSize, size);
+        if (!image.isNull())
+            return image.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+        reader.setScaledSize(jpegScaledSize(imageSize, size));
+        reader.setQuality(kFastDecodeQuality);
+    } else if (isBigger || format.startsWith("svg")) {
+        reader.setScaledSize(imageSize.scaled(size, size, Qt::KeepAspectRatio));
+    }
 
     reader.setAutoTransform(true);
     QImage image;
@@ -203,6 +389,10 @@ QImage ThumbnailCreators::imageThumbnailCreator(const QString &filePath, Thumbna
         return image;
     }
 
+    // at most twice the size after the DCT scaling
+    if (image.width() > size || image.height() > size)
+        image = image.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
     return image;
 }
 
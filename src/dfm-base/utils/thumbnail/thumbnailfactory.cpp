@@ -17,12 +17,19 @@ DFMGLOBAL_USE_NAMESPACE
 
 static constexpr int kMaxCountLimit { 50 };
 static constexpr int kPushInterval { 100 };   // ms
+static constexpr int kMaxWorkerCount { 8 };
 
 ThumbnailFactory::ThumbnailFactory(QObject *parent)
     : QObject(parent),
-      thread(new QThread),
-      worker(new ThumbnailWorker)
+      scheduler(new ThumbnailScheduler)
 {
+    // leave a core to the gui thread
+    const int workerCount = qBound(1, QThread::idealThreadCount() - 1, kMaxWorkerCount);
+    for (int i = 0; i < workerCount; ++i) {
+        threads.append(QSharedPointer<QThread>(new QThread));
+        workers.append(QSharedPointer<ThumbnailWorker>(new ThumbnailWorker(scheduler)));
+    }
+
     registerThumbnailCreator(Mime::kTypeImageVDjvu, ThumbnailCreators::djvuThumbnailCreator);
     registerThumbnailCreator(Mime::kTypeImageVDMultipage, ThumbnailCreators::djvuThumbnailCreator);
     registerThumbnailCreator(Mime::kTypeTextPlain, ThumbnailCreators::textThumbnailCreator);
@@ -37,7 +44,7 @@ ThumbnailFactory::ThumbnailFactory(QObject *parent)
 
 ThumbnailFactory::~ThumbnailFactory()
 {
-    if (thread->isRunning())
+    if (threads.first()->isRunning())
         onAboutToQuit();
 }
 
@@ -51,21 +58,27 @@ void ThumbnailFactory::init()
 
     connect(qApp, &QGuiApplication::aboutToQuit, this, &ThumbnailFactory::onAboutToQuit);
 
-    connect(this, &ThumbnailFactory::addTask, worker.data(), &ThumbnailWorker::onTaskAdded, Qt::QueuedConnection);
-    connect(worker.data(), &ThumbnailWorker::thumbnailCreateFinished, this, &ThumbnailFactory::produceFinished, Qt::QueuedConnection);
-    connect(worker.data(), &ThumbnailWorker::thumbnailCreateFailed, this, &ThumbnailFactory::produceFailed, Qt::QueuedConnection);
+    for (int i = 0; i < workers.count(); ++i) {
+        const auto &worker = workers.at(i);
+        connect(this, &ThumbnailFactory::taskAvailable, worker.data(), &ThumbnailWorker::onTaskAvailable, Qt::QueuedConnection);
+        connect(worker.data(), &ThumbnailWorker::thumbnailCreateFinished, this, &ThumbnailFactory::produceFinished, Qt::QueuedConnection);
+        connect(worker.data(), &ThumbnailWorker::thumbnailCreateFailed, this, &ThumbnailFactory::produceFailed, Qt::QueuedConnection);
 
-    worker->moveToThread(thread.data());
-    thread->start();
+        worker->moveToThread(threads.at(i).data());
+        threads.at(i)->start();
+    }
 }
 
 void ThumbnailFactory::joinThumbnailJob(const QUrl &url, ThumbnailSize size)
 {
-    if (taskMap.isEmpty())
+    // queued right now so that the latest request is taken first,
+    // the workers are woken up in batches
+    // the device of the file is checked by the worker
+    scheduler->push(url, size);
+    if (joinedCount++ == 0)
         taskPushTimer.start();
 
-    taskMap.insert(url, size);
-    if (taskMap.size() < kMaxCountLimit)
+    if (joinedCount < kMaxCountLimit)
         return;
 
     pushTask();
@@ -74,18 +87,31 @@ void ThumbnailFactory::joinThumbnailJob(const QUrl &url, ThumbnailSize size)
 bool ThumbnailFactory::registerThumbnailCreator(const QString &mimeType, ThumbnailCreator creator)
 {
     Q_ASSERT(creator);
-    return worker->registerCreator(mimeType, creator);
+    bool ret = true;
+    for (const auto &worker : workers)
+        ret = worker->registerCreator(mimeType, creator) && ret;
+    return ret;
+}
+
+ThumbnailScheduler::Metrics ThumbnailFactory::metrics() const
+{
+    return scheduler->metrics();
 }
 
 void ThumbnailFactory::onAboutToQuit()
 {
-    worker->stop();
-    thread->quit();
-    thread->wait(3000);
+    scheduler->clear();
+    for (const auto &worker : workers)
+        worker->stop();
+    for (const auto &thread : threads)
+        thread->quit();
+    for (const auto &thread : threads)
+        thread->wait(3000);
 }
 
 void ThumbnailFactory::pushTask()
 {
-    auto map = std::move(taskMap);
-    emit addTask(map);
+    taskPushTimer.stop();
+    joinedCount = 0;
+    emit taskAvailable();
 }
@@ -6,6 +6,7 @@
 #define THUMBNAILFACTORY_H
 
 #include "thumbnailworker.h"
+#include "thumbnailscheduler.h"
 
 #include <dfm-base/dfm_base_global.h>
 #include <dfm-base/dfm_global_defines.h>
@@ -28,12 +29,13 @@ public:
     void joinThumbnailJob(const QUrl &url, DFMGLOBAL_NAMESPACE::ThumbnailSize size);
     using ThumbnailCreator = std::function<QImage(const QString &, DFMGLOBAL_NAMESPACE::ThumbnailSize)>;
     bool registerThumbnailCreator(const QString &mimeType, ThumbnailCreator creator);
+    ThumbnailScheduler::Metrics metrics() const;
 
 Q_SIGNALS:
     void produceFinished(const QUrl &src, const QString &thumb);
     void produceFailed(const QUrl &src);
 
-    void addTask(const ThumbnailWorker::ThumbnailTaskMap &taskMap);
+    void taskAvailable();
 
 private Q_SLOTS:
     void onAboutToQuit();
@@ -45,9 +47,10 @@ protected:
     void init();
 
 private:
-    ThumbnailWorker::ThumbnailTaskMap taskMap;
-    QSharedPointer<QThread> thread { nullptr };
-    QSharedPointer<ThumbnailWorker> worker { nullptr };
+    int joinedCount { 0 };
+    QSharedPointer<ThumbnailScheduler> scheduler { nullptr };
+    QList<QSharedPointer<QThread>> threads;
+    QList<QSharedPointer<ThumbnailWorker>> workers;
     QTimer taskPushTimer;
 };
 }   // namespace dfmbase
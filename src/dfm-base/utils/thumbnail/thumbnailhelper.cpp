@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "thumbnailhelper.h"
+#include "thumbnailpack.h"
 
 #include <dfm-base/base/standardpaths.h>
 #include <dfm-base/base/schemefactory.h>
@@ -17,8 +18,8 @@
 
 #include <QImageReader>
 #include <QDir>
-
-#include <sys/stat.h>
+#include <QFileInfo>
+#include <QPixmap>
 
 #include <sys/stat.h>
 
@@ -132,7 +133,8 @@ QString ThumbnailHelper::saveThumbnail(const QUrl &url, const QImage &img, Thumb
 
     QImage tmpImg = img;
     const QString &fileUrl = url.toString(QUrl::FullyEncoded);
-    const QString &thumbnailName = ThumbnailHelper::dataToMd5Hex(fileUrl.toLocal8Bit()) + kFormat;
+    const QByteArray &key = ThumbnailHelper::dataToMd5Hex(fileUrl.toLocal8Bit());
+    const QString &thumbnailName = key + kFormat;
     const QString &thumbnailPath = ThumbnailHelper::sizeToFilePath(size);
     const QString &thumbnailFilePath = DFMIO::DFMUtils::buildFilePath(thumbnailPath.toStdString().c_str(), thumbnailName.toStdString().c_str(), nullptr);
 
@@ -146,6 +148,12 @@ QString ThumbnailHelper::saveThumbnail(const QUrl &url, const QImage &img, Thumb
         return "";
     }
 
+    // the png stays for the other applications reading the freedesktop directories
+    if (ThumbnailPack::isEnabled()) {
+        if (ThumbnailPack *pack = ThumbnailPack::instance(size))
+            pack->insert(key, fileUrl, fileModify, tmpImg);
+    }
+
     return thumbnailFilePath;
 }
 
@@ -166,8 +174,21 @@ QImage ThumbnailHelper::thumbnailImage(const QUrl &fileUrl, ThumbnailSize size)
         return img;
     }
 
-    const QString thumbnailName = dataToMd5Hex((QUrl::fromLocalFile(filePath).toString(QUrl::FullyEncoded)).toLocal8Bit()) + kFormat;
+    const QString &url = QUrl::fromLocalFile(filePath).toString(QUrl::FullyEncoded);
+    const QByteArray &key = dataToMd5Hex(url.toLocal8Bit());
+    const QString thumbnailName = key + kFormat;
     QString thumbnail = DFMIO::DFMUtils::buildFilePath(sizeToFilePath(size).toStdString().c_str(), thumbnailName.toStdString().c_str(), nullptr);
+    const qint64 fileModify = fileInfo->timeOf(TimeInfoType::kLastModifiedSecond).toLongLong();
+
+    ThumbnailPack *pack = ThumbnailPack::isEnabled() ? ThumbnailPack::instance(size) : nullptr;
+    if (pack) {
+        QImage image = pack->find(key, fileModify);
+        if (!image.isNull()) {
+            image.setText(QT_STRINGIFY(Thumb::Path), thumbnail);
+            return image;
+        }
+    }
+
     if (!DFMIO::DFile(thumbnail).exists())
         return {};
 
@@ -179,16 +200,42 @@ QImage ThumbnailHelper::thumbnailImage(const QUrl &fileUrl, ThumbnailSize size)
     ir.setAutoDetectImageFormat(false);
 
     QImage image = ir.read();
-    const qint64 fileModify = fileInfo->timeOf(TimeInfoType::kLastModifiedSecond).toLongLong();
     if (!image.isNull() && image.text(QT_STRINGIFY(Thumb::MTime)).toInt() != static_cast<int>(fileModify)) {
         LocalFileHandler().deleteFileRecursive(QUrl::fromLocalFile(thumbnail));
         return {};
     }
 
+    // import the thumbnails created before the pack or by other applications
+    if (pack && !image.isNull())
+        pack->insert(key, url, fileModify, image);
+
     image.setText(QT_STRINGIFY(Thumb::Path), thumbnail);
     return image;
 }
 
+/*!
+ * \brief ThumbnailHelper::thumbnailIcon The icon of a thumbnail produced by the thumbnail factory,
+ * it is copied out of the thumbnail pack when the pack has it
+ * \param thumbPath the path of the png thumbnail
+ */
+QIcon ThumbnailHelper::thumbnailIcon(const QString &thumbPath)
+{
+    if (ThumbnailPack::isEnabled()) {
+        const QFileInfo info(thumbPath);
+        for (ThumbnailSize size : { ThumbnailSize::kSmall, ThumbnailSize::kNormal, ThumbnailSize::kLarge }) {
+            if (sizeToFilePath(size) != info.absolutePath())
+                continue;
+
+            const QImage &image = ThumbnailPack::instance(size)->find(info.completeBaseName().toLatin1());
+            if (!image.isNull())
+                return QIcon(QPixmap::fromImage(image));
+            break;
+        }
+    }
+
+    return QIcon(thumbPath);
+}
+
 void ThumbnailHelper::setSizeLimit(const QMimeType &mime, qint64 size)
 {
     if (mime.isValid() && !sizeLimitHash.contains(mime))
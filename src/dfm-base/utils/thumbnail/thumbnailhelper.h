@@ -12,6 +12,7 @@
 
 #include <QUrl>
 #include <QMimeType>
+#include <QIcon>
 
 namespace dfmbase {
 
@@ -29,6 +30,7 @@ public:
 
     QString saveThumbnail(const QUrl &url, const QImage &img, DFMGLOBAL_NAMESPACE::ThumbnailSize size);
     static QImage thumbnailImage(const QUrl &fileUrl, DFMGLOBAL_NAMESPACE::ThumbnailSize size);
+    static QIcon thumbnailIcon(const QString &thumbPath);
 
     static const QStringList &defaultThumbnailDirs();
     static QString sizeToFilePath(DFMGLOBAL_NAMESPACE::ThumbnailSize size);
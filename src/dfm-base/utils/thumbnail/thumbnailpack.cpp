@@ -0,0 +1,649 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "thumbnailpack.h"
+
+#include <dfm-base/base/standardpaths.h>
+#include <dfm-base/base/configs/dconfig/dconfigmanager.h>
+
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDirIterator>
+#include <QImageReader>
+#include <QUrl>
+#include <QDir>
+#include <QDebug>
+
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+using namespace dfmbase;
+DFMGLOBAL_USE_NAMESPACE
+
+static constexpr char kThumbnailPackEnable[] { "dfm.thumbnail.pack.enable" };
+static constexpr char kThumbnailPackSize[] { "dfm.thumbnail.pack.size" };
+static constexpr char kPackMagic[8] { 'D', 'F', 'M', 'T', 'P', 'A', 'C', 'K' };
+static constexpr quint32 kPackVersion { 1 };
+static constexpr quint32 kRecordMagic { 0x44524354 };   // marks the start of a record
+static constexpr quint32 kMaxDimension { 4096 };
+static constexpr quint32 kMaxUrlSize { 64 * 1024 };
+static constexpr qint64 kDefaultSizeBudget { 256 * 1024 * 1024 };
+// replaced records are dropped once they are half of the pack
+static constexpr qint64 kMinDeadSize { 16 * 1024 * 1024 };
+
+namespace {
+struct PackHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 reserved;
+};
+
+// followed by the utf-8 url and the scanlines, both aligned to 8 bytes
+struct RecordHeader
+{
+    quint32 magic;
+    quint32 urlSize;
+    uchar key[16];   // md5 of the url
+    qint64 mtime;
+    quint32 width;
+    quint32 height;
+    quint32 bytesPerLine;
+    quint32 format;
+};
+
+constexpr qint64 align8(qint64 size)
+{
+    return (size + 7) & ~qint64(7);
+}
+
+qint64 pixelsOffset(const RecordHeader &record)
+{
+    return align8(qint64(sizeof(RecordHeader)) + record.urlSize);
+}
+
+qint64 recordSize(const RecordHeader &record)
+{
+    if (record.magic != kRecordMagic || record.urlSize > kMaxUrlSize
+        || record.width == 0 || record.height == 0
+        || record.width > kMaxDimension || record.height > kMaxDimension
+        || record.bytesPerLine < record.width * 4)
+        return -1;
+
+    if (record.format != QImage::Format_ARGB32_Premultiplied && record.format != QImage::Format_RGB32)
+        return -1;
+
+    return pixelsOffset(record) + align8(qint64(record.bytesPerLine) * record.height);
+}
+
+class FileLock
+{
+public:
+    explicit FileLock(int fd, bool wait = true)
+        : fd(fd), locked(fd >= 0 && ::flock(fd, wait ? LOCK_EX : LOCK_EX | LOCK_NB) == 0) {}
+    ~FileLock()
+    {
+        if (locked)
+            ::flock(fd, LOCK_UN);
+    }
+    bool isLocked() const { return locked; }
+
+private:
+    int fd { -1 };
+    bool locked { false };
+};
+
+ino_t pathInode(const QString &path)
+{
+    struct stat st;
+    return ::stat(QFile::encodeName(path).constData(), &st) == 0 ? st.st_ino : 0;
+}
+
+bool readEnabled()
+{
+    return DConfigManager::instance()->value(kDefaultCfgPath, kThumbnailPackEnable, false).toBool();
+}
+
+QAtomicInt packEnabled { 0 };
+}   // namespace
+
+ThumbnailPack::ThumbnailPack(const QString &filePath)
+    : filePath(filePath)
+{
+}
+
+ThumbnailPack::~ThumbnailPack()
+{
+}
+
+ThumbnailPack::PackFile::~PackFile()
+{
+    if (data)
+        file.unmap(data);
+}
+
+// asked for every thumbnail, the config is read once and then followed by its change signal
+bool ThumbnailPack::isEnabled()
+{
+    static const bool kConnected = [] {
+        packEnabled.storeRelease(readEnabled());
+        QObject::connect(DConfigManager::instance(), &DConfigManager::valueChanged, DConfigManager::instance(),
+                         [](const QString &config, const QString &key) {
+                             if (config == kDefaultCfgPath && key == kThumbnailPackEnable)
+                                 packEnabled.storeRelease(readEnabled());
+                         },
+                         Qt::DirectConnection);
+        return true;
+    }();
+    Q_UNUSED(kConnected)
+
+    return packEnabled.loadAcquire();
+}
+
+ThumbnailPack *ThumbnailPack::instance(ThumbnailSize size)
+{
+    switch (size) {
+    case ThumbnailSize::kSmall: {
+        static ThumbnailPack pack(defaultPath(size));
+        return &pack;
+    }
+    case ThumbnailSize::kNormal: {
+        static ThumbnailPack pack(defaultPath(size));
+        return &pack;
+    }
+    case ThumbnailSize::kLarge: {
+        static ThumbnailPack pack(defaultPath(size));
+        return &pack;
+    }
+    }
+
+    return nullptr;
+}
+
+QString ThumbnailPack::defaultPath(ThumbnailSize size)
+{
+    QString name;
+    switch (size) {
+    case ThumbnailSize::kSmall:
+        name = "small";
+        break;
+    case ThumbnailSize::kNormal:
+        name = "normal";
+        break;
+    case ThumbnailSize::kLarge:
+        name = "large";
+        break;
+    }
+
+    return StandardPaths::location(StandardPaths::kCachePath) + "thumbnails/" + name + ".pack";
+}
+
+/*!
+ * \brief ThumbnailPack::find Copy the thumbnail out of the pack
+ * \param key the md5 hex of the url
+ * \param mtime the modification time of the file, a negative value accepts any record
+ */
+QImage ThumbnailPack::find(const QByteArray &key, qint64 mtime)
+{
+    // the lookups do not wait for the writers, the pack is missed until it is opened
+    if (!isOpened() && !tryOpen())
+        return {};
+
+    QReadLocker lk(&stateLock);
+    if (!packFile)
+        return {};
+
+    auto it = packFile->index.constFind(key);
+    if (it == packFile->index.constEnd() || (mtime >= 0 && it->mtime != mtime))
+        return {};
+
+    // the mapping follows the index, unless the remapping failed
+    if (!packFile->data || it->offset + it->size > packFile->dataSize)
+        return {};
+
+    const uchar *data = packFile->data;
+    RecordHeader record;
+    memcpy(&record, data + it->offset, sizeof(record));
+    // the pack is remapped when it grows, so the image cannot refer to the mapping
+    const QImage image(data + it->offset + pixelsOffset(record), int(record.width), int(record.height),
+                       int(record.bytesPerLine), static_cast<QImage::Format>(record.format));
+    QImage thumbnail = image.copy();
+    thumbnail.setText(QT_STRINGIFY(Thumb::URL),
+                      QString::fromUtf8(reinterpret_cast<const char *>(data + it->offset + sizeof(record)), int(record.urlSize)));
+    thumbnail.setText(QT_STRINGIFY(Thumb::MTime), QString::number(record.mtime));
+    return thumbnail;
+}
+
+bool ThumbnailPack::insert(const QByteArray &key, const QString &url, qint64 mtime, const QImage &image)
+{
+    const QByteArray &rawKey = QByteArray::fromHex(key);
+    if (image.isNull() || rawKey.size() != 16
+        || quint32(image.width()) > kMaxDimension || quint32(image.height()) > kMaxDimension)
+        return false;
+
+    const QImage &img = image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                                      : QImage::Format_RGB32);
+    const QByteArray &urlData = url.toUtf8();
+    if (urlData.size() > int(kMaxUrlSize))
+        return false;
+
+    RecordHeader record;
+    record.magic = kRecordMagic;
+    record.urlSize = quint32(urlData.size());
+    memcpy(record.key, rawKey.constData(), sizeof(record.key));
+    record.mtime = mtime;
+    record.width = quint32(img.width());
+    record.height = quint32(img.height());
+    record.bytesPerLine = quint32(img.bytesPerLine());
+    record.format = quint32(img.format());
+
+    const qint64 size = recordSize(record);
+    QByteArray buffer(int(size), '\0');
+    memcpy(buffer.data(), &record, sizeof(record));
+    memcpy(buffer.data() + sizeof(record), urlData.constData(), size_t(urlData.size()));
+    memcpy(buffer.data() + pixelsOffset(record), img.constBits(), size_t(img.sizeInBytes()));
+
+    QMutexLocker lk(&writeMutex);
+    if (!ensureOpened() || !reopenIfReplaced())
+        return false;
+
+    QSharedPointer<PackFile> compacted;
+    {
+        FileLock lock(packFile->file.handle());
+        // compacted by another process after the check above, the record is dropped
+        if (!lock.isLocked() || pathInode(filePath) != packFile->inode)
+            return false;
+
+        // records appended by another process
+        struct stat st;
+        if (::fstat(packFile->file.handle(), &st) != 0 || !update(st.st_size))
+            return false;
+
+        const qint64 offset = packFile->totalSize;
+        if (!packFile->file.seek(offset) || packFile->file.write(buffer) != buffer.size()) {
+            qWarning() << "thumbnail: append to the pack failed" << filePath << packFile->file.errorString();
+            packFile->file.resize(offset);
+            return false;
+        }
+
+        {
+            QWriteLocker wlk(&stateLock);
+            addRecords(packFile.data(), { qMakePair(key, Entry { offset, size, mtime }) }, offset + size);
+            mapTo(packFile.data(), packFile->totalSize);
+        }
+
+        const qint64 budget = sizeBudget();
+        const qint64 totalSize = packFile->totalSize;
+        if (totalSize > budget || (packFile->dead > kMinDeadSize && packFile->dead * 2 > totalSize))
+            compacted = compactLocked(totalSize > budget ? budget / 4 * 3 : budget, false);
+    }
+
+    if (compacted)
+        replacePackFile(compacted);
+    return true;
+}
+
+/*!
+ * \brief ThumbnailPack::importDirectory Import the png thumbnails of a freedesktop thumbnail directory
+ * \return the count of the imported thumbnails
+ */
+int ThumbnailPack::importDirectory(const QString &dirPath)
+{
+    int imported = 0;
+    QDirIterator it(dirPath, { "*.png" }, QDir::Files);
+    while (it.hasNext()) {
+        const QString &path = it.next();
+        const QByteArray &key = it.fileInfo().completeBaseName().toLatin1();
+
+        // the text chunks are read without decoding the image
+        QImageReader reader(path, "png");
+        QString url = reader.text(QT_STRINGIFY(Thumb::URL));
+        if (url.isEmpty())
+            url = reader.text(QT_STRINGIFY(Thumb::URI));
+        bool ok = false;
+        const qint64 mtime = reader.text(QT_STRINGIFY(Thumb::MTime)).toLongLong(&ok);
+        if (url.isEmpty() || !ok || key.size() != 32)
+            continue;
+
+        {
+            QMutexLocker lk(&writeMutex);
+            if (!ensureOpened())
+                return imported;
+            auto record = packFile->index.constFind(key);
+            if (record != packFile->index.constEnd() && record->mtime == mtime)
+                continue;
+        }
+
+        const QImage &image = reader.read();
+        if (!image.isNull() && insert(key, url, mtime, image))
+            ++imported;
+    }
+
+    return imported;
+}
+
+/*!
+ * \brief ThumbnailPack::compact Rewrite the pack without the replaced records and the
+ * records of the files which are modified or removed
+ * \param sizeLimit the oldest records over the limit are dropped, the size budget when negative
+ */
+bool ThumbnailPack::compact(qint64 sizeLimit)
+{
+    QMutexLocker lk(&writeMutex);
+    if (!ensureOpened() || !reopenIfReplaced())
+        return false;
+
+    QSharedPointer<PackFile> compacted;
+    {
+        FileLock lock(packFile->file.handle());
+        struct stat st;
+        if (!lock.isLocked() || ::fstat(packFile->file.handle(), &st) != 0 || !update(st.st_size))
+            return false;
+
+        compacted = compactLocked(sizeLimit < 0 ? sizeBudget() : sizeLimit, true);
+    }
+
+    if (!compacted)
+        return false;
+
+    replacePackFile(compacted);
+    return true;
+}
+
+int ThumbnailPack::count()
+{
+    QMutexLocker lk(&writeMutex);
+    return ensureOpened() ? packFile->index.count() : 0;
+}
+
+qint64 ThumbnailPack::fileSize()
+{
+    QMutexLocker lk(&writeMutex);
+    return ensureOpened() ? packFile->totalSize : 0;
+}
+
+qint64 ThumbnailPack::deadSize()
+{
+    QMutexLocker lk(&writeMutex);
+    return ensureOpened() ? packFile->dead : 0;
+}
+
+bool ThumbnailPack::isOpened()
+{
+    QReadLocker lk(&stateLock);
+    return !packFile.isNull();
+}
+
+// opens the pack for a lookup unless a writer or another process holds it
+bool ThumbnailPack::tryOpen()
+{
+    if (!writeMutex.tryLock())
+        return false;
+
+    const bool ret = ensureOpened(false);
+    writeMutex.unlock();
+    return ret;
+}
+
+// the write mutex is held
+bool ThumbnailPack::ensureOpened(bool wait)
+{
+    if (packFile)
+        return true;
+
+    const auto &opened = openPackFile(wait);
+    if (!opened)
+        return false;
+
+    replacePackFile(opened);
+    return true;
+}
+
+// the write mutex is held
+bool ThumbnailPack::reopenIfReplaced()
+{
+    if (pathInode(filePath) == packFile->inode) {
+        struct stat st;
+        if (::fstat(packFile->file.handle(), &st) == 0 && st.st_size >= packFile->totalSize)
+            return true;
+
+        // truncated in place, the mapping of the records is dropped before the file is scanned again
+        replacePackFile(nullptr);
+    }
+
+    const auto &opened = openPackFile(true);
+    replacePackFile(opened);
+    return !opened.isNull();
+}
+
+QSharedPointer<ThumbnailPack::PackFile> ThumbnailPack::openPackFile(bool wait) const
+{
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSharedPointer<PackFile> opened(new PackFile);
+    opened->file.setFileName(filePath);
+    if (!opened->file.open(QIODevice::ReadWrite | QIODevice::Unbuffered)) {
+        qWarning() << "thumbnail: open the pack failed" << filePath << opened->file.errorString();
+        return nullptr;
+    }
+
+    struct stat st;
+    Records records;
+    qint64 end = 0;
+    {
+        FileLock lock(opened->file.handle(), wait);
+        if (!lock.isLocked() || ::fstat(opened->file.handle(), &st) != 0
+            || !scan(opened->file, 0, st.st_size, &records, &end))
+            return nullptr;
+    }
+
+    opened->inode = st.st_ino;
+    addRecords(opened.data(), records, end);
+    if (!mapTo(opened.data(), end))
+        return nullptr;
+
+    return opened;
+}
+
+// the write mutex and the file lock are held, picks up the records appended by other processes
+bool ThumbnailPack::update(qint64 fileSize)
+{
+    if (fileSize == packFile->totalSize)
+        return true;
+
+    // truncated in place, reopened by the next writer
+    if (fileSize < packFile->totalSize)
+        return false;
+
+    Records records;
+    qint64 end = 0;
+    if (!scan(packFile->file, packFile->totalSize, fileSize, &records, &end))
+        return false;
+
+    QWriteLocker lk(&stateLock);
+    addRecords(packFile.data(), records, end);
+    return mapTo(packFile.data(), end);
+}
+
+// the write mutex is held, the old pack file is released after the lookups are done with it
+void ThumbnailPack::replacePackFile(const QSharedPointer<PackFile> &opened)
+{
+    QSharedPointer<PackFile> old;
+    {
+        QWriteLocker lk(&stateLock);
+        old = packFile;
+        packFile = opened;
+    }
+}
+
+// the file lock is held, the headers are read from the file instead of the mapping of the lookups
+bool ThumbnailPack::scan(QFile &file, qint64 from, qint64 to, Records *records, qint64 *end)
+{
+    if (from == 0) {
+        PackHeader header;
+        const bool valid = to >= qint64(sizeof(header)) && file.seek(0)
+                && file.read(reinterpret_cast<char *>(&header), sizeof(header)) == qint64(sizeof(header))
+                && memcmp(header.magic, kPackMagic, sizeof(kPackMagic)) == 0
+                && header.version == kPackVersion;
+        if (!valid) {
+            // a new pack, or a pack of another version
+            memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+            header.version = kPackVersion;
+            header.reserved = 0;
+            if (!file.resize(0) || !file.seek(0)
+                || file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != qint64(sizeof(header)))
+                return false;
+            to = sizeof(header);
+        }
+        from = sizeof(header);
+    }
+
+    qint64 offset = from;
+    while (offset + qint64(sizeof(RecordHeader)) <= to) {
+        RecordHeader record;
+        if (::pread(file.handle(), &record, sizeof(record), offset) != ssize_t(sizeof(record)))
+            break;
+        const qint64 size = recordSize(record);
+        if (size <= 0 || offset + size > to)
+            break;
+
+        const QByteArray &key = QByteArray(reinterpret_cast<const char *>(record.key), sizeof(record.key)).toHex();
+        records->append(qMakePair(key, Entry { offset, size, record.mtime }));
+        offset += size;
+    }
+
+    if (offset < to) {
+        // the tail of an interrupted append, after the records of the index
+        qWarning() << "thumbnail: drop the broken tail of the pack" << file.fileName() << offset;
+        if (!file.resize(offset))
+            return false;
+    }
+
+    *end = offset;
+    return true;
+}
+
+void ThumbnailPack::addRecords(PackFile *packFile, const Records &records, qint64 end)
+{
+    for (const auto &record : records) {
+        auto it = packFile->index.find(record.first);
+        if (it != packFile->index.end())
+            packFile->dead += it->size;
+        packFile->index.insert(record.first, record.second);
+    }
+    packFile->totalSize = end;
+}
+
+// the mapping only grows
+bool ThumbnailPack::mapTo(PackFile *packFile, qint64 size)
+{
+    if (packFile->data && packFile->dataSize >= size)
+        return true;
+
+    if (packFile->data)
+        packFile->file.unmap(packFile->data);
+    packFile->data = nullptr;
+    packFile->dataSize = 0;
+
+    packFile->data = packFile->file.map(0, size);
+    if (!packFile->data) {
+        qWarning() << "thumbnail: map the pack failed" << packFile->file.fileName() << packFile->file.errorString();
+        return false;
+    }
+
+    packFile->dataSize = size;
+    return true;
+}
+
+/*!
+ * \brief ThumbnailPack::compactLocked Write the kept records into a new pack file
+ * and open it, the lookups go on in the old pack meanwhile
+ * \return the new pack file, swapped in by the caller after the file lock is released
+ */
+QSharedPointer<ThumbnailPack::PackFile> ThumbnailPack::compactLocked(qint64 sizeLimit, bool dropStale) const
+{
+    const uchar *data = packFile->data;
+    if (!data || packFile->dataSize < packFile->totalSize)
+        return nullptr;
+
+    Records entries;
+    for (auto it = packFile->index.cbegin(); it != packFile->index.cend(); ++it)
+        entries.append(qMakePair(it.key(), it.value()));
+    // the newest records are kept first
+    std::sort(entries.begin(), entries.end(), [](const QPair<QByteArray, Entry> &a, const QPair<QByteArray, Entry> &b) {
+        return a.second.offset > b.second.offset;
+    });
+
+    Records kept;
+    qint64 keptSize = sizeof(PackHeader);
+    for (const auto &entry : entries) {
+        if (sizeLimit > 0 && keptSize + entry.second.size > sizeLimit)
+            continue;
+
+        if (dropStale) {
+            RecordHeader record;
+            memcpy(&record, data + entry.second.offset, sizeof(record));
+            const QString &url = QString::fromUtf8(reinterpret_cast<const char *>(data + entry.second.offset + sizeof(record)), int(record.urlSize));
+            struct stat st;
+            if (::stat(QFile::encodeName(QUrl(url).toLocalFile()).constData(), &st) != 0 || st.st_mtime != entry.second.mtime)
+                continue;
+        }
+
+        kept.append(entry);
+        keptSize += entry.second.size;
+    }
+    std::sort(kept.begin(), kept.end(), [](const QPair<QByteArray, Entry> &a, const QPair<QByteArray, Entry> &b) {
+        return a.second.offset < b.second.offset;
+    });
+
+    QSaveFile out(filePath);
+    if (!out.open(QIODevice::WriteOnly))
+        return nullptr;
+
+    PackHeader header;
+    memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+    header.version = kPackVersion;
+    header.reserved = 0;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    // the records move to their offsets in the new file
+    qint64 offset = sizeof(PackHeader);
+    for (auto &entry : kept) {
+        out.write(reinterpret_cast<const char *>(data + entry.second.offset), entry.second.size);
+        entry.second.offset = offset;
+        offset += entry.second.size;
+    }
+
+    if (!out.commit()) {
+        qWarning() << "thumbnail: compact the pack failed" << filePath << out.errorString();
+        return nullptr;
+    }
+
+    qInfo() << "thumbnail: compacted the pack" << filePath << "from" << packFile->totalSize << "to" << keptSize
+            << "bytes," << kept.count() << "records";
+
+    QSharedPointer<PackFile> compacted(new PackFile);
+    compacted->file.setFileName(filePath);
+    struct stat st;
+    if (!compacted->file.open(QIODevice::ReadWrite | QIODevice::Unbuffered)
+        || ::fstat(compacted->file.handle(), &st) != 0)
+        return nullptr;
+
+    // records appended by another process after the rename are picked up by the next writer
+    compacted->inode = st.st_ino;
+    addRecords(compacted.data(), kept, keptSize);
+    if (!mapTo(compacted.data(), keptSize))
+        return nullptr;
+
+    return compacted;
+}
+
+qint64 ThumbnailPack::sizeBudget() const
+{
+    // in MB
+    bool ok = false;
+    const qint64 size = DConfigManager::instance()->value(kDefaultCfgPath, kThumbnailPackSize).toLongLong(&ok);
+    return ok && size > 0 ? size * 1024 * 1024 : kDefaultSizeBudget;
+}
@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef THUMBNAILPACK_H
+#define THUMBNAILPACK_H
+
+#include <dfm-base/dfm_base_global.h>
+#include <dfm-base/dfm_global_defines.h>
+
+#include <QImage>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+
+#include <sys/types.h>
+
+namespace dfmbase {
+
+// Packed store of the thumbnails in front of the freedesktop thumbnail
+// directories, one append-only pack per thumbnail size.
+// A record holds the url, the modification time of the file and the scaled
+// image as raw ARGB32 premultiplied (RGB32 when opaque) scanlines, which
+// QPixmap uploads without a conversion. The pack is memory-mapped and indexed
+// by the md5 of the url, that is the name of the freedesktop thumbnail, so a
+// lookup costs a hash lookup and a copy instead of a stat and a png decode.
+// Replaced records stay in the pack until it is compacted. The appends are
+// serialized by a file lock, a compaction replaces the pack file.
+// The lookups run on the GUI thread, they never wait for the file lock or a
+// compaction: the writers hold the lock of the opened pack only to add a record
+// to the index or to swap in the compacted pack.
+class ThumbnailPack
+{
+public:
+    explicit ThumbnailPack(const QString &filePath);
+    ~ThumbnailPack();
+
+    static bool isEnabled();
+    static ThumbnailPack *instance(DFMGLOBAL_NAMESPACE::ThumbnailSize size);
+    static QString defaultPath(DFMGLOBAL_NAMESPACE::ThumbnailSize size);
+
+    QImage find(const QByteArray &key, qint64 mtime = -1);
+    bool insert(const QByteArray &key, const QString &url, qint64 mtime, const QImage &image);
+    int importDirectory(const QString &dirPath);
+    bool compact(qint64 sizeLimit = -1);
+
+    int count();
+    qint64 fileSize();
+    qint64 deadSize();
+
+private:
+    struct Entry
+    {
+        qint64 offset { 0 };
+        qint64 size { 0 };
+        qint64 mtime { 0 };
+    };
+    using Records = QList<QPair<QByteArray, Entry>>;
+
+    // an opened pack file, replaced as a whole when the file is replaced
+    struct PackFile
+    {
+        ~PackFile();
+
+        QFile file;
+        ino_t inode { 0 };
+        uchar *data { nullptr };
+        qint64 dataSize { 0 };
+        qint64 totalSize { 0 };
+        qint64 dead { 0 };
+        QHash<QByteArray, Entry> index;
+    };
+
+    bool isOpened();
+    bool tryOpen();
+    bool ensureOpened(bool wait = true);
+    bool reopenIfReplaced();
+    QSharedPointer<PackFile> openPackFile(bool wait) const;
+    bool update(qint64 fileSize);
+    QSharedPointer<PackFile> compactLocked(qint64 sizeLimit, bool dropStale) const;
+    void replacePackFile(const QSharedPointer<PackFile> &opened);
+    qint64 sizeBudget() const;
+
+    static bool scan(QFile &file, qint64 from, qint64 to, Records *records, qint64 *end);
+    static void addRecords(PackFile *packFile, const Records &records, qint64 end);
+    static bool mapTo(PackFile *packFile, qint64 size);
+
+private:
+    QString filePath;
+    // serializes the writers of this process, held across the file lock
+    QMutex writeMutex;
+    // packFile is changed with both locks held, and read with either of them
+    QReadWriteLock stateLock;
+    QSharedPointer<PackFile> packFile;
+};
+
+}   // namespace dfmbase
+
+#endif   // THUMBNAILPACK_H
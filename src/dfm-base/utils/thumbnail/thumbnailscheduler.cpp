@@ -0,0 +1,213 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "thumbnailscheduler.h"
+
+#include <dfm-base/base/device/deviceutils.h>
+
+#include <QFile>
+#include <QDebug>
+
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+
+using namespace dfmbase;
+DFMGLOBAL_USE_NAMESPACE
+
+static constexpr int kMetricsInterval { 200 };   // log the metrics every n finished tasks
+
+ThumbnailScheduler::ThumbnailScheduler(int slowDeviceLimit)
+    : slowDeviceLimit(qMax(1, slowDeviceLimit))
+{
+    clock.start();
+}
+
+/*!
+ * \brief ThumbnailScheduler::push Queue a thumbnail task, or raise it when it is queued already,
+ * the device of the file is checked when the task is taken
+ * \return false when the task is queued or running already
+ */
+bool ThumbnailScheduler::push(const QUrl &url, ThumbnailSize size)
+{
+    return pushTask(url, size, false, false);
+}
+
+bool ThumbnailScheduler::push(const QUrl &url, ThumbnailSize size, bool slowDevice)
+{
+    return pushTask(url, size, true, slowDevice);
+}
+
+bool ThumbnailScheduler::pushTask(const QUrl &url, ThumbnailSize size, bool classified, bool slowDevice)
+{
+    QMutexLocker lk(&mutex);
+    const TaskKey key { url, size };
+    if (running.contains(key)) {
+        ++total.deduplicated;
+        return false;
+    }
+
+    const quint64 sequence = ++nextSequence;
+    auto it = queued.find(key);
+    if (it != queued.end()) {
+        ++total.deduplicated;
+        TaskOrder &order = orderOf(*it);
+        order.erase(it->sequence);
+        it->sequence = sequence;
+        order.emplace(sequence, key);
+        return false;
+    }
+
+    Task task;
+    task.url = url;
+    task.size = size;
+    task.slowDevice = slowDevice;
+    task.classified = classified;
+    task.sequence = sequence;
+    task.queuedTime = clock.elapsed();
+    queued.insert(key, task);
+    orderOf(task).emplace(sequence, key);
+    total.maxQueueDepth = qMax(total.maxQueueDepth, queued.count());
+    return true;
+}
+
+/*!
+ * \brief ThumbnailScheduler::take Take the latest requested task, the tasks of slow
+ * devices are skipped while slowDeviceLimit of them are running.
+ * An unclassified task is classified out of the lock, and queued again when it
+ * turns out to be a slow one that cannot run now.
+ */
+bool ThumbnailScheduler::take(Task *task)
+{
+    Q_ASSERT(task);
+
+    QMutexLocker lk(&mutex);
+    forever {
+        TaskOrder *order = nullptr;
+        auto later = [&order](TaskOrder *other) {
+            if (!other->empty() && (!order || other->rbegin()->first > order->rbegin()->first))
+                order = other;
+        };
+        later(&fastOrder);
+        if (slowRunning < slowDeviceLimit)
+            later(&slowOrder);
+        later(&unclassifiedOrder);
+        if (!order)
+            return false;
+
+        auto last = std::prev(order->end());
+        const TaskKey key = last->second;
+        order->erase(last);
+
+        *task = queued.take(key);
+        // a request of the task is deduplicated while it is classified
+        running.insert(key);
+        if (!task->classified) {
+            lk.unlock();
+            const bool slowDevice = isSlowDevice(task->url);
+            lk.relock();
+
+            task->classified = true;
+            task->slowDevice = slowDevice;
+            if (slowDevice && slowRunning >= slowDeviceLimit) {
+                running.remove(key);
+                queued.insert(key, *task);
+                slowOrder.emplace(task->sequence, key);
+                continue;
+            }
+        }
+
+        task->startedTime = clock.elapsed();
+        if (task->slowDevice)
+            ++slowRunning;
+        return true;
+    }
+}
+
+void ThumbnailScheduler::finish(const Task &task)
+{
+    QMutexLocker lk(&mutex);
+    const TaskKey key { task.url, task.size };
+    if (!running.remove(key))
+        return;
+
+    if (task.slowDevice)
+        --slowRunning;
+
+    const qint64 now = clock.elapsed();
+    totalWait += task.startedTime - task.queuedTime;
+    totalRun += now - task.startedTime;
+    ++total.finished;
+
+    if (total.finished % kMetricsInterval == 0) {
+        qInfo() << "thumbnail: finished" << total.finished << "queue depth" << queued.count()
+                << "max queue depth" << total.maxQueueDepth << "deduplicated" << total.deduplicated
+                << "average wait" << totalWait / total.finished << "ms, average create" << totalRun / total.finished << "ms";
+    }
+}
+
+void ThumbnailScheduler::clear()
+{
+    QMutexLocker lk(&mutex);
+    queued.clear();
+    fastOrder.clear();
+    slowOrder.clear();
+    unclassifiedOrder.clear();
+}
+
+ThumbnailScheduler::TaskOrder &ThumbnailScheduler::orderOf(const Task &task)
+{
+    if (!task.classified)
+        return unclassifiedOrder;
+    return task.slowDevice ? slowOrder : fastOrder;
+}
+
+ThumbnailScheduler::Metrics ThumbnailScheduler::metrics() const
+{
+    QMutexLocker lk(&mutex);
+    Metrics result = total;
+    result.queueDepth = queued.count();
+    result.running = running.count();
+    if (total.finished > 0) {
+        result.averageWait = totalWait / total.finished;
+        result.averageRun = totalRun / total.finished;
+    }
+    return result;
+}
+
+/*!
+ * \brief ThumbnailScheduler::isSlowDevice Whether the file is on a network mount or on a rotational disk
+ */
+bool ThumbnailScheduler::isSlowDevice(const QUrl &url)
+{
+    // virtual urls are mapped to the local file by the worker
+    if (!url.isLocalFile())
+        return false;
+
+    if (DeviceUtils::isLowSpeedDevice(url))
+        return true;
+
+    struct stat st;
+    if (::stat(QFile::encodeName(url.toLocalFile()).constData(), &st) != 0)
+        return false;
+
+    static QMutex cacheMutex;
+    static QHash<quint64, bool> rotationalCache;
+    QMutexLocker lk(&cacheMutex);
+    auto it = rotationalCache.constFind(quint64(st.st_dev));
+    if (it != rotationalCache.cend())
+        return it.value();
+
+    // the queue of a partition is the one of its disk
+    const QString &devPath = QString("/sys/dev/block/%1:%2/").arg(major(st.st_dev)).arg(minor(st.st_dev));
+    QFile file(devPath + "queue/rotational");
+    if (!file.exists())
+        file.setFileName(devPath + "../queue/rotational");
+
+    bool rotational = false;
+    if (file.open(QIODevice::ReadOnly))
+        rotational = file.readAll().trimmed() == "1";
+
+    rotationalCache.insert(quint64(st.st_dev), rotational);
+    return rotational;
+}
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef THUMBNAILSCHEDULER_H
+#define THUMBNAILSCHEDULER_H
+
+#include <dfm-base/dfm_base_global.h>
+#include <dfm-base/dfm_global_defines.h>
+
+#include <QUrl>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QElapsedTimer>
+
+#include <map>
+
+namespace dfmbase {
+
+// The thumbnail tasks shared by the thumbnail workers.
+// A file is requested when its item is painted, so the latest request is
+// taken first and the items scrolled out of view sink down the queue.
+// A task is queued once per url and size, a request of a queued task raises it.
+// The tasks of slow devices (network mounts, rotational disks) run on a
+// limited number of workers so that they do not thrash the device. A task
+// pushed without its device speed is classified by the worker taking it,
+// so that the thread requesting the thumbnail never touches the file.
+class ThumbnailScheduler
+{
+public:
+    struct Task
+    {
+        QUrl url;
+        DFMGLOBAL_NAMESPACE::ThumbnailSize size { DFMGLOBAL_NAMESPACE::kNormal };
+        bool slowDevice { false };
+        bool classified { false };
+        quint64 sequence { 0 };
+        qint64 queuedTime { 0 };
+        qint64 startedTime { 0 };
+    };
+
+    struct Metrics
+    {
+        int queueDepth { 0 };
+        int maxQueueDepth { 0 };
+        int running { 0 };
+        qint64 finished { 0 };
+        qint64 deduplicated { 0 };
+        qint64 averageWait { 0 };   // ms in the queue
+        qint64 averageRun { 0 };   // ms to create
+    };
+
+    explicit ThumbnailScheduler(int slowDeviceLimit = 1);
+
+    bool push(const QUrl &url, DFMGLOBAL_NAMESPACE::ThumbnailSize size);
+    bool push(const QUrl &url, DFMGLOBAL_NAMESPACE::ThumbnailSize size, bool slowDevice);
+    bool take(Task *task);
+    void finish(const Task &task);
+    void clear();
+    Metrics metrics() const;
+
+    static bool isSlowDevice(const QUrl &url);
+
+private:
+    using TaskKey = QPair<QUrl, int>;
+    using TaskOrder = std::map<quint64, TaskKey>;
+
+    bool pushTask(const QUrl &url, DFMGLOBAL_NAMESPACE::ThumbnailSize size, bool classified, bool slowDevice);
+    TaskOrder &orderOf(const Task &task);
+
+    mutable QMutex mutex;
+    QHash<TaskKey, Task> queued;
+    TaskOrder fastOrder;
+    TaskOrder slowOrder;
+    TaskOrder unclassifiedOrder;
+    QSet<TaskKey> running;
+    int slowRunning { 0 };
+    int slowDeviceLimit { 1 };
+    quint64 nextSequence { 0 };
+    QElapsedTimer clock;
+
+    Metrics total;
+    qint64 totalWait { 0 };
+    qint64 totalRun { 0 };
+};
+
+}   // namespace dfmbase
+
+#endif   // THUMBNAILSCHEDULER_H
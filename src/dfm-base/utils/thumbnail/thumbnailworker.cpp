@@ -11,13 +11,17 @@
 #include <dfm-base/base/urlroute.h>
 
 #include <QtConcurrent>
+#include <QTimer>
 #include <QPainter>
 #include <QDebug>
 
 using namespace dfmbase;
 
-ThumbnailWorkerPrivate::ThumbnailWorkerPrivate(ThumbnailWorker *qq)
-    : q(qq)
+static constexpr int kUnstableRetryInterval { 1000 };   // ms
+
+ThumbnailWorkerPrivate::ThumbnailWorkerPrivate(ThumbnailWorker *qq, QSharedPointer<ThumbnailScheduler> scheduler)
+    : q(qq),
+      scheduler(scheduler)
 {
     thumbHelper.initSizeLimit();
 }
@@ -84,11 +88,11 @@ bool ThumbnailWorkerPrivate::checkFileStable(const QUrl &url)
     return true;
 }
 
-ThumbnailWorker::ThumbnailWorker(QObject *parent)
+ThumbnailWorker::ThumbnailWorker(QSharedPointer<ThumbnailScheduler> scheduler, QObject *parent)
     : QObject(parent),
-      d(new ThumbnailWorkerPrivate(this))
+      d(new ThumbnailWorkerPrivate(this, scheduler))
 {
-    qRegisterMetaType<ThumbnailTaskMap>("ThumbnailTaskMap");
+    Q_ASSERT(scheduler);
 }
 
 ThumbnailWorker::~ThumbnailWorker()
@@ -113,46 +117,56 @@ void ThumbnailWorker::stop()
     d->isStoped = true;
 }
 
-void ThumbnailWorker::onTaskAdded(const ThumbnailTaskMap &taskMap)
+/*!
+ * \brief ThumbnailWorker::onTaskAvailable Create the thumbnails taken from the
+ * scheduler one by one, until there is no task for this worker
+ */
+void ThumbnailWorker::onTaskAvailable()
 {
-    if (d->isStoped)
-        return;
-
-    QMapIterator<QUrl, Global::ThumbnailSize> iter(taskMap);
-    while (iter.hasNext()) {
-        iter.next();
-        QUrl fileUrl = d->originalUrl = iter.key();
-        if (UrlRoute::isVirtual(fileUrl)) {
-            auto info { InfoFactory::create<FileInfo>(fileUrl) };
-            if (!info || !info->exists())
-                continue;
-
-            fileUrl = QUrl::fromLocalFile(info->pathOf(PathInfoType::kAbsoluteFilePath));
-            if (!fileUrl.isLocalFile())
-                continue;
-        }
+    ThumbnailScheduler::Task task;
+    while (!d->isStoped && d->scheduler->take(&task)) {
+        doTask(task.url, task.size);
+        d->scheduler->finish(task);
+    }
+}
 
-        if (!d->thumbHelper.checkThumbEnable(fileUrl))
-            continue;
+void ThumbnailWorker::doTask(const QUrl &url, Global::ThumbnailSize size)
+{
+    QUrl fileUrl = d->originalUrl = url;
+    if (UrlRoute::isVirtual(fileUrl)) {
+        auto info { InfoFactory::create<FileInfo>(fileUrl) };
+        if (!info || !info->exists())
+            return;
+
+        fileUrl = QUrl::fromLocalFile(info->pathOf(PathInfoType::kAbsoluteFilePath));
+        if (!fileUrl.isLocalFile())
+            return;
+    }
 
-        const auto &img = d->thumbHelper.thumbnailImage(fileUrl, iter.value());
-        if (!img.isNull()) {
-            Q_EMIT thumbnailCreateFinished(iter.key(), img.text(QT_STRINGIFY(Thumb::Path)));
-            continue;
-        }
+    if (!d->thumbHelper.checkThumbEnable(fileUrl))
+        return;
 
-        createThumbnail(fileUrl, iter.value());
+    const auto &img = d->thumbHelper.thumbnailImage(fileUrl, size);
+    if (!img.isNull()) {
+        Q_EMIT thumbnailCreateFinished(url, img.text(QT_STRINGIFY(Thumb::Path)));
+        return;
     }
+
+    createThumbnail(fileUrl, size);
 }
 
 void ThumbnailWorker::createThumbnail(const QUrl &url, Global::ThumbnailSize size)
 {
     // check whether the file is stable
-    // if not, rejoin the event queue and create thumbnail later
+    // if not, queue it again and create thumbnail later
     if (!d->checkFileStable(url)) {
-        ThumbnailTaskMap taskMap { { url, size } };
-        QMetaObject::invokeMethod(this, "onTaskAdded", Qt::QueuedConnection,
-                                  Q_ARG(ThumbnailTaskMap, taskMap));
+        const QUrl originalUrl = d->originalUrl;
+        QTimer::singleShot(kUnstableRetryInterval, this, [this, originalUrl, size, url]() {
+            if (d->isStoped)
+                return;
+            d->scheduler->push(originalUrl, size, ThumbnailScheduler::isSlowDevice(url));
+            onTaskAvailable();
+        });
         return;
     }
 
@@ -9,19 +9,19 @@
 #include <dfm-base/dfm_global_defines.h>
 
 #include <QUrl>
+#include <QSharedPointer>
 
 #include <functional>
 
 namespace dfmbase {
 
+class ThumbnailScheduler;
 class ThumbnailWorkerPrivate;
 class ThumbnailWorker : public QObject
 {
     Q_OBJECT
 public:
-    using ThumbnailTaskMap = QMap<QUrl, DFMGLOBAL_NAMESPACE::ThumbnailSize>;
-
-    explicit ThumbnailWorker(QObject *parent = nullptr);
+    explicit ThumbnailWorker(QSharedPointer<ThumbnailScheduler> scheduler, QObject *parent = nullptr);
     ~ThumbnailWorker();
 
     using ThumbnailCreator = std::function<QImage(const QString &, DFMGLOBAL_NAMESPACE::ThumbnailSize)>;
@@ -29,13 +29,14 @@ public:
     void stop();
 
 public Q_SLOTS:
-    void onTaskAdded(const ThumbnailTaskMap &taskMap);
+    void onTaskAvailable();
 
 Q_SIGNALS:
     void thumbnailCreateFinished(const QUrl &url, const QString &thumbnail);
     void thumbnailCreateFailed(const QUrl &url);
 
 private:
+    void doTask(const QUrl &url, Global::ThumbnailSize size);
     void createThumbnail(const QUrl &url, Global::ThumbnailSize size);
 
 private:
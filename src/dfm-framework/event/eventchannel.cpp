@@ -60,10 +60,11 @@ QVariant EventChannel::send()
 
 QVariant EventChannel::send(const QVariantList &params)
 {
+    const Receiver &conn = std::atomic_load(&receiver);
     if (!conn)
         return QVariant();
 
-    return conn(params);
+    return conn->handler(params);
 }
 
 EventChannelFuture EventChannel::asyncSend()
@@ -87,8 +88,5 @@ bool EventChannelManager::disconnect(const QString &space, const QString &topic)
 bool EventChannelManager::disconnect(const EventType &type)
 {
     QWriteLocker guard(&rwLock);
-    if (channelMap.contains(type))
-        return channelMap.remove(type) > 0;
-
-    return false;
+    return channelMap.remove(type);
 }
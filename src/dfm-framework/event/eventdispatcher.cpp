@@ -17,13 +17,15 @@ bool EventDispatcher::dispatch()
 
 bool EventDispatcher::dispatch(const QVariantList &params)
 {
-    if (std::any_of(filterList.begin(), filterList.end(), [params](const EventHandler<Listener> &h) {
+    const auto &filters = filterList.snapshot();
+    if (std::any_of(filters->begin(), filters->end(), [&params](const EventHandler<Listener> &h) {
             return h.handler(params).toBool();
         })) {
         return false;
     }
 
-    std::for_each(handlerList.begin(), handlerList.end(), [params](const EventHandler<Listener> &h) {
+    const auto &handlers = handlerList.snapshot();
+    std::for_each(handlers->begin(), handlers->end(), [&params](const EventHandler<Listener> &h) {
         h.handler(params);
     });
 
@@ -85,8 +87,5 @@ bool EventDispatcherManager::unsubscribe(const QString &space, const QString &to
 bool EventDispatcherManager::unsubscribe(EventType type)
 {
     QWriteLocker guard(&rwLock);
-    if (dispatcherMap.contains(type))
-        return dispatcherMap.remove(type) > 0;
-
-    return false;
+    return dispatcherMap.remove(type);
 }
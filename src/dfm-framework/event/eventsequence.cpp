@@ -13,7 +13,8 @@ bool EventSequence::traversal()
 
 bool EventSequence::traversal(const QVariantList &params)
 {
-    for (auto seq : list) {
+    const auto &handlers = list.snapshot();
+    for (const auto &seq : *handlers) {
         if (seq.handler(params))
             return true;
     }
@@ -29,8 +30,5 @@ bool EventSequenceManager::unfollow(const QString &space, const QString &topic)
 bool EventSequenceManager::unfollow(EventType type)
 {
     QWriteLocker guard(&rwLock);
-    if (sequenceMap.contains(type))
-        return sequenceMap.remove(type) > 0;
-
-    return false;
+    return sequenceMap.remove(type);
 }
@@ -4,16 +4,24 @@
 
 #include "pluginmetaobject_p.h"
 #include "pluginmanager_p.h"
+#include "pluginmanifest_p.h"
 
 #include <dfm-framework/listener/listener.h>
 #include <dfm-framework/lifecycle/plugin.h>
 #include <dfm-framework/lifecycle/plugincreator.h>
 
+#include <QFile>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 DPF_BEGIN_NAMESPACE
 
 PluginManagerPrivate::PluginManagerPrivate(PluginManager *qq)
     : q(qq)
 {
+    startupTimer.start();
 }
 
 PluginManagerPrivate::~PluginManagerPrivate()
@@ -84,7 +92,12 @@ bool PluginManagerPrivate::stopPlugin(PluginMetaObjectPointer &pluginMetaObj)
  */
 bool PluginManagerPrivate::readPlugins()
 {
-    scanfAllPlugin(&readQueue, pluginLoadPaths, pluginLoadIIDs, blackPlguinNames);
+    startupTimer.restart();
+    // the json of the unchanged plugin files is read from the manifest
+    // instead of scanning each file
+    PluginManifest manifest(PluginManifest::defaultPath(pluginLoadPaths));
+    scanfAllPlugin(&readQueue, pluginLoadPaths, pluginLoadIIDs, blackPlguinNames, &manifest);
+    manifest.save();
     qInfo() << "Lazy load plugin names: " << lazyLoadPluginsNames;
     std::for_each(readQueue.begin(), readQueue.end(), [this](PluginMetaObjectPointer obj) {
         readJsonToMeta(obj);
@@ -110,11 +123,13 @@ bool PluginManagerPrivate::readPlugins()
  * \param destQueue
  * \param pluginPaths
  * \param pluginIID
+ * \param manifest cache of the plugin json, nullptr to scan every file
  */
 void PluginManagerPrivate::scanfAllPlugin(QQueue<PluginMetaObjectPointer> *destQueue,
                                           const QStringList &pluginPaths,
                                           const QStringList &pluginIIDs,
-                                          const QStringList &blackList)
+                                          const QStringList &blackList,
+                                          PluginManifest *manifest)
 {
     Q_ASSERT(destQueue);
 
@@ -131,17 +146,23 @@ void PluginManagerPrivate::scanfAllPlugin(QQueue<PluginMetaObjectPointer> *destQ
             PluginMetaObjectPointer metaObj(new PluginMetaObject);
             const QString &fileName { dirItera.path() + "/" + dirItera.fileName() };
             metaObj->d->loader->setFileName(fileName);
-            QJsonObject &&metaJson = metaObj->d->loader->metaData();
+            QJsonObject &&metaJson = manifest ? manifest->metaData(fileName, metaObj->d->loader.data())
+                                              : metaObj->d->loader->metaData();
             QJsonObject &&dataJson = metaJson.value("MetaData").toObject();
             QString &&iid = metaJson.value("IID").toString();
             if (!pluginIIDs.contains(iid))
                 continue;
 
+            const int count = destQueue->count();
             bool isVirtual = dataJson.contains(kVirtualPluginMeta) && dataJson.contains(kVirtualPluginList);
             if (isVirtual)
                 scanfVirtualPlugin(destQueue, fileName, dataJson, blackList);
             else
                 scanfRealPlugin(destQueue, metaObj, dataJson, blackList);
+
+            // keep the json for readJsonToMeta
+            for (int i = count; i < destQueue->count(); ++i)
+                destQueue->at(i)->d->metaData = metaJson;
         }
     }
 }
@@ -203,7 +224,8 @@ void PluginManagerPrivate::readJsonToMeta(PluginMetaObjectPointer metaObject)
 {
     metaObject->d->state = PluginMetaObject::kReading;
 
-    QJsonObject &&jsonObj = metaObject->d->loader->metaData();
+    QJsonObject &&jsonObj = metaObject->d->metaData.isEmpty() ? metaObject->d->loader->metaData()
+                                                              : metaObject->d->metaData;
     if (jsonObj.isEmpty())
         return;
 
@@ -257,7 +279,10 @@ bool PluginManagerPrivate::loadPlugins()
 {
     qInfo() << "Start loading all plugins: ";
     dependsSort(&loadQueue, &notLazyLoadQuene);
+    dependsLevel(&loadQueue);
+    preloadLibraries(loadQueue);
 
+    // the plugin instances are QObjects, create them in the main thread
     bool ret = true;
     std::for_each(loadQueue.begin(), loadQueue.end(), [&ret, this](PluginMetaObjectPointer pointer) {
         if (!PluginManagerPrivate::doLoadPlugin(pointer))
@@ -269,7 +294,38 @@ bool PluginManagerPrivate::loadPlugins()
 }
 
 /*!
- * \brief 初始化所有插件
+ * \brief 并发预读插件的动态库文件, 动态库仍由 doLoadPlugin 在主线程中打开:
+ *  打开时运行的静态初始化(如 DPF_EVENT_REG 注册事件类型)不是线程安全的
+ *  虚拟插件共用一个动态库, 每个库只预读一次
+ */
+void PluginManagerPrivate::preloadLibraries(const QQueue<PluginMetaObjectPointer> &queue)
+{
+    QStringList fileNames;
+    for (const PluginMetaObjectPointer &ptr : queue) {
+        const QString &fileName = ptr->fileName();
+        if (fileName.isEmpty() || ptr->d->state != PluginMetaObject::kReaded || fileNames.contains(fileName))
+            continue;
+        fileNames.append(fileName);
+    }
+
+    if (fileNames.count() < 2)
+        return;
+
+    // the dynamic loader maps the libraries from the page cache then
+    QtConcurrent::blockingMap(fileNames, [](const QString &fileName) {
+        const int fd = ::open(QFile::encodeName(fileName).constData(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (::fstat(fd, &st) == 0)
+            ::readahead(fd, 0, size_t(st.st_size));
+        ::close(fd);
+    });
+}
+
+/*!
+ * \brief 初始化所有插件, loadQueue 已按依赖层级排序,
+ *  逐层初始化, 插件总在其依赖的插件之后初始化
  */
 bool PluginManagerPrivate::initPlugins()
 {
@@ -299,6 +355,7 @@ bool PluginManagerPrivate::startPlugins()
             ret = false;
     });
     qInfo() << "End start of all plugins.";
+    printTimeline();
 
     emit Listener::instance()->pluginsStarted();
     allPluginsStarted = true;
@@ -357,6 +414,41 @@ void PluginManagerPrivate::dependsSort(QQueue<PluginMetaObjectPointer> *dstQueue
     }
 }
 
+/*!
+ * \brief 计算插件在依赖图中的层级, 并将 sortedQueue 按层级稳定排序
+ *  sortedQueue 中被依赖的插件在前, 依赖的插件层级总是更低, 排序后仍在前
+ */
+void PluginManagerPrivate::dependsLevel(QQueue<PluginMetaObjectPointer> *sortedQueue)
+{
+    QHash<QString, int> levels;
+    for (const PluginMetaObjectPointer &ptr : *sortedQueue) {
+        int level = 0;
+        for (const PluginDepend &depend : ptr->depends()) {
+            auto it = levels.constFind(depend.name());
+            if (it != levels.cend())
+                level = qMax(level, it.value() + 1);
+        }
+        ptr->d->timeline.level = level;
+        levels.insert(ptr->name(), level);
+    }
+
+    std::stable_sort(sortedQueue->begin(), sortedQueue->end(),
+                     [](const PluginMetaObjectPointer &left, const PluginMetaObjectPointer &right) {
+                         return left->d->timeline.level < right->d->timeline.level;
+                     });
+}
+
+void PluginManagerPrivate::printTimeline() const
+{
+    qInfo("Plugins startup timeline (ms since read, %d plugins):", loadQueue.count());
+    for (const PluginMetaObjectPointer &ptr : loadQueue) {
+        const PluginTimeline &t = ptr->d->timeline;
+        qInfo("  level %d, load %lld-%lld, initialize %lld-%lld, start %lld-%lld: %s",
+              t.level, t.loadBegin, t.loadEnd, t.initBegin, t.initEnd, t.startBegin, t.startEnd,
+              qUtf8Printable(ptr->name()));
+    }
+}
+
 bool PluginManagerPrivate::doLoadPlugin(PluginMetaObjectPointer pointer)
 {
     Q_ASSERT(pointer);
@@ -378,12 +470,16 @@ bool PluginManagerPrivate::doLoadPlugin(PluginMetaObjectPointer pointer)
     }
 
     pointer->d->state = PluginMetaObject::State::kLoading;
+    PluginTimeline &timeline = pointer->d->timeline;
+    if (timeline.loadBegin < 0)
+        timeline.loadBegin = startupTimer.elapsed();
 
     if (pointer->isVirtual() && loadedVirtualPlugins.contains(pointer->d->realName)) {
         auto creator = qobject_cast<PluginCreator *>(pointer->d->loader->instance());
         if (creator)
             pointer->d->plugin = creator->create(pointer->name());
         pointer->d->state = PluginMetaObject::State::kLoaded;
+        timeline.loadEnd = startupTimer.elapsed();
         qInfo() << "Virtual Plugin: " << pointer->d->name << " has been loaded";
         return true;
     }
@@ -416,6 +512,7 @@ bool PluginManagerPrivate::doLoadPlugin(PluginMetaObjectPointer pointer)
 
     // load success
     pointer->d->state = PluginMetaObject::State::kLoaded;
+    timeline.loadEnd = startupTimer.elapsed();
     qInfo() << "Loaded plugin: " << pointer->d->name << pointer->d->loader->fileName();
     if (pointer->isVirtual())
         loadedVirtualPlugins.push_back(pointer->d->realName);
@@ -448,7 +545,9 @@ bool PluginManagerPrivate::doInitPlugin(PluginMetaObjectPointer pointer)
     }
 
     pointer->d->state = PluginMetaObject::State::kInitialized;
+    pointer->d->timeline.initBegin = startupTimer.elapsed();
     pointer->d->plugin->initialize();
+    pointer->d->timeline.initEnd = startupTimer.elapsed();
     qInfo() << "Initialized plugin: " << pointer->d->name;
     emit Listener::instance()->pluginInitialized(pointer->d->iid, pointer->d->name);
 
@@ -479,7 +578,10 @@ bool PluginManagerPrivate::doStartPlugin(PluginMetaObjectPointer pointer)
         return false;
     }
 
-    if (pointer->d->plugin->start()) {
+    pointer->d->timeline.startBegin = startupTimer.elapsed();
+    const bool started = pointer->d->plugin->start();
+    pointer->d->timeline.startEnd = startupTimer.elapsed();
+    if (started) {
         qInfo() << "Started plugin: " << pointer->d->name;
         pointer->d->state = PluginMetaObject::State::kStarted;
         emit Listener::instance()->pluginStarted(pointer->d->iid, pointer->d->name);
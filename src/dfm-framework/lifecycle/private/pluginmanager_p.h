@@ -18,11 +18,13 @@
 #include <QDebug>
 #include <QWriteLocker>
 #include <QtConcurrent>
+#include <QElapsedTimer>
 
 DPF_BEGIN_NAMESPACE
 
 class PluginMetaObject;
 class PluginManager;
+class PluginManifest;
 
 class PluginManagerPrivate : public QSharedData
 {
@@ -40,6 +42,7 @@ class PluginManagerPrivate : public QSharedData
     QQueue<PluginMetaObjectPointer> loadQueue;
     bool allPluginsInitialized { false };
     bool allPluginsStarted { false };
+    QElapsedTimer startupTimer;
 
 public:
     explicit PluginManagerPrivate(PluginManager *qq);
@@ -60,7 +63,8 @@ public:
     static void scanfAllPlugin(QQueue<PluginMetaObjectPointer> *destQueue,
                                const QStringList &pluginPaths,
                                const QStringList &pluginIIDs,
-                               const QStringList &blackList);
+                               const QStringList &blackList,
+                               PluginManifest *manifest = nullptr);
     static void scanfRealPlugin(QQueue<PluginMetaObjectPointer> *destQueue, PluginMetaObjectPointer metaObj,
                                 const QJsonObject &dataJson, const QStringList &blackList);
     static void scanfVirtualPlugin(QQueue<PluginMetaObjectPointer> *destQueue, const QString &fileName,
@@ -69,8 +73,12 @@ public:
     static void jsonToMeta(PluginMetaObjectPointer metaObject, const QJsonObject &metaData);
     static void dependsSort(QQueue<PluginMetaObjectPointer> *dstQueue,
                             const QQueue<PluginMetaObjectPointer> *srcQueue);
+    static void dependsLevel(QQueue<PluginMetaObjectPointer> *sortedQueue);
 
 private:
+    void preloadLibraries(const QQueue<PluginMetaObjectPointer> &queue);
+    void printTimeline() const;
+
     bool doLoadPlugin(PluginMetaObjectPointer pointer);
     bool doInitPlugin(PluginMetaObjectPointer pointer);
     bool doStartPlugin(PluginMetaObjectPointer pointer);
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "pluginmanifest_p.h"
+
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QFile>
+#include <QDir>
+#include <QDebug>
+
+DPF_BEGIN_NAMESPACE
+
+static constexpr int kManifestVersion { 1 };
+static constexpr char kManifestVersionKey[] { "version" };
+static constexpr char kManifestPluginsKey[] { "plugins" };
+static constexpr char kManifestSizeKey[] { "size" };
+static constexpr char kManifestMTimeKey[] { "mtime" };
+static constexpr char kManifestMetaDataKey[] { "metaData" };
+
+PluginManifest::PluginManifest(const QString &filePath)
+    : filePath(filePath)
+{
+    QFile file(filePath);
+    if (filePath.isEmpty() || !file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject &root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(kManifestVersionKey).toInt() == kManifestVersion)
+        plugins = root.value(kManifestPluginsKey).toObject();
+}
+
+/*!
+ * \brief one manifest for each set of plugin paths, so the applications
+ *  loading the plugins of other paths do not replace it
+ */
+QString PluginManifest::defaultPath(const QStringList &pluginPaths)
+{
+    const QString &dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty())
+        return {};
+
+    const QByteArray &hash = QCryptographicHash::hash(pluginPaths.join(":").toUtf8(), QCryptographicHash::Md5).toHex();
+    return dir + "/plugins-" + hash.left(8) + ".manifest";
+}
+
+/*!
+ * \brief the meta data of the plugin file, from the manifest if the size
+ *  and the modified time of the file are unchanged
+ */
+QJsonObject PluginManifest::metaData(const QString &fileName, QPluginLoader *loader)
+{
+    Q_ASSERT(loader);
+
+    const QFileInfo info(fileName);
+    const qint64 size = info.size();
+    const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+    usedFiles.insert(fileName);
+
+    const QJsonObject &entry = plugins.value(fileName).toObject();
+    if (!entry.isEmpty()
+        && qint64(entry.value(kManifestSizeKey).toDouble()) == size
+        && qint64(entry.value(kManifestMTimeKey).toDouble()) == mtime)
+        return entry.value(kManifestMetaDataKey).toObject();
+
+    const QJsonObject &metaData = loader->metaData();
+    plugins.insert(fileName, QJsonObject { { kManifestSizeKey, double(size) },
+                                           { kManifestMTimeKey, double(mtime) },
+                                           { kManifestMetaDataKey, metaData } });
+    changed = true;
+    return metaData;
+}
+
+/*!
+ * \brief write the manifest if a plugin file is changed, added or removed
+ */
+bool PluginManifest::save()
+{
+    for (const QString &fileName : plugins.keys()) {
+        if (!usedFiles.contains(fileName)) {
+            plugins.remove(fileName);
+            changed = true;
+        }
+    }
+
+    if (!changed || filePath.isEmpty())
+        return true;
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write the plugin manifest:" << filePath << file.errorString();
+        return false;
+    }
+
+    const QJsonObject root { { kManifestVersionKey, kManifestVersion },
+                             { kManifestPluginsKey, plugins } };
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qWarning() << "Cannot write the plugin manifest:" << filePath << file.errorString();
+        return false;
+    }
+
+    changed = false;
+    return true;
+}
+
+DPF_END_NAMESPACE
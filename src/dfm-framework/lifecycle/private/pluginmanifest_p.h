@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PLUGINMANIFEST_P_H
+#define PLUGINMANIFEST_P_H
+
+#include <dfm-framework/dfm_framework_global.h>
+
+#include <QJsonObject>
+#include <QPluginLoader>
+#include <QStringList>
+#include <QSet>
+
+DPF_BEGIN_NAMESPACE
+
+/*!
+ * \brief The PluginManifest class
+ *  Cache of the json meta data of the plugin files, an unchanged file
+ *  is read from the manifest instead of being scanned by QPluginLoader
+ */
+class PluginManifest
+{
+public:
+    explicit PluginManifest(const QString &filePath);
+
+    static QString defaultPath(const QStringList &pluginPaths);
+
+    QJsonObject metaData(const QString &fileName, QPluginLoader *loader);
+    bool save();
+
+private:
+    QString filePath;
+    QJsonObject plugins;   // key: plugin file name
+    QSet<QString> usedFiles;
+    bool changed { false };
+};
+
+DPF_END_NAMESPACE
+
+#endif   // PLUGINMANIFEST_P_H
@@ -12,6 +12,7 @@
 #include <QString>
 #include <QStringList>
 #include <QSharedPointer>
+#include <QJsonObject>
 
 DPF_BEGIN_NAMESPACE
 
@@ -32,6 +33,18 @@ inline constexpr char kVirtualPluginMeta[] { "Meta" };
 /// \brief kPluginDepends virtual plugin info list
 inline constexpr char kVirtualPluginList[] { "VirtualPlugins" };
 
+/// \brief startup timeline of a plugin, msecs since the plugins are read
+struct PluginTimeline
+{
+    int level { 0 };   // 0 for no depends, otherwise 1 + the highest level of the depends
+    qint64 loadBegin { -1 };
+    qint64 loadEnd { -1 };
+    qint64 initBegin { -1 };
+    qint64 initEnd { -1 };
+    qint64 startBegin { -1 };
+    qint64 startEnd { -1 };
+};
+
 class PluginMetaObject;
 class PluginMetaObjectPrivate
 {
@@ -55,6 +68,8 @@ public:
     QList<PluginDepend> depends;
     QSharedPointer<Plugin> plugin;
     QSharedPointer<QPluginLoader> loader;
+    QJsonObject metaData;   // json of the plugin file, read once by the scan
+    PluginTimeline timeline;
 
     explicit PluginMetaObjectPrivate(PluginMetaObject *q)
         : q(q), loader(new QPluginLoader(nullptr))
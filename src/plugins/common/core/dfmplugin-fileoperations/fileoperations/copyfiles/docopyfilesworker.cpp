@@ -123,6 +123,8 @@ bool DoCopyFilesWorker::initArgs()
         workData->isFsTypeVfat = fsType.contains("vfat");
         workData->needSyncEveryRW = fsType == "cifs" || fsType == "vfat";
     }
+    // the source is kept when copying, so a file can be verified after the next one was started
+    workData->pipelineVerify = FileOperationsUtils::pipelineVerify();
 
     return true;
 }
@@ -131,6 +133,11 @@ void DoCopyFilesWorker::endWork()
 {
     waitThreadPoolOver();
 
+    qInfo() << "copy strategies, reflink: " << workData->copyStrategyCount[WorkerData::kReflinkCopy].load()
+            << " copy_file_range: " << workData->copyStrategyCount[WorkerData::kRangeCopy].load()
+            << " sendfile: " << workData->copyStrategyCount[WorkerData::kSendFileCopy].load()
+            << " user space: " << workData->copyStrategyCount[WorkerData::kUserSpaceCopy].load();
+
     // deal target files
     for (FileInfoPointer info : precompleteTargetFileInfo) {
         if (info->exists()) {
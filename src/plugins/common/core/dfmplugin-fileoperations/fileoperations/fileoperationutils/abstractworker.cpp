@@ -248,6 +248,8 @@ bool AbstractWorker::initArgs()
     completeTargetFiles.clear();
     completeCustomInfos.clear();
     bigFileSize = FileOperationsUtils::bigFileSize();
+    workData->copyQueueDepth = FileOperationsUtils::copyQueueDepth();
+    workData->checksumType = FileOperationsUtils::copyChecksumType();
 
     return true;
 }
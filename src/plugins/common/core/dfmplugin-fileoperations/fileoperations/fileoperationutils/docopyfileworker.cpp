@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "docopyfileworker.h"
+#include "filechecksum.h"
 
 #include <dfm-base/utils/fileutils.h>
 #include <dfm-base/base/device/deviceutils.h>
@@ -11,30 +12,228 @@
 
 #include <QDebug>
 #include <QTime>
+#include <QElapsedTimer>
 #include <QWaitCondition>
 #include <QMutex>
 #include <QThread>
+#include <QQueue>
+#include <QtConcurrent>
 
 #include <fcntl.h>
 #include <zlib.h>
+#include <unistd.h>
 #include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+
+// from linux/fs.h, which conflicts with sys/mount.h
+#ifndef FICLONE
+#    define FICLONE _IOW(0x94, 9, int)
+#endif
 
 static const quint32 kMaxBufferLength { 1024 * 1024 * 1 };
+// progress and stop are checked between two kernel copy calls
+static const qint64 kKernelCopyChunkSize { 1024 * 1024 * 8 };
+static const size_t kDirectIoAlignment { 4096 };
 
 DPFILEOPERATIONS_USE_NAMESPACE
 USING_IO_NAMESPACE
 DFMBASE_USE_NAMESPACE
 
+namespace {
+// The blocks of a pipelined copy, filled by the reader thread and written
+// by the copy thread. Buffers go round between the free and the filled queue,
+// so at most `depth` blocks are read ahead.
+class CopyBlockQueue
+{
+public:
+    enum ReadResult {
+        kReading,
+        kReadFinished,
+        kReadFailed,
+        kReadCanceled,
+    };
+
+    CopyBlockQueue(const int depth, const qint64 blockSize)
+    {
+        for (int i = 0; i < depth; ++i) {
+            buffers.append(new char[static_cast<uint>(blockSize + 1)]);
+            sizes.append(0);
+            freeBlocks.enqueue(i);
+        }
+    }
+    ~CopyBlockQueue()
+    {
+        for (auto buffer : buffers)
+            delete[] buffer;
+    }
+
+    char *buffer(const int index) const
+    {
+        return buffers.at(index);
+    }
+
+    // reader thread, -1 when the writer gave up
+    int takeFree()
+    {
+        QMutexLocker lk(&mutex);
+        while (freeBlocks.isEmpty() && !closed)
+            freeCondition.wait(&mutex);
+        return closed ? -1 : freeBlocks.dequeue();
+    }
+
+    void pushFilled(const int index, const qint64 size)
+    {
+        QMutexLocker lk(&mutex);
+        sizes[index] = size;
+        filledBlocks.enqueue(index);
+        filledCondition.wakeOne();
+    }
+
+    void finishRead(const ReadResult readResult, const qint64 pos)
+    {
+        QMutexLocker lk(&mutex);
+        result = readResult;
+        failedPos = pos;
+        filledCondition.wakeOne();
+    }
+
+    // copy thread, -1 when all the read blocks are taken
+    int takeFilled(qint64 *size)
+    {
+        QMutexLocker lk(&mutex);
+        while (filledBlocks.isEmpty() && result == kReading)
+            filledCondition.wait(&mutex);
+        if (filledBlocks.isEmpty())
+            return -1;
+        const int index = filledBlocks.dequeue();
+        *size = sizes.at(index);
+        return index;
+    }
+
+    void releaseFree(const int index)
+    {
+        QMutexLocker lk(&mutex);
+        freeBlocks.enqueue(index);
+        freeCondition.wakeOne();
+    }
+
+    void close()
+    {
+        QMutexLocker lk(&mutex);
+        closed = true;
+        freeCondition.wakeOne();
+    }
+
+    ReadResult readResult()
+    {
+        QMutexLocker lk(&mutex);
+        return result;
+    }
+
+    qint64 readFailedPos()
+    {
+        QMutexLocker lk(&mutex);
+        return failedPos;
+    }
+
+private:
+    QMutex mutex;
+    QWaitCondition freeCondition;
+    QWaitCondition filledCondition;
+    QVector<char *> buffers;
+    QVector<qint64> sizes;
+    QQueue<int> freeBlocks;
+    QQueue<int> filledBlocks;
+    ReadResult result { kReading };
+    qint64 failedPos { 0 };
+    bool closed { false };
+};
+
+// the read back of the pipelined verification bypasses the page cache,
+// so that the checksum is the one of the data on the device
+DoCopyFileWorker::VerifyResult readBackCheckSum(const QString &path, const FileChecksum::Type type)
+{
+    DoCopyFileWorker::VerifyResult result;
+    const std::string &stdPath = path.toStdString();
+    int fd = open(stdPath.c_str(), O_RDONLY | O_DIRECT);
+    bool isDirect = fd >= 0;
+    // some file systems do not support O_DIRECT
+    if (!isDirect)
+        fd = open(stdPath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        result.errorMsg = strerror(errno);
+        return result;
+    }
+
+    // the target is written through another fd
+    fdatasync(fd);
+    if (!isDirect)
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+
+    void *buffer = nullptr;
+    if (posix_memalign(&buffer, kDirectIoAlignment, kMaxBufferLength) != 0) {
+        close(fd);
+        result.errorMsg = strerror(ENOMEM);
+        return result;
+    }
+
+    FileChecksum checkSum(type);
+    Q_FOREVER {
+        const ssize_t size = read(fd, buffer, kMaxBufferLength);
+        if (size < 0 && errno == EINTR)
+            continue;
+        // opened with O_DIRECT, but the file system rejects the alignment of the reads
+        if (size < 0 && errno == EINVAL && isDirect) {
+            isDirect = false;
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            continue;
+        }
+        if (size < 0) {
+            result.errorMsg = strerror(errno);
+            break;
+        }
+        if (size == 0) {
+            result.ok = true;
+            break;
+        }
+        checkSum.update(static_cast<const char *>(buffer), size);
+    }
+
+    free(buffer);
+    close(fd);
+    result.checkSum = checkSum.value();
+    return result;
+}
+
+const char *copyStrategyName(const WorkerData::CopyStrategy strategy)
+{
+    switch (strategy) {
+    case WorkerData::kReflinkCopy:
+        return "reflink";
+    case WorkerData::kRangeCopy:
+        return "copy_file_range";
+    case WorkerData::kSendFileCopy:
+        return "sendfile";
+    default:
+        return "user space";
+    }
+}
+}   // namespace
+
 DoCopyFileWorker::DoCopyFileWorker(const QSharedPointer<WorkerData> &data, QObject *parent)
     : QObject(parent), workData(data)
 {
     waitCondition.reset(new QWaitCondition);
     mutex.reset(new QMutex);
     localFileHandler.reset(new LocalFileHandler);
+    ioPool.setMaxThreadCount(2);
 }
 
 DoCopyFileWorker::~DoCopyFileWorker()
 {
+    verifyFuture.waitForFinished();
 }
 // main thread using
 void DoCopyFileWorker::pause()
@@ -71,7 +270,10 @@ void DoCopyFileWorker::operateAction(const AbstractJobHandler::SupportAction act
 }
 void DoCopyFileWorker::doFileCopy(FileInfoPointer fromInfo, FileInfoPointer toInfo)
 {
-    doDfmioFileCopy(fromInfo, toInfo, nullptr);
+    if (doKernelFileCopy(fromInfo, toInfo) == WorkerData::kUserSpaceCopy && !isStopped()) {
+        doDfmioFileCopy(fromInfo, toInfo, nullptr);
+        workData->copyStrategyCount[WorkerData::kUserSpaceCopy]++;
+    }
     workData->completeFileCount++;
 }
 
@@ -176,6 +378,106 @@ bool DoCopyFileWorker::doDfmioFileCopy(FileInfoPointer fromInfo, FileInfoPointer
     return ret;
 }
 
+/*!
+ * \brief DoCopyFileWorker::doKernelFileCopy Copy a local file without passing the data through user space:
+ * FICLONE first, which is instantaneous on btrfs/xfs, then copy_file_range, then sendfile.
+ * No error is reported here, when every strategy failed the target is left empty and the
+ * caller copies the file in user space, which reports the error as usual.
+ * \param fromInfo File information of source file
+ * \param toInfo File information of target file
+ * \return The strategy which copied the file, kUserSpaceCopy if the file is not copied
+ */
+WorkerData::CopyStrategy DoCopyFileWorker::doKernelFileCopy(const FileInfoPointer fromInfo, const FileInfoPointer toInfo)
+{
+    if (!fromInfo || !toInfo || isStopped())
+        return WorkerData::kUserSpaceCopy;
+
+    // integrity checking and safe synchronization need the block by block copy
+    const qint64 size = fromInfo->size();
+    if (size <= 0 || workData->exBlockSyncEveryWrite
+        || workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))
+        return WorkerData::kUserSpaceCopy;
+
+    const QUrl &fromUrl = fromInfo->urlOf(UrlInfoType::kUrl);
+    const QUrl &toUrl = toInfo->urlOf(UrlInfoType::kUrl);
+    if (!fromUrl.isLocalFile() || !toUrl.isLocalFile())
+        return WorkerData::kUserSpaceCopy;
+
+    int fromFd = open(fromUrl.path().toStdString().c_str(), O_RDONLY);
+    if (fromFd < 0)
+        return WorkerData::kUserSpaceCopy;
+    int toFd = open(toUrl.path().toStdString().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (toFd < 0) {
+        close(fromFd);
+        return WorkerData::kUserSpaceCopy;
+    }
+
+    emit currentTask(fromUrl, toUrl);
+    QElapsedTimer timer;
+    timer.start();
+
+    WorkerData::CopyStrategy strategy { WorkerData::kUserSpaceCopy };
+    if (ioctl(toFd, FICLONE, fromFd) == 0) {
+        workData->currentWriteSize += size;
+        strategy = WorkerData::kReflinkCopy;
+    } else if (doKernelCopyRange(WorkerData::kRangeCopy, fromFd, toFd, size)) {
+        strategy = WorkerData::kRangeCopy;
+    } else if (!isStopped() && doKernelCopyRange(WorkerData::kSendFileCopy, fromFd, toFd, size)) {
+        strategy = WorkerData::kSendFileCopy;
+    }
+
+    close(fromFd);
+    close(toFd);
+
+    if (strategy == WorkerData::kUserSpaceCopy)
+        return strategy;
+
+    setTargetPermissions(fromInfo, toInfo);
+    workData->copyStrategyCount[strategy]++;
+    qDebug() << "copy strategy: " << copyStrategyName(strategy) << " size: " << size
+             << " elapsed(ms): " << timer.elapsed() << " url from: " << fromUrl << " url to: " << toUrl;
+    return strategy;
+}
+
+/*!
+ * \brief DoCopyFileWorker::doKernelCopyRange Copy the whole file by copy_file_range or sendfile
+ * in chunks, the target is truncated again when the copy did not finish
+ * \return Whether the whole file is copied
+ */
+bool DoCopyFileWorker::doKernelCopyRange(const WorkerData::CopyStrategy strategy, const int fromFd, const int toFd, const qint64 size)
+{
+    qint64 offset = 0;
+    while (offset < size && stateCheck()) {
+        const size_t chunkSize = static_cast<size_t>(qMin(kKernelCopyChunkSize, size - offset));
+        ssize_t copySize = -1;
+        if (strategy == WorkerData::kRangeCopy) {
+            loff_t inOffset = offset;
+            loff_t outOffset = offset;
+            copySize = copy_file_range(fromFd, &inOffset, toFd, &outOffset, chunkSize, 0);
+        } else {
+            off_t inOffset = offset;
+            copySize = sendfile(toFd, fromFd, &inOffset, chunkSize);
+        }
+
+        if (copySize < 0 && errno == EINTR)
+            continue;
+        // unsupported by the file systems, or the source is shorter than its info
+        if (copySize <= 0)
+            break;
+
+        offset += copySize;
+        workData->currentWriteSize += copySize;
+    }
+
+    if (offset == size)
+        return true;
+
+    workData->currentWriteSize -= offset;
+    if (ftruncate(toFd, 0) != 0 || lseek(toFd, 0, SEEK_SET) < 0)
+        qWarning() << "reset target after " << copyStrategyName(strategy) << " failed, error msg: " << strerror(errno);
+    return false;
+}
+
 void DoCopyFileWorker::progressCallback(int64_t current, int64_t total, void *progressData)
 {
     assert(progressData);
@@ -234,8 +536,64 @@ bool DoCopyFileWorker::doCopyFilePractically(const FileInfoPointer fromInfo, con
     if (workData->exBlockSyncEveryWrite)
         toFd = open(toInfo->urlOf(UrlInfoType::kUrl).path().toUtf8().toStdString().data(), O_RDONLY);
     qint64 blockSize = fromInfo->size() > kMaxBufferLength ? kMaxBufferLength : fromInfo->size();
+    FileChecksum sourceCheckSum(workData->checksumType);
+    // read the next blocks while writing when the file has more than one block
+    const bool copied = workData->copyQueueDepth > 1 && fromInfo->size() > blockSize
+            ? doCopyFileByPipeline(fromInfo, toInfo, fromDevice, toDevice, blockSize, toFd, &sourceCheckSum, skip)
+            : doCopyFileByBlock(fromInfo, toInfo, fromDevice, toDevice, blockSize, toFd, &sourceCheckSum, skip);
+    if (!copied) {
+        if (toFd > 0)
+            close(toFd);
+        return false;
+    }
+
+    // 执行同步策略
+    if (workData->exBlockSyncEveryWrite && toFd > 0)
+        syncfs(toFd);
+
+    if (toFd > 0)
+        close(toFd);
+
+    // 对文件加权
+    setTargetPermissions(fromInfo, toInfo);
+    if (!stateCheck())
+        return false;
+
+    // 校验文件完整性, read back while the next file is copied in pipeline mode
+    if (workData->pipelineVerify && !recopyingVerifiedFile
+        && workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking)
+        && toInfo->urlOf(UrlInfoType::kUrl).isLocalFile()) {
+        toDevice->close();
+        startVerify(fromInfo, toInfo, sourceCheckSum.value());
+        if (skip)
+            *skip = true;
+        toInfo->refresh();
+        return true;
+    }
+
+    if (skip)
+        *skip = verifyFileIntegrity(blockSize, sourceCheckSum.value(), fromInfo, toInfo, toDevice);
+    toInfo->refresh();
+
+    if (skip && *skip)
+        FileUtils::notifyFileChangeManual(DFMBASE_NAMESPACE::Global::FileNotifyType::kFileAdded, toInfo->urlOf(UrlInfoType::kUrl));
+
+    return true;
+}
+
+/*!
+ * \brief DoCopyFileWorker::doCopyFileByBlock Read a block and then write it until the end of the source file
+ * \param blockSize Data buffer size
+ * \param toFd Target fd to sync for exBlockSyncEveryWrite, -1 if not needed
+ * \param sourceCheckSum Output parameter: checksum of the copied data
+ * \param skip Output parameter: whether skip
+ * \return Copy successfully
+ */
+bool DoCopyFileWorker::doCopyFileByBlock(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo,
+                                         const QSharedPointer<DFile> &fromDevice, const QSharedPointer<DFile> &toDevice,
+                                         const qint64 blockSize, const int toFd, FileChecksum *sourceCheckSum, bool *skip)
+{
     char *data = new char[static_cast<uint>(blockSize + 1)];
-    uLong sourceCheckSum = adler32(0L, nullptr, 0);
     qint64 sizeRead = 0;
 
     do {
@@ -252,7 +610,7 @@ bool DoCopyFileWorker::doCopyFilePractically(const FileInfoPointer fromInfo, con
         }
 
         if (Q_LIKELY(workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))) {
-            sourceCheckSum = adler32(sourceCheckSum, reinterpret_cast<Bytef *>(data), static_cast<uInt>(sizeRead));
+            sourceCheckSum->update(data, sizeRead);
         }
 
         // 执行同步策略
@@ -266,27 +624,103 @@ bool DoCopyFileWorker::doCopyFilePractically(const FileInfoPointer fromInfo, con
     delete[] data;
     data = nullptr;
 
-    // 执行同步策略
-    if (workData->exBlockSyncEveryWrite && toFd > 0)
-        syncfs(toFd);
+    return true;
+}
 
-    if (toFd > 0)
-        close(toFd);
+/*!
+ * \brief DoCopyFileWorker::doCopyFileByPipeline Copy with a reader thread filling up to copyQueueDepth
+ * blocks while this thread writes, so that the source and the target device work at the same time.
+ * The reader only reads, all the errors are handled in this thread: writing errors as in
+ * doCopyFileByBlock, and a failed read makes the rest of the file copied by doCopyFileByBlock
+ * from the failed position, which reports the error and retries as usual.
+ * \param blockSize Data buffer size
+ * \param toFd Target fd to sync for exBlockSyncEveryWrite, -1 if not needed
+ * \param sourceCheckSum Output parameter: checksum of the copied data
+ * \param skip Output parameter: whether skip
+ * \return Copy successfully
+ */
+bool DoCopyFileWorker::doCopyFileByPipeline(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo,
+                                            const QSharedPointer<DFile> &fromDevice, const QSharedPointer<DFile> &toDevice,
+                                            const qint64 blockSize, const int toFd, FileChecksum *sourceCheckSum, bool *skip)
+{
+    CopyBlockQueue queue(workData->copyQueueDepth, blockSize);
+    const qint64 fromSize = fromInfo->size();
+
+    QFuture<void> reader = QtConcurrent::run(&ioPool, [this, &queue, fromDevice, blockSize, fromSize]() {
+        Q_FOREVER {
+            const int index = queue.takeFree();
+            if (index < 0 || isStopped()) {
+                queue.finishRead(CopyBlockQueue::kReadCanceled, fromDevice->pos());
+                return;
+            }
 
-    // 对文件加权
-    setTargetPermissions(fromInfo, toInfo);
-    if (!stateCheck())
+            const qint64 pos = fromDevice->pos();
+            const qint64 size = fromDevice->read(queue.buffer(index), blockSize);
+            if (size <= 0) {
+                queue.releaseFree(index);
+                const bool isEnd = size == 0 && fromDevice->pos() == fromSize;
+                queue.finishRead(isEnd ? CopyBlockQueue::kReadFinished : CopyBlockQueue::kReadFailed, pos);
+                return;
+            }
+
+            queue.pushFilled(index, size);
+            if (fromDevice->pos() == fromSize) {
+                queue.finishRead(CopyBlockQueue::kReadFinished, fromSize);
+                return;
+            }
+        }
+    });
+
+    bool ok = true;
+    Q_FOREVER {
+        qint64 size = 0;
+        const int index = queue.takeFilled(&size);
+        if (index < 0)
+            break;
+
+        if (!doWriteFile(fromInfo, toInfo, toDevice, queue.buffer(index), size, skip)) {
+            ok = false;
+            break;
+        }
+
+        if (Q_LIKELY(workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))) {
+            sourceCheckSum->update(queue.buffer(index), size);
+        }
+
+        // 执行同步策略
+        if (workData->exBlockSyncEveryWrite && toFd > 0)
+            syncfs(toFd);
+
+        toInfo->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardSize, toDevice->size());
+        queue.releaseFree(index);
+    }
+
+    queue.close();
+    reader.waitForFinished();
+
+    if (!ok || isStopped())
         return false;
 
-    // 校验文件完整性
-    if (skip)
-        *skip = verifyFileIntegrity(blockSize, sourceCheckSum, fromInfo, toInfo, toDevice);
-    toInfo->refresh();
+    if (queue.readResult() == CopyBlockQueue::kReadFinished)
+        return true;
 
-    if (skip && *skip)
-        FileUtils::notifyFileChangeManual(DFMBASE_NAMESPACE::Global::FileNotifyType::kFileAdded, toInfo->urlOf(UrlInfoType::kUrl));
+    if (queue.readResult() == CopyBlockQueue::kReadCanceled)
+        return false;
 
-    return true;
+    // the reader stopped at a failed read, go on block by block to report it
+    const qint64 failedPos = queue.readFailedPos();
+    qWarning() << "pipeline read failed, url from: " << fromInfo->urlOf(UrlInfoType::kUrl) << " pos: " << failedPos;
+    if (fromDevice->pos() != failedPos && !fromDevice->seek(failedPos)) {
+        AbstractJobHandler::SupportAction actionForReadSeek = doHandleErrorAndWait(fromInfo->urlOf(UrlInfoType::kUrl),
+                                                                                   toInfo->urlOf(UrlInfoType::kUrl),
+                                                                                   AbstractJobHandler::JobErrorType::kSeekError,
+                                                                                   false, fromDevice->lastError().errorMsg());
+        checkRetry();
+        actionOperating(actionForReadSeek, fromSize - failedPos, skip);
+        return false;
+    }
+
+    return doCopyFileByBlock(fromInfo, toInfo, fromDevice, toDevice, blockSize, toFd, sourceCheckSum, skip);
 }
 
 bool DoCopyFileWorker::stateCheck()
@@ -659,7 +1093,7 @@ bool DoCopyFileWorker::verifyFileIntegrity(const qint64 &blockSize, const ulong
         return true;
     char *data = new char[static_cast<uint>(blockSize + 1)];
     QTime t;
-    ulong targetCheckSum = adler32(0L, nullptr, 0);
+    FileChecksum targetCheckSum(workData->checksumType);
     Q_FOREVER {
         qint64 size = toDevice->read(data, blockSize);
 
@@ -681,7 +1115,7 @@ bool DoCopyFileWorker::verifyFileIntegrity(const qint64 &blockSize, const ulong
             }
         }
 
-        targetCheckSum = adler32(targetCheckSum, reinterpret_cast<Bytef *>(data), static_cast<uInt>(size));
+        targetCheckSum.update(data, size);
 
         if (Q_UNLIKELY(!stateCheck())) {
             delete[] data;
@@ -693,8 +1127,8 @@ bool DoCopyFileWorker::verifyFileIntegrity(const qint64 &blockSize, const ulong
 
     qDebug("Time spent of integrity check of the file: %d", t.elapsed());
 
-    if (sourceCheckSum != targetCheckSum) {
-        qWarning("Failed on file integrity checking, source file: 0x%lx, target file: 0x%lx", sourceCheckSum, targetCheckSum);
+    if (sourceCheckSum != targetCheckSum.value()) {
+        qWarning("Failed on file integrity checking, source file: 0x%lx, target file: 0x%lx", sourceCheckSum, targetCheckSum.value());
         AbstractJobHandler::SupportAction actionForCheck = doHandleErrorAndWait(fromInfo->urlOf(UrlInfoType::kUrl),
                                                                                 toInfo->urlOf(UrlInfoType::kUrl),
                                                                                 AbstractJobHandler::JobErrorType::kIntegrityCheckingError,
@@ -705,6 +1139,66 @@ bool DoCopyFileWorker::verifyFileIntegrity(const qint64 &blockSize, const ulong
     return true;
 }
 
+/*!
+ * \brief DoCopyFileWorker::startVerify Read back the target in another thread while the next file is
+ * copied, the result is checked before the next verification or by waitVerifyFinished
+ * \param sourceCheckSum checksum of the source data
+ */
+void DoCopyFileWorker::startVerify(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo, const ulong sourceCheckSum)
+{
+    waitVerifyFinished();
+
+    verifyFromInfo = fromInfo;
+    verifyToInfo = toInfo;
+    verifySourceCheckSum = sourceCheckSum;
+    verifyFuture = QtConcurrent::run(&ioPool, readBackCheckSum, toInfo->urlOf(UrlInfoType::kUrl).path(), workData->checksumType);
+}
+
+/*!
+ * \brief DoCopyFileWorker::waitVerifyFinished Wait the pipelined verification of the last copied file
+ * and handle its error, a retry copies the file again and verifies it right after the copy
+ */
+void DoCopyFileWorker::waitVerifyFinished()
+{
+    if (!verifyToInfo)
+        return;
+
+    verifyFuture.waitForFinished();
+    VerifyResult result = verifyFuture.result();
+    const FileInfoPointer fromInfo = verifyFromInfo;
+    const FileInfoPointer toInfo = verifyToInfo;
+    verifyFromInfo.reset();
+    verifyToInfo.reset();
+    verifyFuture = QFuture<VerifyResult>();
+
+    if (isStopped())
+        return;
+
+    if (result.ok && result.checkSum == verifySourceCheckSum) {
+        FileUtils::notifyFileChangeManual(DFMBASE_NAMESPACE::Global::FileNotifyType::kFileAdded, toInfo->urlOf(UrlInfoType::kUrl));
+        return;
+    }
+
+    qWarning("Failed on file integrity checking, source file: 0x%lx, target file: 0x%lx, error: %s",
+             verifySourceCheckSum, result.checkSum, qPrintable(result.errorMsg));
+    // the next file is shown as the current task by now
+    emit currentTask(fromInfo->urlOf(UrlInfoType::kUrl), toInfo->urlOf(UrlInfoType::kUrl));
+    const AbstractJobHandler::SupportAction action = doHandleErrorAndWait(fromInfo->urlOf(UrlInfoType::kUrl),
+                                                                          toInfo->urlOf(UrlInfoType::kUrl),
+                                                                          AbstractJobHandler::JobErrorType::kIntegrityCheckingError,
+                                                                          true, result.errorMsg);
+    if (!isStopped() && action == AbstractJobHandler::SupportAction::kRetryAction) {
+        // the errors of the copy and of its verification are handled in doCopyFilePractically
+        bool skip = false;
+        recopyingVerifiedFile = true;
+        toInfo->refresh();
+        doCopyFilePractically(fromInfo, toInfo, &skip);
+        recopyingVerifiedFile = false;
+    }
+
+    checkRetry();
+}
+
 void DoCopyFileWorker::checkRetry()
 {
     if (!workData->signalThread && retry && !isStopped()) {
@@ -16,6 +16,8 @@
 #include <dfm-io/doperator.h>
 
 #include <QObject>
+#include <QFuture>
+#include <QThreadPool>
 
 #include <fcntl.h>
 
@@ -39,6 +41,12 @@ public:
         QSharedPointer<WorkerData> data{ nullptr };
     };
 
+    struct VerifyResult {
+        bool ok { false };
+        ulong checkSum { 0 };
+        QString errorMsg;
+    };
+
 public:
     explicit DoCopyFileWorker(const QSharedPointer<WorkerData> &data, QObject *parent = nullptr);
     ~DoCopyFileWorker() override;
@@ -57,6 +65,10 @@ public:
     void doMemcpyLocalBigFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, char *dest, char *source, size_t size);
     // copy file by dfmio
     bool doDfmioFileCopy(FileInfoPointer fromInfo, FileInfoPointer toInfo, bool *skip);
+    // copy local file in kernel, kUserSpaceCopy if the caller has to copy it
+    WorkerData::CopyStrategy doKernelFileCopy(const FileInfoPointer fromInfo, const FileInfoPointer toInfo);
+    // wait the pipelined verification of the last copied file
+    void waitVerifyFinished();
 signals:
     void ErrorFinished();
     void CompleteSize(const int size);
@@ -97,10 +109,18 @@ private:   // file copy
     bool doWriteFile(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo,
                      const QSharedPointer<DFMIO::DFile> &toDevice,
                      const char *data, const qint64 readSize, bool *skip);
+    bool doCopyFileByBlock(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo,
+                           const QSharedPointer<DFMIO::DFile> &fromDevice, const QSharedPointer<DFMIO::DFile> &toDevice,
+                           const qint64 blockSize, const int toFd, FileChecksum *sourceCheckSum, bool *skip);
+    bool doCopyFileByPipeline(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo,
+                              const QSharedPointer<DFMIO::DFile> &fromDevice, const QSharedPointer<DFMIO::DFile> &toDevice,
+                              const qint64 blockSize, const int toFd, FileChecksum *sourceCheckSum, bool *skip);
+    bool doKernelCopyRange(const WorkerData::CopyStrategy strategy, const int fromFd, const int toFd, const qint64 size);
     void setTargetPermissions(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo);
     bool verifyFileIntegrity(const qint64 &blockSize, const ulong &sourceCheckSum,
                              const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo,
                              QSharedPointer<DFMIO::DFile> &toFile);
+    void startVerify(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo, const ulong sourceCheckSum);
     void checkRetry();
     bool isStopped();
     void syncBlockFile(const FileInfoPointer toInfo);
@@ -119,6 +139,14 @@ private:
     QList<QUrl> skipUrls;
     QUrl memcpySkipUrl;
     DThreadList<QSharedPointer<dfmio::DOperator>> fileOps;
+    QFuture<VerifyResult> verifyFuture;   // pipelined verification of the last copied file
+    FileInfoPointer verifyFromInfo { nullptr };
+    FileInfoPointer verifyToInfo { nullptr };
+    ulong verifySourceCheckSum { 0 };
+    bool recopyingVerifiedFile { false };   // a retry of the pipelined verification is verified right after the copy
+    // the pipeline reader and the read-back verification, they block for a whole file
+    // and are kept off the global thread pool
+    QThreadPool ioPool;
 };
 DPFILEOPERATIONS_END_NAMESPACE
 #endif   // DOCOPYFILEWORKER_H
@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "filechecksum.h"
+
+#include <zlib.h>
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <nmmintrin.h>
+#    define DFM_CRC32C_X86
+#endif
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+namespace {
+constexpr quint32 kCrc32cPoly { 0x82F63B78 };   // reflected Castagnoli polynomial
+
+struct Crc32cTable
+{
+    quint32 data[256];
+    Crc32cTable()
+    {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 crc = i;
+            for (int j = 0; j < 8; ++j)
+                crc = (crc >> 1) ^ (kCrc32cPoly & (0 - (crc & 1)));
+            data[i] = crc;
+        }
+    }
+};
+
+quint32 crc32cSoftware(quint32 crc, const uchar *data, size_t size)
+{
+    static const Crc32cTable table;
+    while (size--)
+        crc = table.data[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#ifdef DFM_CRC32C_X86
+__attribute__((target("sse4.2"))) quint32 crc32cHardware(quint32 crc, const uchar *data, size_t size)
+{
+    for (; size && (reinterpret_cast<quintptr>(data) & 7); --size)
+        crc = _mm_crc32_u8(crc, *data++);
+#    ifdef __x86_64__
+    quint64 crc64 = crc;
+    for (; size >= 8; size -= 8, data += 8) {
+        quint64 value;
+        memcpy(&value, data, sizeof(value));
+        crc64 = _mm_crc32_u64(crc64, value);
+    }
+    crc = static_cast<quint32>(crc64);
+#    endif
+    for (; size >= 4; size -= 4, data += 4) {
+        quint32 value;
+        memcpy(&value, data, sizeof(value));
+        crc = _mm_crc32_u32(crc, value);
+    }
+    for (; size; --size)
+        crc = _mm_crc32_u8(crc, *data++);
+    return crc;
+}
+#endif
+
+quint32 crc32c(quint32 crc, const uchar *data, size_t size)
+{
+    crc = ~crc;
+#ifdef DFM_CRC32C_X86
+    if (FileChecksum::hasHardwareCrc32c())
+        return ~crc32cHardware(crc, data, size);
+#endif
+    return ~crc32cSoftware(crc, data, size);
+}
+}   // namespace
+
+FileChecksum::FileChecksum(const Type type)
+    : type(type)
+{
+    reset();
+}
+
+void FileChecksum::update(const char *data, const qint64 size)
+{
+    if (!data || size <= 0)
+        return;
+
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    if (type == kCrc32c) {
+        sum = crc32c(static_cast<quint32>(sum), bytes, static_cast<size_t>(size));
+        return;
+    }
+
+    // adler32 takes uInt
+    qint64 remain = size;
+    while (remain > 0) {
+        const uInt length = static_cast<uInt>(qMin<qint64>(remain, 1 << 30));
+        sum = adler32(sum, bytes, length);
+        bytes += length;
+        remain -= length;
+    }
+}
+
+ulong FileChecksum::value() const
+{
+    return sum;
+}
+
+void FileChecksum::reset()
+{
+    sum = type == kCrc32c ? 0 : adler32(0L, nullptr, 0);
+}
+
+/*!
+ * \brief FileChecksum::typeFromName Checksum type of the dconfig value, "auto" is CRC32C when
+ * the cpu computes it in hardware, adler32 otherwise
+ */
+FileChecksum::Type FileChecksum::typeFromName(const QString &name)
+{
+    if (name == "crc32c")
+        return kCrc32c;
+    if (name == "adler32")
+        return kAdler32;
+    return hasHardwareCrc32c() ? kCrc32c : kAdler32;
+}
+
+bool FileChecksum::hasHardwareCrc32c()
+{
+#ifdef DFM_CRC32C_X86
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+#else
+    return false;
+#endif
+}
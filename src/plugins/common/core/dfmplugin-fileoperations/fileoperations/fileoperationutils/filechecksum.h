@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FILECHECKSUM_H
+#define FILECHECKSUM_H
+
+#include "dfmplugin_fileoperations_global.h"
+
+#include <QString>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+// Streaming checksum of the copy integrity checking. CRC32C uses the SSE4.2
+// crc32 instruction when the cpu has it, adler32 of zlib is the fallback.
+class FileChecksum
+{
+public:
+    enum Type : quint8 {
+        kAdler32,
+        kCrc32c,
+    };
+
+    explicit FileChecksum(const Type type = kAdler32);
+
+    void update(const char *data, const qint64 size);
+    ulong value() const;
+    void reset();
+
+    static Type typeFromName(const QString &name);
+    static bool hasHardwareCrc32c();
+
+private:
+    Type type { kAdler32 };
+    ulong sum { 0 };
+};
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // FILECHECKSUM_H
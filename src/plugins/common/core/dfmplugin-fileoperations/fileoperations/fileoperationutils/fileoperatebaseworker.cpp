@@ -30,6 +30,12 @@
 DPFILEOPERATIONS_USE_NAMESPACE
 USING_IO_NAMESPACE
 
+// a batch of small files is dispatched to the copy threads when it is full
+static constexpr int kSmallFileBatchCount { 128 };
+static constexpr qint64 kSmallFileBatchSize { 8 * 1024 * 1024 };
+// or earlier when a copy thread is idle
+static constexpr int kSmallFileMinBatchCount { 8 };
+
 FileOperateBaseWorker::FileOperateBaseWorker(QObject *parent)
     : AbstractWorker(parent)
 {
@@ -703,6 +709,7 @@ bool FileOperateBaseWorker::checkAndCopyDir(const FileInfoPointer &fromInfo, con
 
 void FileOperateBaseWorker::waitThreadPoolOver()
 {
+    flushSmallFileBatch();
     // wait all thread start
     if (!isStopped() && threadPool) {
         QThread::msleep(10);
@@ -711,6 +718,9 @@ void FileOperateBaseWorker::waitThreadPoolOver()
     while (threadPool && threadPool->activeThreadCount() > 0) {
         QThread::msleep(10);
     }
+    // the last file copied in pipeline verify mode
+    if (copyOtherFileWorker)
+        copyOtherFileWorker->waitVerifyFinished();
 }
 
 void FileOperateBaseWorker::initCopyWay()
@@ -825,17 +835,71 @@ bool FileOperateBaseWorker::doCopyLocalFile(const FileInfoPointer fromInfo, cons
     if (!stateCheck())
         return false;
 
-    QtConcurrent::run(threadPool.data(), threadCopyWorker[threadCopyFileCount % threadCount].data(),
-                      static_cast<void (DoCopyFileWorker::*)(const FileInfoPointer, const FileInfoPointer)>(&DoCopyFileWorker::doFileCopy),
-                      fromInfo, toInfo);
+    SmallFileThreadCopyInfo info;
+    info.fromInfo = fromInfo;
+    info.toInfo = toInfo;
+    smallFileBatch.append(info);
+    smallFileBatchSize += fromInfo->size() > 0 ? fromInfo->size() : 0;
+
+    const bool isFull = smallFileBatch.count() >= kSmallFileBatchCount || smallFileBatchSize >= kSmallFileBatchSize;
+    const bool hasIdleThread = smallFileBatch.count() >= kSmallFileMinBatchCount
+            && threadPool && threadPool->activeThreadCount() < threadPool->maxThreadCount();
+    if (isFull || hasIdleThread)
+        flushSmallFileBatch();
 
-    threadCopyFileCount++;
     return true;
 }
 
+/*!
+ * \brief FileOperateBaseWorker::flushSmallFileBatch Dispatch the collected small files as one task,
+ * the tasks are queued in the thread pool and taken by the first idle copy thread
+ */
+void FileOperateBaseWorker::flushSmallFileBatch()
+{
+    if (smallFileBatch.isEmpty())
+        return;
+
+    if (isStopped() || threadCopyWorker.isEmpty()) {
+        smallFileBatch.clear();
+        smallFileBatchSize = 0;
+        return;
+    }
+
+    QtConcurrent::run(threadPool.data(), this, &FileOperateBaseWorker::doCopySmallFileBatch,
+                      threadCopyWorker[threadCopyFileCount % threadCount], smallFileBatch);
+
+    threadCopyFileCount++;
+    smallFileBatch.clear();
+    smallFileBatchSize = 0;
+}
+
+void FileOperateBaseWorker::doCopySmallFileBatch(const QSharedPointer<DoCopyFileWorker> worker, SmallFileBatch batch)
+{
+    // in inode order the metadata and the data of the files are read close to each other
+    QVector<QPair<quint64, int>> order;
+    order.reserve(batch.count());
+    for (int i = 0; i < batch.count(); ++i)
+        order.append({ batch.at(i).fromInfo->extendAttributes(ExtInfoType::kInode).toULongLong(), i });
+    std::sort(order.begin(), order.end());
+
+    for (const auto &item : order) {
+        if (isStopped())
+            return;
+        const auto &info = batch.at(item.second);
+        worker->doFileCopy(info.fromInfo, info.toInfo);
+    }
+}
+
 bool FileOperateBaseWorker::doCopyLocalBigFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, bool *skip)
 {
     waitThreadPoolOver();
+    // clone or copy in kernel, mmap and memcpy when the file systems do not support it
+    if (!threadCopyWorker.isEmpty()
+        && threadCopyWorker.first()->doKernelFileCopy(fromInfo, toInfo) != WorkerData::kUserSpaceCopy)
+        return true;
+    if (isStopped())
+        return false;
+    workData->copyStrategyCount[WorkerData::kUserSpaceCopy]++;
     // open file
     auto fromFd = doOpenFile(fromInfo, toInfo, false, O_RDONLY, skip);
     if (fromFd < 0)
@@ -998,10 +1062,18 @@ bool FileOperateBaseWorker::doCopyOtherFile(const FileInfoPointer fromInfo, cons
 
     FileUtils::cacheCopyingFileUrl(targetUrl);
     bool ok{ false };
-    if (fromInfo->size() > bigFileSize || !supportDfmioCopy || workData->exBlockSyncEveryWrite) {
-        ok = copyOtherFileWorker->doCopyFilePractically(fromInfo, toInfo, skip);
+    if (isSourceFileLocal && isTargetFileLocal
+        && copyOtherFileWorker->doKernelFileCopy(fromInfo, toInfo) != WorkerData::kUserSpaceCopy) {
+        ok = true;
+    } else if (isStopped()) {
+        ok = false;
     } else {
-        ok = copyOtherFileWorker->doDfmioFileCopy(fromInfo, toInfo, skip);
+        if (fromInfo->size() > bigFileSize || !supportDfmioCopy || workData->exBlockSyncEveryWrite) {
+            ok = copyOtherFileWorker->doCopyFilePractically(fromInfo, toInfo, skip);
+        } else {
+            ok = copyOtherFileWorker->doDfmioFileCopy(fromInfo, toInfo, skip);
+        }
+        workData->copyStrategyCount[WorkerData::kUserSpaceCopy]++;
     }
     FileUtils::removeCopyingFileUrl(targetUrl);
 
@@ -37,6 +37,7 @@ public:
         FileInfoPointer fromInfo { nullptr };
         FileInfoPointer toInfo { nullptr };
     };
+    using SmallFileBatch = QList<SmallFileThreadCopyInfo>;
 
 public:
     bool doCheckFile(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo, const QString &fileName,
@@ -96,6 +97,8 @@ private:
                              bool *skip, bool isCountSize = false);
     QUrl createNewTargetUrl(const FileInfoPointer &toInfo, const QString &fileName);
     bool doCopyLocalFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo);
+    void flushSmallFileBatch();
+    void doCopySmallFileBatch(const QSharedPointer<DoCopyFileWorker> worker, SmallFileBatch batch);
     bool doCopyOtherFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, bool *skip);
     bool doCopyLocalBigFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, bool *skip);
 
@@ -135,6 +138,8 @@ protected:
     QString blocakTargetRootPath;
 
     std::atomic_int threadCopyFileCount { 0 };
+    SmallFileBatch smallFileBatch;   // small files not dispatched to the copy threads yet
+    qint64 smallFileBatchSize { 0 };
 };
 DPFILEOPERATIONS_END_NAMESPACE
 
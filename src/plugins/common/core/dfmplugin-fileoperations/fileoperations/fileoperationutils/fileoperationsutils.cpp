@@ -31,6 +31,9 @@ QSet<QString> FileOperationsUtils::fileNameUsing = {};
 inline constexpr char kFileOperations[] { "org.deepin.dde.file-manager.operations" };
 inline constexpr char kFileBigSize[] { "file.operation.bigfilesize" };
 inline constexpr char kBlockEverySync[] { "file.operation.blockeverysync" };
+inline constexpr char kCopyQueueDepth[] { "file.operation.copyqueuedepth" };
+inline constexpr char kCopyChecksum[] { "file.operation.checksum" };
+inline constexpr char kVerifyMode[] { "file.operation.verifymode" };
 QMutex FileOperationsUtils::mutex;
 
 /*!
@@ -167,3 +170,24 @@ bool FileOperationsUtils::blockSync()
     bool sync = DConfigManager::instance()->value(kFileOperations, kBlockEverySync).toBool();
     return sync;
 }
+
+int FileOperationsUtils::copyQueueDepth()
+{
+    bool ok = false;
+    int depth = DConfigManager::instance()->value(kFileOperations, kCopyQueueDepth, 4).toInt(&ok);
+    if (!ok || depth < 1)
+        return 1;
+    return qMin(depth, 16);
+}
+
+FileChecksum::Type FileOperationsUtils::copyChecksumType()
+{
+    const QString &name = DConfigManager::instance()->value(kFileOperations, kCopyChecksum, "auto").toString();
+    return FileChecksum::typeFromName(name);
+}
+
+bool FileOperationsUtils::pipelineVerify()
+{
+    const QString &mode = DConfigManager::instance()->value(kFileOperations, kVerifyMode, "pipeline").toString();
+    return mode != "sync";
+}
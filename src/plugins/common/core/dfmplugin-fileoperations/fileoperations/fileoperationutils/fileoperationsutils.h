@@ -6,6 +6,8 @@
 #define FILEOPERATIONSUTILS_H
 
 #include "dfmplugin_fileoperations_global.h"
+#include "filechecksum.h"
+
 #include <dfm-base/utils/fileutils.h>
 
 #include <QSharedPointer>
@@ -75,6 +77,9 @@ private:
     static bool isFileOnDisk(const QUrl &url);
     static qint64 bigFileSize();
     static bool blockSync();
+    static int copyQueueDepth();
+    static FileChecksum::Type copyChecksumType();
+    static bool pipelineVerify();
 
 private:
     static QSet<QString> fileNameUsing;
@@ -5,6 +5,8 @@
 #ifndef WORKERDATA_H
 #define WORKERDATA_H
 #include "dfmplugin_fileoperations_global.h"
+#include "filechecksum.h"
+
 #include <dfm-base/interfaces/abstractjobhandler.h>
 #include <dfm-base/interfaces/fileinfo.h>
 #include <dfm-base/utils/threadcontainer.h>
@@ -46,6 +48,14 @@ public:
         }
     };
 
+    enum CopyStrategy : quint8 {
+        kUserSpaceCopy,   // dfmio, read/write or mmap, all the data goes through user space
+        kReflinkCopy,   // FICLONE, the target shares the extents of the source
+        kRangeCopy,   // copy_file_range
+        kSendFileCopy,   // sendfile
+        kCopyStrategyCount,
+    };
+
     WorkerData();
 
     quint16 dirSize { 0 };   // size of dir
@@ -55,11 +65,15 @@ public:
     std::atomic_bool exBlockSyncEveryWrite { false };
     std::atomic_bool isFsTypeVfat { false };
     std::atomic_bool isBlockDevice { false };
+    std::atomic_int copyQueueDepth { 1 };   // blocks read ahead while writing, 1 is read then write
+    FileChecksum::Type checksumType { FileChecksum::kAdler32 };   // checksum of the integrity checking
+    std::atomic_bool pipelineVerify { false };   // verify a copied file while the next one is copied
     std::atomic_int64_t currentWriteSize { 0 };
     QAtomicInteger<qint64> zeroOrlinkOrDirWriteSize { 0 };   // The copy size is 0. The write statistics size of the linked file and directory
     QAtomicInteger<qint64> blockRenameWriteSize { 0 };   // The copy size is 0. The write statistics size of the linked file and directory
     QAtomicInteger<qint64> skipWriteSize { 0 };   // 跳过的文件大
     QAtomicInteger<qint64> completeFileCount { 0 };   // copy complete file count
+    QAtomicInteger<qint64> copyStrategyCount[kCopyStrategyCount] {};   // copied file count of each copy strategy
     std::atomic_bool signalThread { true };
     DThreadMap<QUrl, qint64> everyFileWriteSize;
     DThreadList<QSharedPointer<DPFILEOPERATIONS_NAMESPACE::WorkerData::BlockFileCopyInfo>> blockCopyInfoQueue;
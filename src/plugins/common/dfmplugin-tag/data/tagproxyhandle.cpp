@@ -103,12 +103,11 @@ QVariantMap TagProxyHandle::getAllTags()
 
 QVariantMap TagProxyHandle::getTagsThroughFile(const QStringList &value)
 {
-    auto &&reply = d->tagDBusInterface->Query(int(QueryOpts::kTagsOfFile), value);
+    auto &&reply = d->tagDBusInterface->QueryTagsOfFiles(value);
     reply.waitForFinished();
     if (!reply.isValid())
         return {};
-    const auto &data = d->parseDBusVariant(reply.value());
-    return data.toMap();
+    return reply.value();
 }
 
 QVariant TagProxyHandle::getSameTagsOfDiffFiles(const QStringList &value)
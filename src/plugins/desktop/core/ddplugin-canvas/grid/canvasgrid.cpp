@@ -331,6 +331,7 @@ void CanvasGridPrivate::clean()
     posItem.clear();
     itemPos.clear();
     overload.clear();
+    occupied.clear();
 }
 
 void CanvasGridPrivate::sequence(QStringList sortedItems)
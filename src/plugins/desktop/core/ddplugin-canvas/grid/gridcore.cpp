@@ -4,14 +4,58 @@
 
 #include "gridcore.h"
 
+#include <QtAlgorithms>
+
 uint qHash(const QPoint &key, uint seed)
 {
-    QString val = QString("%1x%2").arg(key.x()).arg(key.y());
-    return qHash<QString>(val, seed);
+    return qHash(qMakePair(key.x(), key.y()), seed);
 }
 
 using namespace ddplugin_canvas;
 
+void GridOccupancy::reset(const QSize &size, int entries)
+{
+    gridSize = size;
+    cellCount = qMax(0, size.width()) * qMax(0, size.height());
+    posCount = entries;
+    words.fill(0, (cellCount + 63) / 64);
+}
+
+void GridOccupancy::set(const QPoint &pos, bool used)
+{
+    if (!CanvasGridSpecialist::isValid(pos, gridSize))
+        return;
+
+    const int cell = toCell(pos);
+    const quint64 bit = quint64(1) << (cell % 64);
+    if (used)
+        words[cell / 64] |= bit;
+    else
+        words[cell / 64] &= ~bit;
+}
+
+/*!
+ * \brief the first void cell not less than \a from, -1 if the surface is full.
+ */
+int GridOccupancy::nextVoid(int from) const
+{
+    from = qMax(from, 0);
+    if (from >= cellCount)
+        return -1;
+
+    int word = from / 64;
+    quint64 free = ~words.at(word) & (~quint64(0) << (from % 64));
+    while (!free) {
+        if (++word >= words.size())
+            return -1;
+        free = ~words.at(word);
+    }
+
+    // the bits after the last cell are always void
+    const int cell = word * 64 + int(qCountTrailingZeroBits(free));
+    return cell < cellCount ? cell : -1;
+}
+
 GridCore::GridCore()
 {
 
@@ -22,6 +66,7 @@ GridCore::GridCore(const GridCore &other)
     , posItem(other.posItem)
     , itemPos(other.itemPos)
     , overload(other.overload)
+    , occupied(other.occupied)
 {
 }
 
@@ -48,38 +93,43 @@ bool GridCore::applay(GridCore *core)
     posItem = core->posItem;
     itemPos = core->itemPos;
     overload = core->overload;
+    occupied = core->occupied;
     return true;
 }
 
 void GridCore::insert(int index, const QPoint &pos, const QString &it)
 {
     itemPos[index].insert(it, pos);
-    posItem[index].insert(pos, it);
+    QHash<QPoint, QString> &usedPos = posItem[index];
+    const int count = usedPos.count();
+    usedPos.insert(pos, it);
+    updateOccupancy(index, pos, true, count, usedPos.count());
 }
 
 void GridCore::remove(int index, const QString &it)
 {
     auto pos = itemPos[index].take(it);
-    posItem[index].remove(pos);
+    QHash<QPoint, QString> &usedPos = posItem[index];
+    const int count = usedPos.count();
+    usedPos.remove(pos);
+    updateOccupancy(index, pos, false, count, usedPos.count());
 }
 
 void GridCore::remove(int index, const QPoint &pos)
 {
-    QString it = posItem[index].take(pos);
+    QHash<QPoint, QString> &usedPos = posItem[index];
+    const int count = usedPos.count();
+    QString it = usedPos.take(pos);
     itemPos[index].remove(it);
+    updateOccupancy(index, pos, false, count, usedPos.count());
 }
 
 QList<QPoint> GridCore::voidPos(int index) const
 {
     QList<QPoint> ret;
-    const QSize &size = surfaces.value(index, QSize(0, 0));
-    const QHash<QPoint, QString> &usedPos = posItem.value(index);
-    for (int x = 0; x < size.width(); ++x)
-        for (int y = 0; y < size.height(); ++y) {
-            QPoint pos(x, y);
-            if (!usedPos.contains(pos))
-                ret.append(pos);
-        }
+    const GridOccupancy &bits = occupancy(index);
+    for (int cell = bits.nextVoid(0); cell >= 0; cell = bits.nextVoid(cell + 1))
+        ret.append(bits.toPos(cell));
 
     return ret;
 }
@@ -87,23 +137,18 @@ QList<QPoint> GridCore::voidPos(int index) const
 bool GridCore::findVoidPos(GridPos &pos) const
 {
     for (int idx : surfaceIndex()) {
-        const QHash<QPoint, QString> &usedPos = posItem.value(idx);
-        const QSize &size = surfaces.value(idx);
-
         // no void pos
         if (isFull(idx))
             continue;
 
         // find first void pos.
-        for (int x = 0; x < size.width(); ++x)
-            for (int y = 0; y < size.height(); ++y) {
-                QPoint curPos(x, y);
-                if (!usedPos.contains(curPos)) {
-                    pos.first = idx;
-                    pos.second = curPos;
-                    return true;
-                }
-            }
+        const GridOccupancy &bits = occupancy(idx);
+        int cell = bits.nextVoid(0);
+        if (cell >= 0) {
+            pos.first = idx;
+            pos.second = bits.toPos(cell);
+            return true;
+        }
     }
 
     return false;
@@ -147,9 +192,49 @@ void GridCore::removeAll(const QStringList &items)
             if (!itemPos[index].contains(it))
                 continue;
             auto pos = itemPos[index].take(it);
-            posItem[index].remove(pos);
+            QHash<QPoint, QString> &usedPos = posItem[index];
+            const int count = usedPos.count();
+            usedPos.remove(pos);
+            updateOccupancy(index, pos, false, count, usedPos.count());
+        }
+    }
+}
+
+const GridOccupancy &GridCore::occupancy(int index) const
+{
+    GridOccupancy &bits = occupied[index];
+    const QSize &size = surfaceSize(index);
+    auto usedPos = posItem.constFind(index);
+    const int count = usedPos == posItem.cend() ? 0 : usedPos->count();
+    if (!bits.isSync(size, count)) {
+        bits.reset(size, count);
+        if (count > 0) {
+            for (auto itor = usedPos->cbegin(); itor != usedPos->cend(); ++itor)
+                bits.set(itor.key(), true);
         }
     }
+
+    return bits;
+}
+
+void GridCore::updateOccupancy(int index, const QPoint &pos, bool used, int oldCount, int newCount)
+{
+    // the used positions are unchanged
+    if (oldCount == newCount)
+        return;
+
+    auto bits = occupied.find(index);
+    if (bits == occupied.end())
+        return;
+
+    // changed without GridCore, rebuild it when used
+    if (!bits->isSync(surfaceSize(index), oldCount)) {
+        occupied.erase(bits);
+        return;
+    }
+
+    bits->set(pos, used);
+    bits->setEntries(newCount);
 }
 
 
@@ -250,16 +335,20 @@ QStringList AppendOper::appendAfter(QStringList items, int index, const QPoint &
     if (items.isEmpty())
         return items;
 
-    QList<QPoint> posList = voidPos(index);
-    for (const QPoint &pos : posList) {
-        if ((pos.x() > begin.x()) || (pos.x() == begin.x() && pos.y() >= begin.y())) {
-            // all items is appenped
-            if (items.isEmpty())
-                return items;
+    // the void positions after \a begin, column by column.
+    const QSize &size = surfaceSize(index);
+    int cell = 0;
+    if (begin.x() >= 0)
+        cell = begin.x() * size.height() + qBound(0, begin.y(), size.height());
 
-            QString &&item = items.takeFirst();
-            insert(index, pos, item);
-        }
+    while (!items.isEmpty()) {
+        cell = occupancy(index).nextVoid(cell);
+        if (cell < 0)
+            break;
+
+        QString &&item = items.takeFirst();
+        insert(index, occupancy(index).toPos(cell), item);
+        ++cell;
     }
 
     return items;
@@ -268,14 +357,13 @@ QStringList AppendOper::appendAfter(QStringList items, int index, const QPoint &
 void AppendOper::append(QStringList items)
 {
     for (int idx : surfaceIndex()) {
-        auto posList = voidPos(idx);
-        for (const QPoint &pos : posList) {
+        for (int cell = occupancy(idx).nextVoid(0); cell >= 0; cell = occupancy(idx).nextVoid(cell + 1)) {
             // all items is appenped
             if (items.isEmpty())
                 return;
 
             QString &&it = items.takeFirst();
-            insert(idx, pos, it);
+            insert(idx, occupancy(idx).toPos(cell), it);
         }
     }
 
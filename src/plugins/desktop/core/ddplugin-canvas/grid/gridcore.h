@@ -9,12 +9,41 @@
 
 #include <QMap>
 #include <QSize>
+#include <QVector>
 
 extern uint qHash(const QPoint &key, uint seed);
 
 namespace ddplugin_canvas {
 
 typedef QPair<int, QPoint> GridPos;
+
+// dense bitmap of the used positions of a surface, the cells are numbered
+// column by column as the items are arranged.
+class GridOccupancy
+{
+public:
+    void reset(const QSize &size, int entries);
+    void set(const QPoint &pos, bool used);
+    int nextVoid(int from) const;
+    inline bool isSync(const QSize &size, int entries) const {
+        return gridSize == size && posCount == entries;
+    }
+    inline void setEntries(int entries) {
+        posCount = entries;
+    }
+    inline int toCell(const QPoint &pos) const {
+        return pos.x() * gridSize.height() + pos.y();
+    }
+    inline QPoint toPos(int cell) const {
+        return QPoint(cell / gridSize.height(), cell % gridSize.height());
+    }
+private:
+    QSize gridSize { 0, 0 };
+    int cellCount { 0 };
+    int posCount { 0 };   // count of posItem, including the positions out of the surface
+    QVector<quint64> words;
+};
+
 class GridCore
 {
 protected:
@@ -50,11 +79,17 @@ public:
     inline void pushOverload(const QStringList &items){
         overload.append(items);
     }
+protected:
+    const GridOccupancy &occupancy(int index) const;
+    void updateOccupancy(int index, const QPoint &pos, bool used, int oldCount, int newCount);
 public:
     QMap<int, QSize> surfaces;
     QMap<int, QHash<QPoint, QString>> posItem;
     QMap<int, QHash<QString, QPoint>> itemPos;
     QStringList overload;
+protected:
+    // index of the void positions in posItem, rebuilt if posItem is changed directly.
+    mutable QHash<int, GridOccupancy> occupied;
 };
 
 class MoveGridOper : public GridCore
@@ -12,6 +12,7 @@
 #include <dfm-base/dfm_global_defines.h>
 #include <dfm-base/utils/fileutils.h>
 #include <dfm-base/utils/thumbnail/thumbnailfactory.h>
+#include <dfm-base/utils/thumbnail/thumbnailhelper.h>
 
 #include <dfm-framework/dpf.h>
 
@@ -237,7 +238,7 @@ void FileInfoModelPrivate::thumbUpdated(const QUrl &url, const QString &thumb)
             return;
     }
     // Creating thumbnail icon in a thread may cause the program to crash
-    QIcon thumbIcon(thumb);
+    QIcon thumbIcon(ThumbnailHelper::thumbnailIcon(thumb));
     if (thumbIcon.isNull())
         return;
 
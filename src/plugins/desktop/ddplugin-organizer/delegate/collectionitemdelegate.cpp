@@ -13,6 +13,7 @@
 #include <dfm-base/base/application/settings.h>
 #include <dfm-base/base/device/deviceutils.h>
 #include <dfm-base/utils/clipboard.h>
+#include <dfm-base/utils/textlayoutcache.h>
 #include <dfm-base/dfm_base_global.h>
 #include <dfm-base/dfm_global_defines.h>
 #include <dfm-base/dfm_event_defines.h>
@@ -24,6 +25,8 @@
 #include <DApplicationHelper>
 
 #include <QPainter>
+#include <QDataStream>
+#include <QtMath>
 #include <QScrollBar>
 
 #include <cmath>
@@ -414,36 +417,56 @@ void CollectionItemDelegate::drawNormlText(QPainter *painter, const QStyleOption
     painter->setPen(option.palette.color(QPalette::Text));
 
     qreal pixelRatio = painter->device()->devicePixelRatioF();
-    QImage textImage((rText.size() * pixelRatio).toSize(), QImage::Format_ARGB32_Premultiplied);
-    textImage.fill(Qt::transparent);
-    textImage.setDevicePixelRatio(pixelRatio);
+    const QSize imageSize = (rText.size() * pixelRatio).toSize();
+    const QRectF layoutRect(QPoint(0, 0), QSizeF(imageSize) / pixelRatio);
+
+    // create text Layout, the text image is painted in the direction of the application.
+    QScopedPointer<ElideTextLayout> layout(d->createTextlayout(index, painter));
+    layout->setAttribute(ElideTextLayout::kTextDirection, QGuiApplication::layoutDirection());
+
+    d->extendLayoutText(parent()->model()->fileInfo(index), layout.data());
+
+    // the text with its shadow, shared by the repaints of the same text
+    const QColor &shadowColor = option.palette.color(QPalette::Shadow);
+    QByteArray key = layout->cacheKey(layoutRect.size(), option.textElideMode);
+    QDataStream(&key, QIODevice::Append) << painter->pen().color().rgba() << shadowColor.rgba() << pixelRatio;
+
+    QPixmap textPixmap = TextLayoutCache::instance()->findPixmap(key);
+    if (textPixmap.isNull()) {
+        QImage textImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+        textImage.fill(Qt::transparent);
+        textImage.setDevicePixelRatio(pixelRatio);
 
-    QPixmap textPixmap;
-    {
         QPainter p(&textImage);
         p.setPen(painter->pen());
         p.setFont(painter->font());
 
-        // create text Layout.
-        QScopedPointer<ElideTextLayout> layout(d->createTextlayout(index, &p));
-
-        d->extendLayoutText(parent()->model()->fileInfo(index), layout.data());
-
         // elide and draw
-        layout->layout(QRectF(QPoint(0, 0), QSizeF(textImage.size()) / pixelRatio), option.textElideMode, &p);
+        layout->layout(layoutRect, option.textElideMode, &p);
         p.end();
 
-        textPixmap = QPixmap::fromImage(textImage);
-        textPixmap.setDevicePixelRatio(pixelRatio);
-        qt_blurImage(textImage, 6, false);
+        QImage shadowImage = textImage;
+        qt_blurImage(shadowImage, 6, false);
 
-        p.begin(&textImage);
+        p.begin(&shadowImage);
         p.setCompositionMode(QPainter::CompositionMode_SourceIn);
-        p.fillRect(textImage.rect(), option.palette.color(QPalette::Shadow));
+        p.fillRect(shadowImage.rect(), shadowColor);
         p.end();
+
+        // the shadow is one pixel below the text
+        QImage image(imageSize + QSize(0, qCeil(pixelRatio)), QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        image.setDevicePixelRatio(pixelRatio);
+        p.begin(&image);
+        p.drawImage(layoutRect.translated(0, 1), shadowImage);
+        p.drawImage(layoutRect, textImage);
+        p.end();
+
+        textPixmap = QPixmap::fromImage(image);
+        textPixmap.setDevicePixelRatio(pixelRatio);
+        TextLayoutCache::instance()->insertPixmap(key, textPixmap);
     }
 
-    painter->drawImage(rText.translated(0, 1), textImage);
     painter->drawPixmap(rText.topLeft(), textPixmap);
     painter->restore();
 }
@@ -20,6 +20,7 @@
 #include <dfm-base/utils/universalutils.h>
 #include <dfm-base/base/application/application.h>
 #include <dfm-base/utils/thumbnail/thumbnailfactory.h>
+#include <dfm-base/utils/thumbnail/thumbnailhelper.h>
 #include <dfm-base/widgets/filemanagerwindowsmanager.h>
 #include <dfm-base/base/configs/dconfig/dconfigmanager.h>
 
@@ -653,7 +654,7 @@ void FileViewModel::updateThumbnailIcon(const QModelIndex &index, const QString
         return;
 
     // Creating thumbnail icon in a thread may cause the program to crash
-    QIcon thumbIcon(thumb);
+    QIcon thumbIcon(ThumbnailHelper::thumbnailIcon(thumb));
     if (thumbIcon.isNull())
         return;
 
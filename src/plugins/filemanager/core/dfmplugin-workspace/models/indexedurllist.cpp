@@ -0,0 +1,206 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "indexedurllist.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace dfmplugin_workspace;
+
+// gap between two neighbouring order keys after renumbering,
+// it leaves room for 32 inserts at the same position before spreading the keys again
+static constexpr quint64 kOrderStep { quint64(1) << 32 };
+// the keys around an insert are only spread when that leaves at least this gap between them
+static constexpr quint64 kMinSpreadGap { quint64(1) << 16 };
+// rows on each side of the insert spread first, doubled until the keys fit
+static constexpr int kMinSpreadWidth { 16 };
+
+IndexedUrlList::IndexedUrlList(const QList<QUrl> &urls)
+{
+    append(urls);
+}
+
+IndexedUrlList &IndexedUrlList::operator=(const QList<QUrl> &urls)
+{
+    clear();
+    append(urls);
+    return *this;
+}
+
+int IndexedUrlList::count() const
+{
+    return urls.count();
+}
+
+int IndexedUrlList::length() const
+{
+    return urls.length();
+}
+
+bool IndexedUrlList::isEmpty() const
+{
+    return urls.isEmpty();
+}
+
+const QUrl &IndexedUrlList::at(int row) const
+{
+    return urls.at(row);
+}
+
+const QUrl &IndexedUrlList::first() const
+{
+    return urls.first();
+}
+
+const QUrl &IndexedUrlList::last() const
+{
+    return urls.last();
+}
+
+const QList<QUrl> &IndexedUrlList::toList() const
+{
+    return urls;
+}
+
+bool IndexedUrlList::contains(const QUrl &url) const
+{
+    return urlOrders.contains(url);
+}
+
+int IndexedUrlList::indexOf(const QUrl &url) const
+{
+    auto it = urlOrders.constFind(url);
+    if (it == urlOrders.constEnd())
+        return -1;
+
+    auto pos = std::lower_bound(orders.cbegin(), orders.cend(), it.value());
+    if (pos == orders.cend() || *pos != it.value())
+        return -1;
+
+    return static_cast<int>(pos - orders.cbegin());
+}
+
+bool IndexedUrlList::append(const QUrl &url)
+{
+    return insert(urls.count(), url);
+}
+
+void IndexedUrlList::append(const QList<QUrl> &urls)
+{
+    this->urls.reserve(this->urls.count() + urls.count());
+    orders.reserve(orders.count() + urls.count());
+    urlOrders.reserve(urlOrders.count() + urls.count());
+    for (const auto &url : urls)
+        append(url);
+}
+
+bool IndexedUrlList::insert(int row, const QUrl &url)
+{
+    if (row < 0 || row > urls.count() || urlOrders.contains(url))
+        return false;
+
+    if (row == urls.count()) {
+        if (!orders.isEmpty() && orders.last() > std::numeric_limits<quint64>::max() - kOrderStep)
+            renumber();
+    } else {
+        const quint64 prev = row > 0 ? orders.at(row - 1) : 0;
+        if (orders.at(row) - prev < 2)
+            spreadAround(row);
+    }
+
+    quint64 order = 0;
+    if (row == urls.count()) {
+        order = (orders.isEmpty() ? 0 : orders.last()) + kOrderStep;
+    } else {
+        const quint64 prev = row > 0 ? orders.at(row - 1) : 0;
+        order = prev + (orders.at(row) - prev) / 2;
+    }
+
+    urls.insert(row, url);
+    orders.insert(row, order);
+    urlOrders.insert(url, order);
+    return true;
+}
+
+void IndexedUrlList::removeAt(int row)
+{
+    urlOrders.remove(urls.at(row));
+    urls.removeAt(row);
+    orders.remove(row);
+}
+
+QUrl IndexedUrlList::takeAt(int row)
+{
+    QUrl url = urls.at(row);
+    removeAt(row);
+    return url;
+}
+
+void IndexedUrlList::clear()
+{
+    urls.clear();
+    orders.clear();
+    urlOrders.clear();
+}
+
+IndexedUrlList::const_iterator IndexedUrlList::begin() const
+{
+    return urls.cbegin();
+}
+
+IndexedUrlList::const_iterator IndexedUrlList::end() const
+{
+    return urls.cend();
+}
+
+/*!
+ * \brief IndexedUrlList::spreadAround Spread the keys of the rows around the row evenly over
+ * the range between their neighbours, so that there is a gap in front of the row again.
+ * The range grows until it is wide enough, all rows are renumbered at last.
+ */
+void IndexedUrlList::spreadAround(int row)
+{
+    const int total = orders.count();
+    for (int width = kMinSpreadWidth; width < total; width *= 2) {
+        // the keys of [first, last) are rewritten
+        const int first = qMax(0, row - width);
+        const int last = qMin(total, row + width);
+        const quint64 count = quint64(last - first);
+        const quint64 lower = first > 0 ? orders.at(first - 1) : 0;
+        quint64 upper = 0;
+        if (last < total) {
+            upper = orders.at(last);
+        } else {
+            // the tail may move up as long as the keys do not overflow
+            if (lower > std::numeric_limits<quint64>::max() - (count + 1) * kOrderStep)
+                break;
+            upper = lower + (count + 1) * kOrderStep;
+        }
+
+        const quint64 step = (upper - lower) / (count + 1);
+        if (step < kMinSpreadGap)
+            continue;
+
+        quint64 order = lower;
+        for (int i = first; i < last; ++i) {
+            order += step;
+            orders[i] = order;
+            urlOrders[urls.at(i)] = order;
+        }
+        return;
+    }
+
+    renumber();
+}
+
+void IndexedUrlList::renumber()
+{
+    quint64 order = 0;
+    for (int i = 0; i < urls.count(); ++i) {
+        order += kOrderStep;
+        orders[i] = order;
+        urlOrders[urls.at(i)] = order;
+    }
+}
@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef INDEXEDURLLIST_H
+#define INDEXEDURLLIST_H
+
+#include "dfmplugin_workspace_global.h"
+
+#include <QUrl>
+#include <QList>
+#include <QHash>
+#include <QVector>
+
+namespace dfmplugin_workspace {
+
+// An ordered list of unique urls which answers `indexOf` and `contains`
+// without scanning the list.
+// Every url gets an order key which stays stable while rows are inserted or
+// removed around it, so the row of an url is a binary search over the keys.
+class IndexedUrlList
+{
+public:
+    using const_iterator = QList<QUrl>::const_iterator;
+
+    IndexedUrlList() = default;
+    IndexedUrlList(const QList<QUrl> &urls);
+    IndexedUrlList &operator=(const QList<QUrl> &urls);
+
+    int count() const;
+    int length() const;
+    bool isEmpty() const;
+    const QUrl &at(int row) const;
+    const QUrl &first() const;
+    const QUrl &last() const;
+    const QList<QUrl> &toList() const;
+
+    bool contains(const QUrl &url) const;
+    int indexOf(const QUrl &url) const;
+
+    bool append(const QUrl &url);
+    void append(const QList<QUrl> &urls);
+    bool insert(int row, const QUrl &url);
+    void removeAt(int row);
+    QUrl takeAt(int row);
+    void clear();
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+    void spreadAround(int row);
+    void renumber();
+
+private:
+    QList<QUrl> urls {};
+    QVector<quint64> orders {};
+    QHash<QUrl, quint64> urlOrders {};
+};
+
+}
+
+#endif   // INDEXEDURLLIST_H
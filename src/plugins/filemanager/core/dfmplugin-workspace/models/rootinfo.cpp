@@ -21,6 +21,18 @@
 using namespace dfmbase;
 using namespace dfmplugin_workspace;
 
+static bool isSameSortInfo(const SortInfoPointer &left, const SortInfoPointer &right)
+{
+    return left->fileSize() == right->fileSize()
+            && left->isFile() == right->isFile()
+            && left->isDir() == right->isDir()
+            && left->isSymLink() == right->isSymLink()
+            && left->isHide() == right->isHide()
+            && left->isReadable() == right->isReadable()
+            && left->isWriteable() == right->isWriteable()
+            && left->isExecutable() == right->isExecutable();
+}
+
 RootInfo::RootInfo(const QUrl &u, const bool canCache, QObject *parent)
     : QObject(parent), url(u), canCache(canCache)
 {
@@ -32,6 +44,7 @@ RootInfo::~RootInfo()
 {
     cancelWatcherEvent = true;
     watcherEventFuture.waitForFinished();
+    snapshotFuture.waitForFinished();
     for (const auto &thread : traversalThreads) {
         thread->traversalThread->stop();
         thread->traversalThread->wait();
@@ -88,9 +101,56 @@ void RootInfo::startWork(const QString &key, const bool getCache)
         return handleGetSourceData(key);
 
     traversaling = true;
+
+    bool isEmpty = false;
+    {
+        QReadLocker lk(&childrenLock);
+        isEmpty = childrenUrlList.isEmpty();
+    }
+
+    // show the snapshot of the last listing first, the traversal always reconciles it:
+    // the mtime of a directory misses the changes of its files, and is unreliable on network mounts
+    if (isEmpty && DirListingCache::instance()->isEnabled(url)) {
+        snapshotFuture = QtConcurrent::run([this, key]() {
+            DirListingSnapshot snapshot;
+            if (DirListingCache::instance()->load(url, &snapshot)) {
+                QMutexLocker lk(&snapshotMutex);
+                loadedSnapshot = snapshot;
+            }
+            // shown in the thread of the root info
+            metaObject()->invokeMethod(this, QT_STRINGIFY(showListingSnapshot),
+                                       Qt::QueuedConnection, Q_ARG(QString, key));
+        });
+        return;
+    }
+
+    startTraversal(key);
+}
+
+void RootInfo::startTraversal(const QString &key)
+{
+    if (!traversalThreads.contains(key))
+        return;
+
     traversalThreads.value(key)->traversalThread->start();
 }
 
+void RootInfo::showListingSnapshot(const QString &key)
+{
+    DirListingSnapshot snapshot;
+    {
+        QMutexLocker lk(&snapshotMutex);
+        snapshot = loadedSnapshot;
+        loadedSnapshot = DirListingSnapshot();
+    }
+
+    if (!traversalThreads.contains(key))
+        return;
+
+    applyListingSnapshot(key, snapshot);
+    startTraversal(key);
+}
+
 void RootInfo::startWatcher()
 {
     if (watcher)
@@ -145,6 +205,13 @@ void RootInfo::reset()
         sourceDataList.clear();
     }
 
+    {
+        QMutexLocker lk(&snapshotMutex);
+        snapshotChildren.clear();
+    }
+    snapshotShown = false;
+    listingChanged = true;
+
     traversaling = false;
     traversalFinish = false;
 }
@@ -282,25 +349,95 @@ void RootInfo::handleTraversalResults(QList<FileInfoPointer> children, const QSt
 
     if (sortInfos.length() > 0)
         Q_EMIT iteratorAddFiles(currentKey(travseToken), sortInfos, infos);
+
+    // files of the snapshot which are iterated again, notify the changed ones
+    if (!snapshotShown)
+        return;
+
+    QList<SortInfoPointer> updated;
+    {
+        QMutexLocker lk(&snapshotMutex);
+        for (const auto &sortInfo : sortInfos) {
+            auto it = snapshotChildren.find(sortInfo->fileUrl());
+            if (it == snapshotChildren.end()) {
+                listingChanged = true;
+                continue;
+            }
+            if (!isSameSortInfo(it.value(), sortInfo))
+                updated.append(sortInfo);
+            snapshotChildren.erase(it);
+        }
+    }
+    if (!updated.isEmpty())
+        listingChanged = true;
+
+    for (const auto &sortInfo : updated)
+        Q_EMIT watcherUpdateFile(sortInfo);
 }
 
 void RootInfo::handleTraversalLocalResult(QList<SortInfoPointer> children,
                                           dfmio::DEnumerator::SortRoleCompareFlag sortRole,
                                           Qt::SortOrder sortOrder, bool isMixDirAndFile, const QString &travseToken)
 {
+    if (sortRole != originSortRole || sortOrder != originSortOrder || isMixDirAndFile != originMixSort)
+        listingChanged = true;
     originSortRole = sortRole;
     originSortOrder = sortOrder;
     originMixSort = isMixDirAndFile;
 
-    addChildren(children);
-    traversaling = false;
+    if (snapshotShown) {
+        reconcileListingSnapshot(children);
+        traversaling = false;
+    } else {
+        addChildren(children);
+        traversaling = false;
 
-    Q_EMIT iteratorLocalFiles(currentKey(travseToken), children, originSortRole, originSortOrder, originMixSort);
+        Q_EMIT iteratorLocalFiles(currentKey(travseToken), children, originSortRole, originSortOrder, originMixSort);
+    }
 }
 
 void RootInfo::handleTraversalFinish(const QString &travseToken)
 {
     traversaling = false;
+
+    // iterated one by one, the files of the snapshot which are not iterated again are gone
+    QList<SortInfoPointer> removed;
+    {
+        QMutexLocker lk(&snapshotMutex);
+        removed = snapshotChildren.values();
+        snapshotChildren.clear();
+    }
+    if (!removed.isEmpty()) {
+        {
+            QWriteLocker lk(&childrenLock);
+            for (const auto &sortInfo : removed) {
+                const int index = childrenUrlList.indexOf(sortInfo->fileUrl());
+                if (index < 0)
+                    continue;
+                childrenUrlList.removeAt(index);
+                sourceDataList.removeAt(index);
+            }
+        }
+        Q_EMIT watcherRemoveFiles(removed);
+        listingChanged = true;
+    }
+
+    if (listingChanged && DirListingCache::instance()->isEnabled(url)) {
+        listingChanged = false;
+        QList<SortInfoPointer> children;
+        {
+            QReadLocker lk(&childrenLock);
+            children = sourceDataList;
+        }
+        const QUrl dirUrl = url;
+        const auto sortRole = originSortRole;
+        const auto sortOrder = originSortOrder;
+        const bool isMixDirAndFile = originMixSort;
+        QtConcurrent::run([dirUrl, children, sortRole, sortOrder, isMixDirAndFile]() {
+            DirListingCache::instance()->save(dirUrl, children, sortRole, sortOrder, isMixDirAndFile);
+        });
+    }
+
     emit traversalFinished(currentKey(travseToken));
     traversalFinish = true;
 }
@@ -316,6 +453,74 @@ void RootInfo::handleGetSourceData(const QString &currentToken)
     emit sourceDatas(currentToken, newDatas, originSortRole, originSortOrder, originMixSort, !traversaling);
 }
 
+void RootInfo::applyListingSnapshot(const QString &key, const DirListingSnapshot &snapshot)
+{
+    if (snapshot.children.isEmpty())
+        return;
+
+    {
+        QMutexLocker lk(&snapshotMutex);
+        for (const auto &sortInfo : snapshot.children)
+            snapshotChildren.insert(sortInfo->fileUrl(), sortInfo);
+    }
+
+    originSortRole = snapshot.sortRole;
+    originSortOrder = snapshot.sortOrder;
+    originMixSort = snapshot.isMixDirAndFile;
+    addChildren(snapshot.children);
+    snapshotShown = true;
+    listingChanged = false;
+
+    qInfo() << "dir listing snapshot loaded, file count: " << snapshot.children.count()
+            << " url: " << url << " up to date: " << snapshot.upToDate;
+
+    Q_EMIT iteratorLocalFiles(key, snapshot.children, originSortRole, originSortOrder, originMixSort);
+}
+
+void RootInfo::reconcileListingSnapshot(const QList<SortInfoPointer> &children)
+{
+    QHash<QUrl, SortInfoPointer> snapshot;
+    {
+        QMutexLocker lk(&snapshotMutex);
+        snapshot.swap(snapshotChildren);
+    }
+
+    QList<SortInfoPointer> added;
+    QList<SortInfoPointer> updated;
+    for (const auto &sortInfo : children) {
+        if (!sortInfo)
+            continue;
+        auto it = snapshot.find(sortInfo->fileUrl());
+        if (it == snapshot.end()) {
+            added.append(sortInfo);
+            continue;
+        }
+        if (!isSameSortInfo(it.value(), sortInfo))
+            updated.append(sortInfo);
+        snapshot.erase(it);
+    }
+    const QList<SortInfoPointer> &removed = snapshot.values();
+
+    {
+        QWriteLocker lk(&childrenLock);
+        childrenUrlList.clear();
+        sourceDataList.clear();
+    }
+    addChildren(children);
+
+    qInfo() << "dir listing snapshot reconciled, added: " << added.count() << " removed: " << removed.count()
+            << " updated: " << updated.count() << " url: " << url;
+    if (!added.isEmpty() || !removed.isEmpty() || !updated.isEmpty())
+        listingChanged = true;
+
+    if (!removed.isEmpty())
+        Q_EMIT watcherRemoveFiles(removed);
+    if (!added.isEmpty())
+        Q_EMIT watcherAddFiles(added);
+    for (const auto &sortInfo : updated)
+        Q_EMIT watcherUpdateFile(sortInfo);
+}
+
 void RootInfo::initConnection(const TraversalThreadManagerPointer &traversalThread)
 {
     connect(traversalThread.data(), &TraversalDirThreadManager::updateChildrenManager,
@@ -7,6 +7,7 @@
 
 #include "dfmplugin_workspace_global.h"
 #include "utils/traversaldirthreadmanager.h"
+#include "utils/dirlistingcache.h"
 
 #include <dfm-base/dfm_base_global.h>
 #include <dfm-base/utils/traversaldirthread.h>
@@ -95,9 +96,13 @@ public Q_SLOTS:
     void handleGetSourceData(const QString &currentToken);
 
     void startWatcher();
+    void startTraversal(const QString &key);
+    void showListingSnapshot(const QString &key);
 
 private:
     void initConnection(const TraversalThreadManagerPointer &traversalThread);
+    void applyListingSnapshot(const QString &key, const DirListingSnapshot &snapshot);
+    void reconcileListingSnapshot(const QList<SortInfoPointer> &children);
 
     void addChildren(const QList<QUrl> &urlList);
     void addChildren(const QList<FileInfoPointer> &children);
@@ -141,6 +146,16 @@ private:
     QMutex watcherEventMutex;
     QAtomicInteger<bool> processFileEventRuning = false;
 
+    // children of the listing snapshot which are not iterated again yet
+    QMutex snapshotMutex;
+    QHash<QUrl, SortInfoPointer> snapshotChildren {};
+    // read in the background, shown in the thread of the root info
+    DirListingSnapshot loadedSnapshot;
+    QFuture<void> snapshotFuture;
+    std::atomic_bool snapshotShown { false };
+    // the snapshot is written again only when the traversal finds a change
+    std::atomic_bool listingChanged { true };
+
     QList<TraversalThreadPointer> discardedThread {};
     QList<QSharedPointer<QThread>> threads {};
 };
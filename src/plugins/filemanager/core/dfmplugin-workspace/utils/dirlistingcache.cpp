@@ -0,0 +1,289 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dirlistingcache.h"
+
+#include <dfm-base/dfm_global_defines.h>
+#include <dfm-base/base/standardpaths.h>
+#include <dfm-base/base/configs/dconfig/dconfigmanager.h>
+
+#include <QCryptographicHash>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QDebug>
+
+#include <sys/stat.h>
+
+using namespace dfmbase;
+using namespace dfmplugin_workspace;
+
+static constexpr char kListingCacheEnable[] { "dfm.listing.cache.enable" };
+static constexpr char kListingCacheSize[] { "dfm.listing.cache.size" };
+static constexpr char kSnapshotMagic[8] { 'D', 'F', 'M', 'L', 'I', 'S', 'T', '\0' };
+static constexpr quint32 kSnapshotVersion { 2 };
+// small directories are enumerated fast enough
+static constexpr int kMinSnapshotCount { 5000 };
+static constexpr qint64 kDefaultSizeBudget { 64 * 1024 * 1024 };
+
+namespace {
+enum EntryFlag : quint32 {
+    kEntryFile = 1 << 0,
+    kEntryDir = 1 << 1,
+    kEntrySymLink = 1 << 2,
+    kEntryHide = 1 << 3,
+    kEntryReadable = 1 << 4,
+    kEntryWriteable = 1 << 5,
+    kEntryExecutable = 1 << 6,
+};
+
+// the snapshot file is the header, `count` entries and the utf-8 names,
+// all offsets are relative to the start of the names
+struct SnapshotHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 count;
+    quint64 device;
+    quint64 inode;
+    qint64 mtimeSec;
+    qint64 mtimeNsec;
+    qint32 sortRole;
+    qint32 sortOrder;
+    quint32 mixDirAndFile;
+    quint32 pathSize;
+    quint64 namesSize;
+};
+
+struct SnapshotEntry
+{
+    qint64 size;
+    quint64 nameOffset;
+    quint32 nameSize;
+    quint32 flags;
+};
+
+bool dirStat(const QString &path, struct stat *st)
+{
+    return ::stat(path.toLocal8Bit().constData(), st) == 0 && S_ISDIR(st->st_mode);
+}
+}   // namespace
+
+DirListingCache *DirListingCache::instance()
+{
+    static DirListingCache ins;
+    return &ins;
+}
+
+DirListingCache::DirListingCache()
+{
+    cacheDir = StandardPaths::location(StandardPaths::kCachePath) + "listing";
+    QDir().mkpath(cacheDir);
+}
+
+bool DirListingCache::isEnabled(const QUrl &dirUrl) const
+{
+    if (dirUrl.scheme() != Global::Scheme::kFile)
+        return false;
+
+    return DConfigManager::instance()->value(kDefaultCfgPath, kListingCacheEnable, true).toBool();
+}
+
+bool DirListingCache::load(const QUrl &dirUrl, DirListingSnapshot *snapshot)
+{
+    const QString &dirPath = dirUrl.path();
+    struct stat st;
+    if (!snapshot || !dirStat(dirPath, &st))
+        return false;
+
+    QMutexLocker lk(&mutex);
+    QFile file(snapshotPath(dirPath));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 fileSize = file.size();
+    if (fileSize < qint64(sizeof(SnapshotHeader)))
+        return false;
+
+    const uchar *data = file.map(0, fileSize);
+    if (!data)
+        return false;
+
+    bool ok = false;
+    do {
+        SnapshotHeader header;
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 || header.version != kSnapshotVersion)
+            break;
+
+        const qint64 namesStart = qint64(sizeof(SnapshotHeader)) + qint64(header.count) * qint64(sizeof(SnapshotEntry));
+        if (namesStart + qint64(header.namesSize) != fileSize || header.pathSize > header.namesSize)
+            break;
+
+        const char *names = reinterpret_cast<const char *>(data + namesStart);
+        // another directory with the same hash, or the directory was replaced or mounted over
+        if (QString::fromUtf8(names, int(header.pathSize)) != dirPath
+            || header.device != quint64(st.st_dev) || header.inode != quint64(st.st_ino))
+            break;
+
+        const QString prefix = dirPath.endsWith(QDir::separator()) ? dirPath : dirPath + QDir::separator();
+        QList<SortInfoPointer> children;
+        children.reserve(int(header.count));
+        const uchar *entries = data + sizeof(SnapshotHeader);
+        bool broken = false;
+        for (quint32 i = 0; i < header.count; ++i) {
+            SnapshotEntry entry;
+            memcpy(&entry, entries + i * sizeof(SnapshotEntry), sizeof(entry));
+            if (entry.nameOffset + entry.nameSize > header.namesSize) {
+                broken = true;
+                break;
+            }
+
+            SortInfoPointer sortInfo(new SortFileInfo);
+            sortInfo->setUrl(QUrl::fromLocalFile(prefix + QString::fromUtf8(names + entry.nameOffset, int(entry.nameSize))));
+            sortInfo->setSize(entry.size);
+            sortInfo->setFile(entry.flags & kEntryFile);
+            sortInfo->setDir(entry.flags & kEntryDir);
+            sortInfo->setSymlink(entry.flags & kEntrySymLink);
+            sortInfo->setHide(entry.flags & kEntryHide);
+            sortInfo->setReadable(entry.flags & kEntryReadable);
+            sortInfo->setWriteable(entry.flags & kEntryWriteable);
+            sortInfo->setExecutable(entry.flags & kEntryExecutable);
+            children.append(sortInfo);
+        }
+        if (broken)
+            break;
+
+        snapshot->children = children;
+        snapshot->sortRole = static_cast<dfmio::DEnumerator::SortRoleCompareFlag>(header.sortRole);
+        snapshot->sortOrder = static_cast<Qt::SortOrder>(header.sortOrder);
+        snapshot->isMixDirAndFile = header.mixDirAndFile;
+        snapshot->upToDate = header.mtimeSec == qint64(st.st_mtim.tv_sec) && header.mtimeNsec == qint64(st.st_mtim.tv_nsec);
+        ok = true;
+    } while (false);
+
+    file.unmap(const_cast<uchar *>(data));
+    if (!ok) {
+        file.remove();
+        return false;
+    }
+
+    // the modification time of a snapshot is its last use for eviction
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+void DirListingCache::save(const QUrl &dirUrl, const QList<SortInfoPointer> &children,
+                           const dfmio::DEnumerator::SortRoleCompareFlag sortRole,
+                           const Qt::SortOrder sortOrder, const bool isMixDirAndFile)
+{
+    if (children.count() < kMinSnapshotCount) {
+        remove(dirUrl);
+        return;
+    }
+
+    const QString &dirPath = dirUrl.path();
+    struct stat st;
+    if (!dirStat(dirPath, &st))
+        return;
+
+    const QString prefix = dirPath.endsWith(QDir::separator()) ? dirPath : dirPath + QDir::separator();
+    QByteArray names = dirPath.toUtf8();
+    QByteArray entries;
+    entries.reserve(children.count() * int(sizeof(SnapshotEntry)));
+    names.reserve(names.size() + children.count() * 32);
+
+    SnapshotHeader header;
+    memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kSnapshotVersion;
+    header.count = 0;
+    header.device = quint64(st.st_dev);
+    header.inode = quint64(st.st_ino);
+    header.mtimeSec = qint64(st.st_mtim.tv_sec);
+    header.mtimeNsec = qint64(st.st_mtim.tv_nsec);
+    header.sortRole = static_cast<qint32>(sortRole);
+    header.sortOrder = static_cast<qint32>(sortOrder);
+    header.mixDirAndFile = isMixDirAndFile;
+    header.pathSize = quint32(names.size());
+
+    for (const auto &sortInfo : children) {
+        if (!sortInfo)
+            continue;
+        const QString &path = sortInfo->fileUrl().path();
+        if (!path.startsWith(prefix))
+            continue;
+
+        const QByteArray &name = path.mid(prefix.length()).toUtf8();
+        SnapshotEntry entry;
+        entry.size = sortInfo->fileSize();
+        entry.nameOffset = quint64(names.size());
+        entry.nameSize = quint32(name.size());
+        entry.flags = (sortInfo->isFile() ? kEntryFile : 0)
+                | (sortInfo->isDir() ? kEntryDir : 0)
+                | (sortInfo->isSymLink() ? kEntrySymLink : 0)
+                | (sortInfo->isHide() ? kEntryHide : 0)
+                | (sortInfo->isReadable() ? kEntryReadable : 0)
+                | (sortInfo->isWriteable() ? kEntryWriteable : 0)
+                | (sortInfo->isExecutable() ? kEntryExecutable : 0);
+        names.append(name);
+        entries.append(reinterpret_cast<const char *>(&entry), sizeof(entry));
+        ++header.count;
+    }
+    header.namesSize = quint64(names.size());
+
+    {
+        QMutexLocker lk(&mutex);
+        QSaveFile file(snapshotPath(dirPath));
+        if (!file.open(QIODevice::WriteOnly))
+            return;
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(entries);
+        file.write(names);
+        if (!file.commit()) {
+            qWarning() << "save dir listing snapshot failed, url: " << dirUrl;
+            return;
+        }
+    }
+
+    evict();
+}
+
+void DirListingCache::remove(const QUrl &dirUrl)
+{
+    QMutexLocker lk(&mutex);
+    QFile::remove(snapshotPath(dirUrl.path()));
+}
+
+QString DirListingCache::snapshotPath(const QString &dirPath) const
+{
+    const QByteArray &hash = QCryptographicHash::hash(dirPath.toUtf8(), QCryptographicHash::Md5).toHex();
+    return cacheDir + QDir::separator() + QString::fromLatin1(hash);
+}
+
+qint64 DirListingCache::sizeBudget() const
+{
+    // in MB
+    bool ok = false;
+    const qint64 size = DConfigManager::instance()->value(kDefaultCfgPath, kListingCacheSize).toLongLong(&ok);
+    return ok && size > 0 ? size * 1024 * 1024 : kDefaultSizeBudget;
+}
+
+void DirListingCache::evict()
+{
+    QMutexLocker lk(&mutex);
+    // least recently used first
+    QFileInfoList snapshots = QDir(cacheDir).entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 total = 0;
+    for (const auto &info : snapshots)
+        total += info.size();
+
+    const qint64 budget = sizeBudget();
+    for (const auto &info : snapshots) {
+        if (total <= budget)
+            break;
+        total -= info.size();
+        QFile::remove(info.absoluteFilePath());
+    }
+}
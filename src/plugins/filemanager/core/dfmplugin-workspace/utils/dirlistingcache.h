@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DIRLISTINGCACHE_H
+#define DIRLISTINGCACHE_H
+
+#include "dfmplugin_workspace_global.h"
+
+#include <dfm-base/interfaces/sortfileinfo.h>
+
+#include <dfm-io/denumerator.h>
+
+#include <QUrl>
+#include <QMutex>
+
+namespace dfmplugin_workspace {
+
+struct DirListingSnapshot
+{
+    QList<SortInfoPointer> children;
+    dfmio::DEnumerator::SortRoleCompareFlag sortRole { dfmio::DEnumerator::SortRoleCompareFlag::kSortRoleCompareDefault };
+    Qt::SortOrder sortOrder { Qt::AscendingOrder };
+    bool isMixDirAndFile { false };
+    // the mtime of the directory is the same as the one of the snapshot
+    bool upToDate { false };
+};
+
+// On-disk snapshots of big local directory listings, so that a directory
+// can be shown before its enumeration is finished after a restart.
+// One snapshot file per directory keyed by the path, it is dropped when the
+// device or the inode of the directory changed. It is written again only when
+// the enumeration found the listing changed. Snapshots are evicted by last use when the
+// cache grows over its size budget.
+class DirListingCache
+{
+public:
+    static DirListingCache *instance();
+
+    bool isEnabled(const QUrl &dirUrl) const;
+    bool load(const QUrl &dirUrl, DirListingSnapshot *snapshot);
+    void save(const QUrl &dirUrl, const QList<SortInfoPointer> &children,
+              const dfmio::DEnumerator::SortRoleCompareFlag sortRole,
+              const Qt::SortOrder sortOrder,
+              const bool isMixDirAndFile);
+    void remove(const QUrl &dirUrl);
+
+private:
+    DirListingCache();
+
+    QString snapshotPath(const QString &dirPath) const;
+    qint64 sizeBudget() const;
+    void evict();
+
+private:
+    QString cacheDir;
+    QMutex mutex;
+};
+
+}
+
+#endif   // DIRLISTINGCACHE_H
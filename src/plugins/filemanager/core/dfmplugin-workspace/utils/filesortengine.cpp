@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "filesortengine.h"
+
+#include <dfm-base/utils/fileutils.h>
+
+#include <QtConcurrent>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <algorithm>
+
+using namespace dfmbase;
+using namespace dfmbase::Global;
+using namespace dfmplugin_workspace;
+
+// below this count a chunk is not worth a thread
+static constexpr int kMinChunkSize { 2048 };
+
+FileSortEngine::FileSortEngine(const ItemRoles role, const Qt::SortOrder order,
+                               const bool isMixDirAndFile, const std::atomic_bool &canceled)
+    : role(role), order(order), isMixDirAndFile(isMixDirAndFile), canceled(canceled)
+{
+}
+
+FileSortKey FileSortEngine::makeKey(const QUrl &url, const FileInfoPointer &info, const QVariant &data,
+                                    const SortInfoPointer &sortInfo)
+{
+    FileSortKey key;
+    key.url = url;
+    key.sortInfo = sortInfo;
+    if (!info)
+        return key;
+
+    key.valid = true;
+    key.data = data.toString();
+    key.displayName = info->displayOf(DisPlayInfoType::kFileDisplayName);
+    key.size = info->size();
+    key.isDir = info->isAttributes(OptInfoType::kIsDir);
+    return key;
+}
+
+QByteArray FileSortEngine::nameKeyOf(const SortInfoPointer &sortInfo, const QString &name)
+{
+    return sortInfo ? sortInfo->nameSortKey(name) : FileUtils::sortKeyOfString(name);
+}
+
+QByteArray FileSortEngine::dataKeyOf(const SortInfoPointer &sortInfo, const QString &data)
+{
+    return sortInfo ? sortInfo->dataSortKey(data) : FileUtils::sortKeyOfString(data);
+}
+
+bool FileSortEngine::sort(QVector<FileSortKey> &keys) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    makeStringKeys(keys);
+    if (canceled)
+        return false;
+
+    auto cmp = [this](const FileSortKey &left, const FileSortKey &right) {
+        return before(left, right);
+    };
+
+    const int total = keys.count();
+    const int chunkCount = qMin(QThread::idealThreadCount(), total / kMinChunkSize);
+    if (chunkCount <= 1) {
+        std::stable_sort(keys.begin(), keys.end(), cmp);
+        elapsed = timer.elapsed();
+        return !canceled;
+    }
+
+    QVector<int> bounds;
+    for (int i = 0; i < chunkCount; ++i)
+        bounds.append(static_cast<int>(qint64(total) * i / chunkCount));
+    bounds.append(total);
+
+    FileSortKey *data = keys.data();
+    QList<QFuture<void>> futures;
+    for (int i = 0; i < chunkCount; ++i) {
+        const int first = bounds.at(i);
+        const int last = bounds.at(i + 1);
+        futures.append(QtConcurrent::run([data, first, last, cmp]() {
+            std::stable_sort(data + first, data + last, cmp);
+        }));
+    }
+    for (auto &future : futures)
+        future.waitForFinished();
+
+    // merge neighbouring chunks pairwise until one run is left
+    while (bounds.count() > 2 && !canceled) {
+        futures.clear();
+        QVector<int> merged;
+        int i = 0;
+        for (; i + 2 < bounds.count(); i += 2) {
+            const int first = bounds.at(i);
+            const int middle = bounds.at(i + 1);
+            const int last = bounds.at(i + 2);
+            futures.append(QtConcurrent::run([data, first, middle, last, cmp]() {
+                std::inplace_merge(data + first, data + middle, data + last, cmp);
+            }));
+            merged.append(first);
+        }
+        // the odd chunk waits for the next round
+        if (i < bounds.count() - 1)
+            merged.append(bounds.at(i));
+        merged.append(total);
+
+        for (auto &future : futures)
+            future.waitForFinished();
+        bounds = merged;
+    }
+
+    elapsed = timer.elapsed();
+    return !canceled;
+}
+
+qint64 FileSortEngine::lastSortElapsed() const
+{
+    return elapsed;
+}
+
+// the string keys are made once per file instead of once per comparison,
+// and kept in the sort info of the file for the next sort and for FileSortWorker::lessThan
+void FileSortEngine::makeStringKeys(QVector<FileSortKey> &keys) const
+{
+    auto makeKeys = [this](FileSortKey &key) {
+        if (canceled || !key.valid)
+            return;
+        key.nameKey = nameKeyOf(key.sortInfo, key.displayName);
+        if (role != kItemFileSizeRole)
+            key.dataKey = key.data == key.displayName ? key.nameKey : dataKeyOf(key.sortInfo, key.data);
+    };
+
+    if (keys.count() < kMinChunkSize)
+        std::for_each(keys.begin(), keys.end(), makeKeys);
+    else
+        QtConcurrent::blockingMap(keys, makeKeys);
+}
+
+// same rules as FileSortWorker::lessThan, without the dir/file handling
+bool FileSortEngine::lessThan(const FileSortKey &left, const FileSortKey &right) const
+{
+    // When the selected sort attribute value is the same, sort by file name
+    if (left.data == right.data)
+        return left.nameKey < right.nameKey;
+
+    if (role == kItemFileSizeRole)
+        return left.size < right.size;
+
+    return left.dataKey < right.dataKey;
+}
+
+bool FileSortEngine::before(const FileSortKey &left, const FileSortKey &right) const
+{
+    if (canceled)
+        return false;
+
+    if (!left.valid || !right.valid)
+        return false;
+
+    // The folder is fixed in the front position
+    if (!isMixDirAndFile && (left.isDir ^ right.isDir))
+        return left.isDir;
+
+    return order == Qt::AscendingOrder ? lessThan(left, right) : lessThan(right, left);
+}
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FILESORTENGINE_H
+#define FILESORTENGINE_H
+
+#include "dfmplugin_workspace_global.h"
+
+#include <dfm-base/dfm_global_defines.h>
+#include <dfm-base/interfaces/fileinfo.h>
+#include <dfm-base/interfaces/sortfileinfo.h>
+
+#include <QUrl>
+#include <QVector>
+
+#include <atomic>
+
+namespace dfmplugin_workspace {
+
+// The values FileSortWorker::lessThan reads through QVariant,
+// extracted once per file before sorting.
+struct FileSortKey
+{
+    QUrl url;
+    SortInfoPointer sortInfo;   // caches the string keys between sorts, may be null
+    QString data;
+    QString displayName;
+    QByteArray dataKey;   // FileUtils::sortKeyOfString, filled by FileSortEngine::sort
+    QByteArray nameKey;
+    qint64 size { 0 };
+    bool isDir { false };
+    bool valid { false };
+};
+
+class FileSortEngine
+{
+public:
+    explicit FileSortEngine(const DFMGLOBAL_NAMESPACE::ItemRoles role,
+                            const Qt::SortOrder order,
+                            const bool isMixDirAndFile,
+                            const std::atomic_bool &canceled);
+
+    static FileSortKey makeKey(const QUrl &url, const FileInfoPointer &info, const QVariant &data,
+                               const SortInfoPointer &sortInfo = nullptr);
+
+    // the keys of FileSortKey, taken from the cache of sortInfo when there is one
+    static QByteArray nameKeyOf(const SortInfoPointer &sortInfo, const QString &name);
+    static QByteArray dataKeyOf(const SortInfoPointer &sortInfo, const QString &data);
+
+    // Sort keys in chunks on the global thread pool and merge the chunks,
+    // returns false if sorting was canceled.
+    bool sort(QVector<FileSortKey> &keys) const;
+
+    qint64 lastSortElapsed() const;
+
+private:
+    void makeStringKeys(QVector<FileSortKey> &keys) const;
+    bool lessThan(const FileSortKey &left, const FileSortKey &right) const;
+    bool before(const FileSortKey &left, const FileSortKey &right) const;
+
+private:
+    DFMGLOBAL_NAMESPACE::ItemRoles role { DFMGLOBAL_NAMESPACE::ItemRoles::kItemDisplayRole };
+    Qt::SortOrder order { Qt::AscendingOrder };
+    bool isMixDirAndFile { false };
+    const std::atomic_bool &canceled;
+    mutable qint64 elapsed { 0 };
+};
+
+}
+
+#endif   // FILESORTENGINE_H
@@ -13,11 +13,17 @@
 #include <dfm-io/dfmio_utils.h>
 
 #include <QStandardPaths>
+#include <QSet>
 
 using namespace dfmplugin_workspace;
 using namespace dfmbase::Global;
 using namespace dfmio;
 
+// window in which watcher added files are collected and inserted together
+static constexpr int kWatcherAddInterval { 50 };
+// larger batches are merged into a new visible list instead of being inserted one by one
+static constexpr int kMaxInPlaceInsertCount { 64 };
+
 FileSortWorker::FileSortWorker(const QUrl &url, const QString &key, FileViewFilterCallback callfun, const QStringList &nameFilters, const QDir::Filters filters, const QDirIterator::IteratorFlags flags, QObject *parent)
     : QObject(parent), current(url), nameFilters(nameFilters), filters(filters), flags(flags), filterCallback(callfun), currentKey(key)
 {
@@ -25,6 +31,11 @@ FileSortWorker::FileSortWorker(const QUrl &url, const QString &key, FileViewFilt
     isMixDirAndFile = Application::instance()->appAttribute(Application::kFileAndDirMixedSort).toBool();
     connect(&FileInfoHelper::instance(), &FileInfoHelper::fileRefreshFinished, this,
             &FileSortWorker::handleFileInfoUpdated, Qt::QueuedConnection);
+
+    watcherAddTimer = new QTimer(this);
+    watcherAddTimer->setInterval(kWatcherAddInterval);
+    watcherAddTimer->setSingleShot(true);
+    connect(watcherAddTimer, &QTimer::timeout, this, &FileSortWorker::insertWatcherAddChildren);
 }
 
 FileSortWorker::~FileSortWorker()
@@ -33,6 +44,7 @@ FileSortWorker::~FileSortWorker()
     childrenDataMap.clear();
     childrenUrlList.clear();
     visibleChildren.clear();
+    watcherAddChildren.clear();
     children.clear();
 }
 
@@ -129,7 +141,7 @@ int FileSortWorker::getChildShowIndex(const QUrl &url)
 QList<QUrl> FileSortWorker::getChildrenUrls()
 {
     QReadLocker lk(&locker);
-    return visibleChildren;
+    return visibleChildren.toList();
 }
 
 QDir::Filters FileSortWorker::getFilters() const
@@ -218,6 +230,7 @@ void FileSortWorker::handleSourceChildren(const QString &key,
         if (isCanceled)
             return;
     }
+    newChildren = notVisibleUrls(newChildren);
 
     if (sortRole != DEnumerator::SortRoleCompareFlag::kSortRoleCompareDefault && this->sortRole == sortRole
         && this->sortOrder == sortOrder && this->isMixDirAndFile == isMixDirAndFile) {
@@ -241,7 +254,7 @@ void FileSortWorker::handleSourceChildren(const QString &key,
     if (!onebyone)
         Q_EMIT insertRows(0, newChildren.length());
     for (const auto &url : newChildren) {
-        int showIndex = insertSortList(url, visibleChildren,
+        int showIndex = insertSortList(url, visibleChildren.toList(),
                                        AbstractSortFilter::SortScenarios::kSortScenariosIteratorExistingFile);
         if (isCanceled)
             return;
@@ -318,6 +331,7 @@ void FileSortWorker::handleIteratorChildren(const QString &key, QList<SortInfoPo
         listshow.append(sortInfo->fileUrl());
     }
 
+    listshow = notVisibleUrls(listshow);
     if (listshow.length() <= 0)
         return;
 
@@ -344,7 +358,7 @@ void FileSortWorker::setFilters(QDir::Filters filters)
 void FileSortWorker::setNameFilters(const QStringList &filters)
 {
     nameFilters = filters;
-    QMap<QUrl, FileItemDataPointer>::iterator itr = childrenDataMap.begin();
+    auto itr = childrenDataMap.begin();
     for (; itr != childrenDataMap.end(); ++itr) {
         checkNameFilters(itr.value());
     }
@@ -395,13 +409,19 @@ void FileSortWorker::onAppAttributeChanged(Application::ApplicationAttribute aa,
 
 void FileSortWorker::handleWatcherAddChildren(QList<SortInfoPointer> children)
 {
+    // files are shown when the window is over, so that a burst of
+    // created files is sorted and inserted as a few row ranges
     for (const auto &sortInfo : children) {
         if (isCanceled)
             return;
-        if (this->childrenUrlList.contains(sortInfo->fileUrl()))
+        if (!sortInfo || this->childrenUrlList.contains(sortInfo->fileUrl()))
             continue;
-        addChild(sortInfo, AbstractSortFilter::SortScenarios::kSortScenariosWatcherAddFile);
+        addChildData(sortInfo);
+        watcherAddChildren.append(sortInfo->fileUrl());
     }
+
+    if (!watcherAddChildren.isEmpty() && !watcherAddTimer->isActive())
+        watcherAddTimer->start();
 }
 
 void FileSortWorker::handleWatcherRemoveChildren(QList<SortInfoPointer> children)
@@ -410,10 +430,12 @@ void FileSortWorker::handleWatcherRemoveChildren(QList<SortInfoPointer> children
         if (isCanceled)
             return;
 
-        if (!sortInfo || !childrenUrlList.contains(sortInfo->fileUrl()))
+        if (!sortInfo)
             continue;
 
         auto index = childrenUrlList.indexOf(sortInfo->fileUrl());
+        if (index < 0)
+            continue;
         {
             QWriteLocker lk(&childrenDataLocker);
             childrenDataMap.remove(childrenUrlList.takeAt(index));
@@ -423,8 +445,6 @@ void FileSortWorker::handleWatcherRemoveChildren(QList<SortInfoPointer> children
         int showIndex = -1;
         {
             QReadLocker lk(&locker);
-            if (!visibleChildren.contains(sortInfo->fileUrl()))
-                continue;
             showIndex = visibleChildren.indexOf(sortInfo->fileUrl());
             if (showIndex <= -1)
                 continue;
@@ -531,22 +551,24 @@ void FileSortWorker::handleUpdateFile(const QUrl &url)
     if (isCanceled)
         return;
 
-    if (!url.isValid() || !childrenUrlList.contains(url))
+    if (!url.isValid())
+        return;
+
+    const int index = childrenUrlList.indexOf(url);
+    if (index < 0 || index >= children.count())
         return;
 
-    SortInfoPointer sortInfo = children.at(childrenUrlList.indexOf(url));
+    SortInfoPointer sortInfo = children.at(index);
     if (!sortInfo)
         return;
 
-    bool childVisible = false;
     int childIndex = -1;
     {
         QReadLocker lk(&locker);
-        childVisible = visibleChildren.contains(url);
         childIndex = visibleChildren.indexOf(url);
     }
 
-    if (childVisible) {
+    if (childIndex >= 0) {
         if (!checkFilters(sortInfo, true)) {
             Q_EMIT removeRows(childIndex, 1);
             {
@@ -564,7 +586,7 @@ void FileSortWorker::handleUpdateFile(const QUrl &url)
         int showIndex = visibleChildren.length();
         // kItemDisplayRole 是不进行排序的
         if (orgSortRole != Global::ItemRoles::kItemDisplayRole)
-            showIndex = insertSortList(sortInfo->fileUrl(), visibleChildren, AbstractSortFilter::SortScenarios::kSortScenariosWatcherAddFile);
+            showIndex = insertSortList(sortInfo->fileUrl(), visibleChildren.toList(), AbstractSortFilter::SortScenarios::kSortScenariosWatcherAddFile);
 
         if (isCanceled)
             return;
@@ -621,6 +643,8 @@ void FileSortWorker::handleRefresh()
         visibleChildren.clear();
         children.clear();
     }
+    watcherAddTimer->stop();
+    watcherAddChildren.clear();
 
     {
         QWriteLocker lk(&childrenDataLocker);
@@ -824,7 +848,7 @@ void FileSortWorker::filterAllFilesOrdered()
         if (show ^ (index < 0))
             continue;
         if (show) {
-            auto showIndex = insertSortList(sortInfo->fileUrl(), visibleChildren,
+            auto showIndex = insertSortList(sortInfo->fileUrl(), visibleChildren.toList(),
                                             AbstractSortFilter::SortScenarios::kSortScenariosWatcherOther);
             Q_EMIT insertRows(showIndex, 1);
             {
@@ -855,17 +879,24 @@ void FileSortWorker::sortAllFiles()
         return;
 
     QList<QUrl> sortList;
-    int i = 0;
     bool sortSame = true;
-    for (const auto &url : visibleChildren) {
-        if (isCanceled)
+    // the custom sort filter compares file infos, so it can only be called one by one
+    if (sortAndFilter) {
+        int i = 0;
+        for (const auto &url : visibleChildren) {
+            if (isCanceled)
+                return;
+            auto sortIndex = insertSortList(url, sortList, AbstractSortFilter::SortScenarios::kSortScenariosNormal);
+            if (sortSame)
+                sortSame = sortIndex == i;
+
+            sortList.insert(sortIndex, url);
+            i++;
+        }
+    } else {
+        if (!sortAllFilesByKey(&sortList))
             return;
-        auto sortIndex = insertSortList(url, sortList, AbstractSortFilter::SortScenarios::kSortScenariosNormal);
-        if (sortSame)
-            sortSame = sortIndex == i;
-
-        sortList.insert(sortIndex, url);
-        i++;
+        sortSame = sortList == visibleChildren.toList();
     }
 
     if (sortSame)
@@ -879,6 +910,36 @@ void FileSortWorker::sortAllFiles()
     Q_EMIT insertFinish();
 }
 
+bool FileSortWorker::sortAllFilesByKey(QList<QUrl> *sortList)
+{
+    QVector<FileSortKey> keys;
+    keys.reserve(visibleChildren.count());
+    for (const auto &url : visibleChildren) {
+        if (isCanceled)
+            return false;
+        const auto &item = childrenDataMap.value(url);
+        const FileInfoPointer info = item && item->fileInfo()
+                ? item->fileInfo()
+                : InfoFactory::create<FileInfo>(url);
+        const int index = childrenUrlList.indexOf(url);
+        const SortInfoPointer &sortInfo = index >= 0 ? children.at(index) : SortInfoPointer();
+        keys.append(FileSortEngine::makeKey(url, info, data(info, orgSortRole), sortInfo));
+    }
+
+    FileSortEngine engine(orgSortRole, sortOrder, isMixDirAndFile, isCanceled);
+    if (!engine.sort(keys))
+        return false;
+
+    qInfo() << "sort all files end, file count: " << keys.count() << " url: " << current
+            << " elapsed: " << engine.lastSortElapsed();
+
+    sortList->reserve(keys.count());
+    for (const auto &key : keys)
+        sortList->append(key.url);
+
+    return true;
+}
+
 void FileSortWorker::sortOnlyOrderChange()
 {
     if (isCanceled)
@@ -950,6 +1011,8 @@ void FileSortWorker::addChild(const SortInfoPointer &sortInfo, const FileInfoPoi
     if (isCanceled)
         return;
 
+    // the shown files are all children
+    Q_ASSERT(!visibleChildren.contains(sortInfo->fileUrl()));
     Q_EMIT insertRows(showIndex, 1);
     {
         QWriteLocker lk(&locker);
@@ -958,58 +1021,150 @@ void FileSortWorker::addChild(const SortInfoPointer &sortInfo, const FileInfoPoi
     Q_EMIT insertFinish();
 }
 
-void FileSortWorker::addChild(const SortInfoPointer &sortInfo,
-                              const AbstractSortFilter::SortScenarios sort)
+void FileSortWorker::addChildData(const SortInfoPointer &sortInfo)
 {
-    if (isCanceled)
-        return;
+    children.append(sortInfo);
+    childrenUrlList.append(sortInfo->fileUrl());
 
-    if (!sortInfo)
-        return;
+    auto info = InfoFactory::create<FileInfo>(sortInfo->fileUrl());
+    FileItemDataPointer item { nullptr };
+    if (info) {
+        info->refresh();
+        item.reset(new FileItemData(sortInfo->fileUrl(), info, rootdata.data()));
+        item->setSortFileInfo(sortInfo);
+    } else {
+        item.reset(new FileItemData(sortInfo, rootdata.data()));
+    }
 
-    if (childrenUrlList.contains(sortInfo->fileUrl()))
-        return;
+    QWriteLocker lk(&childrenDataLocker);
+    childrenDataMap.insert(sortInfo->fileUrl(), item);
+}
 
-    children.append(sortInfo);
-    childrenUrlList.append(sortInfo->fileUrl());
-    {
-        auto info = InfoFactory::create<FileInfo>(sortInfo->fileUrl());
-        FileItemDataPointer item{nullptr};
-        if (info) {
-            info->refresh();
-            item.reset(new FileItemData(sortInfo->fileUrl(), info, rootdata.data()));
-            item->setSortFileInfo(sortInfo);
-        } else {
-            item.reset(new FileItemData(sortInfo, rootdata.data()));
-        }
+void FileSortWorker::insertWatcherAddChildren()
+{
+    watcherAddTimer->stop();
 
-        QWriteLocker lk(&childrenDataLocker);
-        childrenDataMap.insert(sortInfo->fileUrl(), item);
+    QList<QUrl> addUrls;
+    for (const auto &url : watcherAddChildren) {
+        if (isCanceled)
+            return;
+        // removed or already shown by other events during the window
+        const int index = childrenUrlList.indexOf(url);
+        if (index < 0 || visibleChildren.contains(url))
+            continue;
+        if (checkFilters(children.at(index), true))
+            addUrls.append(url);
     }
+    watcherAddChildren.clear();
 
-    if (!checkFilters(sortInfo, true))
+    if (addUrls.isEmpty() || isCanceled)
         return;
 
+    // kItemDisplayRole 是不进行排序的
+    if (orgSortRole == Global::ItemRoles::kItemDisplayRole) {
+        Q_EMIT insertRows(visibleChildren.length(), addUrls.length());
+        {
+            QWriteLocker lk(&locker);
+            visibleChildren.append(addUrls);
+        }
+        Q_EMIT insertFinish();
+    } else {
+        insertSortedChildren(addUrls, AbstractSortFilter::SortScenarios::kSortScenariosWatcherAddFile);
+    }
+
     if (isCanceled)
         return;
 
-    int showIndex = visibleChildren.length();
-    // kItemDisplayRole 是不进行排序的
-    if (orgSortRole != Global::ItemRoles::kItemDisplayRole)
-        showIndex = insertSortList(sortInfo->fileUrl(), visibleChildren, sort);
+    for (const auto &url : addUrls)
+        Q_EMIT selectAndEditFile(url);
+}
+
+void FileSortWorker::insertSortedChildren(QList<QUrl> &urls, AbstractSortFilter::SortScenarios sort)
+{
+    std::stable_sort(urls.begin(), urls.end(), [this, sort](const QUrl &left, const QUrl &right) {
+        return sortOrder == Qt::AscendingOrder ? lessThan(left, right, sort) : lessThan(right, left, sort);
+    });
 
     if (isCanceled)
         return;
 
-    Q_EMIT insertRows(showIndex, 1);
+    // rows in the current visible list, each one is found by a binary search,
+    // a sorted batch never goes backwards, so the urls inserted at the same row
+    // make up one contiguous range
+    QList<QPair<int, int>> ranges;
+    const QList<QUrl> &current = visibleChildren.toList();
+    int row = 0;
+    for (const auto &url : urls) {
+        if (isCanceled)
+            return;
+        row = qMax(row, insertSortList(url, current, sort));
+        if (!ranges.isEmpty() && ranges.last().first == row)
+            ++ranges.last().second;
+        else
+            ranges.append(qMakePair(row, 1));
+    }
+
+    if (urls.count() <= kMaxInPlaceInsertCount) {
+        int offset = 0;
+        for (const auto &range : ranges) {
+            Q_EMIT insertRows(range.first + offset, range.second);
+            {
+                QWriteLocker lk(&locker);
+                for (int i = 0; i < range.second; ++i)
+                    visibleChildren.insert(range.first + offset + i, urls.at(offset + i));
+            }
+            Q_EMIT insertFinish();
+            offset += range.second;
+        }
+        return;
+    }
+
+    // many ranges, the new visible list is built by copying the current rows and the ranges in turn
+    QList<QUrl> merged;
+    {
+        merged.reserve(current.count() + urls.count());
+        int from = 0;
+        int offset = 0;
+        for (const auto &range : ranges) {
+            for (; from < range.first; ++from)
+                merged.append(current.at(from));
+            for (int i = 0; i < range.second; ++i)
+                merged.append(urls.at(offset + i));
+            offset += range.second;
+        }
+        for (; from < current.count(); ++from)
+            merged.append(current.at(from));
+    }
+
+    // signals are queued to the model, so the list can be replaced once for all ranges
     {
         QWriteLocker lk(&locker);
-        visibleChildren.insert(showIndex, sortInfo->fileUrl());
+        visibleChildren = merged;
     }
-    Q_EMIT insertFinish();
+    int offset = 0;
+    for (const auto &range : ranges) {
+        Q_EMIT insertRows(range.first + offset, range.second);
+        Q_EMIT insertFinish();
+        offset += range.second;
+    }
+}
 
-    if (sort == AbstractSortFilter::SortScenarios::kSortScenariosWatcherAddFile)
-        Q_EMIT selectAndEditFile(sortInfo->fileUrl());
+/*!
+ * \brief FileSortWorker::notVisibleUrls The urls not shown yet, each one once,
+ * so that the rows emitted by insertRows match the rows added to visibleChildren
+ */
+QList<QUrl> FileSortWorker::notVisibleUrls(const QList<QUrl> &urls) const
+{
+    QList<QUrl> result;
+    QSet<QUrl> added;
+    result.reserve(urls.count());
+    for (const auto &url : urls) {
+        if (visibleChildren.contains(url) || added.contains(url))
+            continue;
+        added.insert(url);
+        result.append(url);
+    }
+    return result;
 }
 
 bool FileSortWorker::sortInfoUpdateByFileInfo(const FileInfoPointer fileInfo)
@@ -1018,9 +1173,6 @@ bool FileSortWorker::sortInfoUpdateByFileInfo(const FileInfoPointer fileInfo)
         return false;
 
     auto url = fileInfo->fileUrl();
-    if (!childrenUrlList.contains(url))
-        return false;
-
     int index = childrenUrlList.indexOf(url);
     if (index < 0 || children.count() <= index)
         return false;
@@ -1084,25 +1236,29 @@ bool FileSortWorker::lessThan(const QUrl &left, const QUrl &right, AbstractSortF
     QVariant leftData = data(leftInfo, orgSortRole);
     QVariant rightData = data(rightInfo, orgSortRole);
 
+    // the same keys as FileSortEngine, so that inserting into a sorted list keeps its order
+    const int leftIndex = childrenUrlList.indexOf(left);
+    const int rightIndex = childrenUrlList.indexOf(right);
+    const SortInfoPointer &leftSortInfo = leftIndex >= 0 ? children.at(leftIndex) : SortInfoPointer();
+    const SortInfoPointer &rightSortInfo = rightIndex >= 0 ? children.at(rightIndex) : SortInfoPointer();
+
     // When the selected sort attribute value is the same, sort by file name
     if (leftData == rightData) {
         QString leftName = leftInfo->displayOf(DisPlayInfoType::kFileDisplayName);
         QString rightName = rightInfo->displayOf(DisPlayInfoType::kFileDisplayName);
-        return FileUtils::compareByStringEx(leftName, rightName);
+        return FileSortEngine::nameKeyOf(leftSortInfo, leftName)
+                < FileSortEngine::nameKeyOf(rightSortInfo, rightName);
     }
 
     switch (orgSortRole) {
-    case kItemFileDisplayNameRole:
-    case kItemFileLastModifiedRole:
-    case kItemFileMimeTypeRole:
-        return FileUtils::compareByStringEx(leftData.toString(), rightData.toString());
     case kItemFileSizeRole: {
         qint64 sizel = leftInfo->size();
         qint64 sizer = rightInfo->size();
         return sizel < sizer;
     }
     default:
-        return FileUtils::compareByStringEx(leftData.toString(), rightData.toString());
+        return FileSortEngine::dataKeyOf(leftSortInfo, leftData.toString())
+                < FileSortEngine::dataKeyOf(rightSortInfo, rightData.toString());
     }
 }
 
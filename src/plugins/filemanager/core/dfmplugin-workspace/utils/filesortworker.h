@@ -7,6 +7,8 @@
 
 #include "dfmplugin_workspace_global.h"
 #include "models/fileitemdata.h"
+#include "models/indexedurllist.h"
+#include "utils/filesortengine.h"
 #include <dfm-base/dfm_global_defines.h>
 #include <dfm-base/interfaces/fileinfo.h>
 #include <dfm-base/interfaces/abstractsortfilter.h>
@@ -19,6 +21,7 @@
 #include <QObject>
 #include <QDirIterator>
 #include <QReadWriteLock>
+#include <QTimer>
 
 using namespace dfmbase;
 namespace dfmplugin_workspace {
@@ -120,11 +123,14 @@ private:
     void filterAllFiles(const bool byInfo = false);
     void filterAllFilesOrdered();
     void sortAllFiles();
+    bool sortAllFilesByKey(QList<QUrl> *sortList);
     // 有序的情况下只是点击升序还是降序特殊处理
     void sortOnlyOrderChange();
     void addChild(const SortInfoPointer &sortInfo, const FileInfoPointer &info);
-    void addChild(const SortInfoPointer &sortInfo,
-                  const AbstractSortFilter::SortScenarios sort);
+    void addChildData(const SortInfoPointer &sortInfo);
+    void insertWatcherAddChildren();
+    void insertSortedChildren(QList<QUrl> &urls, AbstractSortFilter::SortScenarios sort);
+    QList<QUrl> notVisibleUrls(const QList<QUrl> &urls) const;
     bool sortInfoUpdateByFileInfo(const FileInfoPointer fileInfo);
 
 private:
@@ -140,11 +146,14 @@ private:
     QDir::Filters filters { QDir::NoFilter };
     QDirIterator::IteratorFlags flags { QDirIterator::NoIteratorFlags };
     QList<SortInfoPointer> children {};
-    QList<QUrl> childrenUrlList {};
+    IndexedUrlList childrenUrlList {};
     QReadWriteLock childrenDataLocker;
-    QMap<QUrl, FileItemDataPointer> childrenDataMap {};
-    QMap<QUrl, FileItemDataPointer> childrenDataLastMap {};
-    QList<QUrl> visibleChildren {};
+    QHash<QUrl, FileItemDataPointer> childrenDataMap {};
+    QHash<QUrl, FileItemDataPointer> childrenDataLastMap {};
+    IndexedUrlList visibleChildren {};
+    // watcher added files waiting to be shown
+    IndexedUrlList watcherAddChildren {};
+    QTimer *watcherAddTimer { nullptr };
     QReadWriteLock locker;
     AbstractSortFilterPointer sortAndFilter { nullptr };
     FileViewFilterCallback filterCallback { nullptr };
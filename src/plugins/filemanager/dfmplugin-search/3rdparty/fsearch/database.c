@@ -79,6 +79,9 @@ db_location_new(void);
 static void
 db_list_add_location(Database *db, DatabaseLocation *location);
 
+static int
+sort_by_name(const void *a, const void *b);
+
 // Implemenation
 
 static void
@@ -556,6 +559,19 @@ db_location_walk_tree_recursive(DatabaseLocation *location,
     return WALK_OK;
 }
 
+static bool
+location_has_data_prefix(const char *dname)
+{
+    GList *info = get_fstable_bindinfo();
+    for (info = g_list_first(info); info != NULL; info = g_list_next(info)) {
+        char *data = info->data;
+        if (strncmp(data, dname, strlen(data)) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static DatabaseLocation *
 db_location_build_tree(const char *dname, DatabaseConfig *db_config, bool *is_stop, void (*callback)(const char *))
 {
@@ -578,16 +594,7 @@ db_location_build_tree(const char *dname, DatabaseConfig *db_config, bool *is_st
     GTimer *timer = g_timer_new();
     g_timer_start(timer);
 
-    bool has_data_prefix = false;
-    GList *info = get_fstable_bindinfo();
-    for (info = g_list_first(info); info != NULL; info = g_list_next(info)) {
-        char *data = info->data;
-        if (strncmp(data, dname, strlen(data)) == 0) {
-            has_data_prefix = true;
-            break;
-        }
-    }
-
+    bool has_data_prefix = location_has_data_prefix(dname);
     uint32_t res = db_location_walk_tree_recursive(location,
                                                    db_config,
                                                    config->exclude_locations,
@@ -853,6 +860,408 @@ bool db_location_add(Database *db,
     return false;
 }
 
+// The nodes added by the changes being applied are not in the entries list yet
+#define DATABASE_POS_NEW UINT32_MAX
+
+typedef struct
+{
+    Database *db;
+    DatabaseLocation *location;
+    FsearchConfig *config;
+    GPtrArray *added;
+    GTimer *timer;
+    bool has_data_prefix;
+    bool *is_stop;
+    uint32_t num_changes;
+} DatabaseChanges;
+
+static DatabaseLocation *
+db_location_get_for_child_path(Database *db, const char *path)
+{
+    DatabaseLocation *found = NULL;
+    size_t found_len = 0;
+    for (GList *l = db->locations; l != NULL; l = l->next) {
+        DatabaseLocation *location = l->data;
+        const char *root_name = location->entries->name;
+        const size_t len = strlen(root_name);
+        // the root of the file system is named ""
+        if (strncmp(path, root_name, len) || (path[len] != '/' && path[len] != '\0')) {
+            continue;
+        }
+        if (!found || len > found_len) {
+            found = location;
+            found_len = len;
+        }
+    }
+    return found;
+}
+
+static BTreeNode *
+db_node_find_child(BTreeNode *parent, const char *name)
+{
+    for (BTreeNode *child = parent->children; child != NULL; child = child->next) {
+        if (!strcmp(child->name, name)) {
+            return child;
+        }
+    }
+    return NULL;
+}
+
+static bool
+db_changes_remove_entry(BTreeNode *node, void *data)
+{
+    DatabaseChanges *changes = data;
+    if (node->pos == DATABASE_POS_NEW) {
+        g_ptr_array_remove_fast(changes->added, node);
+    } else if (darray_get_item(changes->db->entries, node->pos) == node) {
+        darray_remove_item(changes->db->entries, node->pos);
+    }
+    changes->location->num_items--;
+    changes->num_changes++;
+    return true;
+}
+
+static void
+db_changes_remove_node(DatabaseChanges *changes, BTreeNode *node)
+{
+    btree_node_traverse(node, db_changes_remove_entry, changes);
+    btree_node_free(node);
+}
+
+static bool
+db_changes_add_entry(BTreeNode *node, void *data)
+{
+    DatabaseChanges *changes = data;
+    node->pos = DATABASE_POS_NEW;
+    g_ptr_array_add(changes->added, node);
+    changes->num_changes++;
+    return true;
+}
+
+static void
+db_changes_add_path(DatabaseChanges *changes, BTreeNode *parent, const char *path, const char *name)
+{
+    DatabaseConfig *db_config = changes->db->db_config;
+    if (db_config->filter_hidden_file && name[0] == '.') {
+        return;
+    }
+    if (file_is_excluded(name, changes->config->exclude_files)
+        || directory_is_excluded(path, changes->config->exclude_locations)) {
+        return;
+    }
+
+    struct stat st;
+    if (lstat(path, &st) == -1) {
+        return;
+    }
+
+    const bool is_dir = S_ISDIR(st.st_mode);
+    char full_py_name[FILENAME_MAX] = "";
+    char first_py_name[FILENAME_MAX] = "";
+    if (db_config->enable_py)
+        convert_all_pinyin(name, first_py_name, full_py_name);
+
+    BTreeNode *node = btree_node_new(name,
+                                     full_py_name,
+                                     first_py_name,
+                                     st.st_mtime,
+                                     st.st_size,
+                                     0,
+                                     is_dir);
+    btree_node_prepend(parent, node);
+    changes->location->num_items++;
+    if (is_dir) {
+        db_location_walk_tree_recursive(changes->location,
+                                        db_config,
+                                        changes->config->exclude_locations,
+                                        changes->config->exclude_files,
+                                        path,
+                                        changes->timer,
+                                        NULL,
+                                        node,
+                                        0,
+                                        changes->is_stop,
+                                        changes->has_data_prefix);
+    }
+    btree_node_traverse(node, db_changes_add_entry, changes);
+}
+
+// Sync the children of a directory node with the directory, the children
+// which are directories themselves are synced by their own changes.
+static bool
+db_changes_sync_children(DatabaseChanges *changes, BTreeNode *node, const char *path)
+{
+    if (!db_support(path, changes->has_data_prefix)) {
+        return true;
+    }
+
+    size_t len = strlen(path);
+    if (len >= FILENAME_MAX - 1) {
+        return true;
+    }
+
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return true;
+    }
+
+    GHashTable *children = g_hash_table_new(g_str_hash, g_str_equal);
+    for (BTreeNode *child = node->children; child != NULL; child = child->next) {
+        g_hash_table_insert(children, child->name, child);
+    }
+
+    char fn[FILENAME_MAX] = "";
+    strcpy(fn, path);
+    if (strcmp(path, "/")) {
+        fn[len++] = '/';
+    }
+
+    bool finished = true;
+    struct dirent *dent = NULL;
+    while ((dent = readdir(dir))) {
+        if (*changes->is_stop) {
+            finished = false;
+            break;
+        }
+        if (!strcmp(dent->d_name, ".") || !strcmp(dent->d_name, "..")) {
+            continue;
+        }
+
+        g_strlcpy(fn + len, dent->d_name, FILENAME_MAX - len);
+        BTreeNode *child = g_hash_table_lookup(children, dent->d_name);
+        if (!child) {
+            db_changes_add_path(changes, node, fn, dent->d_name);
+            continue;
+        }
+        g_hash_table_remove(children, dent->d_name);
+
+        struct stat st;
+        if (lstat(fn, &st) == -1) {
+            continue;
+        }
+        if (S_ISDIR(st.st_mode) != child->is_dir) {
+            db_changes_remove_node(changes, child);
+            db_changes_add_path(changes, node, fn, dent->d_name);
+        } else if (!child->is_dir) {
+            child->mtime = st.st_mtime;
+            child->size = st.st_size;
+        }
+    }
+    closedir(dir);
+
+    // the children which were not seen have been removed
+    if (finished) {
+        GList *removed = g_hash_table_get_values(children);
+        for (GList *l = removed; l != NULL; l = l->next) {
+            db_changes_remove_node(changes, l->data);
+        }
+        g_list_free(removed);
+    }
+    g_hash_table_destroy(children);
+    return finished;
+}
+
+static void
+db_changes_sync_path(DatabaseChanges *changes, const char *path)
+{
+    DatabaseLocation *location = db_location_get_for_child_path(changes->db, path);
+    if (!location) {
+        return;
+    }
+
+    BTreeNode *root = location->entries;
+    changes->location = location;
+    changes->has_data_prefix = location_has_data_prefix(strcmp(root->name, "") ? root->name : "/");
+
+    // find the node of the path, the first missing node is built with everything below it
+    char node_path[FILENAME_MAX] = "";
+    g_strlcpy(node_path, root->name, sizeof(node_path));
+    char *relative_path = g_strdup(path + strlen(root->name));
+    char *save_ptr = NULL;
+    BTreeNode *node = root;
+    for (char *name = strtok_r(relative_path, "/", &save_ptr); name != NULL; name = strtok_r(NULL, "/", &save_ptr)) {
+        g_strlcat(node_path, "/", sizeof(node_path));
+        g_strlcat(node_path, name, sizeof(node_path));
+        BTreeNode *child = db_node_find_child(node, name);
+        if (!child) {
+            if (node->is_dir) {
+                db_changes_add_path(changes, node, node_path, name);
+            }
+            g_free(relative_path);
+            return;
+        }
+        node = child;
+    }
+    g_free(relative_path);
+
+    if (node == root && !strcmp(node_path, "")) {
+        g_strlcpy(node_path, "/", sizeof(node_path));
+    }
+
+    struct stat st;
+    if (lstat(node_path, &st) == -1) {
+        if (node != root) {
+            db_changes_remove_node(changes, node);
+        }
+        return;
+    }
+
+    if (S_ISDIR(st.st_mode) != node->is_dir) {
+        if (node != root) {
+            BTreeNode *parent = node->parent;
+            char *name = g_strdup(node->name);
+            db_changes_remove_node(changes, node);
+            db_changes_add_path(changes, parent, node_path, name);
+            g_free(name);
+        }
+        return;
+    }
+
+    if (node->is_dir && !db_changes_sync_children(changes, node, node_path)) {
+        return;
+    }
+    node->mtime = st.st_mtime;
+    node->size = st.st_size;
+}
+
+static BTreeNode *
+db_entries_get_next(DynamicArray *entries, uint32_t *idx)
+{
+    if (!entries) {
+        return NULL;
+    }
+    const uint32_t size = darray_get_size(entries);
+    while (*idx < size) {
+        BTreeNode *node = darray_get_item(entries, (*idx)++);
+        if (node) {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+// The sorted entries list without the removed nodes is merged with the
+// sorted added nodes, a full sort of the list is not needed.
+static void
+db_changes_merge_entries(DatabaseChanges *changes)
+{
+    Database *db = changes->db;
+    GPtrArray *added = changes->added;
+    g_ptr_array_sort(added, sort_by_name);
+
+    DynamicArray *entries = db->entries;
+    uint32_t num_entries = added->len;
+    uint32_t idx = 0;
+    while (db_entries_get_next(entries, &idx)) {
+        num_entries++;
+    }
+
+    DynamicArray *merged = darray_new(num_entries + 1);
+    uint32_t pos = 0;
+    uint32_t added_pos = 0;
+    idx = 0;
+    BTreeNode *entry = db_entries_get_next(entries, &idx);
+    while (entry || added_pos < added->len) {
+        BTreeNode *node = NULL;
+        if (added_pos < added->len
+            && (!entry || sort_by_name(&g_ptr_array_index(added, added_pos), &entry) < 0)) {
+            node = g_ptr_array_index(added, added_pos++);
+        } else {
+            node = entry;
+            entry = db_entries_get_next(entries, &idx);
+        }
+        node->pos = pos;
+        darray_set_item(merged, node, pos++);
+    }
+
+    db_entries_clear(db);
+    db->entries = merged;
+    db->num_entries = pos;
+}
+
+uint32_t
+db_apply_changes(Database *db, const char **paths, uint32_t num_paths, bool *is_stop)
+{
+    assert(db != NULL);
+    assert(is_stop != NULL);
+
+    db_lock(db);
+    if (!db->entries) {
+        db_unlock(db);
+        return 0;
+    }
+
+    FsearchConfig *config = (FsearchConfig *)(calloc(1, sizeof(FsearchConfig)));
+    config_load_default(config);
+
+    DatabaseChanges changes = { 0 };
+    changes.db = db;
+    changes.config = config;
+    changes.added = g_ptr_array_new();
+    changes.timer = g_timer_new();
+    changes.is_stop = is_stop;
+    for (uint32_t i = 0; i < num_paths && !*is_stop; ++i) {
+        db_changes_sync_path(&changes, paths[i]);
+    }
+
+    if (changes.num_changes) {
+        db_changes_merge_entries(&changes);
+    }
+    db_update_timestamp(db);
+
+    g_timer_destroy(changes.timer);
+    g_ptr_array_free(changes.added, TRUE);
+    config_free(config);
+    db_unlock(db);
+    return changes.num_changes;
+}
+
+static void
+db_location_collect_changed_directories(BTreeNode *node, char *path, size_t len, GPtrArray *paths, bool *is_stop)
+{
+    if (*is_stop) {
+        return;
+    }
+
+    const char *node_path = len ? path : "/";
+    struct stat st;
+    if (lstat(node_path, &st) == -1 || !S_ISDIR(st.st_mode)) {
+        g_ptr_array_add(paths, g_strdup(node_path));
+        return;
+    }
+    if (st.st_mtime != node->mtime) {
+        g_ptr_array_add(paths, g_strdup(node_path));
+    }
+
+    for (BTreeNode *child = node->children; child != NULL; child = child->next) {
+        if (!child->is_dir) {
+            continue;
+        }
+        const size_t name_len = strlen(child->name);
+        if (len + name_len + 1 >= FILENAME_MAX) {
+            continue;
+        }
+        path[len] = '/';
+        memcpy(path + len + 1, child->name, name_len + 1);
+        db_location_collect_changed_directories(child, path, len + name_len + 1, paths, is_stop);
+        path[len] = '\0';
+    }
+}
+
+void db_get_changed_directories(Database *db, GPtrArray *paths, bool *is_stop)
+{
+    assert(db != NULL);
+    assert(paths != NULL);
+    assert(is_stop != NULL);
+
+    for (GList *l = db->locations; l != NULL; l = l->next) {
+        DatabaseLocation *location = l->data;
+        char path[FILENAME_MAX] = "";
+        g_strlcpy(path, location->entries->name, sizeof(path));
+        db_location_collect_changed_directories(location->entries, path, strlen(path), paths, is_stop);
+    }
+}
+
 void db_update_sort_index(Database *db)
 {
     assert(db != NULL);
@@ -999,6 +1408,49 @@ db_get_entries(Database *db)
     return db->entries;
 }
 
+typedef struct
+{
+    DynamicArray *entries;
+    uint32_t num_entries;
+} SubtreeEntries;
+
+static bool
+db_subtree_add_node(BTreeNode *node, void *data)
+{
+    SubtreeEntries *subtree = data;
+    darray_set_item(subtree->entries, node, subtree->num_entries++);
+    return true;
+}
+
+static void
+db_traverse_subtree_add(BTreeNode *node, void *data)
+{
+    btree_node_traverse(node, db_subtree_add_node, data);
+}
+
+static int
+sort_by_pos(const void *a, const void *b)
+{
+    const uint32_t pos_a = (*(BTreeNode **)a)->pos;
+    const uint32_t pos_b = (*(BTreeNode **)b)->pos;
+    return pos_a < pos_b ? -1 : pos_a > pos_b;
+}
+
+DynamicArray *
+db_get_subtree_entries(Database *db, BTreeNode *node, uint32_t *num_entries)
+{
+    assert(db != NULL);
+    assert(node != NULL);
+
+    SubtreeEntries subtree = { darray_new(btree_node_n_nodes(node)), 0 };
+    btree_node_children_foreach(node, db_traverse_subtree_add, &subtree);
+    // the same order as the entries list of the database
+    darray_sort(subtree.entries, sort_by_pos);
+
+    *num_entries = subtree.num_entries;
+    return subtree.entries;
+}
+
 static int
 sort_by_name(const void *a, const void *b)
 {
@@ -61,6 +61,14 @@ bool db_location_remove(Database *db, const char *path);
 
 bool db_location_write_to_file(DatabaseLocation *location, const char *fname);
 
+// Sync the nodes of the paths with the file system and merge the changed nodes
+// into the sorted entries list, returns the number of added and removed nodes.
+uint32_t db_apply_changes(Database *db, const char **paths, uint32_t num_paths, bool *is_stop);
+
+// Append the paths of the directories modified since they were read, the
+// caller must keep the locations from being changed meanwhile.
+void db_get_changed_directories(Database *db, GPtrArray *paths, bool *is_stop);
+
 BTreeNode *
 db_location_get_entries(DatabaseLocation *location);
 
@@ -99,6 +107,11 @@ bool db_try_lock(Database *db);
 DynamicArray *
 db_get_entries(Database *db);
 
+// The entries under the node in the order of the entries list, the array
+// is owned by the caller and the database must not change while it is used.
+DynamicArray *
+db_get_subtree_entries(Database *db, BTreeNode *node, uint32_t *num_entries);
+
 void db_sort(Database *db);
 
 bool db_clear(Database *db);
@@ -30,6 +30,7 @@
 #include "database_search.h"
 #include "string_utils.h"
 #include "query.h"
+#include "fsearch_matcher.h"
 //#include "debug.h"
 #include "utf8.h"
 
@@ -38,7 +39,8 @@
 typedef struct search_query_s
 {
     char *query;
-    uint32_t (*search_func)(const char *, const char *);
+    uint32_t (*search_func)(const char *, const struct search_query_s *);
+    FsearchMatcher matcher;
     size_t query_len;
     uint32_t has_uppercase;
     uint32_t has_separator;
@@ -214,8 +216,7 @@ search_thread(void *user_data)
             if (!query) {
                 break;
             }
-            char *ptr = query->query;
-            uint32_t (*search_func)(const char *, const char *) = query->search_func;
+            uint32_t (*search_func)(const char *, const search_query_t *) = query->search_func;
 
             const char *haystack = NULL;
             if (search_in_path || (auto_search_in_path && query->has_separator)) {
@@ -227,12 +228,12 @@ search_thread(void *user_data)
             } else {
                 haystack = haystack_name;
             }
-            if (!search_func(haystack, ptr)) {
+            if (!search_func(haystack, query)) {
                 if (ctx->search->enable_py && strlen(node->full_py_name)) {
                     // search first pinyin
-                    if (!search_func(node->first_py_name, ptr)) {
+                    if (!search_func(node->first_py_name, query)) {
                         // search full pinyin
-                        if (!search_func(node->full_py_name, ptr)) {
+                        if (!search_func(node->full_py_name, query)) {
                             break;
                         }
                     }
@@ -369,34 +370,27 @@ is_regex(const char *query)
 }
 
 static uint32_t
-search_wildcard_icase(const char *haystack, const char *needle)
+search_wildcard_icase(const char *haystack, const search_query_t *query)
 {
-    return !fnmatch(needle, haystack, FNM_CASEFOLD) ? 1 : 0;
+    return !fnmatch(query->query, haystack, FNM_CASEFOLD) ? 1 : 0;
 }
 
 static uint32_t
-search_wildcard(const char *haystack, const char *needle)
+search_wildcard(const char *haystack, const search_query_t *query)
 {
-    return !fnmatch(needle, haystack, 0) ? 1 : 0;
+    return !fnmatch(query->query, haystack, 0) ? 1 : 0;
 }
 
 static uint32_t
-search_normal_icase_u8(const char *haystack, const char *needle)
+search_normal_icase_u8(const char *haystack, const search_query_t *query)
 {
-    // TODO: make this faster
-    return utf8casestr(haystack, needle) ? 1 : 0;
+    return utf8casestr(haystack, query->query) ? 1 : 0;
 }
 
 static uint32_t
-search_normal_icase(const char *haystack, const char *needle)
+search_normal(const char *haystack, const search_query_t *query)
 {
-    return strcasestr(haystack, needle) ? 1 : 0;
-}
-
-static uint32_t
-search_normal(const char *haystack, const char *needle)
-{
-    return strstr(haystack, needle) ? 1 : 0;
+    return fsearch_matcher_match(&query->matcher, haystack) ? 1 : 0;
 }
 
 static void
@@ -409,6 +403,7 @@ search_query_free(void *data)
         g_free(query->query);
         query->query = NULL;
     }
+    fsearch_matcher_clear(&query->matcher);
     g_free(query);
     query = NULL;
 }
@@ -430,14 +425,12 @@ search_query_new(const char *query, bool match_case)
         new->is_utf8 = 0;
     }
 
-    if (match_case) {
+    // the case of the letters of the other scripts than ASCII is folded
+    // by utf8casestr one code point at a time
+    if (fsearch_matcher_init(&new->matcher, query, !match_case)) {
         new->search_func = search_normal;
     } else {
-        if (new->is_utf8) {
-            new->search_func = search_normal_icase_u8;
-        } else {
-            new->search_func = search_normal_icase;
-        }
+        new->search_func = search_normal_icase_u8;
     }
 
     return new;
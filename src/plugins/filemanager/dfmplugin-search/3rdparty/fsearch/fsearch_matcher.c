@@ -0,0 +1,199 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fsearch_matcher.h"
+#include "utf8.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#if defined(__x86_64__) || defined(__i386__)
+#define MATCHER_HAS_AVX2 1
+#endif
+#endif
+
+// the case mappings of utf8lwrcodepoint end before the cyrillic letters
+#define MATCHER_CASELESS_START 0x0400
+
+static inline unsigned char
+fold_ascii(unsigned char c)
+{
+    return (unsigned char)(c - 'A') < 26 ? c | 0x20 : c;
+}
+
+static inline bool
+matcher_equal(const FsearchMatcher *matcher, const char *str)
+{
+    if (!matcher->ignore_case) {
+        return memcmp(str, matcher->needle, matcher->needle_len) == 0;
+    }
+
+    for (size_t i = 0; i < matcher->needle_len; ++i) {
+        if (fold_ascii((unsigned char)str[i]) != (unsigned char)matcher->needle[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+matcher_find_scalar(const FsearchMatcher *matcher, const char *haystack, size_t pos, size_t len)
+{
+    const unsigned char first = (unsigned char)matcher->needle[0];
+    for (; pos + matcher->needle_len <= len; ++pos) {
+        unsigned char c = (unsigned char)haystack[pos];
+        if (matcher->ignore_case) {
+            c = fold_ascii(c);
+        }
+        if (c == first && matcher_equal(matcher, haystack + pos)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the positions of a block are checked by the bits of the mask
+static inline bool
+matcher_check_mask(const FsearchMatcher *matcher, const char *block, unsigned int mask)
+{
+    while (mask) {
+        if (matcher_equal(matcher, block + __builtin_ctz(mask))) {
+            return true;
+        }
+        mask &= mask - 1;
+    }
+    return false;
+}
+
+#ifdef __SSE2__
+static inline __m128i
+fold_ascii_sse2(__m128i v)
+{
+    // the bytes of the multibyte characters are negative and never in the range
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+static bool
+matcher_find_sse2(const FsearchMatcher *matcher, const char *haystack, size_t len)
+{
+    const size_t last_pos = matcher->needle_len - 1;
+    const __m128i first = _mm_set1_epi8(matcher->needle[0]);
+    const __m128i last = _mm_set1_epi8(matcher->needle[last_pos]);
+
+    size_t pos = 0;
+    for (; pos + last_pos + 16 <= len; pos += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i *)(haystack + pos));
+        __m128i block_last = _mm_loadu_si128((const __m128i *)(haystack + pos + last_pos));
+        if (matcher->ignore_case) {
+            block_first = fold_ascii_sse2(block_first);
+            block_last = fold_ascii_sse2(block_last);
+        }
+        const __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                                         _mm_cmpeq_epi8(block_last, last));
+        if (matcher_check_mask(matcher, haystack + pos, (unsigned int)_mm_movemask_epi8(eq))) {
+            return true;
+        }
+    }
+    return matcher_find_scalar(matcher, haystack, pos, len);
+}
+#endif
+
+#ifdef MATCHER_HAS_AVX2
+__attribute__((target("avx2"))) static inline __m256i
+fold_ascii_avx2(__m256i v)
+{
+    const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+    return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2"))) static bool
+matcher_find_avx2(const FsearchMatcher *matcher, const char *haystack, size_t len)
+{
+    const size_t last_pos = matcher->needle_len - 1;
+    const __m256i first = _mm256_set1_epi8(matcher->needle[0]);
+    const __m256i last = _mm256_set1_epi8(matcher->needle[last_pos]);
+
+    size_t pos = 0;
+    for (; pos + last_pos + 32 <= len; pos += 32) {
+        __m256i block_first = _mm256_loadu_si256((const __m256i *)(haystack + pos));
+        __m256i block_last = _mm256_loadu_si256((const __m256i *)(haystack + pos + last_pos));
+        if (matcher->ignore_case) {
+            block_first = fold_ascii_avx2(block_first);
+            block_last = fold_ascii_avx2(block_last);
+        }
+        const __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first),
+                                            _mm256_cmpeq_epi8(block_last, last));
+        if (matcher_check_mask(matcher, haystack + pos, (unsigned int)_mm256_movemask_epi8(eq))) {
+            return true;
+        }
+    }
+    // most of the names are shorter than a block of AVX2
+    return matcher_find_sse2(matcher, haystack + pos, len - pos);
+}
+#endif
+
+bool
+fsearch_matcher_init(FsearchMatcher *matcher, const char *needle, bool ignore_case)
+{
+    memset(matcher, 0, sizeof(FsearchMatcher));
+    if (ignore_case) {
+        // the letters of the other scripts have no case and match themselves only
+        const void *str = needle;
+        utf8_int32_t cp = 0;
+        for (str = utf8codepoint(str, &cp); cp != 0; str = utf8codepoint(str, &cp)) {
+            if (cp >= 0x80 && cp < MATCHER_CASELESS_START) {
+                return false;
+            }
+        }
+    }
+
+    matcher->needle_len = strlen(needle);
+    matcher->needle = strdup(needle);
+    matcher->ignore_case = ignore_case;
+    if (ignore_case) {
+        for (size_t i = 0; i < matcher->needle_len; ++i) {
+            matcher->needle[i] = (char)fold_ascii((unsigned char)matcher->needle[i]);
+        }
+    }
+#ifdef MATCHER_HAS_AVX2
+    matcher->use_avx2 = __builtin_cpu_supports("avx2");
+#endif
+    return true;
+}
+
+void
+fsearch_matcher_clear(FsearchMatcher *matcher)
+{
+    free(matcher->needle);
+    matcher->needle = NULL;
+    matcher->needle_len = 0;
+}
+
+bool
+fsearch_matcher_match(const FsearchMatcher *matcher, const char *haystack)
+{
+    if (matcher->needle_len == 0) {
+        return true;
+    }
+
+    const size_t len = strlen(haystack);
+    if (len < matcher->needle_len) {
+        return false;
+    }
+#ifdef MATCHER_HAS_AVX2
+    if (matcher->use_avx2) {
+        return matcher_find_avx2(matcher, haystack, len);
+    }
+#endif
+#ifdef __SSE2__
+    return matcher_find_sse2(matcher, haystack, len);
+#else
+    return matcher_find_scalar(matcher, haystack, 0, len);
+#endif
+}
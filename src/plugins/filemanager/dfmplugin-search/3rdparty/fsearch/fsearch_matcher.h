@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FSEARCH_MATCHER_H
+#define FSEARCH_MATCHER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// A substring matcher of a needle, the candidates are found by comparing
+// the first and the last byte of the needle with 16 (SSE2) or 32 (AVX2)
+// positions of the haystack at once, the ASCII letters are folded in the
+// registers when the case is ignored.
+typedef struct
+{
+    char *needle;   // folded to lower case when the case is ignored
+    size_t needle_len;
+    bool ignore_case;
+    bool use_avx2;
+} FsearchMatcher;
+
+// Returns false if the needle can't be matched by bytes, that is the case
+// is ignored and the needle has non-ASCII letters with an upper case,
+// utf8casestr has to be used then.
+bool
+fsearch_matcher_init(FsearchMatcher *matcher, const char *needle, bool ignore_case);
+
+void
+fsearch_matcher_clear(FsearchMatcher *matcher);
+
+bool
+fsearch_matcher_match(const FsearchMatcher *matcher, const char *haystack);
+
+#endif   // FSEARCH_MATCHER_H
@@ -12,6 +12,7 @@
 #include "topwidget/advancesearchbar.h"
 #include "menus/searchmenuscene.h"
 #include "searchmanager/searchmanager.h"
+#include "searchmanager/searcher/fsearch/fsearchdatabase.h"
 
 #include "plugins/common/core/dfmplugin-menu/menu_eventinterface_helper.h"
 
@@ -22,6 +23,8 @@
 #include <dfm-base/widgets/filemanagerwindowsmanager.h>
 #include <dfm-base/base/application/application.h>
 
+#include <QtConcurrent>
+
 using CreateTopWidgetCallback = std::function<QWidget *()>;
 using ShowTopWidgetCallback = std::function<bool(QWidget *, const QUrl &)>;
 Q_DECLARE_METATYPE(CreateTopWidgetCallback);
@@ -51,6 +54,8 @@ void Search::initialize()
 bool Search::start()
 {
     dfmplugin_menu_util::menuSceneRegisterScene(SearchMenuCreator::name(), new SearchMenuCreator());
+    // the file name searches of the mounts searched before do not wait for the databases
+    QtConcurrent::run(&FSearchDatabase::loadSavedDatabases);
     return true;
 }
 
@@ -0,0 +1,496 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fsearchdatabase.h"
+
+#include <dfm-base/base/configs/dconfig/dconfigmanager.h>
+
+#include <QtConcurrent>
+#include <QCoreApplication>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QStorageInfo>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QDebug>
+
+#include <cstdio>
+
+DFMBASE_USE_NAMESPACE
+DPSEARCH_USE_NAMESPACE
+
+static constexpr char kWatchCount[] { "dfm.search.fsearch.watch.count" };
+static constexpr int kDefaultWatchCount { 256 };   // the inotify watches are shared by all processes of the user
+static constexpr int kMaxWatchCount { 8192 };
+static constexpr int kIdleTimeout { 10 * 60 * 1000 };   // release the watches after 10 minutes without a search (ms)
+static constexpr int kUpdateDelay { 1000 };   // apply the changes of the watched directories at most once a second (ms)
+static constexpr int kSaveDelay { 5 * 60 * 1000 };   // save a changed database after 5 minutes (ms)
+static constexpr qint64 kCheckInterval { 60 };   // check the mtime of the directories at most once a minute (s)
+
+static QMutex &databasesMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+static QHash<QString, QSharedPointer<FSearchDatabase>> &databases()
+{
+    static QHash<QString, QSharedPointer<FSearchDatabase>> all;
+    return all;
+}
+
+static QString saveDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + "/deepin/dde-file-manager/fsearch";
+}
+
+FSearchDatabase::FSearchDatabase(const QString &rootPath, QObject *parent)
+    : QObject(parent),
+      root(rootPath),
+      db(db_new()),
+      updateTimer(new QTimer(this)),
+      saveTimer(new QTimer(this)),
+      idleTimer(new QTimer(this))
+{
+    // the same as the flags of FSearcher
+    db->db_config->filter_hidden_file = true;
+
+    updateTimer->setSingleShot(true);
+    updateTimer->setInterval(kUpdateDelay);
+    connect(updateTimer, &QTimer::timeout, this, &FSearchDatabase::updateChanges);
+
+    saveTimer->setSingleShot(true);
+    saveTimer->setInterval(kSaveDelay);
+    connect(saveTimer, &QTimer::timeout, this, [this] {
+        QtConcurrent::run([this] { save(); });
+    });
+
+    idleTimer->setSingleShot(true);
+    idleTimer->setInterval(kIdleTimeout);
+    connect(idleTimer, &QTimer::timeout, this, &FSearchDatabase::releaseWatches);
+}
+
+FSearchDatabase::~FSearchDatabase()
+{
+    isStop = true;
+    updateFuture.waitForFinished();
+    if (loadThread)
+        loadThread->wait();
+
+    QMutexLocker lk(&saveMutex);
+    db_clear(db);
+    db_free(db);
+    db = nullptr;
+}
+
+/*!
+ * \brief FSearchDatabase::databaseOf The database of the mount of the path
+ */
+QSharedPointer<FSearchDatabase> FSearchDatabase::databaseOf(const QString &path)
+{
+    const QStorageInfo storage(path);
+    const QString &rootPath = storage.isValid() ? storage.rootPath() : path;
+
+    QMutexLocker lk(&databasesMutex());
+    auto it = databases().find(rootPath);
+    if (it != databases().end())
+        return it.value();
+
+    QSharedPointer<FSearchDatabase> database(new FSearchDatabase(rootPath));
+    if (qApp) {
+        // the timers and the watcher work in the main thread
+        database->moveToThread(qApp->thread());
+        if (databases().isEmpty())
+            QObject::connect(qApp, &QCoreApplication::aboutToQuit, &FSearchDatabase::saveAll);
+    }
+
+    databases().insert(rootPath, database);
+    return database;
+}
+
+/*!
+ * \brief FSearchDatabase::loadSavedDatabases Load the databases saved last time,
+ * the mounts which are not mounted any more are skipped.
+ */
+void FSearchDatabase::loadSavedDatabases()
+{
+    const QDir dir(saveDirectory());
+    for (const QString &name : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        QFile rootFile(dir.filePath(name) + "/root");
+        if (!rootFile.open(QIODevice::ReadOnly))
+            continue;
+
+        const QString &rootPath = QString::fromUtf8(rootFile.readAll());
+        if (rootPath.isEmpty() || !QFileInfo(rootPath).isDir())
+            continue;
+
+        const QSharedPointer<FSearchDatabase> &database = databaseOf(rootPath);
+        if (database->rootPath() != rootPath)
+            continue;
+
+        bool stop = false;
+        if (database->load(&stop, false))
+            database->refresh();
+    }
+}
+
+QString FSearchDatabase::savePathOf(const QString &rootPath)
+{
+    return saveDirectory() + "/"
+            + QCryptographicHash::hash(rootPath.toUtf8(), QCryptographicHash::Md5).toHex();
+}
+
+/*!
+ * \brief FSearchDatabase::load Load the database saved last time, or build
+ * it by walking the mount if \a build is true.
+ */
+bool FSearchDatabase::load(bool *stop, bool build)
+{
+    if (isLoaded())
+        return true;
+
+    QMutexLocker lk(&loadMutex);
+    if (isLoaded())
+        return true;
+
+    QElapsedTimer timer;
+    timer.start();
+    const QString &savePath = savePathOf(root);
+    const bool fromFile = db_location_load(db, savePath.toLocal8Bit().constData());
+    if (fromFile) {
+        db_update_entries_list(db);
+        // as old as the file until the directories are checked
+        db->timestamp = QFileInfo(savePath + "/database.db").lastModified().toSecsSinceEpoch();
+    } else {
+        if (!build)
+            return false;
+
+        const bool ret = db_location_add(db, root.toLocal8Bit().constData(), stop, nullptr);
+        if (!ret || *stop) {
+            db_clear(db);
+            return false;
+        }
+        db_build_initial_entries_list(db);
+        modified.storeRelease(1);
+    }
+
+    qInfo() << "fsearch database of" << root << (fromFile ? "loaded" : "built")
+            << "entries:" << entryCount() << "spending:" << timer.elapsed();
+
+    const QStringList &dirs = directoriesToWatch();
+    loaded.storeRelease(1);
+    QMetaObject::invokeMethod(this, "startWatching", Qt::QueuedConnection,
+                              Q_ARG(QStringList, dirs), Q_ARG(bool, !fromFile));
+    return true;
+}
+
+/*!
+ * \brief FSearchDatabase::loadInBackground Load or build the database in a thread
+ * of its own, walking a whole mount may take minutes and must not hold a thread
+ * of the global pool. The searches walk their paths until it is loaded.
+ */
+void FSearchDatabase::loadInBackground()
+{
+    if (isLoaded() || !loading.testAndSetOrdered(0, 1))
+        return;
+
+    // the last load was stopped
+    if (loadThread)
+        loadThread->wait();
+
+    loadThread.reset(QThread::create([this] {
+        load(&isStop);
+        loading.storeRelease(0);
+    }));
+    loadThread->start(QThread::LowPriority);
+}
+
+/*!
+ * \brief FSearchDatabase::save Save the database, it is written to a temporary
+ * directory first so that an interrupted save keeps the file saved last time.
+ */
+bool FSearchDatabase::save()
+{
+    QMutexLocker lk(&saveMutex);
+    if (!db || !isLoaded())
+        return false;
+
+    const QString &savePath = savePathOf(root);
+    const QString &tempPath = savePath + ".tmp";
+    bool ret = false;
+    {
+        QReadLocker locker(&rwLock);
+        modified.storeRelease(0);
+        ret = db_save_locations(db, tempPath.toLocal8Bit().constData());
+    }
+
+    const QString &tempFile = tempPath + "/database.db";
+    if (!ret || !QFileInfo::exists(tempFile) || !QDir().mkpath(savePath)
+        || ::rename(QFile::encodeName(tempFile).constData(), QFile::encodeName(savePath + "/database.db").constData()) != 0) {
+        qWarning() << "save fsearch database failed:" << root;
+        return false;
+    }
+    QDir().rmdir(tempPath);
+
+    QFile rootFile(savePath + "/root");
+    if (rootFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        rootFile.write(root.toUtf8());
+
+    qInfo() << "fsearch database of" << root << "saved, entries:" << entryCount();
+    return true;
+}
+
+/*!
+ * \brief FSearchDatabase::findNode The node of the path, the read lock must be held
+ */
+BTreeNode *FSearchDatabase::findNode(const QString &path) const
+{
+    if (!db->locations)
+        return nullptr;
+
+    BTreeNode *node = db_location_get_entries(static_cast<DatabaseLocation *>(db->locations->data));
+    // the root of the file system is named ""
+    const QString &rootName = QString::fromLocal8Bit(node->name);
+    if (path != rootName && !path.startsWith(rootName + "/"))
+        return nullptr;
+
+    const QStringList &names = path.mid(rootName.length()).split('/', QString::SkipEmptyParts);
+    for (const QString &name : names) {
+        const QByteArray &localName = name.toLocal8Bit();
+        BTreeNode *child = node->children;
+        while (child && localName != child->name)
+            child = child->next;
+
+        if (!child)
+            return nullptr;
+        node = child;
+    }
+
+    return node;
+}
+
+/*!
+ * \brief FSearchDatabase::age The seconds since the database was updated
+ */
+qint64 FSearchDatabase::age() const
+{
+    return QDateTime::currentSecsSinceEpoch() - db_get_timestamp(db);
+}
+
+quint32 FSearchDatabase::entryCount() const
+{
+    return db_get_num_entries(db);
+}
+
+/*!
+ * \brief FSearchDatabase::refresh Check the mtime of the directories which are not
+ * watched in background, unless they were checked within kCheckInterval.
+ */
+void FSearchDatabase::refresh()
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    if (now - lastCheck.loadAcquire() < kCheckInterval)
+        return;
+
+    lastCheck.storeRelease(now);
+    QMetaObject::invokeMethod(this, "checkDirectories", Qt::QueuedConnection);
+    QMetaObject::invokeMethod(this, "keepWatching", Qt::QueuedConnection);
+}
+
+void FSearchDatabase::startWatching(const QStringList &dirs, bool saveNow)
+{
+    if (isStop)
+        return;
+
+    if (!watcher) {
+        watcher = new QFileSystemWatcher(this);
+        connect(watcher, &QFileSystemWatcher::directoryChanged, this, &FSearchDatabase::onDirectoryChanged);
+    }
+
+    if (!dirs.isEmpty()) {
+        const QStringList &failed = watcher->addPaths(dirs);
+        qInfo() << "fsearch database of" << root << "watching" << dirs.count() - failed.count() << "directories";
+    }
+    idleTimer->start();
+
+    if (saveNow)
+        QtConcurrent::run([this] { save(); });
+}
+
+/*!
+ * \brief FSearchDatabase::keepWatching A search uses the database, watch the
+ * directories again if the watches were released
+ */
+void FSearchDatabase::keepWatching()
+{
+    if (isStop || !isLoaded())
+        return;
+
+    if (watcher) {
+        idleTimer->start();
+        return;
+    }
+
+    QStringList dirs;
+    {
+        QReadLocker lk(&rwLock);
+        dirs = directoriesToWatch();
+    }
+    startWatching(dirs, false);
+}
+
+/*!
+ * \brief FSearchDatabase::releaseWatches No search used the database for a while,
+ * the changes meanwhile are found by checking the mtime of the directories
+ */
+void FSearchDatabase::releaseWatches()
+{
+    if (!watcher)
+        return;
+
+    qInfo() << "fsearch database of" << root << "is idle, release the watches";
+    delete watcher;
+    watcher = nullptr;
+}
+
+void FSearchDatabase::onDirectoryChanged(const QString &path)
+{
+    changedPaths.insert(path);
+    if (!updateTimer->isActive())
+        updateTimer->start();
+}
+
+void FSearchDatabase::checkDirectories()
+{
+    checkPending = true;
+    updateChanges();
+}
+
+void FSearchDatabase::updateChanges()
+{
+    if (isStop || !isLoaded() || (changedPaths.isEmpty() && !checkPending))
+        return;
+
+    // one update at a time, the changes meanwhile are applied by the next one
+    if (updateFuture.isRunning()) {
+        updateTimer->start();
+        return;
+    }
+
+    const QStringList paths = changedPaths.values();
+    changedPaths.clear();
+    const bool checkDirs = checkPending;
+    checkPending = false;
+    updateFuture = QtConcurrent::run(this, &FSearchDatabase::doUpdate, paths, checkDirs);
+}
+
+void FSearchDatabase::saveLater()
+{
+    if (!isStop && !saveTimer->isActive())
+        saveTimer->start();
+}
+
+/*!
+ * \brief FSearchDatabase::directoriesToWatch The directories to watch, breadth
+ * first since the shallow directories are the most likely to change.
+ * The deeper ones are kept current by checking their mtime.
+ */
+QStringList FSearchDatabase::directoriesToWatch() const
+{
+    const int maxCount = watchCount();
+    QStringList dirs;
+    QQueue<QPair<BTreeNode *, QByteArray>> queue;
+    for (GList *l = db->locations; l != nullptr; l = l->next) {
+        BTreeNode *entries = db_location_get_entries(static_cast<DatabaseLocation *>(l->data));
+        queue.enqueue({ entries, QByteArray(entries->name) });
+    }
+
+    while (!queue.isEmpty() && dirs.count() < maxCount) {
+        const auto item = queue.dequeue();
+        const QByteArray &path = item.second.isEmpty() ? QByteArray("/") : item.second;
+        // the paths out of the database such as /proc and /run change all the time
+        if (!db_support(path.constData(), false))
+            continue;
+
+        dirs.append(QString::fromLocal8Bit(path));
+        for (BTreeNode *child = item.first->children; child != nullptr; child = child->next) {
+            if (child->is_dir && dirs.count() + queue.count() < maxCount)
+                queue.enqueue({ child, item.second + '/' + child->name });
+        }
+    }
+
+    return dirs;
+}
+
+/*!
+ * \brief FSearchDatabase::watchCount The directories watched by each database,
+ * 0 to find all the changes by checking the mtime of the directories
+ */
+int FSearchDatabase::watchCount()
+{
+    bool ok = false;
+    const int count = DConfigManager::instance()->value(kDefaultCfgPath, kWatchCount, kDefaultWatchCount).toInt(&ok);
+    return ok ? qBound(0, count, kMaxWatchCount) : kDefaultWatchCount;
+}
+
+void FSearchDatabase::doUpdate(QStringList paths, bool checkDirs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    if (checkDirs) {
+        QReadLocker lk(&rwLock);
+        GPtrArray *dirs = g_ptr_array_new_with_free_func(g_free);
+        db_get_changed_directories(db, dirs, &isStop);
+        for (guint i = 0; i < dirs->len; ++i)
+            paths.append(QString::fromLocal8Bit(static_cast<const char *>(g_ptr_array_index(dirs, i))));
+        g_ptr_array_free(dirs, TRUE);
+    }
+    paths.removeDuplicates();
+
+    QList<QByteArray> localPaths;
+    QVector<const char *> data;
+    for (const QString &path : paths)
+        localPaths.append(path.toLocal8Bit());
+    for (const QByteArray &path : localPaths)
+        data.append(path.constData());
+
+    quint32 count = 0;
+    {
+        QWriteLocker lk(&rwLock);
+        count = db_apply_changes(db, data.data(), static_cast<uint32_t>(data.count()), &isStop);
+    }
+
+    if (count > 0) {
+        modified.storeRelease(1);
+        QMetaObject::invokeMethod(this, "saveLater", Qt::QueuedConnection);
+    }
+    qDebug() << "fsearch database of" << root << "synced" << paths.count() << "paths, changed nodes:"
+             << count << "spending:" << timer.elapsed();
+}
+
+void FSearchDatabase::saveAll()
+{
+    QMutexLocker lk(&databasesMutex());
+    for (const QSharedPointer<FSearchDatabase> &database : databases()) {
+        database->isStop = true;
+        database->updateFuture.waitForFinished();
+        if (database->loadThread)
+            database->loadThread->wait();
+        database->updateTimer->stop();
+        database->saveTimer->stop();
+        database->idleTimer->stop();
+        delete database->watcher;
+        database->watcher = nullptr;
+
+        if (database->modified.loadAcquire())
+            database->save();
+    }
+}
@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FSEARCHDATABASE_H
+#define FSEARCHDATABASE_H
+
+#include "dfmplugin_search_global.h"
+
+extern "C" {
+#include "fsearch/database.h"
+}
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QReadWriteLock>
+#include <QMutex>
+#include <QFuture>
+#include <QSet>
+#include <QScopedPointer>
+#include <QThread>
+
+class QTimer;
+class QFileSystemWatcher;
+
+DPSEARCH_BEGIN_NAMESPACE
+
+// The fsearch database of a mount, shared by the searches under the mount.
+// It is loaded from the file saved last time or built by walking the mount
+// once in a thread of its own, then the changes of the watched directories and of the directories
+// whose mtime has changed are applied to its tree. The watches are released when no
+// search used the database for a while.
+// The searches hold the read lock while they use the entries and the nodes.
+class FSearchDatabase : public QObject
+{
+    Q_OBJECT
+public:
+    static QSharedPointer<FSearchDatabase> databaseOf(const QString &path);
+    static void loadSavedDatabases();
+    static QString savePathOf(const QString &rootPath);
+
+    ~FSearchDatabase() override;
+
+    QString rootPath() const { return root; }
+    bool load(bool *stop, bool build = true);
+    void loadInBackground();
+    bool isLoaded() const { return loaded.loadAcquire(); }
+    bool save();
+
+    Database *database() const { return db; }
+    QReadWriteLock *lock() { return &rwLock; }
+    BTreeNode *findNode(const QString &path) const;
+
+    qint64 age() const;
+    quint32 entryCount() const;
+
+    void refresh();
+
+private Q_SLOTS:
+    void startWatching(const QStringList &dirs, bool saveNow);
+    void keepWatching();
+    void releaseWatches();
+    void onDirectoryChanged(const QString &path);
+    void checkDirectories();
+    void updateChanges();
+    void saveLater();
+
+private:
+    explicit FSearchDatabase(const QString &rootPath, QObject *parent = nullptr);
+    QStringList directoriesToWatch() const;
+    static int watchCount();
+    void doUpdate(QStringList paths, bool checkDirs);
+    static void saveAll();
+
+private:
+    QString root;
+    Database *db { nullptr };
+    QReadWriteLock rwLock;
+    QMutex loadMutex;
+    QMutex saveMutex;
+    QAtomicInt loaded { 0 };
+    QAtomicInt loading { 0 };
+    QAtomicInteger<qint64> lastCheck { 0 };
+    bool isStop { false };
+    QAtomicInt modified { 0 };
+
+    QFileSystemWatcher *watcher { nullptr };
+    QTimer *updateTimer { nullptr };
+    QTimer *saveTimer { nullptr };
+    QTimer *idleTimer { nullptr };
+    QSet<QString> changedPaths;
+    bool checkPending { false };
+    QFuture<void> updateFuture;
+    QScopedPointer<QThread> loadThread;
+};
+
+DPSEARCH_END_NAMESPACE
+
+#endif   // FSEARCHDATABASE_H
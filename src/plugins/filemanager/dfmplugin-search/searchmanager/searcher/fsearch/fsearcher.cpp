@@ -4,6 +4,7 @@
 
 #include "fsearcher.h"
 #include "fsearchhandler.h"
+#include "fsearchdatabase.h"
 #include "utils/searchhelper.h"
 
 #include <dfm-base/base/urlroute.h>
@@ -53,7 +54,9 @@ bool FSearcher::search()
     }
 
     notifyTimer.start();
-    searchHandler->loadDatabase(path, "");
+    // the database of the mount is built once and kept current, the path is walked only without it
+    if (!searchHandler->attachDatabase(FSearchDatabase::databaseOf(path), path))
+        searchHandler->loadDatabase(path, "");
     auto callback = std::bind(FSearcher::receiveResultCallback, std::placeholders::_1, std::placeholders::_2, this);
 
     conditionMtx.lock();
@@ -3,9 +3,12 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "fsearchhandler.h"
+#include "fsearchdatabase.h"
 
 #include <dfm-base/base/device/deviceutils.h>
 
+#include <QDebug>
+
 DPSEARCH_USE_NAMESPACE
 DFMBASE_USE_NAMESPACE
 
@@ -54,6 +57,8 @@ void FSearchHandler::reset()
     setFlags(FSEARCH_FLAG_NONE);
     isStop = false;
     maxResults = DEFAULT_MAX_RESULTS;
+    sharedDatabase.reset();
+    searchPath.clear();
     releaseApp();
 }
 
@@ -65,6 +70,30 @@ bool FSearchHandler::loadDatabase(const QString &path, const QString &dbLocation
                          &isStop);
 }
 
+/*!
+ * \brief FSearchHandler::attachDatabase Search in the shared database of the mount
+ * of the path, instead of walking the path for each search.
+ * The database is loaded in background, false is returned until it is loaded
+ * and the path is walked meanwhile.
+ */
+bool FSearchHandler::attachDatabase(const QSharedPointer<FSearchDatabase> &database, const QString &path)
+{
+    if (!database)
+        return false;
+
+    if (!database->isLoaded()) {
+        database->loadInBackground();
+        return false;
+    }
+
+    sharedDatabase = database;
+    searchPath = path;
+    database->refresh();
+    qInfo() << "fsearch database of" << database->rootPath() << "entries:" << database->entryCount()
+            << "age:" << database->age() << "s";
+    return true;
+}
+
 bool FSearchHandler::updateDatabase()
 {
     isStop = false;
@@ -91,13 +120,39 @@ bool FSearchHandler::search(const QString &keyword, FSearchHandler::FSearchCallb
     callbackFunc = callback;
     db_search_results_clear(app->search);
     Database *db = app->db;
-    if (!db_try_lock(db))
+    DynamicArray *entries = nullptr;
+    uint32_t numEntries = 0;
+    if (sharedDatabase) {
+        // released when the results are received
+        sharedDatabase->lock()->lockForRead();
+        BTreeNode *node = sharedDatabase->findNode(searchPath);
+        if (!node) {
+            sharedDatabase->lock()->unlock();
+            return false;
+        }
+
+        // only the entries under the path are matched, freed when the results are received
+        db = sharedDatabase->database();
+        if (node->parent) {
+            searchEntries = db_get_subtree_entries(db, node, &numEntries);
+            entries = searchEntries;
+        }
+    }
+
+    if (!entries) {
+        entries = db_get_entries(db);
+        numEntries = db_get_num_entries(db);
+    }
+
+    if (!db_try_lock(db)) {
+        releaseDatabase();
         return false;
+    }
 
     if (app->search) {
         db_search_update(app->search,
-                         db_get_entries(db),
-                         db_get_num_entries(db),
+                         entries,
+                         numEntries,
                          maxResults,
                          FsearchFilter::FSEARCH_FILTER_NONE,
                          keyword.toLocal8Bit().data(),
@@ -106,9 +161,11 @@ bool FSearchHandler::search(const QString &keyword, FSearchHandler::FSearchCallb
                          app->config->enable_regex,
                          app->config->auto_search_in_path,
                          app->config->search_in_path,
-                         app->db->db_config->enable_py);
+                         db->db_config->enable_py);
         syncMutex.lock();
         db_perform_search(app->search, FSearchHandler::reveiceResultsCallback, app, this);
+    } else {
+        releaseDatabase();
     }
 
     db_unlock(db);
@@ -145,6 +202,9 @@ void FSearchHandler::setFlags(FSearchFlags flags)
 
 long FSearchHandler::dbTimeStamp()
 {
+    if (sharedDatabase)
+        return sharedDatabase->database()->timestamp;
+
     if (!app || !app->db)
         return 0;
 
@@ -170,15 +230,31 @@ void FSearchHandler::releaseApp()
     }
 }
 
+void FSearchHandler::releaseDatabase()
+{
+    if (searchEntries) {
+        darray_free(searchEntries);
+        searchEntries = nullptr;
+    }
+    if (sharedDatabase)
+        sharedDatabase->lock()->unlock();
+}
+
 void FSearchHandler::reveiceResultsCallback(void *data, void *sender)
 {
     DatabaseSearchResult *results = static_cast<DatabaseSearchResult *>(data);
     FSearchHandler *self = static_cast<FSearchHandler *>(sender);
     Q_ASSERT(results && self);
 
-    if (self->isStop) {
+    // the shared database is released before the searcher is told to finish
+    auto finish = [self] {
+        self->releaseDatabase();
         self->callbackFunc("", true);
         self->syncMutex.unlock();
+    };
+
+    if (self->isStop) {
+        finish();
         return;
     }
 
@@ -186,8 +262,7 @@ void FSearchHandler::reveiceResultsCallback(void *data, void *sender)
         uint32_t num_results = results->results->len;
         for (uint32_t i = 0; i < num_results; ++i) {
             if (self->isStop) {
-                self->callbackFunc("", true);
-                self->syncMutex.unlock();
+                finish();
                 return;
             }
 
@@ -197,8 +272,7 @@ void FSearchHandler::reveiceResultsCallback(void *data, void *sender)
                 auto *node = entry->node;
                 while (node != nullptr) {
                     if (self->isStop) {
-                        self->callbackFunc("", true);
-                        self->syncMutex.unlock();
+                        finish();
                         return;
                     }
 
@@ -216,6 +290,5 @@ void FSearchHandler::reveiceResultsCallback(void *data, void *sender)
         }
     }
 
-    self->callbackFunc("", true);
-    self->syncMutex.unlock();
+    finish();
 }
@@ -13,6 +13,7 @@ extern "C" {
 
 #include <QFlags>
 #include <QMutex>
+#include <QSharedPointer>
 
 #include <functional>
 
@@ -20,6 +21,7 @@ extern "C" {
 
 DPSEARCH_BEGIN_NAMESPACE
 
+class FSearchDatabase;
 class FSearchHandler
 {
 public:
@@ -41,6 +43,7 @@ public:
     void init();
     void reset();
     bool loadDatabase(const QString &path, const QString &dbLocation);
+    bool attachDatabase(const QSharedPointer<FSearchDatabase> &database, const QString &path);
     bool updateDatabase();
     bool saveDatabase(const QString &savePath);
     bool search(const QString &keyword, FSearchCallbackFunc callback);
@@ -51,6 +54,7 @@ public:
 
 private:
     void releaseApp();
+    void releaseDatabase();
     static void reveiceResultsCallback(void *data, void *sender);
 
 private:
@@ -59,6 +63,11 @@ private:
     uint32_t maxResults = DEFAULT_MAX_RESULTS;
     FSearchCallbackFunc callbackFunc = nullptr;
     QMutex syncMutex;
+
+    // the shared database of the mount, only the entries under the search path are matched
+    QSharedPointer<FSearchDatabase> sharedDatabase;
+    QString searchPath;
+    DynamicArray *searchEntries = nullptr;
 };
 
 DPSEARCH_END_NAMESPACE
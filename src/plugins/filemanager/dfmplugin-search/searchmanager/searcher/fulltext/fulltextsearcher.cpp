@@ -18,12 +18,14 @@
 #include <FilterIndexReader.h>
 #include <FuzzyQuery.h>
 #include <QueryWrapperFilter.h>
+#include <MapFieldSelector.h>
 
 #include <QRegExp>
 #include <QDebug>
 #include <QDateTime>
 #include <QMetaEnum>
 #include <QDir>
+#include <QFile>
 #include <QTime>
 #include <QUrl>
 
@@ -36,12 +38,18 @@ static constexpr char kSupportFiles[] = "(rtf)|(odt)|(ods)|(odp)|(odg)|(docx)|(x
                                         "(xls)|(xlsb)|(doc)|(dot)|(wps)|(ppt)|(pps)|(txt)|(pdf)|(dps)";
 static int kMaxResultNum = 100000;   // 最大搜索结果数
 static int kEmitInterval = 50;   // 推送时间间隔
+static constexpr double kRamBufferSizeMB { 64.0 };   // flush the added documents to a segment
+static constexpr int kMergeFactor { 20 };
+static constexpr int kCommitInterval { 2000 };   // commit the index and the journal every n documents
+static constexpr qint64 kProgressInterval { 5000 };   // log the index progress
 
 using namespace Lucene;
 DFMBASE_USE_NAMESPACE
 DPSEARCH_USE_NAMESPACE
 
 bool FullTextSearcherPrivate::isIndexCreating = false;
+QMutex FullTextSearcherPrivate::indexMutex;
+QMutex FullTextSearcherPrivate::convertMutex;
 FullTextSearcherPrivate::FullTextSearcherPrivate(FullTextSearcher *parent)
     : QObject(parent),
       q(parent)
@@ -55,10 +63,14 @@ FullTextSearcherPrivate::~FullTextSearcherPrivate()
 
 IndexWriterPtr FullTextSearcherPrivate::newIndexWriter(bool create)
 {
-    return newLucene<IndexWriter>(FSDirectory::open(indexStorePath().toStdWString()),
-                                  newLucene<ChineseAnalyzer>(),
-                                  create,
-                                  IndexWriter::MaxFieldLengthLIMITED);
+    IndexWriterPtr writer = newLucene<IndexWriter>(FSDirectory::open(indexStorePath().toStdWString()),
+                                                   newLucene<ChineseAnalyzer>(),
+                                                   create,
+                                                   IndexWriter::MaxFieldLengthLIMITED);
+    // less and bigger segments while adding many documents
+    writer->setRAMBufferSizeMB(kRamBufferSizeMB);
+    writer->setMergeFactor(kMergeFactor);
+    return writer;
 }
 
 IndexReaderPtr FullTextSearcherPrivate::newIndexReader()
@@ -66,7 +78,50 @@ IndexReaderPtr FullTextSearcherPrivate::newIndexReader()
     return IndexReader::open(FSDirectory::open(indexStorePath().toStdWString()), true);
 }
 
-void FullTextSearcherPrivate::doIndexTask(const IndexReaderPtr &reader, const IndexWriterPtr &writer, const QString &path, TaskType type)
+IndexJournal *FullTextSearcherPrivate::indexJournal()
+{
+    static IndexJournal journal(indexStorePath() + ".journal");
+    return &journal;
+}
+
+/*!
+ * \brief FullTextSearcherPrivate::loadJournalFromIndex Create the journal of an index created
+ * without journal. The indexed files are taken as up to date, the missing ones are
+ * recorded with an empty state so that the next scan deletes them from the index.
+ */
+bool FullTextSearcherPrivate::loadJournalFromIndex()
+{
+    IndexJournal *journal = indexJournal();
+    journal->clear();
+
+    IndexReaderPtr reader = newIndexReader();
+    Collection<String> fields = Collection<String>::newInstance();
+    fields.add(L"path");
+    FieldSelectorPtr selector = newLucene<MapFieldSelector>(fields);
+
+    const int32_t maxDoc = reader->maxDoc();
+    for (int32_t i = 0; i < maxDoc; ++i) {
+        if (reader->isDeleted(i))
+            continue;
+
+        const String &path = reader->document(i, selector)->get(L"path");
+        if (path.empty())
+            continue;
+
+        const QString &file = QString::fromStdWString(path);
+        struct stat st;
+        if (lstat(file.toLocal8Bit().constData(), &st) == 0)
+            journal->update(file, IndexFileState::fromStat(st));
+        else
+            journal->update(file, IndexFileState());
+    }
+    reader->close();
+
+    qInfo() << "create fulltext index journal from the index, files: " << journal->count();
+    return journal->save();
+}
+
+void FullTextSearcherPrivate::doIndexTask(const IndexWriterPtr &writer, const QString &path, TaskType type)
 {
     if (status.loadAcquire() != AbstractSearcher::kRuning)
         return;
@@ -110,27 +165,28 @@ void FullTextSearcherPrivate::doIndexTask(const IndexReaderPtr &reader, const In
 
         const bool is_dir = S_ISDIR(st.st_mode);
         if (is_dir) {
-            doIndexTask(reader, writer, fn, type);
-        } else {
-            auto info = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(fn));
-            if (!info) continue;
-
-            QString suffix = info->nameOf(NameInfoType::kSuffix);
-            static QRegExp suffixRegExp(kSupportFiles);
-            if (suffixRegExp.exactMatch(suffix)) {
-                switch (type) {
-                case kCreate:
-                    indexDocs(writer, fn, kAddIndex);
-                    break;
-                case kUpdate:
-                    IndexType type;
-                    if (checkUpdate(reader, fn, type)) {
-                        indexDocs(writer, fn, type);
-                        isUpdated = true;
-                    }
-                    break;
-                }
-            }
+            doIndexTask(writer, fn, type);
+            continue;
+        }
+
+        // only stat the files, the file info is created for the changed ones
+        const char *suffix = strrchr(dent->d_name, '.');
+        static QRegExp suffixRegExp(kSupportFiles);
+        if (!suffix || !suffixRegExp.exactMatch(QString::fromUtf8(suffix + 1)))
+            continue;
+
+        const QString &file = QString::fromUtf8(fn);
+        const IndexFileState &state = IndexFileState::fromStat(st);
+        switch (type) {
+        case kCreate:
+            pushDocument(writer, { file, state, false, nullptr });
+            break;
+        case kUpdate:
+            IndexType type;
+            indexJournal()->markSeen(file);
+            if (checkUpdate(file, state, type))
+                pushDocument(writer, { file, state, type == kUpdateIndex, nullptr });
+            break;
         }
     }
 
@@ -138,7 +194,7 @@ void FullTextSearcherPrivate::doIndexTask(const IndexReaderPtr &reader, const In
         closedir(dir);
 }
 
-void FullTextSearcherPrivate::indexDocs(const IndexWriterPtr &writer, const QString &file, IndexType type)
+bool FullTextSearcherPrivate::indexDocs(const IndexWriterPtr &writer, const QString &file, IndexType type)
 {
     Q_ASSERT(writer);
 
@@ -167,6 +223,7 @@ void FullTextSearcherPrivate::indexDocs(const IndexWriterPtr &writer, const QStr
             break;
         }
         }
+        return true;
     } catch (const LuceneException &e) {
         QMetaEnum enumType = QMetaEnum::fromType<FullTextSearcherPrivate::IndexType>();
         qWarning() << QString::fromStdWString(e.getError()) << " type: " << enumType.valueToKey(type);
@@ -176,45 +233,95 @@ void FullTextSearcherPrivate::indexDocs(const IndexWriterPtr &writer, const QStr
     } catch (...) {
         qWarning() << "Index document failed! " << file;
     }
+
+    return false;
 }
 
-bool FullTextSearcherPrivate::checkUpdate(const IndexReaderPtr &reader, const QString &file, IndexType &type)
+/*!
+ * \brief FullTextSearcherPrivate::pushDocument Queue a file to the extraction workers
+ * and write the extracted documents
+ */
+void FullTextSearcherPrivate::pushDocument(const IndexWriterPtr &writer, const IndexTask &task)
 {
-    Q_ASSERT(reader);
+    if (!pipeline) {
+        pipeline.reset(new IndexPipeline([this](const QString &file) { return fileDocument(file); }));
+        indexTimer.start();
+        lastProgress = 0;
+        qInfo() << "fulltext index extraction workers: " << pipeline->workerCount();
+    }
 
-    try {
-        SearcherPtr searcher = newLucene<IndexSearcher>(reader);
-        TermQueryPtr query = newLucene<TermQuery>(newLucene<Term>(L"path", file.toStdWString()));
-
-        // 文件路径为唯一值，所以搜索一个结果就行了
-        TopDocsPtr topDocs = searcher->search(query, 1);
-        int32_t numTotalHits = topDocs->totalHits;
-        if (numTotalHits == 0) {
-            type = kAddIndex;
-            return true;
-        } else {
-            DocumentPtr doc = searcher->doc(topDocs->scoreDocs[0]->doc);
-            auto info = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(file));
-            if (!info)
-                return false;
+    pipeline->push(task);
+    writeDocuments(writer, pipeline->takeFinished());
+}
 
-            QString modifyTime = QString::number(info->timeOf(TimeInfoType::kLastModified).toLongLong());
-            String storeTime = doc->get(L"modified");
+/*!
+ * \brief FullTextSearcherPrivate::writeDocuments Add the extracted documents to the index,
+ * the index and the journal are committed together every kCommitInterval documents
+ */
+void FullTextSearcherPrivate::writeDocuments(const IndexWriterPtr &writer, const QList<IndexTask> &tasks)
+{
+    IndexJournal *journal = indexJournal();
+    for (const IndexTask &task : tasks) {
+        if (!task.doc)
+            continue;
 
-            if (modifyTime.toStdWString() != storeTime) {
-                type = kUpdateIndex;
-                return true;
-            }
+        try {
+            if (task.update)
+                writer->updateDocument(newLucene<Term>(L"path", task.file.toStdWString()), task.doc);
+            else
+                writer->addDocument(task.doc);
+        } catch (const LuceneException &e) {
+            qWarning() << QString::fromStdWString(e.getError()) << " file: " << task.file;
+            continue;
         }
-    } catch (const LuceneException &e) {
-        qWarning() << QString::fromStdWString(e.getError()) << " file: " << file;
-    } catch (const std::exception &e) {
-        qWarning() << QString(e.what()) << " file: " << file;
-    } catch (...) {
-         qWarning() << "The file checked failed!" << file;
+
+        journal->update(task.file, task.state);
+        isUpdated = true;
+        ++indexedCount;
     }
 
-    return false;
+    if (indexedCount - committedCount >= kCommitInterval) {
+        writer->commit();
+        journal->save();
+        committedCount = indexedCount;
+    }
+
+    const qint64 elapsed = indexTimer.elapsed();
+    if (elapsed - lastProgress >= kProgressInterval) {
+        lastProgress = elapsed;
+        qInfo() << "fulltext index progress, indexed: " << indexedCount
+                << " queued: " << (pipeline ? pipeline->pendingCount() : 0)
+                << " documents/s: " << (elapsed > 0 ? indexedCount * 1000 / elapsed : 0);
+    }
+}
+
+/*!
+ * \brief FullTextSearcherPrivate::finishDocuments Write the documents extracted at the end
+ * of the traversal, the queued ones are dropped when the search is stopped
+ */
+void FullTextSearcherPrivate::finishDocuments(const IndexWriterPtr &writer)
+{
+    if (!pipeline)
+        return;
+
+    if (status.loadAcquire() != AbstractSearcher::kRuning)
+        pipeline->cancel();
+    writeDocuments(writer, pipeline->finish());
+    qInfo() << "fulltext index documents: " << indexedCount << " spending: " << indexTimer.elapsed();
+
+    pipeline.reset();
+    indexedCount = 0;
+    committedCount = 0;
+}
+
+bool FullTextSearcherPrivate::checkUpdate(const QString &file, const IndexFileState &state, IndexType &type)
+{
+    IndexJournal *journal = indexJournal();
+    if (!journal->isChanged(file, state))
+        return false;
+
+    type = journal->contains(file) ? kUpdateIndex : kAddIndex;
+    return true;
 }
 
 void FullTextSearcherPrivate::tryNotify()
@@ -235,11 +342,17 @@ DocumentPtr FullTextSearcherPrivate::fileDocument(const QString &file)
 
     // file last modified time
     auto info = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(file));
+    if (!info)
+        return nullptr;
     QString modifyTime = QString::number(info->timeOf(TimeInfoType::kLastModified).toLongLong());
     doc->add(newLucene<Field>(L"modified", modifyTime.toStdWString(), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
 
-    // file contents
-    QString contents = DocParser::convertFile(file.toStdString()).c_str();
+    // file contents, one file is converted at a time while the documents are built in parallel
+    QString contents;
+    {
+        QMutexLocker lk(&convertMutex);
+        contents = DocParser::convertFile(file.toStdString()).c_str();
+    }
     doc->add(newLucene<Field>(L"contents", contents.toStdWString(), Field::STORE_YES, Field::INDEX_ANALYZED));
 
     return doc;
@@ -266,6 +379,8 @@ bool FullTextSearcherPrivate::createIndex(const QString &path)
         }
     }
 
+    QMutexLocker lk(&indexMutex);
+    IndexJournal *journal = indexJournal();
     try {
         // record spending
         QTime timer;
@@ -274,11 +389,15 @@ bool FullTextSearcherPrivate::createIndex(const QString &path)
         qInfo() << "Indexing to directory: " << indexStorePath();
 
         writer->deleteAll();
-        doIndexTask(nullptr, writer, path, kCreate);
+        journal->clear();
+        journal->beginScan();
+        doIndexTask(writer, path, kCreate);
+        finishDocuments(writer);
         writer->optimize();
         writer->close();
+        journal->save();
 
-        qInfo() << "create index spending: " << timer.elapsed();
+        qInfo() << "create index spending: " << timer.elapsed() << " files: " << journal->count();
         status.storeRelease(AbstractSearcher::kCompleted);
         return true;
     } catch (const LuceneException &e) {
@@ -289,6 +408,12 @@ bool FullTextSearcherPrivate::createIndex(const QString &path)
         qWarning() << "The file index created failed!";
     }
 
+    pipeline.reset();
+    indexedCount = 0;
+    committedCount = 0;
+    // the journal is created from the index by the next update
+    QFile::remove(indexStorePath() + ".journal");
+    journal->load();
     status.storeRelease(AbstractSearcher::kCompleted);
     return false;
 }
@@ -296,16 +421,37 @@ bool FullTextSearcherPrivate::createIndex(const QString &path)
 bool FullTextSearcherPrivate::updateIndex(const QString &path)
 {
     QString bindPath = FileUtils::bindPathTransform(path, false);
+    QMutexLocker lk(&indexMutex);
+    IndexJournal *journal = indexJournal();
     try {
-        IndexReaderPtr reader = newIndexReader();
+        if (!journal->isLoaded() && !journal->load() && !loadJournalFromIndex())
+            return false;
+
+        QTime timer;
+        timer.start();
         IndexWriterPtr writer = newIndexWriter();
 
-        doIndexTask(reader, writer, bindPath, kUpdate);
+        journal->beginScan();
+        doIndexTask(writer, bindPath, kUpdate);
+        finishDocuments(writer);
 
-        writer->optimize();
+        // the files not found by a complete scan have been deleted
+        if (status.loadAcquire() == AbstractSearcher::kRuning && QDir(bindPath).exists()) {
+            for (const QString &file : journal->unseenFiles(bindPath)) {
+                if (indexDocs(writer, file, kDeleteIndex)) {
+                    journal->remove(file);
+                    isUpdated = true;
+                }
+            }
+        }
+
+        if (isUpdated)
+            writer->optimize();
         writer->close();
-        reader->close();
+        if (journal->isModified())
+            journal->save();
 
+        qInfo() << "update index spending: " << timer.elapsed() << " updated: " << isUpdated;
         return true;
     } catch (const LuceneException &e) {
         qWarning() << QString::fromStdWString(e.getError());
@@ -315,6 +461,11 @@ bool FullTextSearcherPrivate::updateIndex(const QString &path)
         qWarning() << "The file index updated failed!";
     }
 
+    pipeline.reset();
+    indexedCount = 0;
+    committedCount = 0;
+    // the changes are not committed to the index
+    journal->load();
     return false;
 }
 
@@ -360,7 +511,10 @@ bool FullTextSearcherPrivate::doSearch(const QString &path, const QString &keywo
                 auto info = InfoFactory::create<FileInfo>(url);
                 // delete invalid index
                 if (!info || !info->exists()) {
-                    indexDocs(writer, url.path(), kDeleteIndex);
+                    if (indexDocs(writer, url.path(), kDeleteIndex)) {
+                        QMutexLocker lk(&indexMutex);
+                        indexJournal()->remove(url.path());
+                    }
                     continue;
                 }
 
@@ -6,6 +6,8 @@
 #define FULLTEXTSEARCHER_P_H
 
 #include "searchmanager/searcher/abstractsearcher.h"
+#include "indexjournal.h"
+#include "indexpipeline.h"
 
 #include <lucene++/LuceneHeaders.h>
 
@@ -13,6 +15,7 @@
 #include <QApplication>
 #include <QMutex>
 #include <QTime>
+#include <QElapsedTimer>
 
 DPSEARCH_BEGIN_NAMESPACE
 
@@ -59,11 +62,17 @@ private:
         return path;
     }
 
+    static IndexJournal *indexJournal();
+    bool loadJournalFromIndex();
+
     Lucene::DocumentPtr fileDocument(const QString &file);
     QString dealKeyword(const QString &keyword);
-    void doIndexTask(const Lucene::IndexReaderPtr &reader, const Lucene::IndexWriterPtr &writer, const QString &path, TaskType type);
-    void indexDocs(const Lucene::IndexWriterPtr &writer, const QString &file, IndexType type);
-    bool checkUpdate(const Lucene::IndexReaderPtr &reader, const QString &file, IndexType &type);
+    void doIndexTask(const Lucene::IndexWriterPtr &writer, const QString &path, TaskType type);
+    bool indexDocs(const Lucene::IndexWriterPtr &writer, const QString &file, IndexType type);
+    void pushDocument(const Lucene::IndexWriterPtr &writer, const IndexTask &task);
+    void writeDocuments(const Lucene::IndexWriterPtr &writer, const QList<IndexTask> &tasks);
+    void finishDocuments(const Lucene::IndexWriterPtr &writer);
+    bool checkUpdate(const QString &file, const IndexFileState &state, IndexType &type);
     void tryNotify();
 
     bool isUpdated = false;
@@ -71,8 +80,17 @@ private:
     QList<QUrl> allResults;
     mutable QMutex mutex;
     static bool isIndexCreating;
+    static QMutex indexMutex;   // the index writer and the journal are shared by the searchers
+    static QMutex convertMutex;   // DocParser is not known to be reentrant
     QMap<QString, QString> bindPathTable;
 
+    // documents are extracted in parallel while indexing
+    QScopedPointer<IndexPipeline> pipeline;
+    int indexedCount = 0;
+    int committedCount = 0;
+    QElapsedTimer indexTimer;
+    qint64 lastProgress = 0;
+
     //计时
     QTime notifyTimer;
     int lastEmit = 0;
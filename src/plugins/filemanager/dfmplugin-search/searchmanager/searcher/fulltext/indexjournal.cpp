@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "indexjournal.h"
+
+#include <QSaveFile>
+#include <QFile>
+#include <QDataStream>
+#include <QDebug>
+
+static constexpr quint32 kJournalMagic { 0x4446494A };   // "DFIJ"
+static constexpr quint32 kJournalVersion { 1 };
+
+DPSEARCH_USE_NAMESPACE
+
+IndexFileState IndexFileState::fromStat(const struct stat &st)
+{
+    IndexFileState state;
+    state.inode = quint64(st.st_ino);
+    state.mtimeSec = qint64(st.st_mtim.tv_sec);
+    state.mtimeNsec = qint64(st.st_mtim.tv_nsec);
+    state.size = qint64(st.st_size);
+    return state;
+}
+
+bool IndexFileState::operator==(const IndexFileState &other) const
+{
+    return inode == other.inode && mtimeSec == other.mtimeSec
+            && mtimeNsec == other.mtimeNsec && size == other.size;
+}
+
+IndexJournal::IndexJournal(const QString &filePath)
+    : filePath(filePath)
+{
+}
+
+bool IndexJournal::load()
+{
+    states.clear();
+    modified = false;
+    loaded = false;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0, count = 0;
+    in >> magic >> version >> count;
+    if (magic != kJournalMagic || version != kJournalVersion) {
+        qWarning() << "drop the fulltext index journal of another version: " << filePath;
+        return false;
+    }
+
+    states.reserve(int(count));
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        Entry entry;
+        in >> path >> entry.state.inode >> entry.state.mtimeSec >> entry.state.mtimeNsec >> entry.state.size;
+        states.insert(path, entry);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "the fulltext index journal is broken: " << filePath;
+        states.clear();
+        return false;
+    }
+
+    loaded = true;
+    return true;
+}
+
+bool IndexJournal::save()
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out << kJournalMagic << kJournalVersion << quint32(states.count());
+    for (auto it = states.cbegin(); it != states.cend(); ++it) {
+        const IndexFileState &state = it.value().state;
+        out << it.key() << state.inode << state.mtimeSec << state.mtimeNsec << state.size;
+    }
+
+    if (!file.commit()) {
+        qWarning() << "save the fulltext index journal failed: " << filePath;
+        return false;
+    }
+
+    loaded = true;
+    modified = false;
+    return true;
+}
+
+void IndexJournal::clear()
+{
+    states.clear();
+    loaded = true;
+    modified = true;
+}
+
+bool IndexJournal::isChanged(const QString &path, const IndexFileState &state) const
+{
+    auto it = states.constFind(path);
+    return it == states.cend() || it.value().state != state;
+}
+
+void IndexJournal::update(const QString &path, const IndexFileState &state)
+{
+    Entry &entry = states[path];
+    entry.state = state;
+    entry.scan = currentScan;
+    modified = true;
+}
+
+void IndexJournal::remove(const QString &path)
+{
+    if (states.remove(path) > 0)
+        modified = true;
+}
+
+void IndexJournal::beginScan()
+{
+    ++currentScan;
+}
+
+void IndexJournal::markSeen(const QString &path)
+{
+    auto it = states.find(path);
+    if (it != states.end())
+        it.value().scan = currentScan;
+}
+
+QStringList IndexJournal::unseenFiles(const QString &dirPath) const
+{
+    const QString prefix = dirPath.endsWith('/') ? dirPath : dirPath + '/';
+    QStringList files;
+    for (auto it = states.cbegin(); it != states.cend(); ++it) {
+        if (it.value().scan != currentScan && it.key().startsWith(prefix))
+            files.append(it.key());
+    }
+    return files;
+}
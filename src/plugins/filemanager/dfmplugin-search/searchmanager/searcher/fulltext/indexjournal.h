@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef INDEXJOURNAL_H
+#define INDEXJOURNAL_H
+
+#include "dfmplugin_search_global.h"
+
+#include <QHash>
+#include <QStringList>
+
+#include <sys/stat.h>
+
+DPSEARCH_BEGIN_NAMESPACE
+
+struct IndexFileState
+{
+    quint64 inode { 0 };
+    qint64 mtimeSec { 0 };
+    qint64 mtimeNsec { 0 };
+    qint64 size { 0 };
+
+    static IndexFileState fromStat(const struct stat &st);
+    bool operator==(const IndexFileState &other) const;
+    bool operator!=(const IndexFileState &other) const { return !(*this == other); }
+};
+
+// The state of every indexed file when it was indexed, so that an index update
+// only stats the files and touches the index for the changed ones.
+// A scan marks the files it saw, the files under the scanned directory that
+// were not seen have been deleted.
+class IndexJournal
+{
+public:
+    explicit IndexJournal(const QString &filePath);
+
+    bool load();
+    bool save();
+    bool isLoaded() const { return loaded; }
+    bool isModified() const { return modified; }
+    void clear();
+    int count() const { return states.count(); }
+
+    bool contains(const QString &path) const { return states.contains(path); }
+    bool isChanged(const QString &path, const IndexFileState &state) const;
+    void update(const QString &path, const IndexFileState &state);
+    void remove(const QString &path);
+
+    void beginScan();
+    void markSeen(const QString &path);
+    QStringList unseenFiles(const QString &dirPath) const;
+
+private:
+    struct Entry
+    {
+        IndexFileState state;
+        quint32 scan { 0 };
+    };
+
+    QString filePath;
+    QHash<QString, Entry> states;
+    quint32 currentScan { 0 };
+    bool loaded { false };
+    bool modified { false };
+};
+
+DPSEARCH_END_NAMESPACE
+
+#endif   // INDEXJOURNAL_H
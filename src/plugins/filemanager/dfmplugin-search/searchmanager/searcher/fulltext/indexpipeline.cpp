@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "indexpipeline.h"
+
+#include <QtConcurrent>
+#include <QThread>
+#include <QDebug>
+
+#include <exception>
+
+static constexpr int kMaxWorkerCount { 16 };
+static constexpr int kTasksPerWorker { 4 };
+
+DPSEARCH_USE_NAMESPACE
+
+IndexPipeline::IndexPipeline(const Extractor &extractor, int workerCount)
+    : extractor(extractor)
+{
+    // the index writer runs in the traversal thread
+    if (workerCount <= 0)
+        workerCount = QThread::idealThreadCount() - 1;
+    workers = qBound(1, workerCount, kMaxWorkerCount);
+    capacity = workers * kTasksPerWorker;
+
+    pool.setMaxThreadCount(workers);
+    for (int i = 0; i < workers; ++i)
+        QtConcurrent::run(&pool, [this]() { extract(); });
+}
+
+IndexPipeline::~IndexPipeline()
+{
+    cancel();
+    pool.waitForDone();
+}
+
+/*!
+ * \brief IndexPipeline::push Queue a file to extract, wait while the queue is full
+ */
+void IndexPipeline::push(const IndexTask &task)
+{
+    QMutexLocker lk(&mutex);
+    while (pending.count() >= capacity && !canceled)
+        spaceCondition.wait(&mutex);
+
+    if (closed)
+        return;
+
+    pending.enqueue(task);
+    taskCondition.wakeOne();
+}
+
+QList<IndexTask> IndexPipeline::takeFinished()
+{
+    QMutexLocker lk(&mutex);
+    return std::move(finished);
+}
+
+/*!
+ * \brief IndexPipeline::finish Wait the queued files and take the tasks not taken yet,
+ * nothing can be pushed after
+ */
+QList<IndexTask> IndexPipeline::finish()
+{
+    {
+        QMutexLocker lk(&mutex);
+        closed = true;
+        taskCondition.wakeAll();
+    }
+
+    pool.waitForDone();
+    return takeFinished();
+}
+
+/*!
+ * \brief IndexPipeline::cancel Drop the files not extracted yet, the files
+ * being extracted are finished
+ */
+void IndexPipeline::cancel()
+{
+    QMutexLocker lk(&mutex);
+    canceled = true;
+    closed = true;
+    pending.clear();
+    taskCondition.wakeAll();
+    spaceCondition.wakeAll();
+}
+
+int IndexPipeline::pendingCount()
+{
+    QMutexLocker lk(&mutex);
+    return pending.count();
+}
+
+void IndexPipeline::extract()
+{
+    QMutexLocker lk(&mutex);
+    Q_FOREVER {
+        while (pending.isEmpty() && !closed)
+            taskCondition.wait(&mutex);
+
+        if (pending.isEmpty())
+            return;
+
+        IndexTask task = pending.dequeue();
+        spaceCondition.wakeOne();
+        lk.unlock();
+
+        try {
+            task.doc = extractor(task.file);
+        } catch (const Lucene::LuceneException &e) {
+            qWarning() << QString::fromStdWString(e.getError()) << " file: " << task.file;
+        } catch (const std::exception &e) {
+            qWarning() << QString(e.what()) << " file: " << task.file;
+        } catch (...) {
+            qWarning() << "Extract document failed! " << task.file;
+        }
+
+        lk.relock();
+        finished.append(task);
+    }
+}
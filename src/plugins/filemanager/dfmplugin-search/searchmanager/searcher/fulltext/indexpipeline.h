@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef INDEXPIPELINE_H
+#define INDEXPIPELINE_H
+
+#include "dfmplugin_search_global.h"
+#include "indexjournal.h"
+
+#include <lucene++/LuceneHeaders.h>
+
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThreadPool>
+
+#include <functional>
+
+DPSEARCH_BEGIN_NAMESPACE
+
+struct IndexTask
+{
+    QString file;
+    IndexFileState state;
+    bool update { false };   // replace the document of the file
+    Lucene::DocumentPtr doc;   // null when the extraction failed
+};
+
+// Extracts the documents of the traversed files in parallel. The traversal
+// pushes into a bounded queue, the workers run the extractor and the single
+// index writer takes the finished tasks in batches. The extractor must be
+// thread safe, FullTextSearcherPrivate::fileDocument serializes the conversion
+// of the file contents.
+class IndexPipeline
+{
+public:
+    using Extractor = std::function<Lucene::DocumentPtr(const QString &file)>;
+
+    explicit IndexPipeline(const Extractor &extractor, int workerCount = 0);
+    ~IndexPipeline();
+
+    void push(const IndexTask &task);
+    QList<IndexTask> takeFinished();
+    QList<IndexTask> finish();
+    void cancel();
+
+    int workerCount() const { return workers; }
+    int pendingCount();
+
+private:
+    void extract();
+
+    Extractor extractor;
+    QThreadPool pool;
+    QMutex mutex;
+    QWaitCondition taskCondition;
+    QWaitCondition spaceCondition;
+    QQueue<IndexTask> pending;
+    QList<IndexTask> finished;
+    int workers { 1 };
+    int capacity { 4 };
+    bool closed { false };
+    bool canceled { false };
+};
+
+DPSEARCH_END_NAMESPACE
+
+#endif   // INDEXPIPELINE_H
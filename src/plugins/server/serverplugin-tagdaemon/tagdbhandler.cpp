@@ -20,12 +20,17 @@
 #include <QDebug>
 #include <QProcess>
 #include <QVariant>
+#include <QSqlQuery>
+#include <QSqlError>
 
 DFMBASE_USE_NAMESPACE
 SERVERTAGDAEMON_BEGIN_NAMESPACE
 
 static constexpr char kTagTableFileTags[] = "file_tags";
 static constexpr char kTagTableTagProperty[] = "tag_property";
+// stay below SQLITE_MAX_VARIABLE_NUMBER of the old sqlite versions
+static constexpr int kMaxBoundValues { 500 };
+static constexpr int kMaxCachedFiles { 100000 };
 
 TagDbHandler *TagDbHandler::instance()
 {
@@ -60,13 +65,19 @@ QVariantMap TagDbHandler::getTagsColor(const QStringList &tags)
     }
 
     // query
-    const auto &field = Expression::Field<TagProperty>;
     QVariantMap tagColorsMap;
-    for (auto &tag : tags) {
-        const auto &beanList = handle->query<TagProperty>().where(field("tagName") == tag).toBeans();
-        const auto &color = beanList.isEmpty() ? "" : beanList.first()->getTagColor();
-        if (!color.isEmpty())
-            tagColorsMap.insert(tag, QVariant { QVariant { color } });
+    const QString &sql = QString("SELECT tagName, tagColor FROM %1 WHERE tagName IN ").arg(kTagTableTagProperty);
+    bool ret = queryByValues(sql, tags, [&tagColorsMap](QSqlQuery *query) {
+        while (query->next()) {
+            const QString &tag = query->value(0).toString();
+            const QString &color = query->value(1).toString();
+            if (!color.isEmpty() && !tagColorsMap.contains(tag))
+                tagColorsMap.insert(tag, QVariant { color });
+        }
+    });
+    if (!ret) {
+        lastErr = "Query colors of tags failed!";
+        return {};
     }
 
     finally.dismiss();
@@ -81,18 +92,41 @@ QVariantMap TagDbHandler::getTagsByUrls(const QStringList &urlList)
         return {};
     }
 
-    // query
-    const auto &field = Expression::Field<FileTagInfo>;
     QVariantMap allFileTags;
-    for (auto &path : urlList) {
-        const auto &beanList = handle->query<FileTagInfo>().where(field("filePath") == path).toBeans();
+    QStringList missedPaths;
+    {
+        QMutexLocker locker(&cacheMutex);
+        for (const auto &path : urlList) {
+            auto it = fileTagsCache.constFind(path);
+            if (it == fileTagsCache.constEnd())
+                missedPaths.append(path);
+            else if (!it.value().isEmpty())
+                allFileTags.insert(path, it.value());
+        }
+    }
 
-        QStringList fileTags;
-        for (auto oneBean : beanList)
-            fileTags.append(oneBean->getTagName());
+    // query the files not cached in one statement per chunk
+    if (!missedPaths.isEmpty()) {
+        QHash<QString, QStringList> queriedTags;
+        const QString &sql = QString("SELECT filePath, tagName FROM %1 WHERE filePath IN ").arg(kTagTableFileTags);
+        bool ret = queryByValues(sql, missedPaths, [&queriedTags](QSqlQuery *query) {
+            while (query->next())
+                queriedTags[query->value(0).toString()].append(query->value(1).toString());
+        });
+        if (!ret) {
+            lastErr = "Query tags of files failed!";
+            return {};
+        }
 
-        if (!fileTags.isEmpty())
-            allFileTags.insert(path, fileTags);
+        QMutexLocker locker(&cacheMutex);
+        if (fileTagsCache.size() + missedPaths.size() > kMaxCachedFiles)
+            fileTagsCache.clear();
+        for (const auto &path : missedPaths) {
+            const QStringList &fileTags = queriedTags.value(path);
+            fileTagsCache.insert(path, fileTags);
+            if (!fileTags.isEmpty())
+                allFileTags.insert(path, fileTags);
+        }
     }
 
     finally.dismiss();
@@ -139,17 +173,21 @@ QVariantMap TagDbHandler::getFilesByTag(const QStringList &tags)
     }
 
     // query
-    const auto &field = Expression::Field<FileTagInfo>;
-    QVariantMap allTagFiles;
-    for (auto &tag : tags) {
-        const auto &obj = handle->query<FileTagInfo>().where(field("tagName") == tag).toBeans();
-        QStringList files;
-        for (auto tempBean : obj)
-            files.append(tempBean->getFilePath());
-
-        allTagFiles.insert(tag, QVariant { files });
+    QHash<QString, QStringList> tagFiles;
+    const QString &sql = QString("SELECT tagName, filePath FROM %1 WHERE tagName IN ").arg(kTagTableFileTags);
+    bool ret = queryByValues(sql, tags, [&tagFiles](QSqlQuery *query) {
+        while (query->next())
+            tagFiles[query->value(0).toString()].append(query->value(1).toString());
+    });
+    if (!ret) {
+        lastErr = "Query files of tags failed!";
+        return {};
     }
 
+    QVariantMap allTagFiles;
+    for (auto &tag : tags)
+        allTagFiles.insert(tag, QVariant { tagFiles.value(tag) });
+
     finally.dismiss();
     return allTagFiles;
 }
@@ -235,6 +273,7 @@ bool TagDbHandler::addTagsForFiles(const QVariantMap &data)
         }
         return true;
     });
+    invalidateCache(data.keys());
 
     emit filesWereTagged(data);
     finally.dismiss();
@@ -258,6 +297,7 @@ bool TagDbHandler::removeTagsOfFiles(const QVariantMap &data)
                 return false;
         return true;
     });
+    invalidateCache(data.keys());
 
     emit filesUntagged(data);
     finally.dismiss();
@@ -275,6 +315,8 @@ bool TagDbHandler::deleteTags(const QStringList &tags)
 
     const auto &fieldOne = Expression::Field<TagProperty>;
     const auto &fieldTwo = Expression::Field<FileTagInfo>;
+    // any file may have the tags
+    clearCache();
 
     bool ret = true;
     for (const auto &tag : tags) {
@@ -301,6 +343,7 @@ bool TagDbHandler::deleteFiles(const QStringList &urls)
     }
 
     auto field = Expression::Field<FileTagInfo>;
+    invalidateCache(urls);
     for (const auto &url : urls) {
         if (!handle->remove<FileTagInfo>(field("filePath") == url))
             return false;
@@ -345,6 +388,7 @@ bool TagDbHandler::changeTagNamesWithFiles(const QVariantMap &data)
     auto it = data.begin();
     QVariantMap updatedData;
     bool ret = true;
+    clearCache();
     for (; it != data.end(); ++it) {
         if (changeTagNameWithFile(it.key(), it.value().toString()))
             updatedData.insert(it.key(), it.value());
@@ -370,6 +414,11 @@ bool TagDbHandler::changeFilePaths(const QVariantMap &data)
         return false;
     }
 
+    QStringList paths { data.keys() };
+    for (const auto &newPath : data)
+        paths.append(newPath.toString());
+    invalidateCache(paths);
+
     auto it = data.begin();
     for (; it != data.end(); ++it)
         if (!changeFilePath(it.key(), it.value().toString()))
@@ -401,9 +450,9 @@ void TagDbHandler::initialize()
     if (!dir.exists())
         dir.mkpath(dbPath);
 
-    const auto &dbFilePath = DFMUtils::buildFilePath(dbPath.toLocal8Bit(),
-                                                     Global::DataBase::kDfmDBName,
-                                                     nullptr);
+    dbFilePath = DFMUtils::buildFilePath(dbPath.toLocal8Bit(),
+                                         Global::DataBase::kDfmDBName,
+                                         nullptr);
     handle.reset(new SqliteHandle(dbFilePath));
     QSqlDatabase db { SqliteConnectionPool::instance().openConnection(dbFilePath) };
     if (!db.isValid() || db.isOpenError()) {
@@ -417,6 +466,17 @@ void TagDbHandler::initialize()
 
     if (!createTable(kTagTableTagProperty))
         qWarning() << "Create table failed:" << kTagTableFileTags;
+
+    // the lookups are by file path and by tag name
+    const QStringList indexes {
+        QString("CREATE INDEX IF NOT EXISTS file_tags_filePath ON %1(filePath);").arg(kTagTableFileTags),
+        QString("CREATE INDEX IF NOT EXISTS file_tags_tagName ON %1(tagName);").arg(kTagTableFileTags),
+        QString("CREATE INDEX IF NOT EXISTS tag_property_tagName ON %1(tagName);").arg(kTagTableTagProperty)
+    };
+    for (const auto &sql : indexes) {
+        if (!handle->excute(sql))
+            qWarning() << "Create index failed:" << sql;
+    }
 }
 
 bool TagDbHandler::createTable(const QString &tableName)
@@ -590,8 +650,8 @@ bool TagDbHandler::changeFilePath(const QString &oldPath, const QString &newPath
     }
 
     const auto &field = Expression::Field<FileTagInfo>;
-    if (!handle->update<TagProperty>(field("filePath") = newPath, field("filePath") == oldPath)) {
-        lastErr = QString("Change file path failed! oldPath: %1, newPath: %2").arg(oldPath).arg(oldPath);
+    if (!handle->update<FileTagInfo>(field("filePath") = newPath, field("filePath") == oldPath)) {
+        lastErr = QString("Change file path failed! oldPath: %1, newPath: %2").arg(oldPath).arg(newPath);
         return false;
     }
 
@@ -599,4 +659,46 @@ bool TagDbHandler::changeFilePath(const QString &oldPath, const QString &newPath
     return true;
 }
 
+bool TagDbHandler::queryByValues(const QString &sqlPrefix, const QStringList &values,
+                                 std::function<void(QSqlQuery *)> fn)
+{
+    QSqlDatabase db { SqliteConnectionPool::instance().openConnection(dbFilePath) };
+    QSqlQuery query { db };
+    for (int from = 0; from < values.size(); from += kMaxBoundValues) {
+        const QStringList &chunk = values.mid(from, kMaxBoundValues);
+        QStringList placeholders;
+        placeholders.reserve(chunk.size());
+        for (int i = 0; i < chunk.size(); ++i)
+            placeholders.append("?");
+
+        if (!query.prepare(sqlPrefix + "(" + placeholders.join(",") + ");")) {
+            qWarning().noquote() << "SQL Error: " << query.lastError().text().trimmed();
+            return false;
+        }
+        for (const auto &value : chunk)
+            query.addBindValue(value);
+        if (!query.exec()) {
+            qWarning().noquote() << "SQL Error: " << query.lastError().text().trimmed();
+            return false;
+        }
+
+        fn(&query);
+    }
+
+    return true;
+}
+
+void TagDbHandler::invalidateCache(const QStringList &paths)
+{
+    QMutexLocker locker(&cacheMutex);
+    for (const auto &path : paths)
+        fileTagsCache.remove(path);
+}
+
+void TagDbHandler::clearCache()
+{
+    QMutexLocker locker(&cacheMutex);
+    fileTagsCache.clear();
+}
+
 SERVERTAGDAEMON_END_NAMESPACE
@@ -10,6 +10,7 @@
 #include <dfm-base/base/db/sqlitehandle.h>
 
 #include <QObject>
+#include <QMutex>
 
 SERVERTAGDAEMON_BEGIN_NAMESPACE
 
@@ -68,6 +69,10 @@ private:
     bool changeTagColor(const QString &tagName, const QString &newTagColor);
     bool changeTagNameWithFile(const QString &tagName, const QString &newName);
     bool changeFilePath(const QString &oldPath, const QString &newPath);
+    bool queryByValues(const QString &sqlPrefix, const QStringList &values,
+                       std::function<void(QSqlQuery *)> fn);
+    void invalidateCache(const QStringList &paths);
+    void clearCache();
 
 Q_SIGNALS:
     void newTagsAdded(const QVariantMap &newTags);
@@ -79,7 +84,13 @@ Q_SIGNALS:
 
 private:
     QScopedPointer<DFMBASE_NAMESPACE::SqliteHandle> handle;
+    QString dbFilePath;
     QString lastErr;
+
+    // tags of the queried files, an empty list for a file without tags,
+    // updated by the writes of the daemon itself
+    QMutex cacheMutex;
+    QHash<QString, QStringList> fileTagsCache;
 };
 
 SERVERTAGDAEMON_END_NAMESPACE
@@ -53,6 +53,12 @@ QDBusVariant TagManagerDBus::Query(int opt, const QStringList value)
     return dbusVar;
 }
 
+QVariantMap TagManagerDBus::QueryTagsOfFiles(const QStringList &paths)
+{
+    // the tags of any number of files in one call, without the nested variant of Query
+    return TagDbHandler::instance()->getTagsByUrls(paths);
+}
+
 bool TagManagerDBus::Insert(int opt, const QVariantMap value)
 {
     InsertOpts insetOpt { opt };
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Maintenance of the thumbnail packs:
+//     import   import the png thumbnails of the freedesktop thumbnail directories
+//     compact  drop the replaced records and the records of modified or removed files
+//     info     print the record count and the sizes of the packs
+
+#include <dfm-base/utils/thumbnail/thumbnailpack.h>
+#include <dfm-base/utils/thumbnail/thumbnailhelper.h>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+using namespace dfmbase;
+DFMGLOBAL_USE_NAMESPACE
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Import and compact the thumbnail packs of the file manager.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "import, compact or info");
+    const QCommandLineOption appOption("app", "The application owning the packs.", "name", "dde-file-manager");
+    const QCommandLineOption sizeOption("size", "small, normal or large, all sizes by default.", "size");
+    const QCommandLineOption limitOption("limit", "The size limit of a compacted pack in MB.", "size");
+    parser.addOptions({ appOption, sizeOption, limitOption });
+    parser.process(app);
+
+    const QStringList &args = parser.positionalArguments();
+    const QString &command = args.value(0);
+    if (args.count() != 1 || !QStringList { "import", "compact", "info" }.contains(command))
+        parser.showHelp(1);
+
+    // the packs are in the cache directory of the application
+    app.setOrganizationName("deepin");
+    app.setApplicationName(parser.value(appOption));
+
+    const QMap<QString, ThumbnailSize> sizes { { "small", kSmall }, { "normal", kNormal }, { "large", kLarge } };
+    QList<ThumbnailSize> packSizes = sizes.values();
+    if (parser.isSet(sizeOption)) {
+        if (!sizes.contains(parser.value(sizeOption)))
+            parser.showHelp(1);
+        packSizes = { sizes.value(parser.value(sizeOption)) };
+    }
+
+    const qint64 limit = parser.isSet(limitOption) ? parser.value(limitOption).toLongLong() * 1024 * 1024 : -1;
+    QTextStream out(stdout);
+    int ret = 0;
+    for (ThumbnailSize size : packSizes) {
+        ThumbnailPack *pack = ThumbnailPack::instance(size);
+        const QString &name = sizes.key(size);
+        if (command == "import") {
+            const int count = pack->importDirectory(ThumbnailHelper::sizeToFilePath(size));
+            out << name << ": imported " << count << " thumbnails" << endl;
+        } else if (command == "compact") {
+            if (!pack->compact(limit)) {
+                out << name << ": compact failed" << endl;
+                ret = 1;
+            }
+        }
+
+        out << name << ": " << pack->count() << " thumbnails, " << pack->fileSize() << " bytes, "
+            << pack->deadSize() << " bytes replaced" << endl;
+    }
+
+    return ret;
+}
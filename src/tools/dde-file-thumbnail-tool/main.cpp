@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+// Thumbnail helper of the video and audio files.
+// It is started once per thumbnail worker and keeps the decoders loaded,
+// the requests are read from stdin, one per line:
+//     <size> <encoded file url>\n
+// and the replies are written to stdout in the same order:
+//     ok <length>\n<length bytes of png>   or   err 0\n
+// Requests can be batched, a reply is written as soon as it is ready.
+
+#include <libffmpegthumbnailer/videothumbnailer.h>
+
+#include <QUrl>
+#include <QFile>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <exception>
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+
+static constexpr rlim_t kMaxMemory { 1024ul * 1024 * 1024 };
+static constexpr rlim_t kMaxFiles { 64 };
+static constexpr int kNice { 10 };
+static constexpr int kSeekPercentage { 10 };
+static constexpr int kMaxSize { 1024 };
+
+static void sandbox()
+{
+    // the helper must not outlive the file manager nor gain privileges
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+
+    // a broken file must not eat the memory of the session, the file manager
+    // restarts the helper when it is killed
+    const struct rlimit memory { kMaxMemory, kMaxMemory };
+    setrlimit(RLIMIT_AS, &memory);
+    const struct rlimit files { kMaxFiles, kMaxFiles };
+    setrlimit(RLIMIT_NOFILE, &files);
+    const struct rlimit core { 0, 0 };
+    setrlimit(RLIMIT_CORE, &core);
+
+    if (nice(kNice) == -1)
+        perror("thumbnail tool: nice");
+}
+
+static bool writeReply(const std::vector<uint8_t> &png)
+{
+    if (png.empty())
+        return fputs("err 0\n", stdout) >= 0 && fflush(stdout) == 0;
+
+    return fprintf(stdout, "ok %zu\n", png.size()) > 0
+            && fwrite(png.data(), 1, png.size(), stdout) == png.size()
+            && fflush(stdout) == 0;
+}
+
+int main()
+{
+    sandbox();
+
+    ffmpegthumbnailer::VideoThumbnailer thumbnailer;
+    // seek to the keyframe before 10% of the duration and take the first
+    // decoded frame, the embedded cover art is used for the audio files
+    thumbnailer.setSeekPercentage(kSeekPercentage);
+    thumbnailer.setSmartFrameSelection(false);
+    thumbnailer.setMaintainAspectRatio(true);
+    thumbnailer.setPreferEmbeddedMetadata(true);
+
+    char *line = nullptr;
+    size_t capacity = 0;
+    std::vector<uint8_t> png;
+    while (getline(&line, &capacity, stdin) > 0) {
+        png.clear();
+
+        char *url = strchr(line, ' ');
+        const int size = atoi(line);
+        if (url && size > 0 && size <= kMaxSize) {
+            const QString &path = QUrl::fromEncoded(QByteArray(url + 1).trimmed()).toLocalFile();
+            try {
+                thumbnailer.setThumbnailSize(size);
+                thumbnailer.generateThumbnail(QFile::encodeName(path).toStdString(), ffmpegthumbnailer::Png, png);
+            } catch (const std::exception &e) {
+                fprintf(stderr, "thumbnail tool: %s\n", e.what());
+                png.clear();
+            }
+        }
+
+        if (!writeReply(png))
+            break;
+    }
+
+    free(line);
+    return 0;
+}
@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <dfm-base/utils/chinese2pinyin.h>
+
+#include "pinyintable.h"
+
+#include <QtConcurrent>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace {
+QStringList chineseNames(int count)
+{
+    std::mt19937 gen(20231018);
+    QStringList names;
+    names.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QString name;
+        for (int j = 0; j < 8; ++j)
+            name.append(QChar(static_cast<ushort>(0x4E00 + gen() % (0x9FA5 - 0x4E00 + 1))));
+        names.append(name + QString("_%1.txt").arg(i));
+    }
+    return names;
+}
+}   // namespace
+
+TEST(UT_Chinese2Pinyin, Transliterate)
+{
+    EXPECT_EQ(Pinyin::Chinese2Pinyin(QString("报告文件.txt")), QString("bao4gao4wen2jian4.txt"));
+    EXPECT_EQ(Pinyin::Chinese2Pinyin(QString("report.txt")), QString("report.txt"));
+    EXPECT_EQ(Pinyin::Chinese2Pinyin(QString()), QString());
+}
+
+TEST(UT_Chinese2Pinyin, CallerBuffer)
+{
+    const QString words("文件1");
+    QChar buffer[16];
+    EXPECT_EQ(Pinyin::Chinese2Pinyin(words.constData(), words.length(), buffer, 16), 10);
+    EXPECT_EQ(QString(buffer, 10), QString("wen2jian41"));
+
+    // too short, the length of the whole pinyin is returned
+    QChar shortBuffer[4];
+    EXPECT_EQ(Pinyin::Chinese2Pinyin(words.constData(), words.length(), shortBuffer, 4), 10);
+    EXPECT_EQ(QString(shortBuffer, 4), QString("wen2"));
+}
+
+TEST(UT_Chinese2Pinyin, ConcurrentCalls)
+{
+    const QStringList &names = chineseNames(2000);
+    QStringList expected;
+    for (const QString &name : names)
+        expected.append(Pinyin::Chinese2Pinyin(name));
+
+    const QStringList &results = QtConcurrent::blockingMapped<QStringList>(names, [](const QString &name) {
+        return Pinyin::Chinese2Pinyin(name);
+    });
+    EXPECT_EQ(results, expected);
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST(UT_Chinese2Pinyin, DISABLED_Benchmark)
+{
+    // the dictionary of the removed implementation, a hash of the code points
+    QHash<uint, QString> dict;
+    for (uint code = 0; code <= 0xFFFF; ++code) {
+        const uint8_t block = Pinyin::kBlockIndex[code >> 8];
+        if (block == Pinyin::kNoBlock || !Pinyin::kBlocks[block][code & 0xFF])
+            continue;
+        const Pinyin::Syllable &syllable = Pinyin::kSyllables[Pinyin::kBlocks[block][code & 0xFF] - 1];
+        dict.insert(code, QString::fromLatin1(Pinyin::kSyllableText + syllable.offset, syllable.length));
+    }
+    auto hashPinyin = [&dict](const QString &words) {
+        QString result;
+        for (int i = 0; i < words.length(); ++i) {
+            auto it = dict.find(words.at(i).unicode());
+            if (it != dict.end())
+                result.append(it.value());
+            else
+                result.append(words.at(i));
+        }
+        return result;
+    };
+
+    static constexpr int kNames { 1000000 };
+    const QStringList &names = chineseNames(kNames);
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 hashLength = 0;
+    for (const QString &name : names)
+        hashLength += hashPinyin(name).length();
+    const qint64 hashTime = timer.elapsed();
+
+    timer.restart();
+    qint64 tableLength = 0;
+    for (const QString &name : names)
+        tableLength += Pinyin::Chinese2Pinyin(name).length();
+    const qint64 tableTime = timer.elapsed();
+
+    timer.restart();
+    qint64 bufferLength = 0;
+    QChar buffer[256];
+    for (const QString &name : names)
+        bufferLength += Pinyin::Chinese2Pinyin(name.constData(), name.length(), buffer, 256);
+    const qint64 bufferTime = timer.elapsed();
+
+    EXPECT_EQ(hashLength, tableLength);
+    EXPECT_EQ(hashLength, bufferLength);
+    qInfo() << "pinyin of" << kNames << "names, hash(ms):" << hashTime << "table(ms):" << tableTime
+            << "caller buffer(ms):" << bufferTime;
+}
@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <dfm-base/utils/filestatisticsjob.h>
+#include <dfm-base/utils/fileutils.h>
+
+#include "stubext.h"
+
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDir>
+#include <QDebug>
+
+#include <gtest/gtest.h>
+
+#include <fts.h>
+#include <unistd.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_FileStatisticsJob : public testing::Test
+{
+public:
+    virtual void SetUp() override
+    {
+        stub.set_lamda(&FileUtils::isLocalDevice, [] { __DBG_STUB_INVOKE__ return true; });
+    }
+
+    virtual void TearDown() override
+    {
+        stub.clear();
+    }
+
+    // root/d<i>/s<j>/f<k>, the size of f<k> is k + 1
+    static void createTree(const QString &root, int dirs, int subDirs, int files)
+    {
+        for (int i = 0; i < dirs; ++i) {
+            for (int j = 0; j < subDirs; ++j) {
+                const QString &dir = QString("%1/d%2/s%3").arg(root).arg(i).arg(j);
+                QDir().mkpath(dir);
+                for (int k = 0; k < files; ++k) {
+                    QFile file(QString("%1/f%2").arg(dir).arg(k));
+                    file.open(QIODevice::WriteOnly);
+                    file.write(QByteArray(k + 1, 'x'));
+                }
+            }
+        }
+    }
+
+    static void runJob(FileStatisticsJob &job, const QList<QUrl> &urls)
+    {
+        job.start(urls);
+        job.wait();
+    }
+
+    stub_ext::StubExt stub;
+};
+
+TEST_F(UT_FileStatisticsJob, CountTree)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    createTree(dir.path(), 8, 4, 10);
+    // the hard link is counted once
+    ASSERT_EQ(::link(QString(dir.path() + "/d0/s0/f0").toLocal8Bit().constData(),
+                     QString(dir.path() + "/link").toLocal8Bit().constData()),
+              0);
+
+    FileStatisticsJob job;
+    runJob(job, { QUrl::fromLocalFile(dir.path()) });
+
+    EXPECT_EQ(job.filesCount(), 8 * 4 * 10);
+    EXPECT_EQ(job.directorysCount(), 1 + 8 + 8 * 4);
+    EXPECT_EQ(job.totalSize(), 8 * 4 * 55);
+    EXPECT_EQ(job.getFileSizeInfo()->fileCount, quint32(8 * 4 * 10));
+    EXPECT_EQ(job.getFileSizeInfo()->allFiles.count(), 1 + 8 + 8 * 4 + 8 * 4 * 10);
+    EXPECT_EQ(job.getFileSizeInfo()->allFiles.first(), QUrl::fromLocalFile(dir.path()));
+}
+
+TEST_F(UT_FileStatisticsJob, NestedSources)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    createTree(dir.path(), 2, 2, 5);
+
+    FileStatisticsJob job;
+    runJob(job, { QUrl::fromLocalFile(dir.path() + "/d0/s0/f0"), QUrl::fromLocalFile(dir.path()),
+                  QUrl::fromLocalFile(dir.path() + "/d1"), QUrl::fromLocalFile(dir.path()) });
+
+    EXPECT_EQ(job.filesCount(), 2 * 2 * 5);
+    EXPECT_EQ(job.directorysCount(), 1 + 2 + 2 * 2);
+    EXPECT_EQ(job.totalSize(), 2 * 2 * 15);
+}
+
+TEST_F(UT_FileStatisticsJob, SingleDepth)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    createTree(dir.path(), 3, 2, 5);
+
+    FileStatisticsJob job;
+    job.setFileHints(FileStatisticsJob::kSingleDepth);
+    runJob(job, { QUrl::fromLocalFile(dir.path()) });
+
+    EXPECT_EQ(job.filesCount(), 0);
+    EXPECT_EQ(job.directorysCount(), 1 + 3);
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST_F(UT_FileStatisticsJob, DISABLED_Benchmark)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    static constexpr int kDirs { 50 };
+    static constexpr int kSubDirs { 20 };
+    static constexpr int kFiles { 100 };
+    createTree(dir.path(), kDirs, kSubDirs, kFiles);
+
+    // a single threaded walk without any check, the lower bound of the walk before
+    QElapsedTimer timer;
+    timer.start();
+    QByteArray root = dir.path().toLocal8Bit();
+    char *paths[2] = { root.data(), nullptr };
+    FTS *fts = fts_open(paths, FTS_PHYSICAL | FTS_NOCHDIR, nullptr);
+    ASSERT_NE(fts, nullptr);
+    int ftsFiles = 0;
+    while (FTSENT *ent = fts_read(fts)) {
+        if (ent->fts_info == FTS_F)
+            ++ftsFiles;
+    }
+    fts_close(fts);
+    const qint64 ftsTime = timer.elapsed();
+
+    FileStatisticsJob job;
+    timer.restart();
+    runJob(job, { QUrl::fromLocalFile(dir.path()) });
+    const qint64 jobTime = timer.elapsed();
+
+    EXPECT_EQ(ftsFiles, kDirs * kSubDirs * kFiles);
+    EXPECT_EQ(job.filesCount(), ftsFiles);
+    EXPECT_EQ(job.directorysCount(), 1 + kDirs + kDirs * kSubDirs);
+    qInfo() << "statistics of" << ftsFiles << "files, single threaded fts(ms):" << ftsTime
+            << "statistics job(ms):" << jobTime << "threads:" << QThread::idealThreadCount();
+}
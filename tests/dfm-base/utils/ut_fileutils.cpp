@@ -13,11 +13,15 @@
 #include <QDebug>
 #include <QDir>
 #include <QStandardPaths>
+#include <QRegularExpression>
+#include <QElapsedTimer>
 #include <dfm-io/dfmio_utils.h>
 
 #include <gtest/gtest.h>
 #include "stubext.h"
 
+#include <random>
+
 DFMBASE_USE_NAMESPACE
 
 class UT_FileUtils : public testing::Test
@@ -109,4 +113,71 @@ TEST_F(UT_FileUtils, bug_186753_notdlnfsDeviceIsNotLocalDevice)
    EXPECT_FALSE(FileUtils::isLocalDevice(url));
 }
 
+TEST_F(UT_FileUtils, sortKeyOfStringMatchesCompareByStringEx)
+{
+    // numbers in the range of uint, compareByStringEx reads the larger ones as 0
+    const QStringList parts { "a", "B", "b", "x", "Z", "报", "告", "文", "_", "-", " ", "(", ".", ".",
+                              "txt", "1", "2", "9", "10", "007", "07", "42", "ä" };
+    const QRegularExpression longNumber("\\d{10,}");
+    std::mt19937 gen(20231018);
+    QStringList names;
+    while (names.count() < 400) {
+        QString name;
+        const int count = gen() % 8;
+        for (int i = 0; i < count; ++i)
+            name += parts.at(gen() % parts.count());
+        if (!name.contains(longNumber))
+            names.append(name);
+    }
+
+    QVector<QByteArray> keys;
+    for (const QString &name : names)
+        keys.append(FileUtils::sortKeyOfString(name));
+
+    for (int i = 0; i < names.count(); ++i) {
+        for (int j = 0; j < names.count(); ++j) {
+            EXPECT_EQ(keys.at(i) < keys.at(j), FileUtils::compareByStringEx(names.at(i), names.at(j)))
+                    << names.at(i).toStdString() << " " << names.at(j).toStdString();
+        }
+    }
+}
+
+TEST_F(UT_FileUtils, compareStringByKey)
+{
+    EXPECT_TRUE(FileUtils::compareString("file2", "file10", Qt::AscendingOrder));
+    EXPECT_FALSE(FileUtils::compareString("file2", "file10", Qt::DescendingOrder));
+    EXPECT_TRUE(FileUtils::compareString("file99999999999", "file100000000000", Qt::AscendingOrder));
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST_F(UT_FileUtils, DISABLED_sortKeyOfStringBenchmark)
+{
+    std::mt19937 gen(20231018);
+    QStringList names;
+    for (int i = 0; i < 100000; ++i)
+        names.append(QString("文件_%1 copy(%2).txt").arg(gen() % 100000).arg(gen() % 10));
+
+    QStringList byCompare = names;
+    QElapsedTimer timer;
+    timer.start();
+    std::stable_sort(byCompare.begin(), byCompare.end(), &FileUtils::compareByStringEx);
+    const qint64 compareTime = timer.elapsed();
+
+    timer.restart();
+    QVector<QPair<QByteArray, QString>> byKey;
+    byKey.reserve(names.count());
+    for (const QString &name : names)
+        byKey.append({ FileUtils::sortKeyOfString(name), name });
+    std::stable_sort(byKey.begin(), byKey.end(), [](const QPair<QByteArray, QString> &left, const QPair<QByteArray, QString> &right) {
+        return left.first < right.first;
+    });
+    const qint64 keyTime = timer.elapsed();
+
+    QStringList sorted;
+    for (const auto &pair : byKey)
+        sorted.append(pair.second);
+    EXPECT_EQ(sorted, byCompare);
+    qInfo() << "sort" << names.count() << "names, compareByStringEx(ms):" << compareTime << "sort keys(ms):" << keyTime;
+}
+
 #endif
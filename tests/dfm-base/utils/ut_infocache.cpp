@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "dfm-base/utils/private/infocache_p.h"
+
+#include <dfm-base/base/configs/dconfig/dconfigmanager.h>
+
+#include <QtConcurrent>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_InfoCache : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        stub.set_lamda(&DConfigManager::value, [] { __DBG_STUB_INVOKE__ return QVariant(); });
+        cache.reset(new InfoCache);
+    }
+    void TearDown() override
+    {
+        cache.reset();
+        stub.clear();
+    }
+
+    // no watcher is registered for the scheme
+    static QUrl makeUrl(int i)
+    {
+        return QUrl(QString("ut-infocache:///dir/file_%1").arg(i));
+    }
+
+    FileInfoPointer insert(int i)
+    {
+        FileInfoPointer info(new FileInfo(makeUrl(i)));
+        cache->cacheInfo(makeUrl(i), info);
+        return info;
+    }
+
+    QScopedPointer<InfoCache> cache;
+    stub_ext::StubExt stub;
+};
+
+TEST_F(UT_InfoCache, HitAndMiss)
+{
+    const FileInfoPointer &info = insert(1);
+    EXPECT_EQ(cache->getCacheInfo(makeUrl(1)), info);
+    EXPECT_TRUE(cache->getCacheInfo(makeUrl(2)).isNull());
+
+    const InfoCacheStatistics &stat = cache->statistics();
+    EXPECT_EQ(stat.hits, 1u);
+    EXPECT_EQ(stat.misses, 1u);
+    EXPECT_EQ(stat.inserts, 1u);
+    EXPECT_EQ(stat.count, 1);
+    EXPECT_EQ(stat.capacity, 64 * 1024 * 1024);
+}
+
+TEST_F(UT_InfoCache, Remove)
+{
+    insert(1);
+    insert(2);
+    cache->removeCaches({ makeUrl(1), makeUrl(3) });
+
+    EXPECT_TRUE(cache->getCacheInfo(makeUrl(1)).isNull());
+    EXPECT_FALSE(cache->getCacheInfo(makeUrl(2)).isNull());
+    const InfoCacheStatistics &stat = cache->statistics();
+    EXPECT_EQ(stat.removals, 1u);
+    EXPECT_EQ(stat.cost, InfoCachePrivate::entryCost(makeUrl(2)));
+}
+
+TEST_F(UT_InfoCache, EvictOverCapacity)
+{
+    // room for about 8 entries per shard
+    cache->d->capacity = InfoCachePrivate::entryCost(makeUrl(1000)) * 8 * InfoCachePrivate::kShardCount;
+    insert(0);
+    for (int i = 1; i < 2000; ++i) {
+        insert(i);
+        // a hot entry gets a second chance every time the hand passes it
+        cache->getCacheInfo(makeUrl(0));
+    }
+
+    const InfoCacheStatistics &stat = cache->statistics();
+    EXPECT_LE(stat.cost, stat.capacity);
+    EXPECT_GT(stat.evictions, 1000u);
+    EXPECT_FALSE(cache->getCacheInfo(makeUrl(0)).isNull());
+    EXPECT_FALSE(cache->getCacheInfo(makeUrl(1999)).isNull());
+    EXPECT_TRUE(cache->getCacheInfo(makeUrl(1)).isNull());
+}
+
+TEST_F(UT_InfoCache, AgingWithoutHits)
+{
+    insert(1);
+    insert(2);
+    // one sweep clears the bit set by the insert, the entry is removed after an hour of sweeps
+    for (int i = 0; i < 61; ++i) {
+        cache->getCacheInfo(makeUrl(2));
+        cache->evictCaches(true);
+    }
+
+    EXPECT_TRUE(cache->getCacheInfo(makeUrl(1)).isNull());
+    EXPECT_FALSE(cache->getCacheInfo(makeUrl(2)).isNull());
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST_F(UT_InfoCache, DISABLED_Benchmark)
+{
+    static constexpr int kCount { 50000 };
+    for (int i = 0; i < kCount; ++i)
+        insert(i);
+
+    QList<int> threads { 0, 1, 2, 3 };
+    QElapsedTimer timer;
+    timer.start();
+    QtConcurrent::blockingMap(threads, [this](int) {
+        for (int i = 0; i < kCount; ++i)
+            cache->getCacheInfo(makeUrl(i));
+    });
+    const qint64 elapsed = timer.nsecsElapsed();
+
+    const InfoCacheStatistics &stat = cache->statistics();
+    EXPECT_EQ(stat.hits, quint64(kCount * threads.count()));
+    qInfo() << "info cache:" << stat.hits << "hits from" << threads.count() << "threads in"
+            << elapsed / 1000000 << "ms," << elapsed / qint64(stat.hits) << "ns per hit";
+}
@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "dfm-base/utils/thumbnail/mediathumbnailer.h"
+
+#include <QTemporaryDir>
+#include <QFile>
+#include <QImage>
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+DFMGLOBAL_USE_NAMESPACE
+
+// a fake helper speaking the protocol of dde-file-thumbnail-tool, it replies
+// the same png for every file and crashes on the files named "crash"
+static constexpr char kFakeTool[] {
+    "#!/bin/sh\n"
+    "png=\"$(dirname \"$0\")/frame.png\"\n"
+    "while read size url; do\n"
+    "    case \"$url\" in\n"
+    "    *crash) exit 1 ;;\n"
+    "    *broken) echo \"err 0\" ;;\n"
+    "    *) echo \"ok $(stat -c %s \"$png\")\"; cat \"$png\" ;;\n"
+    "    esac\n"
+    "done\n"
+};
+
+class UT_MediaThumbnailer : public testing::Test
+{
+protected:
+    // the helper keeps running between the tests, so does its directory
+    static void SetUpTestCase()
+    {
+        toolDir = new QTemporaryDir;
+        QFile tool(toolDir->path() + "/dde-file-thumbnail-tool");
+        ASSERT_TRUE(tool.open(QIODevice::WriteOnly));
+        tool.write(kFakeTool);
+        tool.close();
+        tool.setPermissions(tool.permissions() | QFile::ExeOwner);
+
+        QImage frame(64, 32, QImage::Format_RGB32);
+        frame.fill(Qt::red);
+        ASSERT_TRUE(frame.save(toolDir->path() + "/frame.png", "png"));
+    }
+    static void TearDownTestCase()
+    {
+        delete toolDir;
+        toolDir = nullptr;
+    }
+
+    void SetUp() override
+    {
+        const QString path = toolDir->path() + "/dde-file-thumbnail-tool";
+        stub.set_lamda(&MediaThumbnailer::toolPath, [path] { __DBG_STUB_INVOKE__ return path; });
+    }
+    void TearDown() override
+    {
+        stub.clear();
+    }
+
+    static QTemporaryDir *toolDir;
+    stub_ext::StubExt stub;
+};
+
+QTemporaryDir *UT_MediaThumbnailer::toolDir { nullptr };
+
+TEST_F(UT_MediaThumbnailer, Batch)
+{
+    MediaThumbnailer *thumbnailer = MediaThumbnailer::instance();
+    ASSERT_TRUE(thumbnailer->isAvailable());
+
+    const auto &images = thumbnailer->thumbnails({ "/tmp/a b.mp4", "/tmp/c.mp3", "/tmp/broken" }, kNormal);
+    ASSERT_EQ(images.count(), 3);
+    EXPECT_EQ(images.at(0).size(), QSize(64, 32));
+    EXPECT_EQ(images.at(1).size(), QSize(64, 32));
+    EXPECT_TRUE(images.at(2).isNull());
+}
+
+TEST_F(UT_MediaThumbnailer, RestartAfterCrash)
+{
+    MediaThumbnailer *thumbnailer = MediaThumbnailer::instance();
+    const auto &images = thumbnailer->thumbnails({ "/tmp/a.mp4", "/tmp/crash", "/tmp/c.mp4" }, kNormal);
+    ASSERT_EQ(images.count(), 3);
+    EXPECT_FALSE(images.at(0).isNull());
+    EXPECT_TRUE(images.at(1).isNull());
+    EXPECT_FALSE(images.at(2).isNull());
+    EXPECT_TRUE(thumbnailer->isAvailable());
+}
+
+TEST_F(UT_MediaThumbnailer, Unavailable)
+{
+    stub.set_lamda(&MediaThumbnailer::toolPath, [] { __DBG_STUB_INVOKE__ return QString("/not/exists/tool"); });
+    MediaThumbnailer *thumbnailer = MediaThumbnailer::instance();
+    EXPECT_FALSE(thumbnailer->isAvailable());
+}
@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/utils/elidetextlayout.h"
+#include "dfm-base/utils/textlayoutcache.h"
+
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_TextLayoutCache : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        cache = TextLayoutCache::instance();
+        cache->clear();
+        begin = cache->statistics();
+    }
+
+    static ElideTextLayout *createLayout(const QString &text)
+    {
+        ElideTextLayout *layout = new ElideTextLayout(text);
+        layout->setAttribute(ElideTextLayout::kLineHeight, 20);
+        return layout;
+    }
+
+    TextLayoutCache *cache { nullptr };
+    TextLayoutCacheStatistics begin;
+};
+
+TEST_F(UT_TextLayoutCache, SharedLines)
+{
+    const QString name("a long file name that is wrapped and elided in the icon view.txt");
+    QStringList lines;
+    QScopedPointer<ElideTextLayout> layout(createLayout(name));
+    const QList<QRectF> &rects = layout->layout(QRectF(0, 0, 80, 60), Qt::ElideMiddle, nullptr, Qt::NoBrush, &lines);
+    ASSERT_FALSE(rects.isEmpty());
+
+    // another item of the same text at another position
+    QStringList cachedLines;
+    QScopedPointer<ElideTextLayout> other(createLayout(name));
+    const QList<QRectF> &cachedRects = other->layout(QRectF(100, 50, 80, 60), Qt::ElideMiddle, nullptr, Qt::NoBrush, &cachedLines);
+    EXPECT_EQ(cachedLines, lines);
+    ASSERT_EQ(cachedRects.count(), rects.count());
+    for (int i = 0; i < rects.count(); ++i)
+        EXPECT_EQ(cachedRects.at(i), rects.at(i).translated(100, 50));
+
+    const TextLayoutCacheStatistics &stat = cache->statistics();
+    EXPECT_EQ(stat.hits - begin.hits, 1u);
+    EXPECT_EQ(stat.misses - begin.misses, 1u);
+    EXPECT_EQ(stat.lineCount, 1);
+}
+
+TEST_F(UT_TextLayoutCache, KeyOfDocument)
+{
+    QScopedPointer<ElideTextLayout> layout(createLayout("file.txt"));
+    const QByteArray &key = layout->cacheKey(QSizeF(80, 60), Qt::ElideMiddle);
+    EXPECT_EQ(key, layout->cacheKey(QSizeF(80, 60), Qt::ElideMiddle));
+    EXPECT_NE(key, layout->cacheKey(QSizeF(81, 60), Qt::ElideMiddle));
+    EXPECT_NE(key, layout->cacheKey(QSizeF(80, 60), Qt::ElideRight));
+
+    // renamed
+    QScopedPointer<ElideTextLayout> renamed(createLayout("file2.txt"));
+    EXPECT_NE(key, renamed->cacheKey(QSizeF(80, 60), Qt::ElideMiddle));
+
+    // an object inserted by a LayoutText hook
+    QScopedPointer<ElideTextLayout> tagged(createLayout("file.txt"));
+    QTextCharFormat format;
+    format.setObjectType(QTextFormat::UserObject + 1);
+    format.setProperty(QTextFormat::UserProperty + 1, QVariant::fromValue(QList<QColor> { Qt::red }));
+    QTextCursor cursor(tagged->documentHandle());
+    cursor.insertText(QString(QChar::ObjectReplacementCharacter), format);
+    const QByteArray &tagKey = tagged->cacheKey(QSizeF(80, 60), Qt::ElideMiddle);
+    EXPECT_NE(key, tagKey);
+
+    format.setProperty(QTextFormat::UserProperty + 1, QVariant::fromValue(QList<QColor> { Qt::blue }));
+    cursor.setPosition(0);
+    cursor.setPosition(1, QTextCursor::KeepAnchor);
+    cursor.setCharFormat(format);
+    EXPECT_NE(tagKey, tagged->cacheKey(QSizeF(80, 60), Qt::ElideMiddle));
+
+    // the font
+    layout->setAttribute(ElideTextLayout::kFont, QFont("Noto Sans", 20));
+    EXPECT_NE(key, layout->cacheKey(QSizeF(80, 60), Qt::ElideMiddle));
+}
+
+TEST_F(UT_TextLayoutCache, Pixmaps)
+{
+    QPixmap pixmap(10, 10);
+    pixmap.fill(Qt::red);
+    cache->insertPixmap("key", pixmap);
+    EXPECT_FALSE(cache->findPixmap("key").isNull());
+    EXPECT_TRUE(cache->findPixmap("other").isNull());
+
+    cache->clear();
+    EXPECT_TRUE(cache->findPixmap("key").isNull());
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST_F(UT_TextLayoutCache, DISABLED_Benchmark)
+{
+    static constexpr int kItems { 300 };
+    static constexpr int kRepaints { 10 };
+    auto run = [](bool cached) {
+        for (int n = 0; n < kRepaints; ++n) {
+            if (!cached)
+                TextLayoutCache::instance()->clear();
+            for (int i = 0; i < kItems; ++i) {
+                QScopedPointer<ElideTextLayout> layout(createLayout(QString("desktop file name number %1.txt").arg(i)));
+                layout->layout(QRectF(0, 0, 80, 60), Qt::ElideMiddle);
+            }
+        }
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    run(false);
+    const qint64 uncached = timer.nsecsElapsed();
+    timer.restart();
+    run(true);
+    const qint64 cached = timer.nsecsElapsed();
+
+    qInfo() << "text layout:" << uncached / (kItems * kRepaints) / 1000 << "us uncached,"
+            << cached / (kItems * kRepaints) / 1000 << "us cached per item";
+}
@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/utils/thumbnail/thumbnailcreators.h"
+
+#include <QTemporaryDir>
+#include <QBuffer>
+#include <QImage>
+#include <QtEndian>
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+DFMGLOBAL_USE_NAMESPACE
+
+static QByteArray jpegData(const QSize &size, const QColor &color)
+{
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(color);
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "jpeg");
+    return data;
+}
+
+template<typename T>
+static void appendLE(QByteArray *data, T value)
+{
+    uchar bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    data->append(reinterpret_cast<const char *>(bytes), sizeof(T));
+}
+
+static void appendEntry(QByteArray *tiff, quint16 tag, quint16 type, quint32 value)
+{
+    appendLE<quint16>(tiff, tag);
+    appendLE<quint16>(tiff, type);
+    appendLE<quint32>(tiff, 1);
+    appendLE<quint32>(tiff, value);
+}
+
+static QByteArray exifJpegData(const QByteArray &image, const QByteArray &tiff);
+
+// a jpeg with an exif thumbnail and orientation
+static QByteArray exifJpegData(const QByteArray &image, const QByteArray &thumbnail, quint16 orientation)
+{
+    QByteArray tiff("II*\0", 4);
+    appendLE<quint32>(&tiff, 8);
+    // IFD0
+    appendLE<quint16>(&tiff, 1);
+    appendEntry(&tiff, 0x0112, 3, orientation);
+    appendLE<quint32>(&tiff, 26);
+    // IFD1
+    appendLE<quint16>(&tiff, 2);
+    appendEntry(&tiff, 0x0201, 4, 56);
+    appendEntry(&tiff, 0x0202, 4, quint32(thumbnail.size()));
+    appendLE<quint32>(&tiff, 0);
+    tiff.append(thumbnail);
+    return exifJpegData(image, tiff);
+}
+
+// a jpeg with the exif data of the tiff
+static QByteArray exifJpegData(const QByteArray &image, const QByteArray &tiff)
+{
+    const QByteArray &payload = QByteArray("Exif\0\0", 6) + tiff;
+    uchar length[2];
+    qToBigEndian<quint16>(quint16(payload.size() + 2), length);
+
+    QByteArray data = image.left(2);
+    data.append("\xFF\xE1", 2);
+    data.append(reinterpret_cast<const char *>(length), 2);
+    data.append(payload);
+    data.append(image.mid(2));
+    return data;
+}
+
+static QString writeFile(const QTemporaryDir &dir, const QString &name, const QByteArray &data)
+{
+    QFile file(dir.filePath(name));
+    file.open(QIODevice::WriteOnly);
+    file.write(data);
+    return file.fileName();
+}
+
+TEST(UT_ThumbnailCreators, testImageThumbnailCreatorJpeg)
+{
+    QTemporaryDir dir;
+    const QString &path = writeFile(dir, "big.jpg", jpegData({ 4000, 2000 }, Qt::red));
+
+    const QImage &image = ThumbnailCreators::imageThumbnailCreator(path, kLarge);
+    EXPECT_EQ(QSize(256, 128), image.size());
+}
+
+TEST(UT_ThumbnailCreators, testImageThumbnailCreatorWrongSuffix)
+{
+    QTemporaryDir dir;
+    QImage png(300, 300, QImage::Format_ARGB32);
+    png.fill(Qt::green);
+    png.save(dir.filePath("image.png"), "png");
+    QFile::rename(dir.filePath("image.png"), dir.filePath("image.jpg"));
+
+    const QImage &image = ThumbnailCreators::imageThumbnailCreator(dir.filePath("image.jpg"), kLarge);
+    EXPECT_EQ(QSize(256, 256), image.size());
+}
+
+TEST(UT_ThumbnailCreators, testImageThumbnailCreatorExif)
+{
+    QTemporaryDir dir;
+    const QByteArray &thumbnail = jpegData({ 300, 200 }, Qt::blue);
+    const QString &path = writeFile(dir, "exif.jpg", exifJpegData(jpegData({ 3000, 2000 }, Qt::red), thumbnail, 6));
+
+    // the embedded thumbnail, rotated by the orientation
+    const QImage &image = ThumbnailCreators::imageThumbnailCreator(path, kLarge);
+    ASSERT_FALSE(image.isNull());
+    EXPECT_GT(image.height(), image.width());
+    const QColor &color = image.pixelColor(image.width() / 2, image.height() / 2);
+    EXPECT_GT(color.blue(), 200);
+    EXPECT_LT(color.red(), 50);
+
+    // the embedded thumbnail is too small
+    const QString &smallPath = writeFile(dir, "small.jpg", exifJpegData(jpegData({ 3000, 2000 }, Qt::red), jpegData({ 150, 100 }, Qt::blue), 1));
+    const QImage &decoded = ThumbnailCreators::imageThumbnailCreator(smallPath, kLarge);
+    ASSERT_FALSE(decoded.isNull());
+    EXPECT_GT(decoded.pixelColor(decoded.width() / 2, decoded.height() / 2).red(), 200);
+}
+
+TEST(UT_ThumbnailCreators, testImageThumbnailCreatorCorruptExif)
+{
+    QTemporaryDir dir;
+    const QByteArray &image = jpegData({ 3000, 2000 }, Qt::red);
+
+    // the offset of IFD0 wraps the 32 bits bounds checks
+    QByteArray wrapped("II*\0", 4);
+    appendLE<quint32>(&wrapped, 0xFFFFFFFE);
+    wrapped.append(QByteArray(64, '\0'));
+
+    // the offset of IFD1 is out of the data
+    QByteArray nextOutOfData("II*\0", 4);
+    appendLE<quint32>(&nextOutOfData, 8);
+    appendLE<quint16>(&nextOutOfData, 1);
+    appendEntry(&nextOutOfData, 0x0112, 3, 1);
+    appendLE<quint32>(&nextOutOfData, 0xFFFFFFF0);
+
+    for (const QByteArray &tiff : { wrapped, nextOutOfData }) {
+        const QString &path = writeFile(dir, "corrupt.jpg", exifJpegData(image, tiff));
+        const QImage &decoded = ThumbnailCreators::imageThumbnailCreator(path, kLarge);
+        ASSERT_FALSE(decoded.isNull());
+        EXPECT_GT(decoded.pixelColor(decoded.width() / 2, decoded.height() / 2).red(), 200);
+    }
+}
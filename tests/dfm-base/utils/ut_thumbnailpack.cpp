@@ -0,0 +1,195 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "dfm-base/utils/thumbnail/thumbnailpack.h"
+#include "dfm-base/utils/thumbnail/thumbnailhelper.h"
+
+#include <dfm-base/base/configs/dconfig/dconfigmanager.h>
+
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QImageReader>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QFile>
+#include <QUrl>
+#include <QDebug>
+
+#include <gtest/gtest.h>
+
+#include <sys/file.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_ThumbnailPack : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        stub.set_lamda(&DConfigManager::value, [] { __DBG_STUB_INVOKE__ return QVariant(); });
+        packPath = dir.path() + "/normal.pack";
+    }
+    void TearDown() override
+    {
+        stub.clear();
+    }
+
+    static QImage makeImage(const QColor &color, bool alpha = false)
+    {
+        QImage image(128, 96, alpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+        image.fill(color);
+        return image;
+    }
+
+    static QByteArray keyOf(const QString &url)
+    {
+        return ThumbnailHelper::dataToMd5Hex(url.toLocal8Bit());
+    }
+
+    QTemporaryDir dir;
+    QString packPath;
+    stub_ext::StubExt stub;
+};
+
+TEST_F(UT_ThumbnailPack, InsertAndFind)
+{
+    const QString url("file:///tmp/a.jpg");
+    {
+        ThumbnailPack pack(packPath);
+        ASSERT_TRUE(pack.insert(keyOf(url), url, 100, makeImage(Qt::red)));
+        ASSERT_TRUE(pack.insert(keyOf("file:///tmp/b.png"), "file:///tmp/b.png", 200, makeImage(QColor(0, 0, 255, 128), true)));
+
+        const QImage &image = pack.find(keyOf(url), 100);
+        ASSERT_FALSE(image.isNull());
+        EXPECT_EQ(image.size(), QSize(128, 96));
+        EXPECT_EQ(image.pixel(10, 10), QColor(Qt::red).rgb());
+        EXPECT_EQ(image.text(QT_STRINGIFY(Thumb::URL)), url);
+        EXPECT_TRUE(pack.find(keyOf(url), 101).isNull());
+    }
+
+    // read back from the file
+    ThumbnailPack pack(packPath);
+    EXPECT_EQ(pack.count(), 2);
+    const QImage &image = pack.find(keyOf("file:///tmp/b.png"));
+    ASSERT_FALSE(image.isNull());
+    EXPECT_EQ(image.format(), QImage::Format_ARGB32_Premultiplied);
+    EXPECT_EQ(qAlpha(image.pixel(0, 0)), 128);
+}
+
+TEST_F(UT_ThumbnailPack, ReplaceAndCompact)
+{
+    QFile source(dir.path() + "/source.jpg");
+    ASSERT_TRUE(source.open(QIODevice::WriteOnly));
+    source.close();
+    const QString &url = QUrl::fromLocalFile(source.fileName()).toString(QUrl::FullyEncoded);
+    const qint64 mtime = QFileInfo(source.fileName()).lastModified().toSecsSinceEpoch();
+    const QString removedUrl("file:///not/exists.jpg");
+
+    ThumbnailPack pack(packPath);
+    ASSERT_TRUE(pack.insert(keyOf(url), url, mtime - 1, makeImage(Qt::red)));
+    ASSERT_TRUE(pack.insert(keyOf(url), url, mtime, makeImage(Qt::green)));
+    ASSERT_TRUE(pack.insert(keyOf(removedUrl), removedUrl, 1, makeImage(Qt::blue)));
+    EXPECT_EQ(pack.count(), 2);
+    EXPECT_GT(pack.deadSize(), 0);
+
+    const qint64 size = pack.fileSize();
+    ASSERT_TRUE(pack.compact());
+    EXPECT_EQ(pack.count(), 1);
+    EXPECT_EQ(pack.deadSize(), 0);
+    EXPECT_LT(pack.fileSize(), size / 2);
+    EXPECT_EQ(pack.find(keyOf(url), mtime).pixel(0, 0), QColor(Qt::green).rgb());
+}
+
+TEST_F(UT_ThumbnailPack, DropBrokenTail)
+{
+    qint64 size = 0;
+    {
+        ThumbnailPack pack(packPath);
+        ASSERT_TRUE(pack.insert(keyOf("file:///tmp/a.jpg"), "file:///tmp/a.jpg", 1, makeImage(Qt::red)));
+        size = pack.fileSize();
+    }
+
+    // an interrupted append
+    QFile file(packPath);
+    ASSERT_TRUE(file.open(QIODevice::Append));
+    file.write(QByteArray(100, 'x'));
+    file.close();
+
+    ThumbnailPack pack(packPath);
+    EXPECT_EQ(pack.count(), 1);
+    EXPECT_EQ(pack.fileSize(), size);
+    EXPECT_EQ(QFileInfo(packPath).size(), size);
+}
+
+TEST_F(UT_ThumbnailPack, ImportDirectory)
+{
+    const QString url("file:///tmp/imported.jpg");
+    QImage image = makeImage(Qt::yellow);
+    image.setText(QT_STRINGIFY(Thumb::URL), url);
+    image.setText(QT_STRINGIFY(Thumb::MTime), "42");
+    ASSERT_TRUE(image.save(dir.path() + "/" + keyOf(url) + ".png", "png"));
+
+    ThumbnailPack pack(packPath);
+    EXPECT_EQ(pack.importDirectory(dir.path()), 1);
+    EXPECT_EQ(pack.importDirectory(dir.path()), 0);
+    EXPECT_FALSE(pack.find(keyOf(url), 42).isNull());
+}
+
+TEST_F(UT_ThumbnailPack, FindDoesNotWaitForWriters)
+{
+    const QString url("file:///tmp/a.jpg");
+    {
+        ThumbnailPack pack(packPath);
+        ASSERT_TRUE(pack.insert(keyOf(url), url, 1, makeImage(Qt::red)));
+    }
+
+    QFile other(packPath);
+    ASSERT_TRUE(other.open(QIODevice::ReadOnly));
+    ASSERT_EQ(::flock(other.handle(), LOCK_EX), 0);
+
+    // not opened yet, a miss instead of waiting for the file lock of another process
+    ThumbnailPack pack(packPath);
+    EXPECT_TRUE(pack.find(keyOf(url), 1).isNull());
+    ::flock(other.handle(), LOCK_UN);
+    EXPECT_FALSE(pack.find(keyOf(url), 1).isNull());
+
+    // a writer of this process holds the pack
+    pack.writeMutex.lock();
+    ASSERT_EQ(::flock(other.handle(), LOCK_EX), 0);
+    EXPECT_FALSE(pack.find(keyOf(url), 1).isNull());
+    ::flock(other.handle(), LOCK_UN);
+    pack.writeMutex.unlock();
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST_F(UT_ThumbnailPack, DISABLED_Benchmark)
+{
+    static constexpr int kCount { 500 };
+    ThumbnailPack pack(packPath);
+    QStringList pngs;
+    for (int i = 0; i < kCount; ++i) {
+        const QString &url = QString("file:///tmp/photo_%1.jpg").arg(i);
+        QImage image = makeImage(QColor::fromHsv(i % 360, 200, 200));
+        ASSERT_TRUE(pack.insert(keyOf(url), url, i, image));
+        if (i < 100) {
+            pngs.append(dir.path() + QString("/%1.png").arg(i));
+            image.save(pngs.last(), "png");
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kCount; ++i)
+        ASSERT_FALSE(pack.find(keyOf(QString("file:///tmp/photo_%1.jpg").arg(i)), i).isNull());
+    const qint64 packTime = timer.nsecsElapsed();
+
+    timer.restart();
+    for (const QString &png : pngs)
+        ASSERT_FALSE(QImageReader(png, "png").read().isNull());
+    const qint64 pngTime = timer.nsecsElapsed();
+
+    qInfo() << "thumbnail pack: lookup" << packTime / kCount / 1000 << "us, png decode"
+            << pngTime / pngs.count() / 1000 << "us per thumbnail";
+}
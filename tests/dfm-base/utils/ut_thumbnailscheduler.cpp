@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "dfm-base/utils/thumbnail/thumbnailscheduler.h"
+
+#include <QUrl>
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+DFMGLOBAL_USE_NAMESPACE
+
+static QUrl testUrl(int i)
+{
+    return QUrl::fromLocalFile(QString("/tmp/thumbnail_%1.png").arg(i));
+}
+
+TEST(UT_ThumbnailScheduler, testLatestFirst)
+{
+    ThumbnailScheduler scheduler;
+    for (int i = 0; i < 5; ++i)
+        EXPECT_TRUE(scheduler.push(testUrl(i), kLarge));
+
+    // requested again, e.g. scrolled back into view
+    EXPECT_FALSE(scheduler.push(testUrl(1), kLarge));
+
+    ThumbnailScheduler::Task task;
+    QList<QUrl> order;
+    while (scheduler.take(&task)) {
+        order.append(task.url);
+        scheduler.finish(task);
+    }
+
+    EXPECT_EQ((QList<QUrl> { testUrl(1), testUrl(4), testUrl(3), testUrl(2), testUrl(0) }), order);
+
+    const auto &metrics = scheduler.metrics();
+    EXPECT_EQ(5, metrics.finished);
+    EXPECT_EQ(1, metrics.deduplicated);
+    EXPECT_EQ(5, metrics.maxQueueDepth);
+    EXPECT_EQ(0, metrics.queueDepth);
+}
+
+TEST(UT_ThumbnailScheduler, testDeduplicateRunning)
+{
+    ThumbnailScheduler scheduler;
+    EXPECT_TRUE(scheduler.push(testUrl(0), kLarge));
+    EXPECT_TRUE(scheduler.push(testUrl(0), kNormal));
+
+    ThumbnailScheduler::Task task;
+    ASSERT_TRUE(scheduler.take(&task));
+    EXPECT_EQ(kNormal, task.size);
+    EXPECT_FALSE(scheduler.push(testUrl(0), kNormal));
+    EXPECT_EQ(1, scheduler.metrics().running);
+
+    scheduler.finish(task);
+    EXPECT_TRUE(scheduler.push(testUrl(0), kNormal));
+}
+
+TEST(UT_ThumbnailScheduler, testSlowDeviceLimit)
+{
+    ThumbnailScheduler scheduler(1);
+    scheduler.push(testUrl(0), kLarge, false);
+    scheduler.push(testUrl(1), kLarge, true);
+    scheduler.push(testUrl(2), kLarge, true);
+
+    ThumbnailScheduler::Task slow;
+    ASSERT_TRUE(scheduler.take(&slow));
+    EXPECT_EQ(testUrl(2), slow.url);
+
+    // the other slow task waits while one is running
+    ThumbnailScheduler::Task task;
+    ASSERT_TRUE(scheduler.take(&task));
+    EXPECT_EQ(testUrl(0), task.url);
+    EXPECT_FALSE(scheduler.take(&task));
+
+    scheduler.finish(slow);
+    ASSERT_TRUE(scheduler.take(&task));
+    EXPECT_EQ(testUrl(1), task.url);
+}
+
+TEST(UT_ThumbnailScheduler, testClassifyWhenTaken)
+{
+    stub_ext::StubExt stub;
+    QList<QUrl> classified;
+    stub.set_lamda(&ThumbnailScheduler::isSlowDevice, [&classified](const QUrl &url) {
+        __DBG_STUB_INVOKE__
+        classified.append(url);
+        return true;
+    });
+
+    ThumbnailScheduler scheduler(1);
+    scheduler.push(testUrl(0), kLarge, true);
+    scheduler.push(testUrl(1), kLarge);
+    EXPECT_TRUE(classified.isEmpty());
+
+    ThumbnailScheduler::Task slow;
+    ASSERT_TRUE(scheduler.take(&slow));
+    EXPECT_EQ(testUrl(1), slow.url);
+    EXPECT_TRUE(slow.slowDevice);
+    EXPECT_EQ(QList<QUrl> { testUrl(1) }, classified);
+
+    // the slow task waits, it is not classified again
+    ThumbnailScheduler::Task task;
+    EXPECT_FALSE(scheduler.take(&task));
+    scheduler.push(testUrl(2), kLarge);
+    EXPECT_FALSE(scheduler.take(&task));
+    EXPECT_EQ(2, scheduler.metrics().queueDepth);
+
+    scheduler.finish(slow);
+    ASSERT_TRUE(scheduler.take(&task));
+    EXPECT_EQ(testUrl(2), task.url);
+    EXPECT_EQ(2, classified.count());
+}
+
+TEST(UT_ThumbnailScheduler, testClear)
+{
+    ThumbnailScheduler scheduler;
+    scheduler.push(testUrl(0), kLarge);
+    scheduler.clear();
+
+    ThumbnailScheduler::Task task;
+    EXPECT_FALSE(scheduler.take(&task));
+    EXPECT_FALSE(ThumbnailScheduler::isSlowDevice(QUrl("smb://localhost/share/a.png")));
+}
@@ -32,6 +32,12 @@ bool TestQObject::bigger15(int v, int *called)
     return v > 15;
 }
 
+bool TestQObject::bigger20(qint64 v, int *called)
+{
+    *called = 20;
+    return v > 20;
+}
+
 bool TestQObject::empty1()
 {
     qDebug() << __PRETTY_FUNCTION__;
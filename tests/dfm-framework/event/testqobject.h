@@ -18,6 +18,7 @@ public slots:
     int test1(int a);
     bool bigger10(int v, int *called);
     bool bigger15(int v, int *called);
+    bool bigger20(qint64 v, int *called);
     bool empty1();
     bool empty2();
     void add1(int *val);
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "testqobject.h"
+
+#include <dfm-framework/dpf.h>
+#include <dfm-framework/event/event.h>
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <gtest/gtest.h>
+
+DPF_USE_NAMESPACE
+
+// per-dispatch overhead of the events, the typed calls against the calls
+// whose arguments are converted through QVariant
+// opt-in, run with --gtest_also_run_disabled_tests
+class DISABLED_UT_EventBenchmark : public testing::Test
+{
+public:
+    static constexpr int kCount { 200000 };
+
+    template<class Func>
+    static qint64 nsecsPerCall(Func func)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < kCount; ++i)
+            func(i);
+        return timer.nsecsElapsed() / kCount;
+    }
+};
+
+TEST_F(DISABLED_UT_EventBenchmark, hook)
+{
+    TestQObject b;
+    EventType typed = 20001;
+    EventType converted = 20002;
+    int called { 0 };
+
+    dpfHookSequence->follow(typed, &b, &TestQObject::bigger15);
+    dpfHookSequence->follow(typed, &b, &TestQObject::bigger10);
+    dpfHookSequence->follow(converted, &b, &TestQObject::bigger20);
+    dpfHookSequence->follow(converted, &b, &TestQObject::bigger20);
+
+    const qint64 typedTime = nsecsPerCall([&](int i) { dpfHookSequence->run(typed, i % 10, &called); });
+    EXPECT_EQ(called, 10);
+    const qint64 convertedTime = nsecsPerCall([&](int i) { dpfHookSequence->run(converted, i % 10, &called); });
+    EXPECT_EQ(called, 20);
+
+    qInfo() << "hook with 2 handlers:" << typedTime << "ns typed," << convertedTime << "ns converted";
+    dpfHookSequence->unfollow(typed);
+    dpfHookSequence->unfollow(converted);
+}
+
+TEST_F(DISABLED_UT_EventBenchmark, signal)
+{
+    TestQObject b;
+    EventType type = 20003;
+    int value { 0 };
+
+    dpfSignalDispatcher->subscribe(type, &b, &TestQObject::add1);
+    const qint64 typedTime = nsecsPerCall([&](int) { dpfSignalDispatcher->publish(type, &value); });
+    EXPECT_EQ(value, kCount);
+
+    const qint64 variantTime = nsecsPerCall([&](int) { dpfSignalDispatcher->publish(type, QVariantList { QVariant::fromValue(&value) }); });
+    EXPECT_EQ(value, kCount * 2);
+
+    qInfo() << "signal with 1 handler:" << typedTime << "ns typed," << variantTime << "ns through QVariantList";
+    dpfSignalDispatcher->unsubscribe(type);
+}
+
+TEST_F(DISABLED_UT_EventBenchmark, slot)
+{
+    TestQObject b;
+    EventType type = 20004;
+
+    dpfSlotChannel->connect(type, &b, &TestQObject::test1);
+    int sum { 0 };
+    const qint64 typedTime = nsecsPerCall([&](int i) { sum += dpfSlotChannel->push(type, i).toInt(); });
+    EXPECT_GT(sum, 0);
+
+    const qint64 convertedTime = nsecsPerCall([&](int i) { dpfSlotChannel->push(type, qint64(i)); });
+
+    qInfo() << "slot:" << typedTime << "ns typed," << convertedTime << "ns converted";
+    dpfSlotChannel->disconnect(type);
+}
@@ -43,3 +43,32 @@ TEST_F(UT_EventHelper, bug_182183_FunctionFailed)
     EXPECT_EQ(1024, ret());
 #endif
 }
+
+struct TestTableItem
+{
+    void clear() { value = 0; }
+    int value { 0 };
+};
+
+TEST_F(UT_EventHelper, EventTableReusesRemovedItem)
+{
+    EventTable<TestTableItem> table;
+    EventType type { 10 };
+
+    TestTableItem *item = table.insert(type);
+    item->value = 1;
+    EXPECT_TRUE(table.remove(type));
+    EXPECT_FALSE(table.contains(type));
+    // a reader may still hold the removed item
+    EXPECT_EQ(1, item->value);
+
+    for (int i = 0; i < 100; ++i) {
+        TestTableItem *again = table.valueOrInsert(type);
+        EXPECT_EQ(item, again);
+        EXPECT_EQ(0, again->value);
+        again->value = i + 1;
+        EXPECT_TRUE(table.remove(type));
+    }
+    EXPECT_EQ(std::size_t(1), table.ownedItems.size());
+    EXPECT_FALSE(table.remove(type));
+}
@@ -45,6 +45,25 @@ TEST_F(UT_EventSequence, test_append)
     EXPECT_EQ(10, called);
 }
 
+TEST_F(UT_EventSequence, test_append_converted)
+{
+    TestQObject b;
+
+    EventSequence e;
+    int called { 0 };
+
+    // bigger20 takes a qint64, the int is converted by QVariant
+    e.append(&b, &TestQObject::bigger10);
+    e.append(&b, &TestQObject::bigger20);
+
+    EXPECT_FALSE(e.traversal(9, &called));
+    EXPECT_EQ(20, called);
+    EXPECT_TRUE(e.traversal(21, &called));
+    EXPECT_EQ(10, called);
+    EXPECT_TRUE(e.traversal(qint64(21), &called));
+    EXPECT_EQ(20, called);
+}
+
 TEST_F(UT_EventSequence, test_append_empty_1)
 {
     TestQObject b;
@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+
+#include "dfm-framework/lifecycle/private/pluginmanifest_p.h"
+
+#include <QTemporaryDir>
+#include <QFile>
+
+#include <gtest/gtest.h>
+
+DPF_USE_NAMESPACE
+
+class UT_PluginManifest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        manifestPath = dir.path() + "/plugins.manifest";
+        pluginPath = dir.path() + "/libtest.so";
+        writePlugin("plugin");
+
+        stub.set_lamda(&QPluginLoader::metaData, [this] {
+            __DBG_STUB_INVOKE__
+            ++scanned;
+            return QJsonObject { { "IID", "org.deepin.plugin.test" } };
+        });
+    }
+    void TearDown() override
+    {
+        stub.clear();
+    }
+
+    void writePlugin(const QByteArray &data)
+    {
+        QFile file(pluginPath);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(data);
+    }
+
+    QTemporaryDir dir;
+    QString manifestPath;
+    QString pluginPath;
+    QPluginLoader loader;
+    int scanned { 0 };
+    stub_ext::StubExt stub;
+};
+
+TEST_F(UT_PluginManifest, ReadFromManifest)
+{
+    {
+        PluginManifest manifest(manifestPath);
+        EXPECT_EQ(manifest.metaData(pluginPath, &loader).value("IID").toString(), "org.deepin.plugin.test");
+        EXPECT_TRUE(manifest.save());
+    }
+    EXPECT_EQ(scanned, 1);
+    EXPECT_TRUE(QFile::exists(manifestPath));
+
+    PluginManifest manifest(manifestPath);
+    EXPECT_EQ(manifest.metaData(pluginPath, &loader).value("IID").toString(), "org.deepin.plugin.test");
+    EXPECT_EQ(scanned, 1);
+}
+
+TEST_F(UT_PluginManifest, ScanChangedFile)
+{
+    {
+        PluginManifest manifest(manifestPath);
+        manifest.metaData(pluginPath, &loader);
+        manifest.save();
+    }
+
+    writePlugin("changed plugin");
+    PluginManifest manifest(manifestPath);
+    manifest.metaData(pluginPath, &loader);
+    EXPECT_EQ(scanned, 2);
+}
+
+TEST_F(UT_PluginManifest, DropRemovedFile)
+{
+    {
+        PluginManifest manifest(manifestPath);
+        manifest.metaData(pluginPath, &loader);
+        manifest.save();
+    }
+
+    // the file is not scanned this time
+    {
+        PluginManifest manifest(manifestPath);
+        manifest.save();
+    }
+
+    PluginManifest manifest(manifestPath);
+    manifest.metaData(pluginPath, &loader);
+    EXPECT_EQ(scanned, 2);
+}
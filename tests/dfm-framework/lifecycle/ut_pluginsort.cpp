@@ -78,3 +78,27 @@ TEST_F(UT_PluginSort, test_rhombus_complex)
     }
     EXPECT_TRUE(trueRet.contains(ret));
 }
+
+TEST_F(UT_PluginSort, test_depends_level)
+{
+    auto depend = [](PluginMetaObjectPointer ptr, const QString &name) {
+        PluginDepend dep;
+        dep.pluginName = name;
+        ptr->d->depends.append(dep);
+    };
+    // A <- B <- D, A <- C <- D, E depends an unknown plugin
+    depend(B, "A");
+    depend(C, "A");
+    depend(D, "B");
+    depend(D, "C");
+    depend(E, "X");
+
+    QQueue<PluginMetaObjectPointer> queue { A, B, E, C, D };
+    PluginManagerPrivate::dependsLevel(&queue);
+    EXPECT_EQ(queue, QQueue<PluginMetaObjectPointer>({ A, E, B, C, D }));
+    EXPECT_EQ(A->d->timeline.level, 0);
+    EXPECT_EQ(E->d->timeline.level, 0);
+    EXPECT_EQ(B->d->timeline.level, 1);
+    EXPECT_EQ(C->d->timeline.level, 1);
+    EXPECT_EQ(D->d->timeline.level, 2);
+}
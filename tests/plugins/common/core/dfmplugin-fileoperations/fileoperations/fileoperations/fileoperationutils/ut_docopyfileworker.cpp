@@ -14,6 +14,12 @@
 
 #include <gtest/gtest.h>
 
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+
+#include <fcntl.h>
+#include <unistd.h>
+
 
 DPFILEOPERATIONS_USE_NAMESPACE
 DFMBASE_USE_NAMESPACE
@@ -135,6 +141,291 @@ TEST_F(UT_DoCopyFileWorker, testDoCopyFilePractically)
     QProcess::execute("rm sourceUrl.txt targetUrl.txt");
 }
 
+TEST_F(UT_DoCopyFileWorker, testDoCopyFileByPipeline)
+{
+    QSharedPointer<WorkerData> data(new WorkerData);
+    data->copyQueueDepth = 4;
+    DoCopyFileWorker worker(data);
+
+    QTemporaryDir dir;
+    QByteArray content;
+    for (int i = 0; i < 5 * 1024 * 1024 + 123; ++i)
+        content.append(static_cast<char>(i * 7 % 251));
+    QFile sourceFile(dir.filePath("source.bin"));
+    ASSERT_TRUE(sourceFile.open(QIODevice::WriteOnly));
+    sourceFile.write(content);
+    sourceFile.close();
+
+    auto sorceInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("source.bin")));
+    auto targetInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("target.bin")));
+    bool skip { false };
+    EXPECT_TRUE(worker.doCopyFilePractically(sorceInfo, targetInfo, &skip));
+    EXPECT_TRUE(skip);
+    EXPECT_EQ(content.size(), data->currentWriteSize.load());
+
+    QFile targetFile(dir.filePath("target.bin"));
+    ASSERT_TRUE(targetFile.open(QIODevice::ReadOnly));
+    EXPECT_TRUE(targetFile.readAll() == content);
+}
+
+TEST_F(UT_DoCopyFileWorker, testDoCopyFileByPipelineStopped)
+{
+    QSharedPointer<WorkerData> data(new WorkerData);
+    data->copyQueueDepth = 4;
+    DoCopyFileWorker worker(data);
+
+    QTemporaryDir dir;
+    QFile sourceFile(dir.filePath("source.bin"));
+    ASSERT_TRUE(sourceFile.open(QIODevice::WriteOnly));
+    sourceFile.write(QByteArray(3 * 1024 * 1024, 'a'));
+    sourceFile.close();
+
+    auto sorceInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("source.bin")));
+    auto targetInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("target.bin")));
+    stub_ext::StubExt stub;
+    stub.set_lamda(&DoCopyFileWorker::doWriteFile, [&worker] {
+        __DBG_STUB_INVOKE__
+        worker.stop();
+        return false;
+    });
+    bool skip { false };
+    EXPECT_FALSE(worker.doCopyFilePractically(sorceInfo, targetInfo, &skip));
+}
+
+TEST_F(UT_DoCopyFileWorker, testPipelineVerify)
+{
+    QSharedPointer<WorkerData> data(new WorkerData);
+    data->jobFlags |= AbstractJobHandler::JobFlag::kCopyIntegrityChecking;
+    data->checksumType = FileChecksum::kCrc32c;
+    data->pipelineVerify = true;
+    DoCopyFileWorker worker(data);
+
+    QTemporaryDir dir;
+    QFile sourceFile(dir.filePath("source.bin"));
+    ASSERT_TRUE(sourceFile.open(QIODevice::WriteOnly));
+    for (int i = 0; i < 3 * 1024; ++i)
+        sourceFile.write(QByteArray(1024 + 1, static_cast<char>(i)));
+    sourceFile.close();
+
+    int errorCount { 0 };
+    stub_ext::StubExt stub;
+    stub.set_lamda(&DoCopyFileWorker::doHandleErrorAndWait, [&errorCount] {
+        __DBG_STUB_INVOKE__
+        ++errorCount;
+        return AbstractJobHandler::SupportAction::kSkipAction;
+    });
+
+    auto sorceInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("source.bin")));
+    auto targetInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("target.bin")));
+    bool skip { false };
+    EXPECT_TRUE(worker.doCopyFilePractically(sorceInfo, targetInfo, &skip));
+    EXPECT_TRUE(skip);
+    worker.waitVerifyFinished();
+    EXPECT_EQ(0, errorCount);
+
+    // the target does not match the source
+    worker.startVerify(sorceInfo, targetInfo, 0);
+    worker.waitVerifyFinished();
+    EXPECT_EQ(1, errorCount);
+}
+
+TEST_F(UT_DoCopyFileWorker, testPipelineVerifyRetry)
+{
+    QSharedPointer<WorkerData> data(new WorkerData);
+    data->jobFlags |= AbstractJobHandler::JobFlag::kCopyIntegrityChecking;
+    data->checksumType = FileChecksum::kCrc32c;
+    data->pipelineVerify = true;
+    DoCopyFileWorker worker(data);
+
+    QTemporaryDir dir;
+    const QByteArray content(3 * 1024 * 1024 + 1, 'x');
+    QFile sourceFile(dir.filePath("source.bin"));
+    ASSERT_TRUE(sourceFile.open(QIODevice::WriteOnly));
+    sourceFile.write(content);
+    sourceFile.close();
+    // copied wrong
+    QFile targetFile(dir.filePath("target.bin"));
+    ASSERT_TRUE(targetFile.open(QIODevice::WriteOnly));
+    targetFile.write("broken");
+    targetFile.close();
+
+    QList<AbstractJobHandler::SupportAction> actions { AbstractJobHandler::SupportAction::kRetryAction };
+    int errorCount { 0 };
+    stub_ext::StubExt stub;
+    stub.set_lamda(&DoCopyFileWorker::doHandleErrorAndWait, [&errorCount, &actions] {
+        __DBG_STUB_INVOKE__
+        ++errorCount;
+        return actions.isEmpty() ? AbstractJobHandler::SupportAction::kSkipAction : actions.takeFirst();
+    });
+
+    FileChecksum checkSum(FileChecksum::kCrc32c);
+    checkSum.update(content.constData(), content.size());
+    auto sorceInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("source.bin")));
+    auto targetInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("target.bin")));
+    worker.startVerify(sorceInfo, targetInfo, checkSum.value());
+    worker.waitVerifyFinished();
+
+    // the retry copies the file again instead of reading the broken target once more
+    EXPECT_EQ(1, errorCount);
+    ASSERT_TRUE(targetFile.open(QIODevice::ReadOnly));
+    EXPECT_EQ(content, targetFile.readAll());
+}
+
+TEST_F(UT_DoCopyFileWorker, testDoKernelFileCopy)
+{
+    QSharedPointer<WorkerData> data(new WorkerData);
+    DoCopyFileWorker worker(data);
+    EXPECT_EQ(WorkerData::kUserSpaceCopy, worker.doKernelFileCopy(nullptr, nullptr));
+
+    QTemporaryDir dir;
+    QByteArray content;
+    for (int i = 0; i < 3 * 1024 * 1024 + 17; ++i)
+        content.append(static_cast<char>(i % 253));
+    QFile sourceFile(dir.filePath("source.bin"));
+    ASSERT_TRUE(sourceFile.open(QIODevice::WriteOnly));
+    sourceFile.write(content);
+    sourceFile.close();
+
+    auto sorceInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("source.bin")));
+    auto targetInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("target.bin")));
+    const auto strategy = worker.doKernelFileCopy(sorceInfo, targetInfo);
+    EXPECT_NE(WorkerData::kUserSpaceCopy, strategy);
+    EXPECT_EQ(1, data->copyStrategyCount[strategy].load());
+    EXPECT_EQ(content.size(), data->currentWriteSize.load());
+
+    QFile targetFile(dir.filePath("target.bin"));
+    ASSERT_TRUE(targetFile.open(QIODevice::ReadOnly));
+    EXPECT_TRUE(targetFile.readAll() == content);
+
+    data->jobFlags |= AbstractJobHandler::JobFlag::kCopyIntegrityChecking;
+    EXPECT_EQ(WorkerData::kUserSpaceCopy, worker.doKernelFileCopy(sorceInfo, targetInfo));
+}
+
+TEST_F(UT_DoCopyFileWorker, testCopyStrategies)
+{
+    QTemporaryDir dir;
+    // more than one kernel copy chunk
+    const qint64 size = 9 * 1024 * 1024;
+    QFile sourceFile(dir.filePath("source.bin"));
+    ASSERT_TRUE(sourceFile.open(QIODevice::WriteOnly));
+    QByteArray block(1024 * 1024, 0);
+    for (int i = 0; i < size / block.size(); ++i) {
+        block.fill(static_cast<char>(i));
+        sourceFile.write(block);
+    }
+    sourceFile.close();
+    auto sorceInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("source.bin")));
+
+    auto sameContent = [&dir](const QString &name) {
+        QFile source(dir.filePath("source.bin"));
+        QFile target(dir.filePath(name));
+        if (!source.open(QIODevice::ReadOnly) || !target.open(QIODevice::ReadOnly) || source.size() != target.size())
+            return false;
+        while (!source.atEnd()) {
+            if (source.read(1024 * 1024) != target.read(1024 * 1024))
+                return false;
+        }
+        return true;
+    };
+
+    // the strategy picked for the temporary dir, reflink on btrfs/xfs
+    {
+        QSharedPointer<WorkerData> data(new WorkerData);
+        DoCopyFileWorker worker(data);
+        auto targetInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("kernel.bin")));
+        EXPECT_NE(WorkerData::kUserSpaceCopy, worker.doKernelFileCopy(sorceInfo, targetInfo));
+        EXPECT_TRUE(sameContent("kernel.bin"));
+    }
+
+    for (auto strategy : { WorkerData::kRangeCopy, WorkerData::kSendFileCopy }) {
+        QSharedPointer<WorkerData> data(new WorkerData);
+        DoCopyFileWorker worker(data);
+        const QString name = QString("range_%1.bin").arg(strategy);
+        int fromFd = open(dir.filePath("source.bin").toStdString().c_str(), O_RDONLY);
+        int toFd = open(dir.filePath(name).toStdString().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        EXPECT_TRUE(worker.doKernelCopyRange(strategy, fromFd, toFd, size));
+        close(fromFd);
+        close(toFd);
+        EXPECT_TRUE(sameContent(name));
+    }
+
+    {
+        QSharedPointer<WorkerData> data(new WorkerData);
+        DoCopyFileWorker worker(data);
+        auto targetInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("user.bin")));
+        bool skip { false };
+        EXPECT_TRUE(worker.doCopyFilePractically(sorceInfo, targetInfo, &skip));
+        EXPECT_TRUE(sameContent("user.bin"));
+    }
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST_F(UT_DoCopyFileWorker, DISABLED_testCopyStrategiesBenchmark)
+{
+    QTemporaryDir dir;
+    const qint64 size = 64 * 1024 * 1024;
+    QFile sourceFile(dir.filePath("source.bin"));
+    ASSERT_TRUE(sourceFile.open(QIODevice::WriteOnly));
+    QByteArray block(1024 * 1024, 0);
+    for (int i = 0; i < size / block.size(); ++i) {
+        block.fill(static_cast<char>(i));
+        sourceFile.write(block);
+    }
+    sourceFile.close();
+    auto sorceInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("source.bin")));
+
+    auto sameContent = [&dir](const QString &name) {
+        QFile source(dir.filePath("source.bin"));
+        QFile target(dir.filePath(name));
+        if (!source.open(QIODevice::ReadOnly) || !target.open(QIODevice::ReadOnly) || source.size() != target.size())
+            return false;
+        while (!source.atEnd()) {
+            if (source.read(1024 * 1024) != target.read(1024 * 1024))
+                return false;
+        }
+        return true;
+    };
+
+    // the strategy picked for the temporary dir, reflink on btrfs/xfs
+    {
+        QSharedPointer<WorkerData> data(new WorkerData);
+        DoCopyFileWorker worker(data);
+        auto targetInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("kernel.bin")));
+        QElapsedTimer timer;
+        timer.start();
+        const auto strategy = worker.doKernelFileCopy(sorceInfo, targetInfo);
+        qInfo() << "kernel copy, strategy:" << int(strategy) << "elapsed(ms):" << timer.elapsed();
+        EXPECT_TRUE(sameContent("kernel.bin"));
+    }
+
+    for (auto strategy : { WorkerData::kRangeCopy, WorkerData::kSendFileCopy }) {
+        QSharedPointer<WorkerData> data(new WorkerData);
+        DoCopyFileWorker worker(data);
+        const QString name = QString("range_%1.bin").arg(strategy);
+        int fromFd = open(dir.filePath("source.bin").toStdString().c_str(), O_RDONLY);
+        int toFd = open(dir.filePath(name).toStdString().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        QElapsedTimer timer;
+        timer.start();
+        EXPECT_TRUE(worker.doKernelCopyRange(strategy, fromFd, toFd, size));
+        qInfo() << "kernel copy, strategy:" << int(strategy) << "elapsed(ms):" << timer.elapsed();
+        close(fromFd);
+        close(toFd);
+        EXPECT_TRUE(sameContent(name));
+    }
+
+    {
+        QSharedPointer<WorkerData> data(new WorkerData);
+        DoCopyFileWorker worker(data);
+        auto targetInfo = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(dir.filePath("user.bin")));
+        bool skip { false };
+        QElapsedTimer timer;
+        timer.start();
+        EXPECT_TRUE(worker.doCopyFilePractically(sorceInfo, targetInfo, &skip));
+        qInfo() << "user space copy, elapsed(ms):" << timer.elapsed();
+        EXPECT_TRUE(sameContent("user.bin"));
+    }
+}
+
 TEST_F(UT_DoCopyFileWorker, testDoDfmioFileCopy)
 {
     QSharedPointer<WorkerData> data(new WorkerData);
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "plugins/common/core/dfmplugin-fileoperations/fileoperations/fileoperationutils/filechecksum.h"
+
+#include <gtest/gtest.h>
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <zlib.h>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+class UT_FileChecksum : public testing::Test
+{
+public:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(UT_FileChecksum, testCrc32c)
+{
+    const QByteArray data("123456789");
+    FileChecksum checkSum(FileChecksum::kCrc32c);
+    EXPECT_EQ(0u, checkSum.value());
+    checkSum.update(data.constData(), data.size());
+    EXPECT_EQ(0xe3069283ul, checkSum.value());
+
+    checkSum.reset();
+    EXPECT_EQ(0u, checkSum.value());
+}
+
+TEST_F(UT_FileChecksum, testStreaming)
+{
+    QByteArray data;
+    for (int i = 0; i < 1024 * 1024 + 13; ++i)
+        data.append(static_cast<char>(i * 31 % 253));
+
+    for (auto type : { FileChecksum::kCrc32c, FileChecksum::kAdler32 }) {
+        FileChecksum whole(type);
+        whole.update(data.constData(), data.size());
+
+        // unaligned pieces of different sizes
+        FileChecksum pieces(type);
+        int pos = 0;
+        for (int size = 1; pos < data.size(); size = size * 3 + 1) {
+            const int length = qMin(size, data.size() - pos);
+            pieces.update(data.constData() + pos, length);
+            pos += length;
+        }
+        EXPECT_EQ(whole.value(), pieces.value());
+    }
+
+    FileChecksum adler(FileChecksum::kAdler32);
+    adler.update(data.constData(), data.size());
+    EXPECT_EQ(adler32(adler32(0L, nullptr, 0), reinterpret_cast<const Bytef *>(data.constData()), static_cast<uInt>(data.size())),
+              adler.value());
+}
+
+TEST_F(UT_FileChecksum, testTypeFromName)
+{
+    EXPECT_EQ(FileChecksum::kCrc32c, FileChecksum::typeFromName("crc32c"));
+    EXPECT_EQ(FileChecksum::kAdler32, FileChecksum::typeFromName("adler32"));
+    EXPECT_EQ(FileChecksum::hasHardwareCrc32c() ? FileChecksum::kCrc32c : FileChecksum::kAdler32,
+              FileChecksum::typeFromName("auto"));
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST_F(UT_FileChecksum, DISABLED_testChecksumBenchmark)
+{
+    const QByteArray data(64 * 1024 * 1024, 'a');
+    for (auto type : { FileChecksum::kAdler32, FileChecksum::kCrc32c }) {
+        FileChecksum checkSum(type);
+        QElapsedTimer timer;
+        timer.start();
+        for (int pos = 0; pos < data.size(); pos += 1024 * 1024)
+            checkSum.update(data.constData() + pos, 1024 * 1024);
+        qInfo() << "checksum type: " << static_cast<int>(type) << " hardware crc32c: " << FileChecksum::hasHardwareCrc32c()
+                << " 64MB in " << timer.elapsed() << "ms";
+    }
+}
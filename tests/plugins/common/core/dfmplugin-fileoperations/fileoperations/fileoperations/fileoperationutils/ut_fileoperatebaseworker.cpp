@@ -18,6 +18,9 @@
 #include <gtest/gtest.h>
 #include <dfm-io/denumerator.h>
 
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+
 DPFILEOPERATIONS_USE_NAMESPACE
 DFMBASE_USE_NAMESPACE
 class UT_FileOperateBaseWorker : public testing::Test
@@ -599,6 +602,84 @@ TEST_F(UT_FileOperateBaseWorker, testInitThreadCopy)
     worker.stopAllThread();
 }
 
+TEST_F(UT_FileOperateBaseWorker, testDoCopySmallFileBatch)
+{
+    // several full batches and a partial one
+    const int fileCount = 1000;
+    QTemporaryDir sourceDir;
+    QTemporaryDir targetDir;
+    QList<QPair<FileInfoPointer, FileInfoPointer>> files;
+    for (int i = 0; i < fileCount; ++i) {
+        const QString &subDir = QString("dir_%1").arg(i / 100);
+        QDir(sourceDir.path()).mkpath(subDir);
+        QDir(targetDir.path()).mkpath(subDir);
+        const QString &name = subDir + QString("/file_%1.txt").arg(i);
+        QFile file(sourceDir.filePath(name));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(name.toUtf8());
+        file.close();
+        files.append({ InfoFactory::create<FileInfo>(QUrl::fromLocalFile(sourceDir.filePath(name))),
+                       InfoFactory::create<FileInfo>(QUrl::fromLocalFile(targetDir.filePath(name))) });
+    }
+
+    FileOperateBaseWorker worker;
+    worker.workData.reset(new WorkerData);
+    worker.initThreadCopy();
+    worker.currentState = AbstractJobHandler::JobState::kRunningState;
+
+    for (const auto &file : files)
+        EXPECT_TRUE(worker.doCopyLocalFile(file.first, file.second));
+    worker.waitThreadPoolOver();
+
+    EXPECT_TRUE(worker.smallFileBatch.isEmpty());
+    EXPECT_EQ(fileCount, worker.workData->completeFileCount.load());
+    for (int i = 0; i < fileCount; i += 97)
+        EXPECT_TRUE(QFile::exists(files.at(i).second->urlOf(UrlInfoType::kUrl).path()));
+    worker.stopAllThread();
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST_F(UT_FileOperateBaseWorker, DISABLED_testDoCopySmallFileBatchBenchmark)
+{
+    // raise the count to measure a tree with millions of files
+    const int fileCount = 20000;
+    QTemporaryDir sourceDir;
+    QTemporaryDir targetDir;
+    QList<QPair<FileInfoPointer, FileInfoPointer>> files;
+    for (int i = 0; i < fileCount; ++i) {
+        const QString &subDir = QString("dir_%1").arg(i / 1000);
+        QDir(sourceDir.path()).mkpath(subDir);
+        QDir(targetDir.path()).mkpath(subDir);
+        const QString &name = subDir + QString("/file_%1.txt").arg(i);
+        QFile file(sourceDir.filePath(name));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(name.toUtf8());
+        file.close();
+        files.append({ InfoFactory::create<FileInfo>(QUrl::fromLocalFile(sourceDir.filePath(name))),
+                       InfoFactory::create<FileInfo>(QUrl::fromLocalFile(targetDir.filePath(name))) });
+    }
+
+    FileOperateBaseWorker worker;
+    worker.workData.reset(new WorkerData);
+    worker.initThreadCopy();
+    worker.currentState = AbstractJobHandler::JobState::kRunningState;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (const auto &file : files)
+        EXPECT_TRUE(worker.doCopyLocalFile(file.first, file.second));
+    worker.waitThreadPoolOver();
+    const qint64 elapsed = qMax(timer.elapsed(), qint64(1));
+    qInfo() << "small file copy, files:" << fileCount << "elapsed(ms):" << elapsed
+            << "files/s:" << fileCount * 1000 / elapsed;
+
+    EXPECT_TRUE(worker.smallFileBatch.isEmpty());
+    EXPECT_EQ(fileCount, worker.workData->completeFileCount.load());
+    for (int i = 0; i < fileCount; i += 997)
+        EXPECT_TRUE(QFile::exists(files.at(i).second->urlOf(UrlInfoType::kUrl).path()));
+    worker.stopAllThread();
+}
+
 TEST_F(UT_FileOperateBaseWorker, testDoCopyLocalBigFile)
 {
     QProcess::execute("rm sourceUrl.txt targetUrl.txt");
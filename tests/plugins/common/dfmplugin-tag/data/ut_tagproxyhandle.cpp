@@ -125,6 +125,10 @@ TEST(UT_TagProxyHandle, Query)
         isRun++;
         return QDBusPendingReply<QDBusVariant>();
     });
+    stub.set_lamda(&OrgDeepinFilemanagerServerTagManagerInterface::QueryTagsOfFiles, [&isRun]() {
+        isRun++;
+        return QDBusPendingReply<QVariantMap>();
+    });
     stub.set_lamda(&QDBusPendingCall::isValid, []() {
         return true;
     });
@@ -14,6 +14,7 @@
 #include "dfm-base/base/application/application.h"
 #include "dfm-base/base/application/settings.h"
 #include "dfm-base/base/device/deviceutils.h"
+#include "dfm-base/utils/textlayoutcache.h"
 
 #include "stubext.h"
 
@@ -519,8 +520,15 @@ TEST_F(TestCanvasItemDelegate, drawNormlText)
         return QList<QRectF>();
     });
 
+    // not rendered by the other cases
+    TextLayoutCache::instance()->clear();
     dlgt->drawNormlText(&pa, option, model->index(0), option.rect);
     EXPECT_TRUE(paint);
+
+    // the rendered text is reused
+    paint = false;
+    dlgt->drawNormlText(&pa, option, model->index(0), option.rect);
+    EXPECT_FALSE(paint);
 }
 
 TEST_F(TestCanvasItemDelegate, drawExpandText)
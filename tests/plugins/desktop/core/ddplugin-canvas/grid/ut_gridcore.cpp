@@ -6,6 +6,9 @@
 
 #include "stubext.h"
 
+#include <QElapsedTimer>
+#include <QDebug>
+
 #include <gtest/gtest.h>
 
 DDP_CANVAS_USE_NAMESPACE
@@ -261,3 +264,114 @@ TEST(AppendOper, tryAppendAfter)
     EXPECT_TRUE(ao.overload.contains(QString("5")));
     EXPECT_EQ(ao.overload.size(), 1);
 }
+
+TEST_F(TestGridCore, occupancy)
+{
+    // built from posItem
+    EXPECT_EQ(core.voidPos(1).first(), QPoint(0, 0));
+    EXPECT_FALSE(core.voidPos(1).contains(QPoint(1, 2)));
+
+    // updated by insert and remove
+    core.insert(1, QPoint(0, 0), QString("0,0"));
+    core.remove(1, QString("1,1"));
+    QList<QPoint> pos = core.voidPos(1);
+    EXPECT_EQ(pos.size(), 22);
+    EXPECT_EQ(pos.first(), QPoint(0, 2));
+    EXPECT_TRUE(pos.contains(QPoint(1, 1)));
+
+    // rebuilt if posItem is changed directly
+    core.posItem[1].insert(QPoint(0, 2), QString("0,2"));
+    EXPECT_EQ(core.voidPos(1).first(), QPoint(0, 3));
+
+    // rebuilt if the surface is resized
+    core.surfaces.insert(1, QSize(1, 3));
+    EXPECT_TRUE(core.voidPos(1).isEmpty());
+
+    // the tail of the last word
+    GridOccupancy bits;
+    bits.reset(QSize(10, 13), 0);
+    for (int i = 0; i < 129; ++i)
+        bits.set(bits.toPos(i), true);
+    EXPECT_EQ(bits.nextVoid(0), 129);
+    bits.set(bits.toPos(129), true);
+    EXPECT_EQ(bits.nextVoid(0), -1);
+    bits.set(QPoint(3, 5), false);
+    EXPECT_EQ(bits.nextVoid(0), 3 * 13 + 5);
+    EXPECT_EQ(bits.nextVoid(3 * 13 + 6), -1);
+}
+
+TEST(AppendOper, appendAfterBeginOutOfColumn)
+{
+    GridCore core;
+    AppendOper ao(&core);
+    ao.surfaces.insert(1, QSize(3, 2));
+    ao.insert(1, QPoint(1, 0), "used");
+
+    // the rest of the column of begin, and then the next columns
+    EXPECT_TRUE(ao.appendAfter({ "1", "2", "3" }, 1, QPoint(1, -1)).isEmpty());
+    EXPECT_EQ(ao.posItem[1].value(QPoint(1, 1)), QString("1"));
+    EXPECT_EQ(ao.posItem[1].value(QPoint(2, 0)), QString("2"));
+    EXPECT_EQ(ao.posItem[1].value(QPoint(2, 1)), QString("3"));
+    EXPECT_EQ(ao.appendAfter({ "4" }, 1, QPoint(0, 2)), QStringList { "4" });
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST(GridCore, DISABLED_benchmark)
+{
+    // grid sizes of the screens for the icons of 80x100
+    const QList<QPair<QString, QList<QSize>>> setups {
+        { "2 x 4K", { QSize(48, 21), QSize(48, 21) } },
+        { "3 x 8K", { QSize(96, 43), QSize(96, 43), QSize(96, 43) } }
+    };
+
+    for (const auto &setup : setups) {
+        GridCore core;
+        for (int i = 0; i < setup.second.size(); ++i)
+            core.surfaces.insert(i + 1, setup.second.at(i));
+
+        QStringList items;
+        for (int i = 0; i < 2000; ++i)
+            items.append(QString("file:///home/user/Desktop/file_%1.txt").arg(i));
+
+        // files created one by one
+        QElapsedTimer timer;
+        timer.start();
+        for (const QString &item : items) {
+            GridPos pos;
+            ASSERT_TRUE(core.findVoidPos(pos));
+            core.insert(pos.first, pos.second, item);
+        }
+        const qint64 single = timer.nsecsElapsed();
+
+        // dropped into the middle of the second screen
+        QStringList dropped;
+        for (int i = 0; i < 2000; ++i)
+            dropped.append(QString("file:///home/user/Downloads/file_%1.txt").arg(i));
+        timer.restart();
+        AppendOper drop(&core);
+        drop.tryAppendAfter(dropped, 2, QPoint(10, 10));
+        core.applay(&drop);
+        const qint64 bulk = timer.nsecsElapsed();
+
+        // arranged again after the resolution is changed
+        const QStringList &all = items + dropped;
+        core.posItem.clear();
+        core.itemPos.clear();
+        core.overload.clear();
+        for (auto itor = core.surfaces.begin(); itor != core.surfaces.end(); ++itor)
+            itor.value() = itor.value() - QSize(4, 2);
+        timer.restart();
+        AppendOper arrange(&core);
+        arrange.append(all);
+        core.applay(&arrange);
+        const qint64 arranged = timer.nsecsElapsed();
+
+        int count = 0;
+        for (int idx : core.surfaceIndex())
+            count += core.itemPos.value(idx).count();
+        EXPECT_EQ(count + core.overload.count(), all.count());
+
+        qInfo() << "grid" << setup.first << ": 2000 single appends" << single / 1000000 << "ms, drop of 2000"
+                << bulk / 1000000 << "ms, arrange of 4000" << arranged / 1000000 << "ms";
+    }
+}
@@ -14,6 +14,7 @@
 #include "dfm-base/base/application/application.h"
 #include "dfm-base/base/application/settings.h"
 #include "dfm-base/base/device/deviceutils.h"
+#include "dfm-base/utils/textlayoutcache.h"
 
 #include <dfm-framework/dpf.h>
 
@@ -649,8 +650,15 @@ TEST_F(TestCollectionItemDelegate, drawNormlText)
         return QList<QRectF>();
     });
 
+    // not rendered by the other cases
+    TextLayoutCache::instance()->clear();
     dlgt->drawNormlText(&pa, option, model->index(0, 0), option.rect);
     EXPECT_TRUE(paint);
+
+    // the rendered text is reused
+    paint = false;
+    dlgt->drawNormlText(&pa, option, model->index(0, 0), option.rect);
+    EXPECT_FALSE(paint);
 }
 
 TEST_F(TestCollectionItemDelegate, drawExpandText)
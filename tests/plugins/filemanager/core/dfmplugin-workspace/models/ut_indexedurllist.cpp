@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins/filemanager/core/dfmplugin-workspace/models/indexedurllist.h"
+
+#include <gtest/gtest.h>
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <random>
+
+DPWORKSPACE_USE_NAMESPACE
+
+namespace {
+QUrl childUrl(int i)
+{
+    return QUrl::fromLocalFile(QString("/tmp/burst/file_%1").arg(i));
+}
+
+QList<QUrl> childUrls(int count)
+{
+    QList<QUrl> urls;
+    urls.reserve(count);
+    for (int i = 0; i < count; ++i)
+        urls.append(childUrl(i));
+    return urls;
+}
+
+// replay a burst of watcher events: every create is inserted at a random row,
+// every delete removes a random existing child by url, like the sort worker does
+qint64 replayBurst(IndexedUrlList &list, int events, QList<QUrl> *mirror = nullptr)
+{
+    std::mt19937 gen(20231018);
+    int nextId = list.count();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < events; ++i) {
+        if (i % 2 == 0) {
+            const QUrl url = childUrl(nextId++);
+            const int row = static_cast<int>(gen() % static_cast<quint32>(list.count() + 1));
+            list.insert(row, url);
+            if (mirror)
+                mirror->insert(row, url);
+        } else {
+            const QUrl url = list.at(static_cast<int>(gen() % static_cast<quint32>(list.count())));
+            const int row = list.indexOf(url);
+            list.removeAt(row);
+            if (mirror)
+                mirror->removeAt(mirror->indexOf(url));
+        }
+    }
+    return timer.elapsed();
+}
+}   // namespace
+
+TEST(UT_IndexedUrlList, AppendAndIndexOf)
+{
+    IndexedUrlList list(childUrls(100));
+
+    EXPECT_EQ(list.count(), 100);
+    EXPECT_EQ(list.indexOf(childUrl(0)), 0);
+    EXPECT_EQ(list.indexOf(childUrl(57)), 57);
+    EXPECT_EQ(list.indexOf(childUrl(100)), -1);
+    EXPECT_TRUE(list.contains(childUrl(99)));
+    EXPECT_FALSE(list.append(childUrl(3)));
+    EXPECT_EQ(list.count(), 100);
+}
+
+TEST(UT_IndexedUrlList, InsertAtSameRowRenumbers)
+{
+    IndexedUrlList list(childUrls(2));
+    for (int i = 2; i < 200; ++i)
+        EXPECT_TRUE(list.insert(1, childUrl(i)));
+
+    EXPECT_EQ(list.count(), 200);
+    for (int i = 0; i < list.count(); ++i)
+        EXPECT_EQ(list.indexOf(list.at(i)), i);
+    EXPECT_EQ(list.first(), childUrl(0));
+    EXPECT_EQ(list.last(), childUrl(1));
+}
+
+TEST(UT_IndexedUrlList, InsertAtSameRowSpreadsNeighbours)
+{
+    IndexedUrlList list(childUrls(10000));
+    const quint64 lastOrder = list.orders.last();
+    const quint64 firstOrder = list.orders.first();
+    for (int i = 10000; i < 11000; ++i)
+        ASSERT_TRUE(list.insert(5000, childUrl(i)));
+
+    // the keys far from the inserts are not renumbered
+    EXPECT_EQ(list.orders.first(), firstOrder);
+    EXPECT_EQ(list.orders.last(), lastOrder);
+    EXPECT_EQ(list.at(5000), childUrl(10999));
+    EXPECT_EQ(list.at(5999), childUrl(10000));
+    for (int i = 4000; i < 7000; ++i)
+        EXPECT_EQ(list.indexOf(list.at(i)), i);
+}
+
+TEST(UT_IndexedUrlList, RemoveAndTake)
+{
+    IndexedUrlList list(childUrls(10));
+
+    list.removeAt(0);
+    EXPECT_EQ(list.indexOf(childUrl(0)), -1);
+    EXPECT_EQ(list.indexOf(childUrl(1)), 0);
+
+    EXPECT_EQ(list.takeAt(4), childUrl(5));
+    EXPECT_EQ(list.indexOf(childUrl(6)), 4);
+    EXPECT_EQ(list.count(), 8);
+
+    list = childUrls(3);
+    EXPECT_EQ(list.count(), 3);
+    EXPECT_FALSE(list.contains(childUrl(9)));
+
+    list.clear();
+    EXPECT_TRUE(list.isEmpty());
+    EXPECT_EQ(list.indexOf(childUrl(1)), -1);
+}
+
+TEST(UT_IndexedUrlList, BurstMatchesList)
+{
+    IndexedUrlList list(childUrls(10000));
+    QList<QUrl> mirror = list.toList();
+
+    replayBurst(list, 2000, &mirror);
+
+    ASSERT_EQ(list.toList(), mirror);
+    for (int i = 0; i < mirror.count(); i += 97)
+        EXPECT_EQ(list.indexOf(mirror.at(i)), i);
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST(UT_IndexedUrlList, DISABLED_BurstReplay)
+{
+    for (int count : { 10000, 100000, 1000000 }) {
+        IndexedUrlList list(childUrls(count));
+        const qint64 elapsed = replayBurst(list, 5000);
+        qInfo() << "indexed url list burst replay, children:" << count
+                << "events:" << 5000 << "elapsed(ms):" << elapsed;
+        EXPECT_EQ(list.count(), count);
+    }
+}
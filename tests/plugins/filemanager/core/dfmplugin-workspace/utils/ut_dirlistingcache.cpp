@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "plugins/filemanager/core/dfmplugin-workspace/utils/dirlistingcache.h"
+
+#include <dfm-base/base/configs/dconfig/dconfigmanager.h>
+
+#include <gtest/gtest.h>
+
+#include <QTemporaryDir>
+#include <QDir>
+
+DFMBASE_USE_NAMESPACE
+DPWORKSPACE_USE_NAMESPACE
+
+class UT_DirListingCache : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        stub.set_lamda(&DConfigManager::value, [] { __DBG_STUB_INVOKE__ return QVariant(); });
+
+        cache = DirListingCache::instance();
+        orgCacheDir = cache->cacheDir;
+        cache->cacheDir = cacheDir.path();
+        dirUrl = QUrl::fromLocalFile(listedDir.path());
+    }
+    void TearDown() override
+    {
+        cache->cacheDir = orgCacheDir;
+        stub.clear();
+    }
+
+    QList<SortInfoPointer> makeChildren(int count)
+    {
+        QList<SortInfoPointer> children;
+        for (int i = 0; i < count; ++i) {
+            SortInfoPointer sortInfo(new SortFileInfo);
+            sortInfo->setUrl(QUrl::fromLocalFile(listedDir.path() + QString("/file_%1").arg(i)));
+            sortInfo->setSize(i);
+            sortInfo->setFile(i % 2);
+            sortInfo->setDir(!(i % 2));
+            sortInfo->setReadable(true);
+            children.append(sortInfo);
+        }
+        return children;
+    }
+
+    QTemporaryDir cacheDir;
+    QTemporaryDir listedDir;
+    QString orgCacheDir;
+    QUrl dirUrl;
+    DirListingCache *cache { nullptr };
+    stub_ext::StubExt stub;
+};
+
+TEST_F(UT_DirListingCache, SaveAndLoad)
+{
+    const auto &children = makeChildren(6000);
+    cache->save(dirUrl, children, dfmio::DEnumerator::SortRoleCompareFlag::kSortRoleCompareFileSize,
+                Qt::DescendingOrder, true);
+
+    DirListingSnapshot snapshot;
+    ASSERT_TRUE(cache->load(dirUrl, &snapshot));
+    ASSERT_EQ(snapshot.children.count(), children.count());
+    EXPECT_TRUE(snapshot.upToDate);
+    EXPECT_EQ(snapshot.sortRole, dfmio::DEnumerator::SortRoleCompareFlag::kSortRoleCompareFileSize);
+    EXPECT_EQ(snapshot.sortOrder, Qt::DescendingOrder);
+    EXPECT_TRUE(snapshot.isMixDirAndFile);
+
+    const auto &loaded = snapshot.children.at(4321);
+    EXPECT_EQ(loaded->fileUrl(), children.at(4321)->fileUrl());
+    EXPECT_EQ(loaded->fileSize(), 4321);
+    EXPECT_TRUE(loaded->isFile());
+    EXPECT_FALSE(loaded->isDir());
+    EXPECT_TRUE(loaded->isReadable());
+    EXPECT_FALSE(loaded->isWriteable());
+}
+
+TEST_F(UT_DirListingCache, SmallDirNotSaved)
+{
+    cache->save(dirUrl, makeChildren(10), dfmio::DEnumerator::SortRoleCompareFlag::kSortRoleCompareDefault,
+                Qt::AscendingOrder, false);
+
+    DirListingSnapshot snapshot;
+    EXPECT_FALSE(cache->load(dirUrl, &snapshot));
+}
+
+TEST_F(UT_DirListingCache, StaleAfterChange)
+{
+    cache->save(dirUrl, makeChildren(6000), dfmio::DEnumerator::SortRoleCompareFlag::kSortRoleCompareDefault,
+                Qt::AscendingOrder, false);
+
+    QFile newFile(listedDir.path() + "/new_file");
+    ASSERT_TRUE(newFile.open(QIODevice::WriteOnly));
+    newFile.close();
+
+    DirListingSnapshot snapshot;
+    ASSERT_TRUE(cache->load(dirUrl, &snapshot));
+    EXPECT_FALSE(snapshot.upToDate);
+}
+
+TEST_F(UT_DirListingCache, EvictOverBudget)
+{
+    stub.set_lamda(ADDR(DirListingCache, sizeBudget), [] { __DBG_STUB_INVOKE__ return qint64(1); });
+
+    cache->save(dirUrl, makeChildren(6000), dfmio::DEnumerator::SortRoleCompareFlag::kSortRoleCompareDefault,
+                Qt::AscendingOrder, false);
+
+    EXPECT_TRUE(QDir(cacheDir.path()).entryList(QDir::Files).isEmpty());
+}
+
+TEST_F(UT_DirListingCache, DroppedOnOtherDevice)
+{
+    cache->save(dirUrl, makeChildren(6000), dfmio::DEnumerator::SortRoleCompareFlag::kSortRoleCompareDefault,
+                Qt::AscendingOrder, false);
+
+    // the same inode on another device, e.g. a disk mounted over the path
+    QFile file(cache->snapshotPath(listedDir.path()));
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    uchar *data = file.map(0, file.size());
+    ASSERT_TRUE(data);
+    const size_t deviceOffset = 8 + 4 + 4;
+    data[deviceOffset] ^= 0xFF;
+    file.unmap(data);
+    file.close();
+
+    DirListingSnapshot snapshot;
+    EXPECT_FALSE(cache->load(dirUrl, &snapshot));
+    EXPECT_FALSE(QFile::exists(cache->snapshotPath(listedDir.path())));
+}
@@ -0,0 +1,150 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins/filemanager/core/dfmplugin-workspace/utils/filesortengine.h"
+
+#include <dfm-base/utils/fileutils.h>
+
+#include <gtest/gtest.h>
+
+#include <QDebug>
+#include <QtConcurrent>
+
+#include <random>
+
+DFMBASE_USE_NAMESPACE
+DFMGLOBAL_USE_NAMESPACE
+DPWORKSPACE_USE_NAMESPACE
+
+namespace {
+FileSortKey sortKey(const QString &name, bool isDir, qint64 size = 0)
+{
+    FileSortKey key;
+    key.url = QUrl::fromLocalFile("/tmp/sort/" + name);
+    key.data = name;
+    key.displayName = name;
+    key.size = size;
+    key.isDir = isDir;
+    key.valid = true;
+    return key;
+}
+
+QStringList names(const QVector<FileSortKey> &keys)
+{
+    QStringList list;
+    for (const auto &key : keys)
+        list.append(key.displayName);
+    return list;
+}
+}   // namespace
+
+TEST(UT_FileSortEngine, DirsFirstInBothOrders)
+{
+    std::atomic_bool canceled { false };
+    QVector<FileSortKey> keys { sortKey("b.txt", false), sortKey("dir2", true),
+                                sortKey("a.txt", false), sortKey("dir1", true) };
+
+    FileSortEngine ascending(kItemFileDisplayNameRole, Qt::AscendingOrder, false, canceled);
+    EXPECT_TRUE(ascending.sort(keys));
+    EXPECT_EQ(names(keys), QStringList({ "dir1", "dir2", "a.txt", "b.txt" }));
+
+    FileSortEngine descending(kItemFileDisplayNameRole, Qt::DescendingOrder, false, canceled);
+    EXPECT_TRUE(descending.sort(keys));
+    EXPECT_EQ(names(keys), QStringList({ "dir2", "dir1", "b.txt", "a.txt" }));
+
+    FileSortEngine mixed(kItemFileDisplayNameRole, Qt::AscendingOrder, true, canceled);
+    EXPECT_TRUE(mixed.sort(keys));
+    EXPECT_EQ(names(keys), QStringList({ "a.txt", "b.txt", "dir1", "dir2" }));
+}
+
+TEST(UT_FileSortEngine, NaturalNameOrder)
+{
+    std::atomic_bool canceled { false };
+    QVector<FileSortKey> keys { sortKey("file10", false), sortKey("file2", false), sortKey("file1", false) };
+
+    FileSortEngine engine(kItemFileDisplayNameRole, Qt::AscendingOrder, false, canceled);
+    EXPECT_TRUE(engine.sort(keys));
+    EXPECT_EQ(names(keys), QStringList({ "file1", "file2", "file10" }));
+}
+
+TEST(UT_FileSortEngine, SizeRoleFallsBackToName)
+{
+    std::atomic_bool canceled { false };
+    auto big = sortKey("big", false, 2048);
+    big.data = "2 KB";
+    auto small = sortKey("small", false, 1024);
+    small.data = "1 KB";
+    auto same = sortKey("same", false, 1024);
+    same.data = "1 KB";
+    QVector<FileSortKey> keys { big, small, same };
+
+    FileSortEngine engine(kItemFileSizeRole, Qt::AscendingOrder, false, canceled);
+    EXPECT_TRUE(engine.sort(keys));
+    EXPECT_EQ(names(keys), QStringList({ "same", "small", "big" }));
+}
+
+TEST(UT_FileSortEngine, ParallelMatchesSerial)
+{
+    std::atomic_bool canceled { false };
+    std::mt19937 gen(20231018);
+    QVector<FileSortKey> keys;
+    // enough keys for several chunks
+    for (int i = 0; i < 10000; ++i)
+        keys.append(sortKey(QString("name_%1.txt").arg(gen() % 1000000), gen() % 10 == 0, gen() % 4096));
+
+    QVector<FileSortKey> expected = keys;
+    std::stable_sort(expected.begin(), expected.end(), [](const FileSortKey &left, const FileSortKey &right) {
+        if (left.isDir ^ right.isDir)
+            return left.isDir;
+        if (left.data == right.data)
+            return FileUtils::compareByStringEx(left.displayName, right.displayName);
+        return FileUtils::compareByStringEx(left.data, right.data);
+    });
+
+    FileSortEngine engine(kItemFileDisplayNameRole, Qt::AscendingOrder, false, canceled);
+    EXPECT_TRUE(engine.sort(keys));
+    EXPECT_EQ(names(keys), names(expected));
+}
+
+TEST(UT_FileSortEngine, KeysCachedInSortInfo)
+{
+    std::atomic_bool canceled { false };
+    SortInfoPointer sortInfo(new SortFileInfo());
+    auto cached = sortKey("file10", false);
+    cached.sortInfo = sortInfo;
+    QVector<FileSortKey> keys { cached, sortKey("file2", false) };
+
+    FileSortEngine engine(kItemFileDisplayNameRole, Qt::AscendingOrder, false, canceled);
+    EXPECT_TRUE(engine.sort(keys));
+    EXPECT_EQ(names(keys), QStringList({ "file2", "file10" }));
+    EXPECT_EQ(FileSortEngine::nameKeyOf(sortInfo, "file10"), FileUtils::sortKeyOfString("file10"));
+    EXPECT_EQ(FileSortEngine::dataKeyOf(sortInfo, "file10"), FileUtils::sortKeyOfString("file10"));
+
+    // renamed
+    EXPECT_EQ(FileSortEngine::nameKeyOf(sortInfo, "file1"), FileUtils::sortKeyOfString("file1"));
+    EXPECT_EQ(FileSortEngine::dataKeyOf(nullptr, "file3"), FileUtils::sortKeyOfString("file3"));
+}
+
+TEST(UT_FileSortEngine, KeysOfSharedSortInfo)
+{
+    // the sort info of a file is shared by the sort workers of its directory
+    SortInfoPointer sortInfo(new SortFileInfo());
+    QList<int> calls;
+    for (int i = 0; i < 2000; ++i)
+        calls.append(i);
+    QtConcurrent::blockingMap(calls, [sortInfo](int i) {
+        const QString &name = QString("file%1").arg(i % 3);
+        EXPECT_EQ(FileSortEngine::nameKeyOf(sortInfo, name), FileUtils::sortKeyOfString(name));
+        EXPECT_EQ(FileSortEngine::dataKeyOf(sortInfo, name + ".txt"), FileUtils::sortKeyOfString(name + ".txt"));
+    });
+}
+
+TEST(UT_FileSortEngine, Canceled)
+{
+    std::atomic_bool canceled { true };
+    QVector<FileSortKey> keys { sortKey("b", false), sortKey("a", false) };
+
+    FileSortEngine engine(kItemFileDisplayNameRole, Qt::AscendingOrder, false, canceled);
+    EXPECT_FALSE(engine.sort(keys));
+}
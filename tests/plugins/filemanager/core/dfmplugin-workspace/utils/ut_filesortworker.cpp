@@ -72,3 +72,114 @@ TEST_F(UT_FileSortWorker, Bug_199473_handleUpdateFile)
 
     EXPECT_EQ(selectAndEditFile, updateFile);
 }
+
+TEST_F(UT_FileSortWorker, handleWatcherAddChildren_Batch)
+{
+    stub.set_lamda(ADDR(FileSortWorker, checkFilters), [] {
+        return true;
+    });
+    stub.set_lamda(ADDR(FileSortWorker, lessThan), [](FileSortWorker *, const QUrl &left, const QUrl &right, AbstractSortFilter::SortScenarios) {
+        return left.path() < right.path();
+    });
+
+    auto makeSortInfo = [](const QString &name) {
+        SortInfoPointer sortInfo(new SortFileInfo());
+        sortInfo->setUrl(QUrl::fromLocalFile("/tmp/batch/" + name));
+        sortInfo->setFile(true);
+        return sortInfo;
+    };
+
+    worker->orgSortRole = Global::ItemRoles::kItemFileDisplayNameRole;
+    for (const auto &name : { "b", "d", "f" }) {
+        auto sortInfo = makeSortInfo(name);
+        worker->children.append(sortInfo);
+        worker->childrenUrlList.append(sortInfo->fileUrl());
+        worker->visibleChildren.append(sortInfo->fileUrl());
+    }
+
+    QList<QPair<int, int>> insertedRanges;
+    QObject::connect(worker, &FileSortWorker::insertRows, worker, [&insertedRanges](int first, int count) {
+        insertedRanges.append(qMakePair(first, count));
+    });
+
+    worker->handleWatcherAddChildren({ makeSortInfo("e"), makeSortInfo("a"), makeSortInfo("c"), makeSortInfo("g"), makeSortInfo("h") });
+    EXPECT_TRUE(insertedRanges.isEmpty());
+    EXPECT_TRUE(worker->watcherAddTimer->isActive());
+
+    worker->insertWatcherAddChildren();
+
+    QStringList names;
+    for (const auto &url : worker->getChildrenUrls())
+        names.append(url.fileName());
+    EXPECT_EQ(names, QStringList({ "a", "b", "c", "d", "e", "f", "g", "h" }));
+    QList<QPair<int, int>> expectedRanges { qMakePair(0, 1), qMakePair(2, 1), qMakePair(4, 1), qMakePair(6, 2) };
+    EXPECT_EQ(insertedRanges, expectedRanges);
+    EXPECT_TRUE(worker->watcherAddChildren.isEmpty());
+}
+
+TEST_F(UT_FileSortWorker, handleWatcherAddChildren_LargeBatch)
+{
+    stub.set_lamda(ADDR(FileSortWorker, checkFilters), [] {
+        return true;
+    });
+    stub.set_lamda(ADDR(FileSortWorker, lessThan), [](FileSortWorker *, const QUrl &left, const QUrl &right, AbstractSortFilter::SortScenarios) {
+        return left.path() < right.path();
+    });
+
+    auto makeSortInfo = [](int i) {
+        SortInfoPointer sortInfo(new SortFileInfo());
+        sortInfo->setUrl(QUrl::fromLocalFile(QString("/tmp/batch/f%1").arg(i, 3, 10, QChar('0'))));
+        sortInfo->setFile(true);
+        return sortInfo;
+    };
+
+    // f000, f010 ... f090 are shown, the other 90 files are created
+    worker->orgSortRole = Global::ItemRoles::kItemFileDisplayNameRole;
+    QList<SortInfoPointer> created;
+    for (int i = 0; i < 100; ++i) {
+        auto sortInfo = makeSortInfo(i);
+        if (i % 10) {
+            created.prepend(sortInfo);
+            continue;
+        }
+        worker->children.append(sortInfo);
+        worker->childrenUrlList.append(sortInfo->fileUrl());
+        worker->visibleChildren.append(sortInfo->fileUrl());
+    }
+    // more than kMaxInPlaceInsertCount, the visible list is rebuilt
+    ASSERT_GT(created.count(), 64);
+
+    QList<QPair<int, int>> insertedRanges;
+    QObject::connect(worker, &FileSortWorker::insertRows, worker, [&insertedRanges](int first, int count) {
+        insertedRanges.append(qMakePair(first, count));
+    });
+
+    worker->handleWatcherAddChildren(created);
+    worker->insertWatcherAddChildren();
+
+    QStringList names;
+    for (const auto &url : worker->getChildrenUrls())
+        names.append(url.fileName());
+    QStringList expectedNames;
+    for (int i = 0; i < 100; ++i)
+        expectedNames.append(QString("f%1").arg(i, 3, 10, QChar('0')));
+    EXPECT_EQ(names, expectedNames);
+
+    // the rows of the final list, f001 ~ f009 at 1, f011 ~ f019 at 11 ...
+    QList<QPair<int, int>> expectedRanges;
+    for (int i = 0; i < 9; ++i)
+        expectedRanges.append(qMakePair(i * 10 + 1, 9));
+    EXPECT_EQ(insertedRanges, expectedRanges);
+}
+
+TEST_F(UT_FileSortWorker, notVisibleUrls)
+{
+    auto url = [](const QString &name) {
+        return QUrl::fromLocalFile("/tmp/visible/" + name);
+    };
+    worker->visibleChildren.append(QList<QUrl> { url("a"), url("b") });
+
+    // the rows emitted for a batch are the rows added
+    const QList<QUrl> expected { url("c"), url("d") };
+    EXPECT_EQ(worker->notVisibleUrls({ url("b"), url("c"), url("c"), url("d"), url("a") }), expected);
+}
@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+extern "C" {
+#include "fsearch/fsearch_matcher.h"
+}
+#include "fsearch/utf8.h"
+
+#include <gtest/gtest.h>
+
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QVector>
+#include <QDebug>
+
+#include <string.h>
+
+class UT_FSearchMatcher : public testing::Test
+{
+protected:
+    // the names of a synthetic database, ASCII and chinese words in mixed case
+    static QVector<QByteArray> createNames(int count)
+    {
+        static const char *const kWords[] = { "Report", "report", "IMG", "_", "2023", ".txt", ".TXT",
+                                              "报告", "文档", "资料", "final", "Ä", "-", "copy", "Deepin" };
+        QRandomGenerator random(1);
+        QVector<QByteArray> names;
+        names.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            QByteArray name;
+            const int words = random.bounded(1, 8);
+            for (int j = 0; j < words; ++j)
+                name += kWords[random.bounded(int(sizeof(kWords) / sizeof(kWords[0])))];
+            names.append(name);
+        }
+        return names;
+    }
+
+    // the functions used by database_search before the matcher
+    static bool matchBefore(const char *haystack, const char *needle, bool ignoreCase)
+    {
+        if (!ignoreCase)
+            return strstr(haystack, needle);
+        if (utf8len(needle) != strlen(needle))
+            return utf8casestr(haystack, needle);
+        return strcasestr(haystack, needle);
+    }
+};
+
+TEST_F(UT_FSearchMatcher, SameAsBefore)
+{
+    const QVector<QByteArray> &names = createNames(2000);
+    const QList<QByteArray> needles { "r", "REPORT", "txt", "报告", "报告final", "IMG_2023", "-copy.txt", "deepinreportreportreportreport" };
+    for (const QByteArray &needle : needles) {
+        for (bool ignoreCase : { true, false }) {
+            FsearchMatcher matcher;
+            ASSERT_TRUE(fsearch_matcher_init(&matcher, needle.constData(), ignoreCase));
+            for (const QByteArray &name : names) {
+                EXPECT_EQ(fsearch_matcher_match(&matcher, name.constData()), matchBefore(name.constData(), needle.constData(), ignoreCase))
+                        << name.constData() << " " << needle.constData();
+            }
+            fsearch_matcher_clear(&matcher);
+        }
+    }
+}
+
+TEST_F(UT_FSearchMatcher, CasedNonAsciiNeedle)
+{
+    FsearchMatcher matcher;
+    EXPECT_FALSE(fsearch_matcher_init(&matcher, "ä", true));
+    ASSERT_TRUE(fsearch_matcher_init(&matcher, "ä", false));
+    EXPECT_TRUE(fsearch_matcher_match(&matcher, "bär"));
+    EXPECT_FALSE(fsearch_matcher_match(&matcher, "BÄR"));
+    fsearch_matcher_clear(&matcher);
+
+    ASSERT_TRUE(fsearch_matcher_init(&matcher, "", true));
+    EXPECT_TRUE(fsearch_matcher_match(&matcher, "any"));
+    fsearch_matcher_clear(&matcher);
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST_F(UT_FSearchMatcher, DISABLED_Benchmark)
+{
+    static constexpr int kNames { 1000000 };
+    const QVector<QByteArray> &names = createNames(kNames);
+    const QList<QByteArray> needles { "report", "TXT", "报告", "final-copy" };
+
+    for (const QByteArray &needle : needles) {
+        QElapsedTimer timer;
+        timer.start();
+        int before = 0;
+        for (const QByteArray &name : names)
+            before += matchBefore(name.constData(), needle.constData(), true);
+        const qint64 beforeTime = timer.nsecsElapsed();
+
+        FsearchMatcher matcher;
+        fsearch_matcher_init(&matcher, needle.constData(), true);
+        timer.restart();
+        int after = 0;
+        for (const QByteArray &name : names)
+            after += fsearch_matcher_match(&matcher, name.constData());
+        const qint64 afterTime = timer.nsecsElapsed();
+        fsearch_matcher_clear(&matcher);
+
+        EXPECT_EQ(before, after);
+        qInfo() << "fsearch match" << needle << "in" << kNames << "names:"
+                << 1e9 / qMax<qint64>(beforeTime, 1) << "queries/s before,"
+                << 1e9 / qMax<qint64>(afterTime, 1) << "queries/s with the matcher";
+    }
+}
@@ -0,0 +1,247 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "searchmanager/searcher/fsearch/fsearchdatabase.h"
+#include "searchmanager/searcher/fsearch/fsearchhandler.h"
+
+#include "stubext.h"
+
+#include <gtest/gtest.h>
+
+#include <QTemporaryDir>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QDebug>
+
+#include <utime.h>
+
+DPSEARCH_USE_NAMESPACE
+
+class UT_FSearchDatabase : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        rootPath = dir.path() + "/root";
+        savePath = dir.path() + "/save";
+        stub.set_lamda(&FSearchDatabase::savePathOf, [this] { __DBG_STUB_INVOKE__ return savePath; });
+
+        createFile("a/1.txt");
+        createFile("a/2.txt");
+        createFile("b/3.txt");
+        createFile(".hidden");
+    }
+    void TearDown() override
+    {
+        stub.clear();
+    }
+
+    void createFile(const QString &name) const
+    {
+        const QString &path = rootPath + "/" + name;
+        QDir().mkpath(QFileInfo(path).path());
+        QFile file(path);
+        file.open(QIODevice::WriteOnly);
+    }
+
+    // the mtime is in seconds, a change in the second of the walk is not seen otherwise
+    void touchLater(const QString &name) const
+    {
+        const qint64 later = QDateTime::currentSecsSinceEpoch() + 10;
+        struct utimbuf times { static_cast<time_t>(later), static_cast<time_t>(later) };
+        utime(QFile::encodeName(rootPath + "/" + name).constData(), &times);
+    }
+
+    QSharedPointer<FSearchDatabase> loadDatabase() const
+    {
+        QSharedPointer<FSearchDatabase> database(new FSearchDatabase(rootPath));
+        bool stop = false;
+        database->load(&stop);
+        return database;
+    }
+
+    QTemporaryDir dir;
+    QString rootPath;
+    QString savePath;
+    stub_ext::StubExt stub;
+};
+
+TEST_F(UT_FSearchDatabase, BuildSaveAndLoad)
+{
+    bool stop = false;
+    FSearchDatabase notSaved(rootPath);
+    EXPECT_FALSE(notSaved.load(&stop, false));
+
+    const QSharedPointer<FSearchDatabase> &database = loadDatabase();
+    ASSERT_TRUE(database->isLoaded());
+    EXPECT_EQ(database->entryCount(), 5u);
+    EXPECT_LE(database->age(), 1);
+    EXPECT_TRUE(database->save());
+
+    FSearchDatabase saved(rootPath);
+    ASSERT_TRUE(saved.load(&stop, false));
+    EXPECT_EQ(saved.entryCount(), 5u);
+    EXPECT_TRUE(saved.findNode(rootPath + "/b/3.txt"));
+    EXPECT_FALSE(saved.findNode(rootPath + "/b/4.txt"));
+    EXPECT_FALSE(saved.findNode(rootPath + "/.hidden"));
+}
+
+TEST_F(UT_FSearchDatabase, ApplyChanges)
+{
+    const QSharedPointer<FSearchDatabase> &database = loadDatabase();
+    createFile("c/4.txt");
+    createFile("c/.5.txt");
+    QFile::remove(rootPath + "/a/1.txt");
+    database->doUpdate({ rootPath, rootPath + "/a" }, false);
+
+    EXPECT_EQ(database->entryCount(), 6u);
+    EXPECT_TRUE(database->findNode(rootPath + "/c/4.txt"));
+    EXPECT_FALSE(database->findNode(rootPath + "/c/.5.txt"));
+    EXPECT_FALSE(database->findNode(rootPath + "/a/1.txt"));
+    EXPECT_TRUE(database->modified.loadAcquire());
+
+    // the entries are still sorted, directories first
+    Database *db = database->database();
+    for (uint32_t i = 0; i < db->num_entries; ++i) {
+        auto *node = static_cast<BTreeNode *>(darray_get_item(db->entries, i));
+        ASSERT_TRUE(node);
+        EXPECT_EQ(node->pos, i);
+    }
+    EXPECT_STREQ(static_cast<BTreeNode *>(darray_get_item(db->entries, 0))->name, "a");
+    EXPECT_STREQ(static_cast<BTreeNode *>(darray_get_item(db->entries, 3))->name, "2.txt");
+}
+
+TEST_F(UT_FSearchDatabase, CheckDirectories)
+{
+    const QSharedPointer<FSearchDatabase> &database = loadDatabase();
+    createFile("b/4.txt");
+    touchLater("b");
+    database->doUpdate({}, true);
+
+    EXPECT_EQ(database->entryCount(), 6u);
+    EXPECT_TRUE(database->findNode(rootPath + "/b/4.txt"));
+
+    // nothing changed since
+    database->modified.storeRelease(0);
+    database->doUpdate({}, true);
+    EXPECT_FALSE(database->modified.loadAcquire());
+}
+
+TEST_F(UT_FSearchDatabase, LoadInBackground)
+{
+    QSharedPointer<FSearchDatabase> database(new FSearchDatabase(rootPath));
+    FSearchHandler handler;
+    handler.init();
+
+    // the path is walked until the database is loaded
+    EXPECT_FALSE(handler.attachDatabase(database, rootPath + "/a"));
+    database->loadThread->wait();
+    EXPECT_TRUE(database->isLoaded());
+    EXPECT_TRUE(handler.attachDatabase(database, rootPath + "/a"));
+}
+
+TEST_F(UT_FSearchDatabase, WatchBudget)
+{
+    stub.set_lamda(&FSearchDatabase::watchCount, [] { __DBG_STUB_INVOKE__ return 2; });
+    const QSharedPointer<FSearchDatabase> &database = loadDatabase();
+    const QStringList &dirs = database->directoriesToWatch();
+    ASSERT_EQ(dirs.count(), 2);
+    EXPECT_EQ(dirs.first(), rootPath);
+}
+
+TEST_F(UT_FSearchDatabase, ReleaseWatchesWhenIdle)
+{
+    const QSharedPointer<FSearchDatabase> &database = loadDatabase();
+    database->startWatching(database->directoriesToWatch(), false);
+    ASSERT_TRUE(database->watcher);
+    EXPECT_TRUE(database->idleTimer->isActive());
+
+    database->releaseWatches();
+    EXPECT_FALSE(database->watcher);
+
+    // watched again by the next search
+    database->keepWatching();
+    ASSERT_TRUE(database->watcher);
+    EXPECT_EQ(database->watcher->directories().count(), database->directoriesToWatch().count());
+}
+
+TEST_F(UT_FSearchDatabase, SearchInPath)
+{
+    const QSharedPointer<FSearchDatabase> &database = loadDatabase();
+    FSearchHandler handler;
+    handler.init();
+    handler.setMaxResults(10);
+    ASSERT_TRUE(handler.attachDatabase(database, rootPath + "/a"));
+
+    DatabaseSearchEntry inPath { database->findNode(rootPath + "/a/1.txt"), 0 };
+    DatabaseSearchResult data;
+    data.num_files = 1;
+    data.num_folders = 0;
+    data.cb_data = nullptr;
+    data.results = g_ptr_array_sized_new(1);
+    g_ptr_array_add(data.results, &inPath);
+
+    // only the entries under the path are matched, with the limit of the results
+    QStringList matched;
+    uint32_t maxResults = 0;
+    stub_ext::StubExt st;
+    st.set_lamda(db_perform_search, [&] {
+        __DBG_STUB_INVOKE__
+        DatabaseSearch *search = handler.app->search;
+        for (uint32_t i = 0; i < search->num_entries; ++i)
+            matched << static_cast<BTreeNode *>(darray_get_item(search->entries, i))->name;
+        maxResults = search->max_results;
+        FSearchHandler::reveiceResultsCallback(&data, &handler);
+    });
+
+    QStringList results;
+    auto callback = [&](const QString &file, bool finished) {
+        if (!finished)
+            results << file;
+    };
+    EXPECT_TRUE(handler.search("txt", callback));
+    EXPECT_EQ(matched, (QStringList { "1.txt", "2.txt" }));
+    EXPECT_EQ(maxResults, 10u);
+    EXPECT_EQ(results, QStringList { rootPath + "/a/1.txt" });
+    EXPECT_FALSE(handler.searchEntries);
+
+    // the read lock is released with the results
+    EXPECT_TRUE(database->lock()->tryLockForWrite());
+    database->lock()->unlock();
+    g_ptr_array_free(data.results, TRUE);
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST_F(UT_FSearchDatabase, DISABLED_Benchmark)
+{
+    static constexpr int kDirs { 50 };
+    static constexpr int kFiles { 200 };
+    for (int i = 0; i < kDirs; ++i) {
+        for (int j = 0; j < kFiles; ++j)
+            createFile(QString("dir%1/file%2.txt").arg(i).arg(j));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const QSharedPointer<FSearchDatabase> &database = loadDatabase();
+    const qint64 buildTime = timer.nsecsElapsed();
+    ASSERT_EQ(database->entryCount(), quint32(5 + kDirs + kDirs * kFiles));
+
+    createFile("dir0/new.txt");
+    timer.restart();
+    database->doUpdate({ rootPath + "/dir0" }, false);
+    const qint64 updateTime = timer.nsecsElapsed();
+
+    touchLater("dir1");
+    timer.restart();
+    database->doUpdate({}, true);
+    const qint64 checkTime = timer.nsecsElapsed();
+
+    qInfo() << "fsearch database of" << database->entryCount() << "entries: walk" << buildTime / 1000
+            << "us, sync a directory" << updateTime / 1000 << "us, check all directories" << checkTime / 1000 << "us";
+}
@@ -43,6 +43,7 @@ TEST(FSearcherTest, ut_search_2)
     FSearcher searcher(QUrl::fromLocalFile("/"), "test");
 
     stub_ext::StubExt st;
+    st.set_lamda(&FSearchHandler::attachDatabase, [] { __DBG_STUB_INVOKE__ return false; });
     st.set_lamda(&FSearchHandler::loadDatabase, [] { __DBG_STUB_INVOKE__ return true; });
     st.set_lamda(&FSearchHandler::search, [&] { __DBG_STUB_INVOKE__ return true; });
     st.set_lamda(VADDR(FSearcher, hasItem), [] { __DBG_STUB_INVOKE__ return true; });
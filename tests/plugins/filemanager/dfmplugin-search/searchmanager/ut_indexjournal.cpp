@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "searchmanager/searcher/fulltext/indexjournal.h"
+
+#include <gtest/gtest.h>
+
+#include <QTemporaryDir>
+#include <QFile>
+
+DPSEARCH_USE_NAMESPACE
+
+static IndexFileState makeState(qint64 size)
+{
+    IndexFileState state;
+    state.inode = 42;
+    state.mtimeSec = 1000;
+    state.mtimeNsec = 5;
+    state.size = size;
+    return state;
+}
+
+TEST(IndexJournalTest, ut_saveAndLoad)
+{
+    QTemporaryDir dir;
+    const QString &path = dir.filePath("journal");
+
+    IndexJournal journal(path);
+    EXPECT_FALSE(journal.load());
+    journal.update("/home/test/a.txt", makeState(1));
+    journal.update("/home/test/b.txt", makeState(2));
+    EXPECT_TRUE(journal.isModified());
+    EXPECT_TRUE(journal.save());
+    EXPECT_FALSE(journal.isModified());
+
+    IndexJournal loaded(path);
+    EXPECT_TRUE(loaded.load());
+    EXPECT_EQ(2, loaded.count());
+    EXPECT_FALSE(loaded.isChanged("/home/test/a.txt", makeState(1)));
+    EXPECT_TRUE(loaded.isChanged("/home/test/a.txt", makeState(3)));
+    EXPECT_TRUE(loaded.isChanged("/home/test/c.txt", makeState(1)));
+}
+
+TEST(IndexJournalTest, ut_brokenFile)
+{
+    QTemporaryDir dir;
+    const QString &path = dir.filePath("journal");
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("broken journal");
+    file.close();
+
+    IndexJournal journal(path);
+    EXPECT_FALSE(journal.load());
+    EXPECT_EQ(0, journal.count());
+}
+
+TEST(IndexJournalTest, ut_unseenFiles)
+{
+    QTemporaryDir dir;
+    IndexJournal journal(dir.filePath("journal"));
+    journal.update("/home/test/a.txt", makeState(1));
+    journal.update("/home/test/sub/b.txt", makeState(1));
+    journal.update("/home/test2/c.txt", makeState(1));
+
+    journal.beginScan();
+    journal.markSeen("/home/test/a.txt");
+
+    const QStringList &unseen = journal.unseenFiles("/home/test");
+    EXPECT_EQ(QStringList { "/home/test/sub/b.txt" }, unseen);
+
+    journal.remove("/home/test/sub/b.txt");
+    EXPECT_TRUE(journal.unseenFiles("/home/test/").isEmpty());
+    EXPECT_EQ(2, journal.count());
+}
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "searchmanager/searcher/fulltext/indexpipeline.h"
+
+#include <gtest/gtest.h>
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <QDebug>
+
+DPSEARCH_USE_NAMESPACE
+
+static Lucene::DocumentPtr slowDocument(const QString &file)
+{
+    // a parser spending 2ms on each document
+    QThread::msleep(2);
+    Lucene::DocumentPtr doc = Lucene::newLucene<Lucene::Document>();
+    doc->add(Lucene::newLucene<Lucene::Field>(L"path", file.toStdWString(), Lucene::Field::STORE_YES, Lucene::Field::INDEX_NOT_ANALYZED));
+    return doc;
+}
+
+static int runPipeline(IndexPipeline *pipeline, int count)
+{
+    int finished = 0;
+    for (int i = 0; i < count; ++i) {
+        pipeline->push({ QString("/home/test/%1.txt").arg(i), IndexFileState(), false, nullptr });
+        finished += pipeline->takeFinished().count();
+    }
+    for (const auto &task : pipeline->finish()) {
+        EXPECT_TRUE(task.doc);
+        ++finished;
+    }
+    return finished;
+}
+
+TEST(IndexPipelineTest, ut_extractAll)
+{
+    IndexPipeline pipeline(slowDocument, 4);
+    EXPECT_EQ(4, pipeline.workerCount());
+    EXPECT_EQ(100, runPipeline(&pipeline, 100));
+}
+
+TEST(IndexPipelineTest, ut_extractFailed)
+{
+    IndexPipeline pipeline([](const QString &) -> Lucene::DocumentPtr { throw std::runtime_error("broken file"); }, 2);
+    pipeline.push({ "/home/test/broken.pdf", IndexFileState(), true, nullptr });
+
+    const auto &tasks = pipeline.finish();
+    ASSERT_EQ(1, tasks.count());
+    EXPECT_FALSE(tasks.first().doc);
+    EXPECT_TRUE(tasks.first().update);
+}
+
+TEST(IndexPipelineTest, ut_cancel)
+{
+    IndexPipeline pipeline(slowDocument, 1);
+    for (int i = 0; i < 4; ++i)
+        pipeline.push({ QString("/home/test/%1.txt").arg(i), IndexFileState(), false, nullptr });
+
+    pipeline.cancel();
+    pipeline.push({ "/home/test/after.txt", IndexFileState(), false, nullptr });
+    EXPECT_GT(4, pipeline.finish().count());
+    EXPECT_EQ(0, pipeline.pendingCount());
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST(IndexPipelineTest, DISABLED_ut_throughputBenchmark)
+{
+    const int count = 1000;
+    for (int workers : { 1, QThread::idealThreadCount() }) {
+        IndexPipeline pipeline(slowDocument, workers);
+        QElapsedTimer timer;
+        timer.start();
+        EXPECT_EQ(count, runPipeline(&pipeline, count));
+        const qint64 elapsed = qMax<qint64>(1, timer.elapsed());
+        qInfo() << "index pipeline workers: " << pipeline.workerCount() << " documents: " << count
+                << " spending: " << elapsed << "ms documents/s: " << count * 1000 / elapsed;
+    }
+}
@@ -7,6 +7,7 @@
 #include "utils/searchhelper.h"
 #include "events/searcheventreceiver.h"
 #include "utils/custommanager.h"
+#include "searchmanager/searcher/fsearch/fsearchdatabase.h"
 
 #include "plugins/common/core/dfmplugin-menu/menu_eventinterface_helper.h"
 
@@ -45,6 +46,7 @@ TEST(SearchTest, ut_start)
         delete creator;
         return QVariant();
     });
+    st.set_lamda(&FSearchDatabase::loadSavedDatabases, [] { __DBG_STUB_INVOKE__ });
 
     Search search;
     EXPECT_TRUE(search.start());